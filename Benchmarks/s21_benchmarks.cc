@@ -0,0 +1,632 @@
+/**
+ * @file s21_benchmarks.cc
+ * @brief Throughput benchmarks of the compiled expression evaluator.
+ *
+ * Built and run by `make benchmarks`. Every expression case evaluates a
+ * batch of x values through Program and reports millions of points per
+ * second, along with the ratio to the first case of its group. The credit
+ * cases report millions of loans per second, the deposit case the time of
+ * one calculation, the simulation case millions of paths per second, the
+ * formatting cases millions of values per second against snprintf, the
+ * library case the time to get a library of expressions ready to evaluate
+ * and the plotting cases the single-precision evaluation against double,
+ * with its largest error in pixels and the share of values it recomputed.
+ * The fusion case plots several functions sharing subexpressions, each
+ * through its own program against a single fused set, and the curve cases
+ * the time to sample a dense curve and to thin it for drawing. The graph
+ * cases sample with the interval bounds that skip what cannot be seen and
+ * break the poles, against evaluating every point. The typing case types a
+ * long expression key by key and deletes it again, previewing it after each
+ * key by the incremental parser against running the Model on the whole text.
+ * The scaling cases run a loop and a reduction on pools of one thread up to
+ * every core, and time an interactive loop while a batch job holds the
+ * pool, queued in either lane. The history case recalls calculations from
+ * the mapped history against running the Model on them again.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../Model/s21_creditmodel.h"
+#include "../Model/s21_curvesampler.h"
+#include "../Model/s21_depositmodel.h"
+#include "../Model/s21_format.h"
+#include "../Model/s21_graphsampler.h"
+#include "../Model/s21_historyfile.h"
+#include "../Model/s21_implicitsampler.h"
+#include "../Model/s21_incrementalparser.h"
+#include "../Model/s21_model.h"
+#include "../Model/s21_portfolio.h"
+#include "../Model/s21_program.h"
+#include "../Model/s21_programfile.h"
+#include "../Model/s21_programset.h"
+#include "../Model/s21_simulation.h"
+#include "../Model/s21_threadpool.h"
+
+namespace {
+
+constexpr std::size_t kPoints = 1 << 20;
+constexpr int kRepetitions = 20;
+
+/// Returns the seconds elapsed since @p start.
+double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+/// Returns millions of points per second for the batch evaluation.
+double Throughput(const std::string& expression) {
+  s21::Model model;
+  model.SetInput(expression);
+  s21::Program program = model.CompileMathExpression();
+
+  std::vector<double> x(kPoints), y(kPoints);
+  for (std::size_t i = 0; i < kPoints; ++i)
+    x[i] = -10.0 + 20.0 * i / kPoints;
+  program.Evaluate(x.data(), y.data(), kPoints);  // Warm-up
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRepetitions; ++r)
+    program.Evaluate(x.data(), y.data(), kPoints);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return kPoints * kRepetitions / elapsed.count() / 1e6;
+}
+
+/// Runs a group of cases, the first one being the baseline.
+void RunGroup(const char* title, const std::vector<std::string>& cases) {
+  std::printf("%s\n", title);
+  double baseline = 0.0;
+  for (const std::string& expression : cases) {
+    double throughput = Throughput(expression);
+    if (baseline == 0.0) baseline = throughput;
+    std::printf("  %-44s %9.1f Mpts/s  %5.2fx\n", expression.c_str(),
+                throughput, throughput / baseline);
+  }
+}
+
+/// Prices a synthetic portfolio of @p count loans, one by one and in batch.
+void RunPortfolio(std::size_t count) {
+  std::vector<double> amount(count), rate(count);
+  std::vector<int> term(count), k(count);
+  std::vector<char> type(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    amount[i] = 10'000 + (i * 7919) % 5'000'000;
+    term[i] = 1 + i % 30;
+    rate[i] = 0.5 + (i % 400) * 0.05;
+    type[i] = (i % 3) ? 'a' : 'd';
+    k[i] = 12;
+  }
+  std::vector<double> payment(count), overpayment(count), total(count);
+  std::printf("Portfolio of %zu loans\n", count);
+
+  auto start = std::chrono::steady_clock::now();
+  s21::CreditModel model;
+  double checksum = 0.0;
+  for (std::size_t i = 0; i < count; ++i)
+    checksum += std::get<2>(model.CalculateResult(k[i], amount[i], term[i],
+                                                  rate[i], 1, type[i]));
+  double elapsed = Seconds(start);
+  std::printf("  %-44s %9.1f Mloans/s  %.3f s\n", "CreditModel per loan",
+              count / elapsed / 1e6, elapsed);
+
+  start = std::chrono::steady_clock::now();
+  s21::Portfolio::Summary summary = s21::Portfolio().Calculate(
+      {amount.data(), term.data(), rate.data(), type.data(), k.data(), count},
+      {payment.data(), overpayment.data(), total.data()});
+  elapsed = Seconds(start);
+  std::printf("  %-44s %9.1f Mloans/s  %.3f s\n", "Portfolio batch",
+              count / elapsed / 1e6, elapsed);
+  std::printf("  total %.2f, per loan sum %.2f\n", summary.total, checksum);
+
+  // The payments just computed make every solve well-posed
+  s21::Portfolio::Loans loans{amount.data(), term.data(), rate.data(),
+                              type.data(),   k.data(),    count};
+  std::vector<double> solution(count);
+  for (auto [unknown, title] :
+       {std::pair{s21::CreditModel::Unknown::kRate, "Solve for rate"},
+        std::pair{s21::CreditModel::Unknown::kPeriods, "Solve for periods"},
+        std::pair{s21::CreditModel::Unknown::kAmount, "Solve for amount"}}) {
+    start = std::chrono::steady_clock::now();
+    std::size_t failed = s21::Portfolio().Solve(unknown, loans, payment.data(),
+                                                solution.data());
+    elapsed = Seconds(start);
+    std::printf("  %-44s %9.1f Msolves/s %.3f s, %zu failed\n", title,
+                count / elapsed / 1e6, elapsed, failed);
+  }
+}
+
+/// Fills a rate x term grid, cell by cell and with shared power tables.
+void RunGrid(std::size_t rates, int terms) {
+  s21::CreditModel model;
+  s21::CreditModel::Grid grid;
+  for (std::size_t i = 0; i < rates; ++i) grid.rates.push_back(0.01 * (i + 1));
+  for (int j = 1; j <= terms; ++j) grid.terms.push_back(j);
+  std::size_t cells = rates * terms;
+  std::printf("Grid of %zu rates x %d terms, monthly\n", rates, terms);
+
+  auto start = std::chrono::steady_clock::now();
+  double checksum = 0.0;
+  for (double rate : grid.rates)
+    for (int term : grid.terms)
+      checksum +=
+          std::get<0>(model.CalculateResult(1, 1'000'000, term, rate, 1, 'a'));
+  double elapsed = Seconds(start);
+  std::printf("  %-44s %9.1f Mcells/s  %.3f s\n", "CalculateResult per cell",
+              cells / elapsed / 1e6, elapsed);
+
+  start = std::chrono::steady_clock::now();
+  model.CalculateGrid(1, 1'000'000, 'a', grid);
+  elapsed = Seconds(start);
+  double sum = 0.0;
+  for (double payment : grid.payment) sum += payment;
+  std::printf("  %-44s %9.1f Mcells/s  %.3f s\n", "CalculateGrid",
+              cells / elapsed / 1e6, elapsed);
+  std::printf("  payments %.2f, per cell sum %.2f\n", sum, checksum);
+}
+
+/// Times a 30-year deposit with daily capitalization and many events.
+void RunDeposit(int event_count) {
+  using Event = s21::DepositModel::Event;
+  std::vector<Event> events;
+  for (int i = 0; i < event_count; ++i) {
+    Event::Type type = (i % 10 == 0)  ? Event::Type::kRateChange
+                       : (i % 3 != 0) ? Event::Type::kReplenishment
+                                      : Event::Type::kWithdrawal;
+    events.push_back({(i * 7919) % (30 * 365), type,
+                      type == Event::Type::kRateChange ? 3.0 + i % 7 : 1000.0});
+  }
+  s21::DepositModel::Deposit deposit{1'000'000, 30 * 365, 7.5, 13,
+                                     s21::DepositModel::Periodicity::kDaily,
+                                     true};
+  s21::DepositModel model;
+  constexpr int kRuns = 1000;
+  double checksum = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRuns; ++r)
+    checksum += model.Calculate(deposit, events).balance;
+  double elapsed = Seconds(start);
+  std::printf("Deposit, 30 years, daily capitalization\n");
+  std::printf("  %-44s %9.1f us/calc   balance %.2f\n",
+              (std::to_string(event_count) + " events").c_str(),
+              elapsed / kRuns * 1e6, checksum / kRuns);
+}
+
+/// Times a Monte Carlo run of a 20-year credit with yearly rate resets.
+void RunSimulation(std::size_t paths) {
+  s21::Simulation::Scenario scenario{12,   2'000'000, 20,    9.0, 'a',
+                                     0.75, 12,        0.005, paths, 1};
+  auto start = std::chrono::steady_clock::now();
+  auto result = s21::Simulation().Simulate(scenario, {0.05, 0.5, 0.95});
+  double elapsed = Seconds(start);
+  std::printf("Simulation, 20 years, yearly resets, prepayments\n");
+  std::printf("  %-44s %9.1f M paths/s   p50 %.0f, p95 %.0f\n",
+              (std::to_string(paths) + " paths").c_str(),
+              paths / elapsed * 1e-6, result.quantiles[1],
+              result.quantiles[2]);
+}
+
+/// Times formatting of results spread over many magnitudes.
+void RunFormat(std::size_t count) {
+  std::vector<double> values(count);
+  for (std::size_t i = 0; i < count; ++i)
+    values[i] = std::sin(i * 0.37) * std::pow(10.0, i % 13 - 4.0);
+  char buffer[s21::Format::kBufferSize];
+  // Summed lengths keep the compiler from dropping the formatting
+  volatile std::size_t length = 0;
+  auto time = [&](auto&& format) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t sum = 0;
+    for (double value : values) sum += format(value);
+    length = length + sum;
+    return count / Seconds(start) * 1e-6;
+  };
+  std::printf("Formatting, values of 17 magnitudes\n");
+  const std::tuple<const char*, double, double> cases[] = {
+      {"shortest round trip vs %.17g",
+       time([&](double v) {
+         return std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+       }),
+       time([&](double v) {
+         return static_cast<int>(s21::Format::Shortest(v, buffer).size());
+       })},
+      {"2 decimals vs %.2f",
+       time([&](double v) {
+         return std::snprintf(buffer, sizeof(buffer), "%.2f", v);
+       }),
+       time([&](double v) {
+         return static_cast<int>(s21::Format::Fixed(v, 2, buffer).size());
+       })}};
+  for (const auto& [title, printf_rate, format_rate] : cases)
+    std::printf("  %-44s %9.1f M values/s   x%.2f\n", title, format_rate,
+                format_rate / printf_rate);
+}
+
+/// Times parsing a library of expressions against mapping it precompiled.
+void RunProgramFile(std::size_t count) {
+  std::vector<std::string> expressions;
+  for (std::size_t i = 0; i < count; ++i)
+    expressions.push_back("sin(x)^2*" + std::to_string(i) +
+                          "+sqrt(abs(x-" + std::to_string(i % 97) +
+                          "))/(1+x^2)-ln(2+cos(x))");
+  const char* path = "s21_bench_programs.bin";
+  s21::ProgramFile::Compile(path, expressions);
+
+  std::vector<double> values(count);
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    s21::Model model;
+    model.SetInput(expressions[i]);
+    values[i] = model.CompileMathExpression().Evaluate(0.5);
+  }
+  double parsed = Seconds(start);
+  std::size_t mismatches = 0;
+  start = std::chrono::steady_clock::now();
+  s21::ProgramFile file(path);
+  for (std::size_t i = 0; i < count; ++i)
+    mismatches += file.Find(expressions[i])->Evaluate(0.5) != values[i];
+  double mapped = Seconds(start);
+  std::remove(path);
+
+  std::printf("Expression library, parsed vs precompiled file\n");
+  std::printf("  %-44s %9.1f ms vs %.1f ms   x%.1f, %zu mismatches\n",
+              (std::to_string(count) + " expressions").c_str(), parsed * 1e3,
+              mapped * 1e3, parsed / mapped, mismatches);
+}
+
+/// Calculates expressions with the Model, then recalls them from a history
+/// reopened as in a new session.
+void RunHistory(std::size_t count) {
+  std::vector<std::string> expressions;
+  for (std::size_t i = 0; i < count; ++i)
+    expressions.push_back("sin(x)^2*" + std::to_string(i) +
+                          "+sqrt(abs(x-" + std::to_string(i % 97) +
+                          "))/(1+x^2)-ln(2+cos(x))");
+  const char* path = "s21_bench_history.bin";
+  std::remove(path);
+
+  std::vector<double> values(count);
+  auto start = std::chrono::steady_clock::now();
+  s21::Model model;
+  model.SetX(0.5);
+  for (std::size_t i = 0; i < count; ++i) {
+    model.SetInput(expressions[i]);
+    values[i] = model.CalculateMathExpression();
+  }
+  double calculated = Seconds(start);
+  {
+    s21::HistoryFile history(path);
+    for (std::size_t i = 0; i < count; ++i)
+      history.Append(expressions[i], expressions[i], 0.5, values[i], 0);
+  }
+  std::size_t mismatches = 0;
+  start = std::chrono::steady_clock::now();
+  s21::HistoryFile history(path);
+  for (std::size_t i = 0; i < count; ++i)
+    mismatches += history.Find(expressions[i], 0.5) != values[i];
+  double recalled = Seconds(start);
+  std::remove(path);
+
+  std::printf("History, calculated vs recalled from the mapped log\n");
+  std::printf("  %-44s %9.1f ms vs %.1f ms   x%.1f, %zu mismatches\n",
+              (std::to_string(count) + " expressions").c_str(),
+              calculated * 1e3, recalled * 1e3, calculated / recalled,
+              mismatches);
+}
+
+/// Samples expressions as the graph does, on a plot 310 pixels high
+/// showing y from -10 to 10, in double and in the fast single mode.
+void RunPlot(const std::vector<std::string>& cases) {
+  const double pixel = 20.0 / 310;
+  std::vector<double> x(kPoints), exact(kPoints), fast(kPoints);
+  for (std::size_t i = 0; i < kPoints; ++i)
+    x[i] = -10.0 + 20.0 * i / kPoints;
+  std::printf("Plotting, double vs single with fallback, half-pixel bound\n");
+  for (const std::string& expression : cases) {
+    s21::Model model;
+    model.SetInput(expression);
+    s21::Program program = model.CompileMathExpression();
+    program.Evaluate(x.data(), exact.data(), kPoints);  // Warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; ++r)
+      program.Evaluate(x.data(), exact.data(), kPoints);
+    double double_time = Seconds(start);
+    std::size_t retries = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; ++r)
+      retries = program.EvaluateFast(x.data(), fast.data(), kPoints, pixel / 2);
+    double fast_time = Seconds(start);
+
+    double worst = 0.0;
+    for (std::size_t i = 0; i < kPoints; ++i)
+      if (std::isfinite(exact[i]))
+        worst = std::max(worst, std::abs(fast[i] - exact[i]) / pixel);
+    std::printf("  %-36s %7.1f vs %7.1f Mpts/s  x%.2f, %.3f px, %4.1f%% in "
+                "double\n",
+                expression.c_str(), kPoints * kRepetitions / double_time / 1e6,
+                kPoints * kRepetitions / fast_time / 1e6,
+                double_time / fast_time, worst, 100.0 * retries / kPoints);
+  }
+}
+
+/// Times functions evaluated one by one against the same functions fused.
+void RunFusion(const std::vector<std::string>& cases) {
+  std::vector<s21::Program> programs;
+  s21::ProgramSet set;
+  for (const std::string& expression : cases) {
+    s21::Model model;
+    model.SetInput(expression);
+    programs.push_back(model.CompileMathExpression());
+    set.Add(programs.back());
+  }
+  std::vector<double> x(kPoints);
+  for (std::size_t i = 0; i < kPoints; ++i)
+    x[i] = -10.0 + 20.0 * i / kPoints;
+  std::vector<std::vector<double>> y(cases.size(),
+                                     std::vector<double>(kPoints));
+  std::vector<double*> results;
+  for (std::vector<double>& values : y) results.push_back(values.data());
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRepetitions; ++r)
+    for (std::size_t f = 0; f < programs.size(); ++f)
+      programs[f].Evaluate(x.data(), results[f], kPoints);
+  double separate = Seconds(start);
+  std::vector<std::vector<double>> expected = y;
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < kRepetitions; ++r)
+    set.Evaluate(x.data(), results.data(), kPoints);
+  double fused = Seconds(start);
+
+  std::printf("Plotting several functions, separate vs fused\n");
+  std::printf("  %-36s %7.1f vs %7.1f Mpts/s  x%.2f, %zu operations, %s\n",
+              (std::to_string(cases.size()) + " functions").c_str(),
+              kPoints * kRepetitions / separate / 1e6,
+              kPoints * kRepetitions / fused / 1e6, separate / fused,
+              set.Operations(), y == expected ? "equal" : "different");
+}
+
+/// Samples polar spirals r = θ of @p turns on a plot 1000 pixels wide and
+/// thins them for drawing at that scale.
+void RunCurve(const std::vector<int>& turns) {
+  s21::Model model;
+  model.SetInput("x");
+  s21::Program r = model.CompileMathExpression();
+  std::printf("Polar spirals, sampling and thinning\n");
+  for (int count : turns) {
+    double radius = 2 * M_PI * count;
+    s21::CurveSampler::Viewport viewport{-radius, radius, -radius, radius,
+                                         1000, 1000};
+    auto start = std::chrono::steady_clock::now();
+    s21::CurveSampler::Curve curve =
+        s21::CurveSampler().Polar(r, 0, radius, viewport);
+    double sampled = Seconds(start);
+    start = std::chrono::steady_clock::now();
+    s21::CurveSampler::Curve thin = s21::CurveSampler::Thin(curve, viewport);
+    double thinned = Seconds(start);
+    std::printf("  %-36s %8zu points %7.1f ms, thinned to %7zu %5.1f ms\n",
+                (std::to_string(count) + " turns").c_str(), curve.t.size(),
+                sampled * 1e3, thin.t.size(), thinned * 1e3);
+  }
+}
+
+}  // namespace
+
+void RunImplicit(const std::vector<std::string>& cases) {
+  s21::CurveSampler::Viewport viewport{-5, 5, -5, 5, 1000, 1000};
+  // The grid of the leaf cells evaluated in full, for comparison
+  std::size_t side = 513;
+  std::vector<double> x(side * side), y(side * side), f(side * side);
+  for (std::size_t i = 0; i < side * side; ++i) {
+    x[i] = -5 + 10.0 * (i % side) / (side - 1);
+    y[i] = -5 + 10.0 * (i / side) / (side - 1);
+  }
+  std::printf("Implicit curves, 1000x1000 pixels, quadtree vs full grid\n");
+  for (const std::string& expression : cases) {
+    s21::Model model;
+    model.SetInput(expression);
+    s21::Program program = model.CompileMathExpression();
+    auto start = std::chrono::steady_clock::now();
+    s21::CurveSampler::Curve curve =
+        s21::ImplicitSampler().Sample(program, viewport);
+    double sampled = Seconds(start);
+    start = std::chrono::steady_clock::now();
+    program.EvaluateXY(x.data(), y.data(), f.data(), x.size());
+    double full = Seconds(start);
+    std::printf("  %-36s %8zu points %7.2f ms, grid alone %7.2f ms\n",
+                expression.c_str(), curve.t.size(), sampled * 1e3,
+                full * 1e3);
+  }
+}
+
+/// Samples graphs as the plot does, showing y from -10 to 10 and sampled
+/// for -30 to 30, against evaluating every point in the fast mode.
+void RunGraph(const std::vector<std::string>& cases) {
+  const double pixel = 20.0 / 310;
+  std::vector<double> x(kPoints);
+  for (std::size_t i = 0; i < kPoints; ++i)
+    x[i] = -10.0 + 20.0 * i / kPoints;
+  std::printf("Graphs, interval-guided vs every point\n");
+  for (const std::string& expression : cases) {
+    s21::Model model;
+    model.SetInput(expression);
+    s21::Program program = model.CompileMathExpression();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<s21::GraphSampler::Graph> graph =
+        s21::GraphSampler().Sample({program}, x, -30, 30, pixel / 2);
+    double guided = Seconds(start);
+    start = std::chrono::steady_clock::now();
+    std::vector<double> y(kPoints);  // Allocated per plot, as graph is
+    program.EvaluateFast(x.data(), y.data(), kPoints, pixel / 2);
+    double full = Seconds(start);
+    std::size_t drawn = std::count_if(graph[0].y.begin(), graph[0].y.end(),
+                                      [](double v) { return !std::isnan(v); });
+    std::printf("  %-36s %7.2f ms vs %7.2f ms, %5.1f%% drawn\n",
+                expression.c_str(), guided * 1e3, full * 1e3,
+                100.0 * drawn / kPoints);
+  }
+}
+
+/// Types an expression of @p length characters key by key and deletes it
+/// again, timing the preview after each key.
+void RunTyping(std::size_t length) {
+  std::string text;
+  while (text.size() < length) text += "sin(x)*2.5+(x-1)/3-";
+  text += "x";
+  auto start = std::chrono::steady_clock::now();
+  s21::IncrementalParser parser;
+  parser.SetX(0.5);
+  std::size_t previews = 0;
+  for (int r = 0; r < kRepetitions; ++r) {
+    for (char c : text) {
+      parser.Append(std::string(1, c));
+      previews += parser.Preview().has_value();
+    }
+    for (std::size_t k = 0; k < text.size(); ++k) {
+      parser.Erase(1);
+      previews += parser.Preview().has_value();
+    }
+  }
+  double incremental = Seconds(start);
+  // The Model cannot tell an incomplete text, so it runs where the text
+  // ends in an operand, and each of those twice, typed and deleted
+  start = std::chrono::steady_clock::now();
+  s21::Model model;
+  model.SetX(0.5);
+  for (int r = 0; r < kRepetitions; ++r) {
+    for (std::size_t size = 1; size <= text.size(); ++size) {
+      char last = text[size - 1];
+      if (last != ')' && last != 'x' && !std::isdigit(last)) continue;
+      try {
+        model.SetInput(text.substr(0, size));
+        model.CalculateMathExpression();
+      } catch (...) {
+      }
+    }
+  }
+  double full = 2 * Seconds(start);
+  double keys = 2.0 * text.size() * kRepetitions;
+  std::printf("Typing, %zu characters, incremental vs whole text\n",
+              text.size());
+  std::printf("  %7.3f us vs %7.3f us per key, %zu previews\n",
+              incremental / keys * 1e6, full / keys * 1e6,
+              previews / kRepetitions);
+}
+
+/// Runs a loop and a reduction on pools of 1 to all the cores, and an
+/// interactive loop alone and behind a background job.
+void RunScaling() {
+  s21::Model model;
+  model.SetInput("x*sin(x)+cos(x)");
+  s21::Program program = model.CompileMathExpression();
+  std::vector<double> x(kPoints), y(kPoints);
+  for (std::size_t i = 0; i < kPoints; ++i)
+    x[i] = -10.0 + 20.0 * i / kPoints;
+  auto evaluate = [&](std::size_t begin, std::size_t end) {
+    program.Evaluate(x.data() + begin, y.data() + begin, end - begin);
+  };
+  auto sum = [&](std::size_t begin, std::size_t end) {
+    double total = 0.0;
+    for (std::size_t i = begin; i < end; ++i) total += std::sin(x[i]);
+    return total;
+  };
+  auto add = [](double& total, double part) { total += part; };
+
+  std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::size_t> sizes;
+  for (std::size_t threads = 1; threads < cores; threads *= 2)
+    sizes.push_back(threads);
+  sizes.push_back(cores);
+  std::printf("Thread pool scaling, %zu points\n", kPoints);
+  double loop_base = 0.0, reduce_base = 0.0;
+  for (std::size_t threads : sizes) {
+    s21::ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; ++r)
+      pool.ParallelFor(kPoints, evaluate, 1 << 12);
+    double loop = Seconds(start) / kRepetitions;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepetitions; ++r)
+      pool.ParallelReduce(kPoints, 1 << 12, 0.0, sum, add);
+    double reduce = Seconds(start) / kRepetitions;
+    if (threads == 1) {
+      loop_base = loop;
+      reduce_base = reduce;
+    }
+    std::printf("  %2zu threads  loop %7.2f ms (x%4.1f)  reduce %7.2f ms "
+                "(x%4.1f)\n",
+                threads, loop * 1e3, loop_base / loop, reduce * 1e3,
+                reduce_base / reduce);
+  }
+
+  // A long background job keeps every worker busy while the loop runs
+  s21::ThreadPool pool(cores);
+  auto timed = [&](s21::ThreadPool::Priority priority) {
+    auto start = std::chrono::steady_clock::now();
+    pool.ParallelFor(kPoints, evaluate, 1 << 12, priority);
+    return Seconds(start);
+  };
+  double alone = timed(s21::ThreadPool::Priority::kInteractive);
+  const std::size_t block = 1 << 12, blocks = 16 * kPoints / block;
+  std::vector<double> z(blocks * block);
+  std::thread batch([&] {
+    pool.ParallelFor(
+        blocks,
+        [&](std::size_t begin, std::size_t end) {
+          for (std::size_t b = begin; b < end; ++b)
+            program.Evaluate(x.data() + b * block % kPoints,
+                             z.data() + b * block, block);
+        },
+        1, s21::ThreadPool::Priority::kBackground);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  double interactive = timed(s21::ThreadPool::Priority::kInteractive);
+  double background = timed(s21::ThreadPool::Priority::kBackground);
+  batch.join();
+  std::printf("  loop alone %7.2f ms, behind a batch %7.2f ms interactive, "
+              "%7.2f ms background\n",
+              alone * 1e3, interactive * 1e3, background * 1e3);
+}
+
+int main() {
+  // Each group pairs cases that compile to the same number of instructions,
+  // so the ratio shows the cost of the piecewise operations themselves.
+  RunGroup("Arithmetic, 7 instructions",
+           {"(x+1)*(x-1)", "max(x+1,x-1)", "min(x+1,x-1)", "abs(x+1)*(x-1)"});
+  RunGroup("Arithmetic, 10 instructions",
+           {"(x-0)*(x+1)+(x-1)", "if(x<0,x+1,x-1)", "(x<0)*(x+1)+(x-1)"});
+  RunGroup("Transcendental, 7 instructions",
+           {"x*sin(x)+cos(x)", "if(x<0,sin(x),cos(x))",
+            "max(sin(x),cos(x))*x"});
+  RunGroup("Tiered fee, 17 instructions",
+           {"x*0.01+x*0.02+x*0.03+x*0.04+x",
+            "if(x<2,x*0.01,if(x<5,x*0.02,x*0.03))"});
+  RunPortfolio(10'000'000);
+  RunGrid(2000, 360);
+  RunDeposit(5000);
+  RunSimulation(1'000'000);
+  RunFormat(1'000'000);
+  RunProgramFile(10'000);
+  RunPlot({"x*sin(x)+cos(x)", "(x+1)*(x-1)/(x^2+1)", "sqrt(abs(x))-ln(1+x^2)",
+           "tan(x)", "sin(1000*x)", "(1+x)^2-x^2-2*x",
+           "if(x<0,x^3/20,atan(x))"});
+  RunFusion({"sin(x)^2", "sin(x)^2+cos(x)^2", "sin(x)*cos(x)",
+             "sqrt(1+sin(x)^2)", "x*sin(x)"});
+  RunCurve({10, 100, 1000});
+  RunImplicit({"x^2+y^2-1", "sin(x*y)-0.5", "y-tan(x)", "x^3-3*x*y^2-y",
+               "y^2-x^3+x"});
+  RunGraph({"x^2", "x^3-x", "tan(x)", "1/x", "x^2*sin(x)", "100*sin(50*x)"});
+  RunTyping(240);
+  RunScaling();
+  RunHistory(5000);
+  return 0;
+}
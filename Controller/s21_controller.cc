@@ -5,32 +5,454 @@
 
 #include "s21_controller.h"
 
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
 #include <QString>
+#include <QStringList>
+#include <chrono>
+#include <fstream>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
+#include "Model/s21_depositmodel.h"
+#include "Model/s21_format.h"
+#include "Model/s21_integrator.h"
+#include "Model/s21_library.h"
 #include "Model/s21_model.h"
+#include "Model/s21_programfile.h"
+#include "Model/s21_solver.h"
+
+namespace {
+
+/// Compiled expressions kept by the Controller before the cache is reset.
+constexpr std::size_t kMaxPrograms = 64;
+
+}  // namespace
+
+s21::Controller::Controller() noexcept {
+  model_.SetLibrary(&library_);
+  library_.Load(DataPath("definitions.txt").toStdString());
+  try {
+    program_file_.emplace(DataPath("programs.bin").toStdString());
+  } catch (...) {
+    program_file_.reset();
+  }
+  try {
+    history_.emplace(DataPath("history.bin").toStdString());
+  } catch (...) {
+    history_.reset();
+  }
+}
+
+bool s21::Controller::StartTracing(const QString &path) noexcept {
+  return s21::Tracer::Shared().Start(path.toStdString());
+}
+
+void s21::Controller::StopTracing() noexcept { s21::Tracer::Shared().Stop(); }
 
 /**
  * @details The mathematical expression is a QString type and requires
  * pre-processing to convert it to std::string. If the model throws any
  * exception, the controller will return "calc_error" instead of the result to
- * the View.
+ * the View. The history is keyed by the expression with the definitions
+ * inlined, so a result is not recalled once a definition it used changes.
  */
 QString s21::Controller::ProcessMathExpression(const QString &expression,
                                                double x) noexcept {
+  TraceSpan span("Controller::ProcessMathExpression", "controller");
   try {
-    model_.SetInput(expression.toStdString());
-    model_.SetX(x);
-    double result = model_.CalculateMathExpression();
-    return QString::number(result, 'g', 8);
+    std::string text = expression.toStdString();
+    std::string key = library_.Expand(text);
+    if (history_)
+      if (std::optional<double> recalled = history_->Find(key, x))
+        return FormatGeneral(*recalled, 8);
+    double result;
+    if (auto stored = FindStored(text)) {
+      result = stored->Evaluate(x);
+    } else {
+      model_.SetInput(text);
+      model_.SetX(x);
+      result = model_.CalculateMathExpression();
+    }
+    Remember(text, key, x, result);
+    return FormatGeneral(result, 8);
   } catch (...) {
     return "calc_error";
   }
 }
 
+std::vector<s21::HistoryFile::Record> s21::Controller::GetHistory(
+    std::size_t count) noexcept {
+  try {
+    return history_ ? history_->Recent(count)
+                    : std::vector<s21::HistoryFile::Record>();
+  } catch (...) {
+    return {};
+  }
+}
+
+QString s21::Controller::ProcessPreview(const QString &expression,
+                                        double x) noexcept {
+  TraceSpan span("Controller::ProcessPreview", "controller");
+  try {
+    preview_parser_.SetX(x);
+    preview_parser_.Assign(expression.toStdString());
+    std::optional<double> value = preview_parser_.Preview();
+    return value ? FormatGeneral(*value, 8) : QString();
+  } catch (...) {
+    return QString();
+  }
+}
+
+/**
+ * @details The cache is emptied first if the expressions may not all fit in
+ * it, so compiling one of them does not drop the program of another.
+ */
+bool s21::Controller::ProcessPlot(const QStringList &expressions,
+                                  const std::vector<double> &x,
+                                  std::vector<s21::GraphSampler::Graph> &graphs,
+                                  double y_min, double y_max,
+                                  double tolerance) noexcept {
+  TraceSpan span("Controller::ProcessPlot", "controller");
+  try {
+    std::size_t count = static_cast<std::size_t>(expressions.size());
+    if (count > kMaxPrograms) return false;
+    if (programs_.size() + count > kMaxPrograms) programs_.clear();
+    std::vector<s21::ProgramView> functions;
+    for (const QString &expression : expressions)
+      functions.push_back(Compile(expression));
+    graphs = graph_sampler_.Sample(functions, x, y_min, y_max, tolerance);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+/**
+ * @details The cache is emptied first if the two expressions of a
+ * parametric curve may not both fit in it, as in ProcessPlot.
+ */
+std::optional<s21::CurveSampler::Curve> s21::Controller::ProcessCurve(
+    const QStringList &expressions, double from, double to,
+    const s21::CurveSampler::Viewport &viewport) noexcept {
+  TraceSpan span("Controller::ProcessCurve", "controller");
+  try {
+    if (expressions.size() == 1)
+      return curve_sampler_.Polar(Compile(expressions.front()), from, to,
+                                  viewport);
+    if (expressions.size() != 2) return std::nullopt;
+    if (programs_.size() + 2 > kMaxPrograms) programs_.clear();
+    s21::ProgramView x = Compile(expressions.front());
+    s21::ProgramView y = Compile(expressions.back());
+    return curve_sampler_.Parametric(x, y, from, to, viewport);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::CurveSampler::Curve> s21::Controller::ProcessImplicit(
+    const QString &expression,
+    const s21::CurveSampler::Viewport &viewport) noexcept {
+  TraceSpan span("Controller::ProcessImplicit", "controller");
+  try {
+    return implicit_sampler_.Sample(Compile(expression), viewport);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+s21::CurveSampler::Curve s21::Controller::ThinCurve(
+    const s21::CurveSampler::Curve &curve,
+    const s21::CurveSampler::Viewport &viewport) {
+  return s21::CurveSampler::Thin(curve, viewport);
+}
+
+QString s21::Controller::FormatFixed(double value, int precision) noexcept {
+  char buffer[s21::Format::kBufferSize];
+  std::string_view text = s21::Format::Fixed(value, precision, buffer);
+  return QString::fromLatin1(text.data(), static_cast<int>(text.size()));
+}
+
+QString s21::Controller::FormatGeneral(double value, int precision) noexcept {
+  char buffer[s21::Format::kBufferSize];
+  std::string_view text = s21::Format::General(value, precision, buffer);
+  return QString::fromLatin1(text.data(), static_cast<int>(text.size()));
+}
+
 std::tuple<double, double, double> s21::Controller::ProcessCreditExpression(
     int months, double amount, double term, double rate, int month,
     char type) noexcept {
+  TraceSpan span("Controller::ProcessCreditExpression", "controller");
   return credit_model_.CalculateResult(months, amount, term, rate, month, type);
 }
+
+std::optional<s21::DepositModel::Result> s21::Controller::ProcessDeposit(
+    const s21::DepositModel::Deposit &deposit,
+    const std::vector<s21::DepositModel::Event> &events) noexcept {
+  try {
+    return deposit_model_.Calculate(deposit, events);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+bool s21::Controller::ProcessCreditSchedule(
+    int months, double amount, int term, double rate, char type,
+    s21::CreditModel::Schedule &schedule) noexcept {
+  TraceSpan span("Controller::ProcessCreditSchedule", "controller");
+  try {
+    credit_model_.CalculateSchedule(months, amount, term, rate, type,
+                                    schedule);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool s21::Controller::ProcessCreditGrid(int months, double amount, char type,
+                                        s21::CreditModel::Grid &grid) noexcept {
+  TraceSpan span("Controller::ProcessCreditGrid", "controller");
+  try {
+    credit_model_.CalculateGrid(months, amount, type, grid);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+std::optional<double> s21::Controller::ProcessCreditSolve(
+    s21::CreditModel::Unknown unknown, int months, double amount, int term,
+    double rate, double payment, char type) noexcept {
+  try {
+    if (unknown == s21::CreditModel::Unknown::kRate)
+      return credit_model_.SolveRate(months, amount, term, payment, type);
+    if (unknown == s21::CreditModel::Unknown::kPeriods)
+      return credit_model_.SolvePeriods(amount, rate, payment, type);
+    return credit_model_.SolveAmount(months, term, rate, payment, type);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<std::size_t> s21::Controller::ProcessPortfolioSolve(
+    s21::CreditModel::Unknown unknown, const s21::Portfolio::Loans &loans,
+    const double *payment, double *solution) noexcept {
+  using Unknown = s21::CreditModel::Unknown;
+  bool has_columns =
+      (loans.amount || unknown == Unknown::kAmount) &&
+      (loans.rate || unknown == Unknown::kRate) &&
+      ((loans.term && loans.k) || unknown == Unknown::kPeriods) &&
+      loans.type && payment && solution;
+  if (loans.size > 0 && !has_columns) return std::nullopt;
+  try {
+    return portfolio_.Solve(unknown, loans, payment, solution);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::CreditModel::VariableCredit>
+s21::Controller::ProcessVariableCredit(
+    int months, double amount, int term, double rate, char type,
+    const std::vector<s21::CreditModel::RateReset> &resets) noexcept {
+  try {
+    return credit_model_.CalculateVariableCredit(months, amount, term, rate,
+                                                 type, resets);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::Portfolio::Summary>
+s21::Controller::ProcessVariablePortfolio(
+    const s21::Portfolio::VariableLoans &loans,
+    const s21::Portfolio::Payments &payments) noexcept {
+  bool has_columns = loans.amount && loans.term && loans.type && loans.k &&
+                     loans.offsets && loans.resets && payments.payment &&
+                     payments.overpayment && payments.total;
+  if (loans.size > 0 && !has_columns) return std::nullopt;
+  try {
+    return portfolio_.CalculateVariable(loans, payments);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::Simulation::Result> s21::Controller::ProcessSimulation(
+    const s21::Simulation::Scenario &scenario,
+    const std::vector<double> &probabilities) noexcept {
+  try {
+    return simulation_.Simulate(scenario, probabilities);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::Portfolio::Summary> s21::Controller::ProcessPortfolio(
+    const s21::Portfolio::Loans &loans,
+    const s21::Portfolio::Payments &payments) noexcept {
+  bool has_columns = loans.amount && loans.term && loans.rate && loans.type &&
+                     loans.k && payments.payment && payments.overpayment &&
+                     payments.total;
+  if (loans.size > 0 && !has_columns) return std::nullopt;
+  try {
+    return portfolio_.Calculate(loans, payments);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<std::size_t> s21::Controller::ProcessBatch(
+    const QString &input, const QString &output,
+    const s21::CancellationToken &token) noexcept {
+  try {
+    return s21::BatchFile::Run(input.toStdString(), output.toStdString(),
+                               &library_, token);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::Solver::Result> s21::Controller::ProcessRoots(
+    const QString &expression, double xmin, double xmax) noexcept {
+  TraceSpan span("Controller::ProcessRoots", "controller");
+  try {
+    return solver_.Solve(Compile(expression), xmin, xmax);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+std::optional<s21::Integrator::Result> s21::Controller::ProcessIntegral(
+    const QString &expression, double a, double b) noexcept {
+  TraceSpan span("Controller::ProcessIntegral", "controller");
+  try {
+    return integrator_.Integrate(Compile(expression), a, b);
+  } catch (...) {
+    return std::nullopt;
+  }
+}
+
+bool s21::Controller::IsDefinition(const QString &input) const noexcept {
+  return s21::Library::IsDefinition(input.toStdString());
+}
+
+bool s21::Controller::ProcessDefinition(const QString &definition) noexcept {
+  try {
+    std::string name = library_.Define(definition.toStdString());
+    library_.Save(DataPath("definitions.txt").toStdString());
+    Recompile(name);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool s21::Controller::RemoveDefinition(const QString &name) noexcept {
+  if (!library_.Remove(name.toStdString())) return false;
+  library_.Save(DataPath("definitions.txt").toStdString());
+  Recompile(name.toStdString());
+  return true;
+}
+
+QStringList s21::Controller::GetDefinitions() const {
+  QStringList definitions;
+  for (const std::string &definition : library_.List())
+    definitions.append(QString::fromStdString(definition));
+  return definitions;
+}
+
+/**
+ * @details The old library is unmapped before the new one replaces it, and
+ * stays unmapped if the new one cannot be written. Other processes keep
+ * the old file mapped until they restart. The same file can be written by
+ * `s21_batch compile`.
+ */
+std::optional<std::size_t> s21::Controller::ProcessProgramFile(
+    const QString &expressions) noexcept {
+  try {
+    std::ifstream file(expressions.toStdString());
+    if (!file) return std::nullopt;
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (!line.empty()) lines.push_back(line);
+    }
+    std::string path = DataPath("programs.bin").toStdString();
+    program_file_.reset();
+    std::size_t count = s21::ProgramFile::Compile(path, lines, &library_);
+    program_file_.emplace(path);
+    return count;
+  } catch (...) {
+    program_file_.reset();
+    return std::nullopt;
+  }
+}
+
+s21::ProgramView s21::Controller::Compile(const QString &expression) {
+  std::string text = expression.toStdString();
+  if (auto stored = FindStored(text)) return *stored;
+  auto found = programs_.find(text);
+  if (found != programs_.end()) return found->second.program;
+
+  model_.SetInput(text);
+  CompiledExpression compiled{model_.CompileMathExpression(),
+                              model_.GetDependencies()};
+  if (programs_.size() >= kMaxPrograms) programs_.clear();
+  return programs_.emplace(text, std::move(compiled)).first->second.program;
+}
+
+/**
+ * @details An expression is affected if the definition was inlined into it,
+ * or if it mentions the name, which covers definitions that did not exist
+ * when the expression was compiled.
+ */
+void s21::Controller::Recompile(const std::string &name) noexcept {
+  for (auto it = programs_.begin(); it != programs_.end();) {
+    CompiledExpression &compiled = it->second;
+    if (!compiled.dependencies.count(name) &&
+        it->first.find(name) == std::string::npos) {
+      ++it;
+      continue;
+    }
+    try {
+      model_.SetInput(it->first);
+      compiled.program = model_.CompileMathExpression();
+      compiled.dependencies = model_.GetDependencies();
+      ++it;
+    } catch (...) {
+      it = programs_.erase(it);
+    }
+  }
+}
+
+std::optional<s21::ProgramView> s21::Controller::FindStored(
+    const std::string &expression) {
+  if (!program_file_) return std::nullopt;
+  return program_file_->Find(library_.Expand(expression));
+}
+
+void s21::Controller::Remember(const std::string &expression,
+                               const std::string &key, double x,
+                               double result) noexcept {
+  if (!history_) return;
+  try {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    history_->Append(
+        expression, key, x, result,
+        std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+  } catch (...) {
+    // A calculation too long for the history is simply not kept
+  }
+}
+
+QString s21::Controller::DataPath(const QString &name) {
+  QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QDir().mkpath(directory);
+  return QFileInfo(QDir(directory), name).filePath();
+}
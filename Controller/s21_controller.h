@@ -8,11 +8,31 @@
 #define SMARTCALC_CONTROLLER_S21_CONTROLLER_H_
 
 #include <QString>
+#include <QStringList>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include "../Model/s21_batchfile.h"
 #include "../Model/s21_creditmodel.h"
+#include "../Model/s21_curvesampler.h"
+#include "../Model/s21_depositmodel.h"
+#include "../Model/s21_graphsampler.h"
+#include "../Model/s21_historyfile.h"
+#include "../Model/s21_implicitsampler.h"
+#include "../Model/s21_incrementalparser.h"
+#include "../Model/s21_integrator.h"
+#include "../Model/s21_library.h"
 #include "../Model/s21_model.h"
+#include "../Model/s21_portfolio.h"
+#include "../Model/s21_programfile.h"
+#include "../Model/s21_simulation.h"
+#include "../Model/s21_solver.h"
+#include "../Model/s21_tracer.h"
 
 namespace s21 {
 
@@ -27,26 +47,161 @@ namespace s21 {
  */
 class Controller {
  public:
+  /// Span of a traced user action, see StartTracing.
+  using TraceSpan = s21::Tracer::Span;
+
   /**
    * @brief Constructor for the Controller class.
+   *
+   * Attaches the library of user definitions to the model, loads the
+   * definitions saved by a previous session and maps the precompiled
+   * expressions, if any, and the history of calculations.
    */
-  Controller() noexcept = default;
+  Controller() noexcept;
 
   /**
    * @brief Destructor for the Controller class.
    */
   ~Controller() = default;
 
+  Controller(const Controller &) = delete;
+  Controller &operator=(const Controller &) = delete;
+
+  /**
+   * @brief Starts recording the spans of user actions, controller calls and
+   * model phases into a Chrome trace-event JSON file.
+   *
+   * @param[in] path The file to write, opened by chrome://tracing or
+   * Perfetto.
+   * @return True if the file could be created.
+   */
+  static bool StartTracing(const QString &path) noexcept;
+
+  /**
+   * @brief Stops tracing and completes the file.
+   */
+  static void StopTracing() noexcept;
+
   /**
    * @brief Accepts a mathematical expression and x value, redirecting them to
    * the Model for processing.
    *
+   * A calculation made before, in this session or a previous one, with the
+   * same definitions is recalled from the history instead.
+   *
    * @param[in] expression The matematical expression.
    * @param[in] x The value of x.
    * @return The result of expression.
    */
   QString ProcessMathExpression(const QString &expression, double x) noexcept;
 
+  /**
+   * @brief Returns the latest calculations of the history.
+   *
+   * @param[in] count The number of calculations at most.
+   * @return The calculations, the latest first, or none if there is no
+   * history.
+   */
+  std::vector<s21::HistoryFile::Record> GetHistory(
+      std::size_t count) noexcept;
+
+  /**
+   * @brief Previews the value of an expression being typed, parsing only the
+   * characters changed since the last call.
+   *
+   * @param[in] expression The expression typed so far.
+   * @param[in] x The value of x.
+   * @return The value with every open parenthesis closed, or an empty string
+   * if the expression is incomplete, invalid or holds a sum, a product or a
+   * user definition.
+   */
+  QString ProcessPreview(const QString &expression, double x) noexcept;
+
+  /**
+   * @brief Samples expressions for plotting on a shared array of x values.
+   *
+   * A single expression is computed in single precision where that is
+   * accurate to @p tolerance and in double elsewhere. Several expressions
+   * are fused, so their common subexpressions are computed once per x, and
+   * are evaluated in double in one pass. Parts of the graphs bounded outside
+   * [@p y_min, @p y_max] are skipped, and the graphs are broken at poles,
+   * see GraphSampler.
+   *
+   * @param[in] expressions The matematical expressions of x.
+   * @param[in] x The abscissas.
+   * @param[out] graphs The graph of each expression: its values, one per
+   * abscissa and NaN where it is not drawn, and the steps broken at poles.
+   * @param[in] y_min The bottom of the plot.
+   * @param[in] y_max The top of the plot.
+   * @param[in] tolerance The absolute error allowed, such as half the height
+   * of a pixel.
+   * @return True on success, false if an expression or the range of y is
+   * invalid.
+   */
+  bool ProcessPlot(const QStringList &expressions,
+                   const std::vector<double> &x,
+                   std::vector<s21::GraphSampler::Graph> &graphs,
+                   double y_min, double y_max, double tolerance) noexcept;
+
+  /**
+   * @brief Samples a parametric curve x(t), y(t) or a polar curve r(θ) for
+   * a plot, with its points spaced along the curve.
+   *
+   * @param[in] expressions x(t) and y(t), or r(θ) alone, the parameter
+   * being written 'x'.
+   * @param[in] from The first value of the parameter.
+   * @param[in] to The last value of the parameter.
+   * @param[in] viewport The visible rectangle of the plot and its size.
+   * @return The curve, or std::nullopt if an expression, the range or the
+   * viewport is invalid.
+   */
+  std::optional<s21::CurveSampler::Curve> ProcessCurve(
+      const QStringList &expressions, double from, double to,
+      const s21::CurveSampler::Viewport &viewport) noexcept;
+
+  /**
+   * @brief Samples the curve f(x, y) = 0 in the visible rectangle of a plot.
+   *
+   * @param[in] expression f(x, y).
+   * @param[in] viewport The visible rectangle of the plot and its size.
+   * @return The curve, or std::nullopt if the expression or the viewport is
+   * invalid.
+   */
+  std::optional<s21::CurveSampler::Curve> ProcessImplicit(
+      const QString &expression,
+      const s21::CurveSampler::Viewport &viewport) noexcept;
+
+  /**
+   * @brief Returns the points of a sampled curve worth drawing on a plot,
+   * at least a pixel apart.
+   *
+   * @param[in] curve The curve returned by ProcessCurve or ProcessImplicit.
+   * @param[in] viewport The visible rectangle of the plot and its size.
+   */
+  static s21::CurveSampler::Curve ThinCurve(
+      const s21::CurveSampler::Curve &curve,
+      const s21::CurveSampler::Viewport &viewport);
+
+  /**
+   * @brief Formats a number with a fixed number of decimals, as shown for
+   * amounts of money.
+   *
+   * @param[in] value The number to format.
+   * @param[in] precision The number of decimals.
+   * @return The formatted number.
+   */
+  static QString FormatFixed(double value, int precision = 2) noexcept;
+
+  /**
+   * @brief Formats a number with a number of significant digits, switching
+   * to the exponent form for very large or small values.
+   *
+   * @param[in] value The number to format.
+   * @param[in] precision The number of significant digits.
+   * @return The formatted number.
+   */
+  static QString FormatGeneral(double value, int precision) noexcept;
+
   /**
    * @brief Process a credit expression and calculate annuity or differential
    * payments.
@@ -76,12 +231,302 @@ class Controller {
       int months, double amount, double term, double rate, int month,
       char type) noexcept;
 
+  /**
+   * @brief Calculates a deposit with replenishments, withdrawals and rate
+   * changes.
+   *
+   * @param[in] deposit The amount, term, rates, periodicity and
+   * capitalization.
+   * @param[in] events The changes of the deposit, in any order.
+   * @return The interest, tax and final balance, or std::nullopt if the input
+   * is invalid.
+   */
+  std::optional<s21::DepositModel::Result> ProcessDeposit(
+      const s21::DepositModel::Deposit &deposit,
+      const std::vector<s21::DepositModel::Event> &events) noexcept;
+
+  /**
+   * @brief Fills the amortization schedule of a credit.
+   *
+   * @param[in] months The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual interest rate.
+   * @param[in] type 'a' for annuity, 'd' for differential payments.
+   * @param[out] schedule The buffers receiving every period.
+   * @return True on success, false if the credit parameters are invalid.
+   */
+  bool ProcessCreditSchedule(int months, double amount, int term, double rate,
+                             char type,
+                             s21::CreditModel::Schedule &schedule) noexcept;
+
+  /**
+   * @brief Fills the payments and overpayments of every combination of the
+   * rate and term axes of a grid.
+   *
+   * @param[in] months The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] type 'a' for annuity, 'd' for differential payments.
+   * @param[in, out] grid The axes to combine and the matrices to fill.
+   * @return True on success, false if an axis value or the amount is invalid.
+   */
+  bool ProcessCreditGrid(int months, double amount, char type,
+                         s21::CreditModel::Grid &grid) noexcept;
+
+  /**
+   * @brief Finds the rate, number of periods or amount of a credit that has
+   * a given payment.
+   *
+   * @param[in] unknown The parameter to find; its argument is ignored.
+   * @param[in] months The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual interest rate.
+   * @param[in] payment The payment, the first one if differential.
+   * @param[in] type 'a' for annuity, 'd' for differential payments.
+   * @return The annual rate, the number of periods or the amount, or
+   * std::nullopt if there is no solution.
+   */
+  std::optional<double> ProcessCreditSolve(s21::CreditModel::Unknown unknown,
+                                           int months, double amount, int term,
+                                           double rate, double payment,
+                                           char type) noexcept;
+
+  /**
+   * @brief Solves a portfolio of credits for one parameter.
+   *
+   * @param[in] unknown The parameter to find.
+   * @param[in] loans The input columns; the column of the unknown may be
+   * null.
+   * @param[in] payment The payment column.
+   * @param[out] solution The solution column, NaN where there is none.
+   * @return The number of loans without a solution, or std::nullopt if a
+   * column is missing.
+   */
+  std::optional<std::size_t> ProcessPortfolioSolve(
+      s21::CreditModel::Unknown unknown, const s21::Portfolio::Loans &loans,
+      const double *payment, double *solution) noexcept;
+
+  /**
+   * @brief Calculates a credit whose annual rate resets during the term.
+   *
+   * @param[in] months The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual interest rate until the first reset.
+   * @param[in] type 'a' for annuity, 'd' for differential payments.
+   * @param[in] resets The periods and the rates in force from them on.
+   * @return The segments, overpayment and total, or std::nullopt if the input
+   * is invalid.
+   */
+  std::optional<s21::CreditModel::VariableCredit> ProcessVariableCredit(
+      int months, double amount, int term, double rate, char type,
+      const std::vector<s21::CreditModel::RateReset> &resets) noexcept;
+
+  /**
+   * @brief Prices a portfolio of variable-rate credits.
+   *
+   * @param[in] loans The amount, term, type, period and rate path columns.
+   * @param[out] payments The payment, overpayment and total columns.
+   * @return The aggregate statistics, or std::nullopt if a column is
+   * missing.
+   */
+  std::optional<s21::Portfolio::Summary> ProcessVariablePortfolio(
+      const s21::Portfolio::VariableLoans &loans,
+      const s21::Portfolio::Payments &payments) noexcept;
+
+  /**
+   * @brief Simulates a credit under random rate resets and prepayments.
+   *
+   * @param[in] scenario The credit, the rate volatility and reset interval,
+   * the prepayment probability, the number of paths and the seed.
+   * @param[in] probabilities The quantiles of the interest to estimate.
+   * @return The statistics of the interest, or std::nullopt if the input is
+   * invalid.
+   */
+  std::optional<s21::Simulation::Result> ProcessSimulation(
+      const s21::Simulation::Scenario &scenario,
+      const std::vector<double> &probabilities) noexcept;
+
+  /**
+   * @brief Prices a portfolio of credits given as columnar arrays.
+   *
+   * @param[in] loans The amount, term, rate, type and period columns.
+   * @param[out] payments The payment, overpayment and total columns.
+   * @return The aggregate statistics, or std::nullopt if a column is
+   * missing.
+   */
+  std::optional<s21::Portfolio::Summary> ProcessPortfolio(
+      const s21::Portfolio::Loans &loans,
+      const s21::Portfolio::Payments &payments) noexcept;
+
+  /**
+   * @brief Evaluates the expressions of a batch input file into a batch
+   * output file, using the user definitions.
+   *
+   * The rows are evaluated as background work, so a plot drawn meanwhile
+   * takes the cores first.
+   *
+   * @param[in] input The input file with the expressions and the x column.
+   * @param[in] output The output file to create.
+   * @param[in] token Cancels the run from another thread.
+   * @return The number of rows, or std::nullopt if a file cannot be mapped,
+   * an expression is invalid or the run was cancelled.
+   */
+  std::optional<std::size_t> ProcessBatch(
+      const QString &input, const QString &output,
+      const s21::CancellationToken &token =
+          s21::CancellationToken()) noexcept;
+
+  /**
+   * @brief Finds the roots and local extrema of an expression on an interval.
+   *
+   * @param[in] expression The matematical expression of x.
+   * @param[in] xmin The lower bound of the interval.
+   * @param[in] xmax The upper bound of the interval.
+   * @return The roots, minima and maxima, or std::nullopt if the expression
+   * or the interval is invalid.
+   */
+  std::optional<s21::Solver::Result> ProcessRoots(const QString &expression,
+                                                  double xmin,
+                                                  double xmax) noexcept;
+
+  /**
+   * @brief Computes the definite integral of an expression over [a, b].
+   *
+   * @param[in] expression The matematical expression of x.
+   * @param[in] a The lower limit of integration.
+   * @param[in] b The upper limit of integration.
+   * @return The integral and its error estimate, or std::nullopt if the
+   * expression or the limits are invalid.
+   */
+  std::optional<s21::Integrator::Result> ProcessIntegral(
+      const QString &expression, double a, double b) noexcept;
+
+  /**
+   * @brief Checks if the input defines a function or a constant.
+   *
+   * @param[in] input The text entered by the user.
+   * @return True for input such as "f(a,b)=a^2+b" or "rate=0.07".
+   */
+  bool IsDefinition(const QString &input) const noexcept;
+
+  /**
+   * @brief Registers a user-defined function or constant and saves the
+   * definitions.
+   *
+   * Compiled expressions depending on the definition are recompiled.
+   *
+   * @param[in] definition The text "name=body" or "name(a,b,...)=body".
+   * @return True if the definition is valid.
+   */
+  bool ProcessDefinition(const QString &definition) noexcept;
+
+  /**
+   * @brief Removes a user-defined function or constant and saves the
+   * definitions.
+   *
+   * @param[in] name The name of the function or constant.
+   * @return True if the definition existed.
+   */
+  bool RemoveDefinition(const QString &name) noexcept;
+
+  /**
+   * @brief Returns the user definitions in the "name(a,b)=body" form.
+   */
+  QStringList GetDefinitions() const;
+
+  /**
+   * @brief Compiles a text file of expressions, one per line, into the
+   * precompiled library mapped at startup, and maps it.
+   *
+   * Expressions found in the library are evaluated from it directly, without
+   * being parsed. Those using user definitions changed since are no longer
+   * found and are parsed as usual.
+   *
+   * @param[in] expressions The text file of expressions.
+   * @return The number of expressions compiled, or std::nullopt if a file
+   * cannot be read or written.
+   */
+  std::optional<std::size_t> ProcessProgramFile(
+      const QString &expressions) noexcept;
+
  private:
+  /**
+   * @struct CompiledExpression
+   * @brief A compiled expression and the user definitions inlined into it.
+   */
+  struct CompiledExpression {
+    s21::Program program;
+    std::set<std::string> dependencies;
+  };
+
+  /**
+   * @brief Returns the compiled form of an expression, from the precompiled
+   * library or compiling it on the first request.
+   *
+   * @throws std::invalid_argument if the expression is invalid.
+   */
+  s21::ProgramView Compile(const QString &expression);
+
+  /**
+   * @brief Looks up an expression in the precompiled library.
+   *
+   * @throws std::invalid_argument if the user definitions do not expand.
+   */
+  std::optional<s21::ProgramView> FindStored(const std::string &expression);
+
+  /**
+   * @brief Recompiles the cached expressions that use a changed definition
+   * and drops those that no longer compile.
+   *
+   * @param[in] name The name of the changed definition.
+   */
+  void Recompile(const std::string &name) noexcept;
+
+  /**
+   * @brief Appends a calculation to the history, if it fits in it.
+   */
+  void Remember(const std::string &expression, const std::string &key,
+                double x, double result) noexcept;
+
+  /**
+   * @brief Returns the file @p name of the data kept between sessions, such
+   * as the user definitions.
+   */
+  static QString DataPath(const QString &name);
+
   s21::Model model_;  //<< The associated Model instance for processing
                       // mathematical expressions.
   s21::CreditModel
       credit_model_;  //<< The associated CreditModel instance for processing
                       // credit expressions.
+  s21::DepositModel deposit_model_;  //<< The associated DepositModel instance
+                                    // for deposits.
+  s21::Solver solver_;  //<< The associated Solver instance for finding roots
+                        // and extrema.
+  s21::Portfolio portfolio_;  //<< The associated Portfolio instance for
+                              // batches of credits.
+  s21::Simulation simulation_;  //<< The associated Simulation instance for
+                                // Monte Carlo credit risk.
+  s21::Integrator integrator_;  //<< The associated Integrator instance for
+                                // definite integrals.
+  s21::GraphSampler graph_sampler_;  //<< The associated GraphSampler instance
+                                     // for the graphs of functions.
+  s21::CurveSampler curve_sampler_;  //<< The associated CurveSampler instance
+                                     // for parametric and polar curves.
+  s21::ImplicitSampler implicit_sampler_;  //<< The associated ImplicitSampler
+                                           // instance for curves f(x,y)=0.
+  s21::IncrementalParser preview_parser_;  //<< The parser kept between key
+                                           // presses for the live preview.
+  s21::Library library_;  //<< User-defined functions and constants inlined
+                          // by the Model.
+  std::map<std::string, CompiledExpression>
+      programs_;  //<< Compiled expressions by their text.
+  std::optional<s21::ProgramFile>
+      program_file_;  //<< The precompiled library, if there is one.
+  std::optional<s21::HistoryFile>
+      history_;  //<< The calculations of every session, if the file opened.
 };
 }  // namespace s21
 
@@ -0,0 +1,231 @@
+/**
+ * @file s21_batchfile.cc
+ * @brief Implementation file for the s21_batchfile.h.
+ */
+
+#include "s21_batchfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_model.h"
+#include "s21_program.h"
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', '2', '1', 'B', 'A', 'T', 'C', 'H'};
+constexpr std::uint32_t kVersion = 1;
+/// Alignment of the first column, a cache line.
+constexpr std::size_t kAlignment = 64;
+/// Rows per task inside a block, enough to amortize the evaluation setup.
+constexpr std::size_t kChunkRows = 16384;
+
+/// Returns the system page size.
+std::size_t PageSize() noexcept {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+}  // namespace
+
+BatchFile::BatchFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::invalid_argument("Invalid input");
+  struct stat status {};
+  bool is_mapped = false;
+  if (fstat(fd, &status) == 0 &&
+      static_cast<std::size_t>(status.st_size) >= sizeof(Header)) {
+    size_ = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    is_mapped = data != MAP_FAILED;
+    if (is_mapped) data_ = static_cast<unsigned char*>(data);
+  }
+  close(fd);
+  if (!is_mapped) {
+    size_ = 0;
+    throw std::invalid_argument("Invalid input");
+  }
+  madvise(data_, size_, MADV_SEQUENTIAL);
+
+  Header header;
+  std::memcpy(&header, data_, sizeof(Header));
+  bool is_valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                  header.version == kVersion &&
+                  header.text_size <= size_ - sizeof(Header);
+  if (is_valid) {
+    offset_ = DataOffset(header.text_size);
+    rows_ = header.rows;
+    columns_ = header.columns;
+    std::size_t limit = std::numeric_limits<std::size_t>::max() / 8;
+    is_valid = (columns_ == 0 || rows_ <= limit / columns_) &&
+               offset_ <= size_ && size_ - offset_ == rows_ * columns_ * 8;
+  }
+  if (is_valid && header.expressions == 0) is_valid = header.text_size == 0;
+  if (is_valid && header.expressions > 0) {
+    const char* text = reinterpret_cast<const char*>(data_ + sizeof(Header));
+    for (std::size_t begin = 0;;) {
+      const char* end = static_cast<const char*>(
+          std::memchr(text + begin, '\n', header.text_size - begin));
+      std::size_t length =
+          end ? end - (text + begin) : header.text_size - begin;
+      expressions_.emplace_back(text + begin, length);
+      if (!end) break;
+      begin += length + 1;
+    }
+    is_valid = expressions_.size() == header.expressions;
+  }
+  if (!is_valid) {
+    munmap(data_, size_);
+    throw std::invalid_argument("Invalid input");
+  }
+}
+
+BatchFile BatchFile::Create(const std::string& path,
+                            const std::vector<std::string>& expressions,
+                            std::size_t rows, std::size_t columns) {
+  std::string text;
+  for (std::size_t i = 0; i < expressions.size(); ++i) {
+    if (expressions[i].find('\n') != std::string::npos)
+      throw std::invalid_argument("Invalid input");
+    text += (i == 0 ? "" : "\n") + expressions[i];
+  }
+  std::size_t limit = std::numeric_limits<std::size_t>::max() / 16;
+  if (columns > 0 && rows > limit / columns)
+    throw std::invalid_argument("Invalid input");
+  constexpr std::size_t kMaxCount = std::numeric_limits<std::uint32_t>::max();
+  if (columns > kMaxCount || expressions.size() > kMaxCount)
+    throw std::invalid_argument("Invalid input");
+
+  BatchFile file;
+  file.offset_ = DataOffset(text.size());
+  file.size_ = file.offset_ + rows * columns * 8;
+  file.rows_ = rows;
+  file.columns_ = columns;
+  file.expressions_ = expressions;
+  file.writable_ = true;
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) throw std::invalid_argument("Invalid input");
+  void* data = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(file.size_)) == 0)
+    data = mmap(nullptr, file.size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    file.size_ = 0;
+    throw std::invalid_argument("Invalid input");
+  }
+  file.data_ = static_cast<unsigned char*>(data);
+
+  Header header{{}, kVersion, static_cast<std::uint32_t>(expressions.size()),
+                rows, text.size(), static_cast<std::uint32_t>(columns), 0};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  std::memcpy(file.data_, &header, sizeof(Header));
+  std::memcpy(file.data_ + sizeof(Header), text.data(), text.size());
+  return file;
+}
+
+/**
+ * @details Each block of kBlockRows rows is split into chunks spread across
+ * the thread pool; every chunk evaluates all the programs over its rows,
+ * reading x from the input mapping and writing straight into the output
+ * mapping. After a block its pages are released in both files, so the
+ * resident memory stays around one block per column. The chunks are queued
+ * as background work, behind the loops of an interactive plot.
+ */
+std::size_t BatchFile::Run(const std::string& input, const std::string& output,
+                           const Library* library,
+                           const CancellationToken& token) {
+  BatchFile source(input);
+  if (source.Columns() != 1) throw std::invalid_argument("Invalid input");
+  std::vector<Program> programs;
+  for (const std::string& expression : source.Expressions()) {
+    Model model;
+    model.SetLibrary(library);
+    model.SetInput(expression);
+    programs.push_back(model.CompileMathExpression());
+  }
+
+  std::size_t rows = source.Rows();
+  BatchFile target = Create(output, source.Expressions(), rows,
+                            programs.size());
+  const double* x = source.Column(0);
+  for (std::size_t block = 0; block < rows; block += kBlockRows) {
+    std::size_t count = std::min(kBlockRows, rows - block);
+    std::size_t chunks = (count + kChunkRows - 1) / kChunkRows;
+    ThreadPool::Shared().ParallelFor(
+        chunks, [&](std::size_t begin, std::size_t end) {
+          std::size_t first = block + begin * kChunkRows;
+          std::size_t last = std::min(block + end * kChunkRows, block + count);
+          for (std::size_t p = 0; p < programs.size(); ++p)
+            programs[p].Evaluate(x + first, target.Column(p) + first,
+                                 last - first);
+        },
+        1, ThreadPool::Priority::kBackground, token);
+    source.Release(0, block, block + count);
+    for (std::size_t p = 0; p < programs.size(); ++p)
+      target.Release(p, block, block + count);
+  }
+  return rows;
+}
+
+BatchFile::BatchFile(BatchFile&& other) noexcept { *this = std::move(other); }
+
+BatchFile& BatchFile::operator=(BatchFile&& other) noexcept {
+  if (this != &other) {
+    if (data_) munmap(data_, size_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    writable_ = other.writable_;
+    offset_ = other.offset_;
+    rows_ = other.rows_;
+    columns_ = other.columns_;
+    expressions_ = std::move(other.expressions_);
+  }
+  return *this;
+}
+
+BatchFile::~BatchFile() {
+  if (data_) munmap(data_, size_);
+}
+
+const double* BatchFile::Column(std::size_t column) const noexcept {
+  return reinterpret_cast<const double*>(data_ + offset_) + column * rows_;
+}
+
+double* BatchFile::Column(std::size_t column) noexcept {
+  return reinterpret_cast<double*>(data_ + offset_) + column * rows_;
+}
+
+/**
+ * @details Only the pages lying entirely inside the rows are released, as
+ * the pages at the edges are shared with the neighbouring rows.
+ */
+void BatchFile::Release(std::size_t column, std::size_t begin,
+                        std::size_t end) noexcept {
+  std::size_t page = PageSize();
+  std::size_t first = offset_ + (column * rows_ + begin) * 8;
+  std::size_t last = offset_ + (column * rows_ + end) * 8;
+  first = (first + page - 1) / page * page;
+  last = last / page * page;
+  if (first >= last) return;
+  if (writable_) msync(data_ + first, last - first, MS_ASYNC);
+  madvise(data_ + first, last - first, MADV_DONTNEED);
+}
+
+std::size_t BatchFile::DataOffset(std::size_t text_size) noexcept {
+  return (sizeof(Header) + text_size + kAlignment - 1) / kAlignment *
+         kAlignment;
+}
+
+}  // namespace s21
@@ -0,0 +1,158 @@
+/**
+ * @file s21_batchfile.h
+ * @brief Header file containing the declaration of the BatchFile, the
+ * memory-mapped columnar file of offline evaluation jobs.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_BATCHFILE_H
+#define SMARTCALC_MODEL_S21_BATCHFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+class Library;
+
+/**
+ * @class BatchFile
+ *
+ * @brief A binary file of expressions and columns of doubles, mapped into
+ * memory.
+ *
+ * The file starts with a 40-byte header: the magic "S21BATCH", the format
+ * version, the number of expressions, the number of rows, the size of the
+ * expression text and the number of columns. The expressions follow, one per
+ * line, then, from the next multiple of 64 bytes, the columns one after
+ * another, each a contiguous array of rows doubles in host byte order.
+ *
+ * An input file has one column, the x values. Run evaluates every
+ * expression of an input file into an output file holding the same
+ * expressions and one result column per expression. Both files are mapped,
+ * so values are read and written in place without parsing or copies, and
+ * the pages of finished blocks are released, so the files may be larger than
+ * the memory.
+ *
+ * Mapping uses the POSIX mmap interface.
+ */
+class BatchFile {
+ public:
+  /// Rows evaluated between two releases of mapped pages.
+  static constexpr std::size_t kBlockRows = std::size_t{1} << 20;
+
+  /**
+   * @brief Maps an existing file for reading.
+   *
+   * @param[in] path The file to open.
+   * @throws std::invalid_argument if the file cannot be mapped or is not a
+   * well-formed batch file.
+   */
+  explicit BatchFile(const std::string& path);
+
+  /**
+   * @brief Creates a file of the given shape, filled with zeros, and maps it
+   * for writing.
+   *
+   * @param[in] path The file to create or overwrite.
+   * @param[in] expressions The expressions, none containing a line break.
+   * @param[in] rows The number of rows.
+   * @param[in] columns The number of columns.
+   * @throws std::invalid_argument if the file cannot be created or mapped,
+   * or the columns or expressions do not fit the 32-bit counts of the
+   * header.
+   */
+  static BatchFile Create(const std::string& path,
+                          const std::vector<std::string>& expressions,
+                          std::size_t rows, std::size_t columns);
+
+  /**
+   * @brief Evaluates every expression of an input file over its x column.
+   *
+   * @param[in] input An input file with one column.
+   * @param[in] output The output file to create, with one column per
+   * expression.
+   * @param[in] library The definitions the expressions may use, or nullptr.
+   * @param[in] token Stops the run between chunks once it is cancelled; the
+   * output is then incomplete.
+   * @return The number of rows.
+   * @throws std::invalid_argument if a file cannot be mapped or is
+   * malformed, or an expression does not compile; Cancelled if the run was
+   * cancelled.
+   */
+  static std::size_t Run(const std::string& input, const std::string& output,
+                         const Library* library = nullptr,
+                         const CancellationToken& token = CancellationToken());
+
+  BatchFile(BatchFile&& other) noexcept;
+  BatchFile& operator=(BatchFile&& other) noexcept;
+  BatchFile(const BatchFile&) = delete;
+  BatchFile& operator=(const BatchFile&) = delete;
+
+  /**
+   * @brief Unmaps the file; written values are kept.
+   */
+  ~BatchFile();
+
+  const std::vector<std::string>& Expressions() const noexcept {
+    return expressions_;
+  }
+  std::size_t Rows() const noexcept { return rows_; }
+  std::size_t Columns() const noexcept { return columns_; }
+
+  /**
+   * @brief Returns column @p column, Rows() doubles.
+   */
+  const double* Column(std::size_t column) const noexcept;
+
+  /**
+   * @brief Returns column @p column for writing; the file must have been
+   * created by Create.
+   */
+  double* Column(std::size_t column) noexcept;
+
+  /**
+   * @brief Lets the system drop the pages of rows [begin, end) of a column
+   * from memory; written values are scheduled for writing first.
+   */
+  void Release(std::size_t column, std::size_t begin,
+               std::size_t end) noexcept;
+
+ private:
+  /**
+   * @struct Header
+   * @brief The fixed part at the start of the file.
+   */
+  struct Header {
+    char magic[8];               ///< "S21BATCH".
+    std::uint32_t version;       ///< Format version, 1.
+    std::uint32_t expressions;   ///< Number of expressions.
+    std::uint64_t rows;          ///< Number of rows of every column.
+    std::uint64_t text_size;     ///< Bytes of expression text.
+    std::uint32_t columns;       ///< Number of columns.
+    std::uint32_t reserved;      ///< Zero.
+  };
+
+  BatchFile() noexcept = default;
+
+  /**
+   * @brief Returns the offset of the first column for @p text_size bytes of
+   * expression text.
+   */
+  static std::size_t DataOffset(std::size_t text_size) noexcept;
+
+  unsigned char* data_ = nullptr;  ///< Start of the mapping.
+  std::size_t size_ = 0;           ///< Size of the mapping in bytes.
+  bool writable_ = false;          ///< True if mapped for writing.
+  std::size_t offset_ = 0;         ///< Offset of the first column.
+  std::size_t rows_ = 0;
+  std::size_t columns_ = 0;
+  std::vector<std::string> expressions_;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_BATCHFILE_H
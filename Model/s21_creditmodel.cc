@@ -5,10 +5,39 @@
 
 #include "s21_creditmodel.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_threadpool.h"
+#include "s21_tracer.h"
+
 namespace s21 {
 
+namespace {
+
+/// Checks the loan and returns its number of periods.
+int CountPeriods(int k, double amount, int term, char type) {
+  if (k <= 0 || term <= 0 || !std::isfinite(amount) ||
+      (type != 'a' && type != 'd'))
+    throw std::invalid_argument("Invalid input");
+  return term * k;
+}
+
+/// Annuity payment; expm1 and log1p keep small rates accurate.
+double AnnuityPayment(double amount, double r, int time) noexcept {
+  if (r == 0) return amount / time;
+  return amount * r / -std::expm1(-time * std::log1p(r));
+}
+
+}  // namespace
+
 std::tuple<double, double, double> CreditModel::CalculateResult(
     int k, double amount, int term, double rate, int month, char type) {
+  Tracer::Span span("CreditModel::CalculateResult", "model");
   if (type == 'a')
     return CalculateAnnuityCredit(k, amount, term, rate);
   else
@@ -19,27 +48,338 @@ std::tuple<double, double, double> CreditModel::CalculateAnnuityCredit(
     int k, double amount, int term, double rate) {
   int time = term * k;
   double r = rate / 12.0 / 100;
-  double pay = amount * (r * pow(1 + r, time)) / (pow(1 + r, time) - 1);
+  double pay = AnnuityPayment(amount, r, time);
   double perc = (pay * time) - amount;
   double total = amount + perc;
 
   return std::make_tuple(pay, perc, total);
 }
 
+/**
+ * @details The interest of period i is charged on amount * (time - i + 1) /
+ * time, so the total interest is the arithmetic series
+ * amount * (time + 1) / 2 * m_rate.
+ */
 std::tuple<double, double, double> CreditModel::CalculateDifferentialCredit(
     int k, double amount, int term, double rate, int month) {
   int time = term * k;
   double m_rate = rate / 12.0 / 100.0;
   double tmp = amount / time;
-  double pay = 0.0, perc = 0.0, total = 0.0;
-  for (int i = 0; i < time; ++i) {
-    double interest_payment = amount * m_rate;
-    if (month == i + 1) pay = interest_payment + tmp;
-    total += tmp + interest_payment;
-    perc += interest_payment;
-    amount -= tmp;
-  }
+  double pay = 0.0;
+  if (month >= 1 && month <= time)
+    pay = tmp + (amount - tmp * (month - 1)) * m_rate;
+  // Rate last, so whole-number inputs give a whole-number result.
+  double perc = amount * (time + 1) / 2 * rate / 12.0 / 100.0;
+  double total = amount + perc;
   return std::make_tuple(pay, perc, total);
 }
 
+/**
+ * @details The balance after m annuity periods is
+ * amount * g - pay * (g - 1) / r with g = (1 + r)^m, and the differentiated
+ * balance falls by amount / time every period.
+ */
+CreditModel::Period CreditModel::CalculatePeriod(int k, double amount,
+                                                 int term, double rate,
+                                                 int month, char type) const {
+  int time = CountPeriods(k, amount, term, type);
+  if (month < 1 || month > time) throw std::invalid_argument("Invalid input");
+  double r = rate / 12.0 / 100;
+
+  double pay = 0.0, before = 0.0;
+  if (type == 'a') {
+    pay = AnnuityPayment(amount, r, time);
+    if (r == 0) {
+      before = amount - pay * (month - 1);
+    } else {
+      double growth = std::expm1((month - 1) * std::log1p(r));  // g - 1
+      before = amount + growth * (amount - pay / r);
+    }
+  } else {
+    before = amount - amount / time * (month - 1);
+    pay = amount / time + before * r;
+  }
+  double interest = before * r;
+  double balance = (month == time) ? 0.0 : before - (pay - interest);
+  return {pay, interest, pay - interest, balance};
+}
+
+/**
+ * @details The periods are written front to back into the four arrays. The
+ * annuity growth factor is advanced by one multiplication per period instead
+ * of a pow call.
+ */
+void CreditModel::CalculateSchedule(int k, double amount, int term,
+                                    double rate, char type,
+                                    Schedule& schedule) const {
+  Tracer::Span span("CreditModel::CalculateSchedule", "model");
+  int time = CountPeriods(k, amount, term, type);
+  double r = rate / 12.0 / 100;
+  schedule.payment.resize(time);
+  schedule.interest.resize(time);
+  schedule.principal.resize(time);
+  schedule.balance.resize(time);
+  double* payment = schedule.payment.data();
+  double* interest = schedule.interest.data();
+  double* principal = schedule.principal.data();
+  double* balance = schedule.balance.data();
+
+  if (type == 'a') {
+    double pay = AnnuityPayment(amount, r, time);
+    double excess = (r == 0) ? 0.0 : amount - pay / r;
+    double growth = 1.0;  // (1 + r)^i
+    for (int i = 0; i < time; ++i) {
+      double before = (r == 0) ? amount - pay * i : pay / r + growth * excess;
+      payment[i] = pay;
+      interest[i] = before * r;
+      principal[i] = pay - interest[i];
+      balance[i] = before - principal[i];
+      growth *= 1 + r;
+    }
+  } else {
+    double part = amount / time;
+    for (int i = 0; i < time; ++i) {
+      double before = amount - part * i;
+      interest[i] = before * r;
+      principal[i] = part;
+      payment[i] = part + interest[i];
+      balance[i] = before - part;
+    }
+  }
+  balance[time - 1] = 0.0;
+}
+
+/**
+ * @details The annuity payment of n periods is amount * r * g / (g - 1) with
+ * g = (1 + r)^n. Along a row of the grid the rate is fixed, so with the terms
+ * visited in ascending order g is carried from one term to the next and
+ * multiplied by (1 + r)^d, where d is the difference in periods. Evenly
+ * spaced axes have a single d, whose power is computed once per row, so a
+ * row costs one multiplication per term instead of a pow call. The rows are
+ * independent and spread across the thread pool.
+ */
+void CreditModel::CalculateGrid(int k, double amount, char type,
+                                Grid& grid) const {
+  Tracer::Span span("CreditModel::CalculateGrid", "model");
+  CountPeriods(k, amount, 1, type);
+  for (int term : grid.terms) CountPeriods(k, amount, term, type);
+  for (double rate : grid.rates) {
+    if (!(rate >= 0) || !std::isfinite(rate))
+      throw std::invalid_argument("Invalid input");
+  }
+
+  std::size_t columns = grid.terms.size();
+  std::vector<std::size_t> order(columns);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+    return grid.terms[l] < grid.terms[r];
+  });
+  grid.payment.resize(grid.rates.size() * columns);
+  grid.overpayment.resize(grid.rates.size() * columns);
+
+  ThreadPool::Shared().ParallelFor(
+      grid.rates.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          double r = grid.rates[i] / 12.0 / 100;
+          double* payment = grid.payment.data() + grid.At(i, 0);
+          double* overpayment = grid.overpayment.data() + grid.At(i, 0);
+          double growth = 1.0, step = 1.0;
+          int periods = 0, distance = 0;
+          for (std::size_t j : order) {
+            int time = grid.terms[j] * k;
+            if (time - periods != distance) {
+              distance = time - periods;
+              step = std::pow(1 + r, distance);
+            }
+            growth *= step;
+            periods = time;
+            if (type == 'd') {
+              payment[j] = amount / time + amount * r;
+              overpayment[j] =
+                  amount * (time + 1) / 2 * grid.rates[i] / 12.0 / 100.0;
+            } else {
+              payment[j] = (r == 0) ? amount / time
+                                    : amount * r * growth / (growth - 1);
+              overpayment[j] = payment[j] * time - amount;
+            }
+          }
+        }
+      });
+}
+
+CreditModel::VariableCredit CreditModel::CalculateVariableCredit(
+    int k, double amount, int term, double rate, char type,
+    std::vector<RateReset> resets) const {
+  int time = CountPeriods(k, amount, term, type);
+  resets.insert(resets.begin(), {1, rate});
+  std::stable_sort(
+      resets.begin(), resets.end(),
+      [](const RateReset& l, const RateReset& r) { return l.month < r.month; });
+  // Of several resets for one period the last one given wins
+  std::vector<RateReset> unique;
+  for (const RateReset& reset : resets) {
+    if (!unique.empty() && unique.back().month == reset.month)
+      unique.back() = reset;
+    else
+      unique.push_back(reset);
+  }
+
+  VariableCredit credit{std::vector<Segment>(unique.size()), 0.0, 0.0};
+  credit.overpayment = CalculateSegments(amount, time, type, unique.data(),
+                                         unique.size(), credit.segments.data());
+  if (std::isnan(credit.overpayment))
+    throw std::invalid_argument("Invalid input");
+  credit.total = amount + credit.overpayment;
+  return credit;
+}
+
+/**
+ * @details A segment starting at period m with balance B, periodic rate r and
+ * length L costs O(1):
+ *   annuity:         payment P = B * r / (1 - (1 + r)^-(n - m + 1)), the
+ *                    balance afterwards is B * g - P * (g - 1) / r with
+ *                    g = (1 + r)^L, and the interest is P * L minus the
+ *                    principal repaid;
+ *   differentiated:  with d = amount / n, the interest is the arithmetic
+ *                    series r * (L * B - d * L * (L - 1) / 2).
+ */
+double CreditModel::CalculateSegments(double amount, int periods, char type,
+                                      const RateReset* resets,
+                                      std::size_t count,
+                                      Segment* segments) noexcept {
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  if (count == 0 || resets[0].month != 1 || periods <= 0 ||
+      (type != 'a' && type != 'd'))
+    return kNaN;
+
+  double balance = amount, overpayment = 0.0;
+  double part = amount / periods;
+  for (std::size_t i = 0; i < count; ++i) {
+    int month = resets[i].month;
+    int next = (i + 1 < count) ? resets[i + 1].month : periods + 1;
+    if (next <= month || next > periods + 1 || !(resets[i].rate >= 0))
+      return kNaN;
+    double r = resets[i].rate / 12.0 / 100;
+    int length = next - month;
+
+    double payment = 0.0, after = 0.0;
+    if (type == 'a') {
+      payment = AnnuityPayment(balance, r, periods - month + 1);
+      if (next == periods + 1)
+        after = 0.0;
+      else if (r == 0)
+        after = balance - payment * length;
+      else
+        after = balance +
+                std::expm1(length * std::log1p(r)) * (balance - payment / r);
+      overpayment += payment * length - (balance - after);
+    } else {
+      payment = part + balance * r;
+      overpayment += r * (length * balance -
+                          part * length * (length - 1.0) / 2);
+      after = balance - part * length;
+    }
+    if (segments != nullptr) segments[i] = {month, resets[i].rate, payment};
+    balance = after;
+  }
+  return overpayment;
+}
+
+double CreditModel::SolveRate(int k, double amount, int term, double payment,
+                              char type) const {
+  int time = CountPeriods(k, amount, term, type);
+  double rate = Solve(Unknown::kRate, amount, time, 0.0, payment, type);
+  if (std::isnan(rate)) throw std::invalid_argument("Invalid input");
+  return rate;
+}
+
+int CreditModel::SolvePeriods(double amount, double rate, double payment,
+                              char type) const {
+  double periods = Solve(Unknown::kPeriods, amount, 0, rate, payment, type);
+  if (std::isnan(periods)) throw std::invalid_argument("Invalid input");
+  return static_cast<int>(periods);
+}
+
+double CreditModel::SolveAmount(int k, int term, double rate, double payment,
+                                char type) const {
+  int time = CountPeriods(k, 0.0, term, type);
+  double amount = Solve(Unknown::kAmount, 0.0, time, rate, payment, type);
+  if (std::isnan(amount)) throw std::invalid_argument("Invalid input");
+  return amount;
+}
+
+/**
+ * @details With r the periodic rate, n the periods, A the amount and P the
+ * payment, the annuity equation P = A * r / (1 - (1 + r)^-n) gives n and A in
+ * closed form, and so does the differentiated first payment P = A / n + A * r
+ * for every unknown. Only the annuity rate needs an iteration: Newton's
+ * method with the analytic derivative
+ *   dP/dr = A * (D - n * r * (1 + r)^(-n-1)) / D^2,  D = 1 - (1 + r)^-n,
+ * safeguarded by bisection inside the bracket [0, P / A], since P > A * r for
+ * every positive rate. The first guess comes from the small-rate expansion
+ * P * n - A = A * r * (n + 1) / 2, and the iteration usually converges to
+ * machine precision in four to six steps.
+ */
+double CreditModel::Solve(Unknown unknown, double amount, int periods,
+                          double rate, double payment, char type) noexcept {
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  bool is_annuity = type == 'a';
+  double r = rate / 12.0 / 100;
+  double n = periods;
+  if (!(is_annuity || type == 'd') || !(payment > 0) ||
+      !std::isfinite(payment) ||
+      (unknown != Unknown::kAmount && !(amount > 0 && std::isfinite(amount))) ||
+      (unknown != Unknown::kRate && !(r >= 0 && std::isfinite(r))) ||
+      (unknown != Unknown::kPeriods && periods <= 0))
+    return kNaN;
+
+  if (unknown == Unknown::kAmount) {
+    if (!is_annuity) return payment / (1 / n + r);
+    return (r == 0) ? payment * n
+                    : payment * -std::expm1(-n * std::log1p(r)) / r;
+  }
+
+  if (unknown == Unknown::kPeriods) {
+    double exact = 0.0;
+    if (!is_annuity) {
+      if (payment <= amount * r) return kNaN;
+      exact = amount / (payment - amount * r);
+    } else if (r == 0) {
+      exact = amount / payment;
+    } else {
+      double share = amount * r / payment;
+      if (share >= 1) return kNaN;
+      exact = -std::log1p(-share) / std::log1p(r);
+    }
+    // Slack for payments computed from a whole number of periods
+    double whole = std::max(1.0, std::ceil(exact * (1 - 1e-12)));
+    return whole <= std::numeric_limits<int>::max() ? whole : kNaN;
+  }
+
+  double excess = payment * n - amount;
+  if (excess < -1e-12 * amount) return kNaN;
+  if (excess <= 1e-12 * amount) return 0.0;
+  if (!is_annuity) return (payment / amount - 1 / n) * 12 * 100;
+
+  double low = 0.0, high = payment / amount;
+  r = std::min(2 * excess / (amount * (n + 1)), high);
+  for (int i = 0; i < 100; ++i) {
+    double d = -std::expm1(-n * std::log1p(r));
+    double f = amount * r / d - payment;
+    // Within rounding of the payment no later step can do better
+    if (std::abs(f) <= 1e-15 * payment) break;
+    if (f > 0)
+      high = r;
+    else
+      low = r;
+    double slope = amount * (d - n * r * (1 - d) / (1 + r)) / (d * d);
+    double next = r - f / slope;
+    if (!(next > low && next < high)) next = (low + high) / 2;
+    bool converged = std::abs(next - r) <= 1e-15 * r;
+    r = next;
+    if (converged || high - low <= 1e-15 * high) break;
+  }
+  return r * 12 * 100;
+}
+
 }  // namespace s21
@@ -8,12 +8,105 @@
 #define CREDITMODEL_H
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <tuple>
+#include <vector>
 
 namespace s21 {
 
 class CreditModel {
  public:
+  /**
+   * @struct Period
+   * @brief The payment of a single period and how it splits.
+   */
+  struct Period {
+    double payment;    ///< Payment of the period.
+    double interest;   ///< Interest part of the payment.
+    double principal;  ///< Debt repaid by the payment.
+    double balance;    ///< Debt remaining after the period.
+  };
+
+  /**
+   * @struct Schedule
+   * @brief Amortization schedule in structure-of-arrays layout.
+   *
+   * Element i of every array belongs to period i + 1. The buffers keep their
+   * capacity between calls of CalculateSchedule.
+   */
+  struct Schedule {
+    std::vector<double> payment;
+    std::vector<double> interest;
+    std::vector<double> principal;
+    std::vector<double> balance;
+
+    /**
+     * @brief Returns the number of periods.
+     */
+    std::size_t Size() const noexcept { return payment.size(); }
+  };
+
+  /**
+   * @struct Grid
+   * @brief Payments and overpayments over every rate and term combination.
+   *
+   * The matrices are row-major with one row per rate: the element of rate i
+   * and term j is at i * terms.size() + j.
+   */
+  struct Grid {
+    std::vector<double> rates;        ///< Annual rates in percent.
+    std::vector<int> terms;           ///< Terms, in units of 1 / k years.
+    std::vector<double> payment;      ///< Payment, the first if differentiated.
+    std::vector<double> overpayment;  ///< Total interest.
+
+    /**
+     * @brief Returns the index of rate @p i and term @p j in the matrices.
+     */
+    std::size_t At(std::size_t i, std::size_t j) const noexcept {
+      return i * terms.size() + j;
+    }
+  };
+
+  /**
+   * @struct RateReset
+   * @brief An annual rate in force from a given period on.
+   */
+  struct RateReset {
+    int month;    ///< First period of the rate, from 1.
+    double rate;  ///< Annual interest rate in percent.
+  };
+
+  /**
+   * @struct Segment
+   * @brief A run of periods with a constant rate.
+   */
+  struct Segment {
+    int month;       ///< First period of the segment.
+    double rate;     ///< Annual interest rate in percent.
+    double payment;  ///< Payment of the first period of the segment.
+  };
+
+  /**
+   * @struct VariableCredit
+   * @brief The outcome of a variable-rate credit.
+   */
+  struct VariableCredit {
+    std::vector<Segment> segments;  ///< One segment per distinct reset.
+    double overpayment;             ///< Total interest.
+    double total;                   ///< Amount plus interest.
+  };
+
+  /**
+   * @enum Unknown
+   * @brief The parameter an inverse solve looks for.
+   */
+  enum class Unknown : std::uint8_t {
+    kRate,     ///< Annual rate in percent.
+    kPeriods,  ///< Number of periods.
+    kAmount    ///< Loan amount.
+  };
+
   CreditModel() noexcept = default;
   ~CreditModel() = default;
 
@@ -32,6 +125,150 @@ class CreditModel {
                                                      int term, double rate,
                                                      int month, char type);
 
+  /**
+   * @brief Calculates a single period of the schedule in constant time.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual interest rate in percent.
+   * @param[in] month The period, from 1 to term * k.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @return The payment of the period and its parts.
+   * @throws std::invalid_argument if the loan or the period is invalid.
+   */
+  Period CalculatePeriod(int k, double amount, int term, double rate,
+                         int month, char type) const;
+
+  /**
+   * @brief Calculates every period of the schedule in a single pass.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual interest rate in percent.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @param[out] schedule The buffers to fill, resized to term * k periods.
+   * @throws std::invalid_argument if the loan is invalid.
+   */
+  void CalculateSchedule(int k, double amount, int term, double rate,
+                         char type, Schedule& schedule) const;
+
+  /**
+   * @brief Calculates the payment and overpayment of every rate and term
+   * combination.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @param[in, out] grid The rate and term axes, in any order; the matrices
+   * are resized and filled.
+   * @throws std::invalid_argument if the loan, a rate or a term is invalid.
+   */
+  void CalculateGrid(int k, double amount, char type, Grid& grid) const;
+
+  /**
+   * @brief Calculates a credit whose rate resets during the term.
+   *
+   * At every reset the annuity payment is recomputed from the remaining
+   * balance and the remaining periods; differentiated payments keep their
+   * principal part and charge the new rate on the balance.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual rate in percent until the first reset.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @param[in] resets The rate changes, in any order; a later entry for the
+   * same period wins.
+   * @return The segments, the overpayment and the total.
+   * @throws std::invalid_argument if the loan or a reset is invalid.
+   */
+  VariableCredit CalculateVariableCredit(int k, double amount, int term,
+                                         double rate, char type,
+                                         std::vector<RateReset> resets) const;
+
+  /**
+   * @brief Calculates the overpayment of a variable-rate credit in time
+   * proportional to the number of resets.
+   *
+   * This is the allocation-free core of CalculateVariableCredit, also used by
+   * the batch engine.
+   *
+   * @param[in] amount The loan amount.
+   * @param[in] periods The number of periods.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @param[in] resets The resets sorted by strictly increasing period, the
+   * first one at period 1.
+   * @param[in] count The number of resets, at least 1.
+   * @param[out] segments If not null, receives @p count segments.
+   * @return The overpayment, or NaN if the input is invalid.
+   */
+  static double CalculateSegments(double amount, int periods, char type,
+                                  const RateReset* resets, std::size_t count,
+                                  Segment* segments) noexcept;
+
+  /**
+   * @brief Finds the annual rate at which a credit has a given payment.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] amount The loan amount.
+   * @param[in] term The loan term.
+   * @param[in] payment The payment, the first one if differentiated.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @return The annual rate in percent.
+   * @throws std::invalid_argument if no rate gives the payment, as when it
+   * does not even repay the amount at zero interest.
+   */
+  double SolveRate(int k, double amount, int term, double payment,
+                   char type) const;
+
+  /**
+   * @brief Finds how many periods it takes to repay a credit.
+   *
+   * @param[in] amount The loan amount.
+   * @param[in] rate The annual rate in percent.
+   * @param[in] payment The payment, the first one if differentiated.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @return The smallest number of periods whose payment does not exceed
+   * @p payment.
+   * @throws std::invalid_argument if the payment does not cover the interest.
+   */
+  int SolvePeriods(double amount, double rate, double payment,
+                   char type) const;
+
+  /**
+   * @brief Finds the largest amount a given payment repays.
+   *
+   * @param[in] k The number of periods per unit of the term.
+   * @param[in] term The loan term.
+   * @param[in] rate The annual rate in percent.
+   * @param[in] payment The payment, the first one if differentiated.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @return The loan amount.
+   * @throws std::invalid_argument if a parameter is invalid.
+   */
+  double SolveAmount(int k, int term, double rate, double payment,
+                     char type) const;
+
+  /**
+   * @brief Solves the payment equation of a credit for one parameter.
+   *
+   * The parameter named by @p unknown is ignored. This is the
+   * allocation-free core of the Solve methods, also used by the batch engine.
+   *
+   * @param[in] unknown The parameter to find.
+   * @param[in] amount The loan amount.
+   * @param[in] periods The number of periods.
+   * @param[in] rate The annual rate in percent.
+   * @param[in] payment The payment, the first one if differentiated.
+   * @param[in] type 'a' for annuity, 'd' for differentiated payments.
+   * @return The rate in percent, the number of periods or the amount, or NaN
+   * if there is no solution.
+   */
+  static double Solve(Unknown unknown, double amount, int periods, double rate,
+                      double payment, char type) noexcept;
+
  private:
   /**
    * @brief Calculates the annuity payment, interest, and total amount for a
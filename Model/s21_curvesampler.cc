@@ -0,0 +1,248 @@
+/**
+ * @file s21_curvesampler.cc
+ * @brief Implementation file for the s21_curvesampler.h.
+ */
+
+#include "s21_curvesampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_programset.h"
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr int kMaxRounds = 12;
+/// Most parts a segment is split into in a round.
+constexpr std::size_t kMaxSplit = 64;
+/// Parameter values evaluated by one thread pool task.
+constexpr std::size_t kGrain = 1 << 14;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Returns true if [low, high] is a finite non-empty range.
+bool IsRange(double low, double high) noexcept {
+  return std::isfinite(low) && std::isfinite(high) && low < high &&
+         std::isfinite(high - low);
+}
+
+void Validate(double t_min, double t_max,
+              const CurveSampler::Viewport& viewport, std::size_t samples) {
+  bool is_valid = IsRange(t_min, t_max) &&
+                  IsRange(viewport.x_min, viewport.x_max) &&
+                  IsRange(viewport.y_min, viewport.y_max) &&
+                  viewport.width > 0 && viewport.height > 0 &&
+                  std::isfinite(viewport.width) &&
+                  std::isfinite(viewport.height) && samples >= 2;
+  if (!is_valid) throw std::invalid_argument("Invalid input");
+}
+
+}  // namespace
+
+CurveSampler::Curve CurveSampler::Parametric(ProgramView x, ProgramView y,
+                                             double t_min, double t_max,
+                                             const Viewport& viewport,
+                                             std::size_t samples) const {
+  Validate(t_min, t_max, viewport, samples);
+  ProgramSet set;
+  set.Add(x);
+  set.Add(y);
+  auto evaluate = [&set](const double* t, double* xs, double* ys,
+                         std::size_t count) {
+    ThreadPool::Shared().ParallelFor(
+        count,
+        [&](std::size_t begin, std::size_t end) {
+          double* const results[] = {xs + begin, ys + begin};
+          set.Evaluate(t + begin, results, end - begin);
+        },
+        kGrain);
+  };
+  return Sample(evaluate, t_min, t_max, viewport, samples);
+}
+
+CurveSampler::Curve CurveSampler::Polar(ProgramView r, double theta_min,
+                                        double theta_max,
+                                        const Viewport& viewport,
+                                        std::size_t samples) const {
+  Validate(theta_min, theta_max, viewport, samples);
+  if (r.Empty()) throw std::invalid_argument("Invalid input");
+  auto evaluate = [r](const double* theta, double* xs, double* ys,
+                      std::size_t count) {
+    ThreadPool::Shared().ParallelFor(
+        count,
+        [&](std::size_t begin, std::size_t end) {
+          r.Evaluate(theta + begin, xs + begin, end - begin);
+          for (std::size_t i = begin; i < end; ++i) {
+            double radius = xs[i];
+            xs[i] = radius * std::cos(theta[i]);
+            ys[i] = radius * std::sin(theta[i]);
+          }
+        },
+        kGrain);
+  };
+  return Sample(evaluate, theta_min, theta_max, viewport, samples);
+}
+
+/**
+ * @details A segment too short to be split, whose midpoint rounds to one of
+ * its ends, is left as it is. Points that are not finite are stored as NaN
+ * in both coordinates, so every break of the curve reads the same.
+ */
+template <typename Evaluate>
+CurveSampler::Curve CurveSampler::Sample(Evaluate evaluate, double t_min,
+                                         double t_max,
+                                         const Viewport& viewport,
+                                         std::size_t samples) {
+  double x_size = viewport.x_max - viewport.x_min;
+  double y_size = viewport.y_max - viewport.y_min;
+  double x_pixel = x_size / viewport.width;
+  double y_pixel = y_size / viewport.height;
+  double x_low = viewport.x_min - kMargin * x_size;
+  double x_high = viewport.x_max + kMargin * x_size;
+  double y_low = viewport.y_min - kMargin * y_size;
+  double y_high = viewport.y_max + kMargin * y_size;
+
+  Curve curve;
+  double h = (t_max - t_min) / static_cast<double>(samples - 1);
+  curve.t.resize(samples);
+  for (std::size_t i = 0; i < samples; ++i)
+    curve.t[i] = (i + 1 == samples) ? t_max : t_min + h * i;
+  curve.x.resize(samples);
+  curve.y.resize(samples);
+  evaluate(curve.t.data(), curve.x.data(), curve.y.data(), samples);
+
+  auto is_defined = [&curve](std::size_t i) {
+    return std::isfinite(curve.x[i]) && std::isfinite(curve.y[i]);
+  };
+  auto is_beyond = [&](std::size_t i) {
+    auto both = [&](const std::vector<double>& v, double low, double high) {
+      return (v[i] < low && v[i + 1] < low) ||
+             (v[i] > high && v[i + 1] > high);
+    };
+    return both(curve.x, x_low, x_high) || both(curve.y, y_low, y_high);
+  };
+  auto length = [&](std::size_t i) {
+    double dx = (curve.x[i + 1] - curve.x[i]) / x_pixel;
+    double dy = (curve.y[i + 1] - curve.y[i]) / y_pixel;
+    return std::sqrt(dx * dx + dy * dy);  // Overflows to infinity at worst
+  };
+
+  bool is_truncated = false;
+  std::vector<std::size_t> parts;
+  Curve added, merged;
+  for (int round = 0; round < kMaxRounds; ++round) {
+    std::size_t n = curve.t.size();
+    parts.assign(n - 1, 1);
+    std::size_t extra = 0;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+      double a = curve.t[i], b = curve.t[i + 1];
+      double middle = a + (b - a) / 2;
+      if (middle <= a || middle >= b) continue;
+      bool has_a = is_defined(i), has_b = is_defined(i + 1);
+      if (has_a && has_b) {
+        if (is_beyond(i)) continue;
+        double parts_needed = std::ceil(length(i) / kStep);
+        parts[i] = parts_needed < kMaxSplit
+                       ? std::max<std::size_t>(
+                             1, static_cast<std::size_t>(parts_needed))
+                       : kMaxSplit;
+      } else if (has_a != has_b) {
+        parts[i] = 2;
+      }
+      extra += parts[i] - 1;
+    }
+    if (n + extra > kMaxPoints) {
+      is_truncated = true;
+      double share = static_cast<double>(kMaxPoints - n) / extra;
+      extra = 0;
+      for (std::size_t& part : parts) {
+        part = 1 + static_cast<std::size_t>((part - 1) * share);
+        extra += part - 1;
+      }
+    }
+    if (extra == 0) break;
+
+    added.t.clear();
+    added.t.reserve(extra);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+      double a = curve.t[i], width = curve.t[i + 1] - a;
+      for (std::size_t k = 1; k < parts[i]; ++k)
+        added.t.push_back(a + width * k / parts[i]);
+    }
+    added.x.resize(extra);
+    added.y.resize(extra);
+    evaluate(added.t.data(), added.x.data(), added.y.data(), extra);
+
+    merged.t.resize(n + extra);
+    merged.x.resize(n + extra);
+    merged.y.resize(n + extra);
+    for (std::size_t i = 0, j = 0, k = 0; i < n; ++i) {
+      merged.t[j] = curve.t[i];
+      merged.x[j] = curve.x[i];
+      merged.y[j++] = curve.y[i];
+      for (std::size_t p = 1; i + 1 < n && p < parts[i]; ++p, ++k) {
+        merged.t[j] = added.t[k];
+        merged.x[j] = added.x[k];
+        merged.y[j++] = added.y[k];
+      }
+    }
+    std::swap(curve, merged);
+  }
+
+  Curve result;
+  std::size_t n = curve.t.size();
+  result.t.reserve(n);
+  result.x.reserve(n);
+  result.y.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    bool has_point = is_defined(i);
+    result.t.push_back(curve.t[i]);
+    result.x.push_back(has_point ? curve.x[i] : kNaN);
+    result.y.push_back(has_point ? curve.y[i] : kNaN);
+    bool is_jump = !is_truncated && i + 1 < n && has_point &&
+                   is_defined(i + 1) && !is_beyond(i) && length(i) > kGap;
+    if (is_jump) {
+      result.t.push_back(curve.t[i] + (curve.t[i + 1] - curve.t[i]) / 2);
+      result.x.push_back(kNaN);
+      result.y.push_back(kNaN);
+    }
+  }
+  return result;
+}
+
+/**
+ * @details The last point before a break and the last point of the curve
+ * are always kept, so the pieces end where the sampled curve does. A run of
+ * breaks is kept as a single one.
+ */
+CurveSampler::Curve CurveSampler::Thin(const Curve& curve,
+                                       const Viewport& viewport) {
+  double x_pixel = (viewport.x_max - viewport.x_min) / viewport.width;
+  double y_pixel = (viewport.y_max - viewport.y_min) / viewport.height;
+  Curve thin;
+  std::size_t n = curve.t.size();
+  double last_x = kNaN, last_y = kNaN;
+  for (std::size_t i = 0; i < n; ++i) {
+    double x = curve.x[i], y = curve.y[i];
+    bool is_break = std::isnan(x);
+    if (is_break && (thin.x.empty() || std::isnan(thin.x.back()))) continue;
+    bool is_end = i + 1 == n || std::isnan(curve.x[i + 1]);
+    bool is_near = std::abs(x - last_x) < x_pixel &&
+                   std::abs(y - last_y) < y_pixel;
+    if (is_break || is_end || !is_near) {
+      thin.t.push_back(curve.t[i]);
+      thin.x.push_back(x);
+      thin.y.push_back(y);
+      last_x = x;
+      last_y = y;
+    }
+  }
+  return thin;
+}
+
+}  // namespace s21
@@ -0,0 +1,137 @@
+/**
+ * @file s21_curvesampler.h
+ * @brief Header file containing the declaration of the CurveSampler for
+ * parametric and polar curves.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_CURVESAMPLER_H
+#define SMARTCALC_MODEL_S21_CURVESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class CurveSampler
+ *
+ * @brief Samples parametric curves x(t), y(t) and polar curves r(θ) with
+ * points spaced along the curve rather than along the parameter.
+ *
+ * The parameter, written 'x' in the expressions, starts on a uniform grid.
+ * The sampling then proceeds in rounds. Every round measures each segment
+ * of the curve in pixels, splits the segments longer than kStep into just
+ * enough equal parts in the parameter, and evaluates all the new parameter
+ * values of the round in one batch over the thread pool: both functions of
+ * a parametric curve at once through a ProgramSet, r of a polar curve
+ * through its program. A segment with one end undefined is bisected, which
+ * closes in on the boundary of the domain.
+ *
+ * The lengths are measured at the scale of the plot, and only the part of
+ * the curve near the visible rectangle is refined: a segment lying beyond
+ * the same edge of the rectangle widened by kMargin of its size on every
+ * side is left as it is. Without that, the infinite arc length of a curve
+ * such as tan near a pole would take every point there is.
+ *
+ * A segment near the rectangle still longer than kGap once the rounds are
+ * over is a jump of the curve and is broken by a point with NaN coordinates. The curve holds
+ * at most kMaxPoints points; when a round would exceed them, every segment
+ * gets a proportional share of the points left and no segment is broken.
+ *
+ * Dense curves have many more points than the plot has pixels; Thin keeps
+ * the points at least a pixel apart for drawing at a given scale.
+ */
+class CurveSampler {
+ public:
+  /**
+   * @struct Curve
+   * @brief The points of a curve in the order of the parameter.
+   */
+  struct Curve {
+    std::vector<double> t;  ///< The parameter, increasing.
+    std::vector<double> x;  ///< NaN where the curve is broken.
+    std::vector<double> y;  ///< NaN where the curve is broken.
+  };
+
+  /**
+   * @struct Viewport
+   * @brief The visible rectangle of the plot and its size in pixels.
+   */
+  struct Viewport {
+    double x_min, x_max;
+    double y_min, y_max;
+    double width, height;
+  };
+
+  /// Points of the uniform grid the sampling starts from.
+  static constexpr std::size_t kDefaultSamples = 1024;
+  /// Longest segment of the sampled curve, in pixels.
+  static constexpr double kStep = 2.0;
+  /// Shortest segment, in pixels, taken for a jump after the rounds.
+  static constexpr double kGap = 32.0;
+  /// Margin refined around the viewport, in viewport sizes.
+  static constexpr double kMargin = 1.0;
+  /// Largest number of points of a curve.
+  static constexpr std::size_t kMaxPoints = std::size_t{1} << 22;
+
+  CurveSampler() noexcept = default;
+  ~CurveSampler() = default;
+
+  /**
+   * @brief Samples the curve (x(t), y(t)) for t in [t_min, t_max].
+   *
+   * @param[in] x The compiled x(t).
+   * @param[in] y The compiled y(t).
+   * @param[in] t_min The first value of the parameter.
+   * @param[in] t_max The last value of the parameter.
+   * @param[in] viewport The plot the curve is sampled for.
+   * @param[in] samples The points of the initial grid, at least 2.
+   * @return The sampled curve.
+   * @throws std::invalid_argument if a program is empty, if the range of
+   * the parameter is empty or if the viewport is empty or not finite.
+   */
+  Curve Parametric(ProgramView x, ProgramView y, double t_min, double t_max,
+                   const Viewport& viewport,
+                   std::size_t samples = kDefaultSamples) const;
+
+  /**
+   * @brief Samples the curve (r(θ) cos θ, r(θ) sin θ) for θ in
+   * [theta_min, theta_max].
+   *
+   * @param[in] r The compiled r(θ).
+   * @param[in] theta_min The first angle, in radians.
+   * @param[in] theta_max The last angle, in radians.
+   * @param[in] viewport The plot the curve is sampled for.
+   * @param[in] samples The points of the initial grid, at least 2.
+   * @return The sampled curve.
+   * @throws std::invalid_argument as Parametric.
+   */
+  Curve Polar(ProgramView r, double theta_min, double theta_max,
+              const Viewport& viewport,
+              std::size_t samples = kDefaultSamples) const;
+
+  /**
+   * @brief Returns the points of @p curve at least a pixel away from the
+   * previous point kept, along with the breaks and the ends of the pieces.
+   *
+   * @param[in] curve The sampled curve.
+   * @param[in] viewport The plot the curve is drawn on.
+   */
+  static Curve Thin(const Curve& curve, const Viewport& viewport);
+
+ private:
+  /**
+   * @brief Runs the rounds of refinement.
+   *
+   * @param[in] evaluate Called as evaluate(t, x, y, count) for a batch.
+   */
+  template <typename Evaluate>
+  static Curve Sample(Evaluate evaluate, double t_min, double t_max,
+                      const Viewport& viewport, std::size_t samples);
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_CURVESAMPLER_H
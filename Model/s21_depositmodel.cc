@@ -0,0 +1,119 @@
+/**
+ * @file s21_depositmodel.cc
+ * @brief Implementation file for the s21_depositmodel.h.
+ */
+
+#include "s21_depositmodel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace s21 {
+
+namespace {
+
+constexpr double kDaysInYear = 365.0;
+/// Slack for period ends that land on a whole day, such as 12 * 365 / 12.
+constexpr double kDayEpsilon = 1e-9;
+
+}  // namespace
+
+DepositModel::Result DepositModel::Calculate(const Deposit& deposit,
+                                             std::vector<Event> events) const {
+  if (!(deposit.amount >= 0) || !std::isfinite(deposit.amount) ||
+      deposit.term <= 0 || !(deposit.rate >= 0) ||
+      !std::isfinite(deposit.rate) || !(deposit.tax_rate >= 0) ||
+      deposit.tax_rate > 100)
+    throw std::invalid_argument("Invalid input");
+  for (const Event& event : events) {
+    if (event.day < 0 || event.day > deposit.term || !(event.value >= 0) ||
+        !std::isfinite(event.value))
+      throw std::invalid_argument("Invalid input");
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event& l, const Event& r) { return l.day < r.day; });
+
+  double period = PeriodLength(deposit.periodicity, deposit.term);
+  double rate = deposit.rate / 100 / kDaysInYear;
+  State state{deposit.amount, 0.0, 0.0, rate, std::log1p(rate * period),
+              0.0, 1};
+  for (const Event& event : events) {
+    Advance(state, event.day, period, deposit.capitalization);
+    if (event.type == Event::Type::kReplenishment) {
+      state.balance += event.value;
+    } else if (event.type == Event::Type::kWithdrawal) {
+      if (event.value > state.balance)
+        throw std::invalid_argument("Invalid input");
+      state.balance -= event.value;
+    } else {
+      state.rate = event.value / 100 / kDaysInYear;
+      state.log_growth = std::log1p(state.rate * period);
+    }
+  }
+  Advance(state, deposit.term, period, deposit.capitalization);
+
+  // The unfinished last period is settled at the end of the term
+  state.interest += state.accrued;
+  if (deposit.capitalization) state.balance += state.accrued;
+  return {state.interest, state.interest * deposit.tax_rate / 100,
+          state.balance};
+}
+
+/**
+ * @details The current period is completed first, then all full periods up
+ * to @p day at once: with capitalization the balance is multiplied by
+ * (1 + rate * period)^m, computed as exp(m * log1p(rate * period)) to keep
+ * low rates accurate; without it each period pays balance * rate * period.
+ * The days after the last period end accrue simple interest.
+ */
+void DepositModel::Advance(State& state, double day, double period,
+                           bool capitalization) noexcept {
+  double end = state.next * period;
+  if (day + kDayEpsilon < end) {
+    state.accrued += state.balance * state.rate * (day - state.day);
+    state.day = day;
+    return;
+  }
+
+  state.accrued += state.balance * state.rate * (end - state.day);
+  state.interest += state.accrued;
+  if (capitalization) state.balance += state.accrued;
+  state.accrued = 0.0;
+
+  auto last = static_cast<std::int64_t>(std::floor(day / period + kDayEpsilon));
+  std::int64_t full = last - state.next;
+  if (full > 0) {
+    double growth = capitalization
+                        ? std::expm1(full * state.log_growth)
+                        : full * state.rate * period;
+    state.interest += state.balance * growth;
+    if (capitalization) state.balance += state.balance * growth;
+  }
+  state.next = last + 1;
+  state.day = std::min(day, last * period);
+  state.accrued += state.balance * state.rate * (day - state.day);
+  state.day = day;
+}
+
+double DepositModel::PeriodLength(Periodicity periodicity, int term) noexcept {
+  switch (periodicity) {
+    case Periodicity::kDaily:
+      return 1.0;
+    case Periodicity::kWeekly:
+      return 7.0;
+    case Periodicity::kMonthly:
+      return kDaysInYear / 12;
+    case Periodicity::kQuarterly:
+      return kDaysInYear / 4;
+    case Periodicity::kYearly:
+      return kDaysInYear;
+    case Periodicity::kAtEnd:
+    default:
+      return term;
+  }
+}
+
+}  // namespace s21
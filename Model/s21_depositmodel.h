@@ -0,0 +1,138 @@
+/**
+ * @file s21_depositmodel.h
+ * @brief Header file containing the declaration of the DepositModel
+ * abstraction in the MVC pattern.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_DEPOSITMODEL_H
+#define SMARTCALC_MODEL_S21_DEPOSITMODEL_H
+
+#include <cstdint>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class DepositModel
+ *
+ * @brief Calculates the interest, tax and final balance of a deposit.
+ *
+ * Replenishments, partial withdrawals and rate changes form a timeline of
+ * events sorted by day. Between two events the rate and the principal are
+ * constant, so the growth over all full capitalization periods in between is
+ * a single power (1 + rate * period)^m, and only the partial periods at the
+ * ends accrue simple interest. The cost depends on the number of events, not
+ * on the number of days or capitalizations.
+ *
+ * Interest accrues daily at rate / 365. At the end of every period it is
+ * either added to the balance (capitalization) or paid out. The tax is the
+ * tax rate applied to the total interest.
+ */
+class DepositModel {
+ public:
+  /**
+   * @enum Periodicity
+   * @brief How often the interest is capitalized or paid out.
+   */
+  enum class Periodicity : std::uint8_t {
+    kDaily,      ///< Every day.
+    kWeekly,     ///< Every 7 days.
+    kMonthly,    ///< Every 365 / 12 days.
+    kQuarterly,  ///< Every 365 / 4 days.
+    kYearly,     ///< Every 365 days.
+    kAtEnd       ///< Once, at the end of the term.
+  };
+
+  /**
+   * @struct Deposit
+   * @brief The conditions of the deposit.
+   */
+  struct Deposit {
+    double amount;            ///< Initial amount.
+    int term;                 ///< Term in days.
+    double rate;              ///< Annual interest rate in percent.
+    double tax_rate;          ///< Tax rate on the interest in percent.
+    Periodicity periodicity;  ///< Period of capitalization or payout.
+    bool capitalization;      ///< True to add interest to the balance.
+  };
+
+  /**
+   * @struct Event
+   * @brief A change of the deposit on a given day.
+   */
+  struct Event {
+    /**
+     * @enum Type
+     * @brief The kind of change.
+     */
+    enum class Type : std::uint8_t {
+      kReplenishment,  ///< Adds value to the balance.
+      kWithdrawal,     ///< Takes value from the balance.
+      kRateChange      ///< Sets the annual rate to value percent.
+    };
+
+    int day;      ///< Day since the opening, from 0 to the term.
+    Type type;    ///< The kind of change.
+    double value; ///< Amount or rate.
+  };
+
+  /**
+   * @struct Result
+   * @brief The outcome of the deposit at the end of the term.
+   */
+  struct Result {
+    double interest;  ///< Interest earned, capitalized or paid out.
+    double tax;       ///< Tax on the interest.
+    double balance;   ///< Balance at the end of the term.
+  };
+
+  DepositModel() noexcept = default;
+  ~DepositModel() = default;
+
+  /**
+   * @brief Calculates the deposit.
+   *
+   * Events of the same day apply in the given order, after the interest of
+   * the preceding days.
+   *
+   * @param[in] deposit The conditions of the deposit.
+   * @param[in] events The replenishments, withdrawals and rate changes.
+   * @return The interest, tax and final balance.
+   * @throws std::invalid_argument if a parameter or an event is invalid, or a
+   * withdrawal exceeds the balance.
+   */
+  Result Calculate(const Deposit& deposit, std::vector<Event> events) const;
+
+ private:
+  /**
+   * @struct State
+   * @brief The deposit between two events.
+   */
+  struct State {
+    double balance;     ///< Principal, including capitalized interest.
+    double accrued;     ///< Interest of the current, unfinished period.
+    double interest;    ///< Interest of the finished periods.
+    double rate;        ///< Daily rate.
+    double log_growth;  ///< log(1 + rate * period), updated with the rate.
+    double day;         ///< Current day.
+    std::int64_t next;  ///< Index of the next period end.
+  };
+
+  /**
+   * @brief Advances @p state to @p day in closed form.
+   *
+   * @param[in] period The length of a period in days.
+   * @param[in] capitalization True to add interest to the balance.
+   */
+  static void Advance(State& state, double day, double period,
+                      bool capitalization) noexcept;
+
+  /**
+   * @brief Returns the length of a period in days, or the term for kAtEnd.
+   */
+  static double PeriodLength(Periodicity periodicity, int term) noexcept;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_DEPOSITMODEL_H
@@ -0,0 +1,40 @@
+/**
+ * @file s21_format.cc
+ * @brief Implementation file for the s21_format.h.
+ */
+
+#include "s21_format.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace s21 {
+
+std::string_view Format::Shortest(double value, char* buffer) noexcept {
+  auto result = std::to_chars(buffer, buffer + kBufferSize, value);
+  return {buffer, static_cast<std::size_t>(result.ptr - buffer)};
+}
+
+/**
+ * @details kBufferSize holds the 309 integer digits of the largest double,
+ * the sign, the point and kMaxPrecision decimals.
+ */
+std::string_view Format::Fixed(double value, int precision,
+                               char* buffer) noexcept {
+  auto result =
+      std::to_chars(buffer, buffer + kBufferSize, value,
+                    std::chars_format::fixed,
+                    std::clamp(precision, 0, kMaxPrecision));
+  return {buffer, static_cast<std::size_t>(result.ptr - buffer)};
+}
+
+std::string_view Format::General(double value, int precision,
+                                 char* buffer) noexcept {
+  auto result =
+      std::to_chars(buffer, buffer + kBufferSize, value,
+                    std::chars_format::general,
+                    std::clamp(precision, 1, kMaxPrecision));
+  return {buffer, static_cast<std::size_t>(result.ptr - buffer)};
+}
+
+}  // namespace s21
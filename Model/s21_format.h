@@ -0,0 +1,69 @@
+/**
+ * @file s21_format.h
+ * @brief Header file containing the declaration of the Format functions
+ * turning numbers into text for results and exports.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_FORMAT_H
+#define SMARTCALC_MODEL_S21_FORMAT_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace s21 {
+
+/**
+ * @class Format
+ *
+ * @brief Formats doubles into caller-provided buffers with std::to_chars.
+ *
+ * Nothing is allocated and no locale is consulted, so the functions are safe
+ * to call from any thread and cost a fraction of the printf family. Infinity
+ * and NaN are written as "inf", "-inf" and "nan", which std::stod and
+ * std::strtod read back.
+ */
+class Format {
+ public:
+  /// Buffer size that fits every result of the functions below.
+  static constexpr std::size_t kBufferSize = 352;
+  /// Largest precision accepted by Fixed and General.
+  static constexpr int kMaxPrecision = 17;
+
+  Format() = delete;
+
+  /**
+   * @brief Writes the shortest text that reads back as exactly @p value.
+   *
+   * @param[in] value The number to format.
+   * @param[out] buffer The output, kBufferSize characters.
+   * @return The text in @p buffer, without a terminating zero.
+   */
+  static std::string_view Shortest(double value, char* buffer) noexcept;
+
+  /**
+   * @brief Writes @p value with a fixed number of decimals, like "%.*f".
+   *
+   * @param[in] value The number to format.
+   * @param[in] precision The number of decimals, clamped to kMaxPrecision.
+   * @param[out] buffer The output, kBufferSize characters.
+   * @return The text in @p buffer, without a terminating zero.
+   */
+  static std::string_view Fixed(double value, int precision,
+                                char* buffer) noexcept;
+
+  /**
+   * @brief Writes @p value with a number of significant digits, like "%.*g".
+   *
+   * @param[in] value The number to format.
+   * @param[in] precision The significant digits, clamped to 1 and
+   * kMaxPrecision.
+   * @param[out] buffer The output, kBufferSize characters.
+   * @return The text in @p buffer, without a terminating zero.
+   */
+  static std::string_view General(double value, int precision,
+                                  char* buffer) noexcept;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_FORMAT_H
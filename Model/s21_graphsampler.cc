@@ -0,0 +1,158 @@
+/**
+ * @file s21_graphsampler.cc
+ * @brief Implementation file for the s21_graphsampler.h.
+ */
+
+#include "s21_graphsampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_interval.h"
+#include "s21_programset.h"
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Points evaluated by one chunk of the thread pool; a multiple of the
+/// blocks of the single-precision evaluation, so the values do not depend
+/// on the cut.
+constexpr std::size_t kPiece = std::size_t{1} << 14;
+
+/// Returns true if [low, high] is a finite non-empty range.
+bool IsRange(double low, double high) noexcept {
+  return std::isfinite(low) && std::isfinite(high) && low < high &&
+         std::isfinite(high - low);
+}
+
+/// Returns true if @p a has finite bounds.
+bool IsBounded(Interval a) noexcept {
+  return std::isfinite(a.low) && std::isfinite(a.high);
+}
+
+}  // namespace
+
+/**
+ * @details Block b runs from point b kBlock to point (b + 1) kBlock, or to
+ * the last point, so neighbour blocks share the point between them: a graph
+ * leaving the plot in one block is drawn up to the first point of the next,
+ * even if that one is not drawn.
+ */
+std::vector<GraphSampler::Graph> GraphSampler::Sample(
+    const std::vector<ProgramView>& functions, const std::vector<double>& x,
+    double y_min, double y_max, double tolerance) const {
+  bool is_valid = !functions.empty() && IsRange(y_min, y_max) &&
+                  std::none_of(functions.begin(), functions.end(),
+                               [](ProgramView f) { return f.Empty(); });
+  if (!is_valid) throw std::invalid_argument("Invalid input");
+  std::size_t n = x.size(), m = functions.size();
+  std::vector<Graph> graphs(m);
+  for (Graph& graph : graphs) graph.y.assign(n, kNaN);
+  if (n == 0) return graphs;
+
+  std::size_t blocks = n == 1 ? 1 : (n - 2) / kBlock + 1;
+  auto first = [](std::size_t b) { return b * kBlock; };
+  auto last = [n](std::size_t b) { return std::min((b + 1) * kBlock, n - 1); };
+  auto span = [&x](std::size_t i, std::size_t j) {
+    return Interval(std::min(x[i], x[j]), std::max(x[i], x[j]));
+  };
+  // The functions read x alone, and 'y' is not a number
+  std::vector<Interval> xs(std::max(blocks, kBlock)), ys(xs.size());
+  std::vector<Interval> ranges(xs.size());
+
+  // Bounds each function over the blocks
+  std::vector<std::vector<bool>> is_shown(m, std::vector<bool>(blocks));
+  std::vector<std::vector<bool>> is_unbounded = is_shown;
+  std::vector<bool> is_needed(blocks);
+  for (std::size_t b = 0; b < blocks; ++b) xs[b] = span(first(b), last(b));
+  for (std::size_t f = 0; f < m; ++f) {
+    functions[f].EvaluateXY(xs.data(), ys.data(), ranges.data(), blocks);
+    for (std::size_t b = 0; b < blocks; ++b) {
+      is_shown[f][b] = ranges[b].low <= y_max && ranges[b].high >= y_min;
+      is_unbounded[f][b] = !IsBounded(ranges[b]);
+      if (is_shown[f][b]) is_needed[b] = true;
+    }
+  }
+
+  // Evaluates the runs of blocks shown for some function, in place, in
+  // pieces spread over the thread pool, and leaves out the values that are
+  // not finite while a piece is still in the cache
+  std::vector<std::pair<std::size_t, std::size_t>> pieces;  // First, count
+  for (std::size_t b = 0; b < blocks;) {
+    if (!is_needed[b]) {
+      ++b;
+      continue;
+    }
+    std::size_t begin = first(b);
+    while (b < blocks && is_needed[b]) ++b;
+    std::size_t end = last(b - 1) + 1;
+    for (std::size_t at = begin; at < end; at += kPiece)
+      pieces.emplace_back(at, std::min(kPiece, end - at));
+  }
+  ProgramSet set;
+  if (m > 1)
+    for (ProgramView f : functions) set.Add(f);
+  ThreadPool::Shared().ParallelFor(
+      pieces.size(), [&](std::size_t begin, std::size_t end) {
+        std::vector<double*> results(m);
+        for (std::size_t p = begin; p < end; ++p) {
+          auto [at, count] = pieces[p];
+          for (std::size_t f = 0; f < m; ++f)
+            results[f] = graphs[f].y.data() + at;
+          if (m == 1)
+            functions.front().EvaluateFast(x.data() + at, results.front(),
+                                           count, tolerance);
+          else
+            set.Evaluate(x.data() + at, results.data(), count);
+          for (double* values : results)
+            for (std::size_t i = 0; i < count; ++i)
+              if (!std::isfinite(values[i])) values[i] = kNaN;
+        }
+      });
+  // Leaves out the values computed for other functions
+  for (std::size_t f = 0; f < m; ++f) {
+    std::vector<double>& y = graphs[f].y;
+    for (std::size_t b = 0; b < blocks; ++b) {
+      if (!is_needed[b] || is_shown[f][b]) continue;
+      bool is_after = b + 1 < blocks && is_shown[f][b + 1];
+      std::fill(y.begin() + first(b) + (b > 0 && is_shown[f][b - 1]),
+                y.begin() + last(b) + !is_after, kNaN);
+    }
+  }
+
+  // Breaks the steps that may cross a pole. Only those of the unbounded
+  // blocks whose ends disagree are bounded; a step with a NaN end is broken
+  // already and fails the comparison.
+  std::vector<std::size_t> steps;
+  for (std::size_t f = 0; f < m; ++f) {
+    const std::vector<double>& y = graphs[f].y;
+    steps.clear();
+    for (std::size_t b = 0; b < blocks; ++b) {
+      if (!is_shown[f][b] || !is_unbounded[f][b]) continue;
+      for (std::size_t i = first(b); i < last(b); ++i)
+        if (std::abs(y[i] - y[i + 1]) > tolerance) steps.push_back(i);
+    }
+    if (steps.empty()) continue;
+    if (xs.size() < steps.size()) {
+      xs.resize(steps.size());
+      ys.resize(steps.size());
+      ranges.resize(steps.size());
+    }
+    for (std::size_t s = 0; s < steps.size(); ++s)
+      xs[s] = span(steps[s], steps[s] + 1);
+    functions[f].EvaluateXY(xs.data(), ys.data(), ranges.data(),
+                            steps.size());
+    for (std::size_t s = 0; s < steps.size(); ++s)
+      if (!IsBounded(ranges[s])) graphs[f].breaks.push_back(steps[s]);
+  }
+  return graphs;
+}
+
+}  // namespace s21
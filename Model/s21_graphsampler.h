@@ -0,0 +1,77 @@
+/**
+ * @file s21_graphsampler.h
+ * @brief Header file containing the declaration of the GraphSampler for the
+ * graphs of functions y = f(x).
+ */
+
+#ifndef SMARTCALC_MODEL_S21_GRAPHSAMPLER_H
+#define SMARTCALC_MODEL_S21_GRAPHSAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class GraphSampler
+ *
+ * @brief Samples the graphs of functions of x on a shared grid for a plot,
+ * guided by the interval evaluation of the programs.
+ *
+ * The grid is cut into blocks of kBlock steps, and each function is bounded
+ * over each block with intervals. A block whose range lies entirely above
+ * or below the plot, or where the function is nowhere a number, is not
+ * drawn, and its values are not computed unless another function needs
+ * them. The rest are evaluated in one pass over the thread pool, as
+ * interactive work, in single precision where that is accurate enough for a
+ * single function, fused for several.
+ *
+ * A step of the grid can only cross a pole where the function has no bound
+ * over it and its ends disagree by more than the tolerance; a step whose
+ * ends agree holds a hole rather than a pole, as sin(x)/x has one at zero.
+ * So the steps of the unbounded blocks whose ends disagree are bounded one
+ * by one, and those without a bound are broken between their ends, keeping
+ * both samples. Steep but continuous graphs stay whole, whatever the height
+ * of a step.
+ */
+class GraphSampler {
+ public:
+  /**
+   * @struct Graph
+   * @brief The sampled graph of a function on the grid.
+   */
+  struct Graph {
+    std::vector<double> y;  ///< One per point; NaN where not drawn.
+    /// The steps from x[i] to x[i + 1] broken at a pole, as i, ascending.
+    std::vector<std::size_t> breaks;
+  };
+
+  /// Steps of the grid bounded together by one interval evaluation.
+  static constexpr std::size_t kBlock = 64;
+
+  GraphSampler() noexcept = default;
+  ~GraphSampler() = default;
+
+  /**
+   * @brief Samples the graphs of functions on a grid for a plot.
+   *
+   * @param[in] functions The compiled functions of x.
+   * @param[in] x The grid, in ascending order.
+   * @param[in] y_min The bottom of the plot.
+   * @param[in] y_max The top of the plot.
+   * @param[in] tolerance The absolute error allowed, such as half the height
+   * of a pixel.
+   * @return The graph of each function.
+   * @throws std::invalid_argument if there is no function, if a program is
+   * empty or if the range of y is empty or not finite.
+   */
+  std::vector<Graph> Sample(
+      const std::vector<ProgramView>& functions, const std::vector<double>& x,
+      double y_min, double y_max, double tolerance) const;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_GRAPHSAMPLER_H
@@ -0,0 +1,319 @@
+/**
+ * @file s21_historyfile.cc
+ * @brief Implementation file for the s21_historyfile.h.
+ */
+
+#include "s21_historyfile.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "s21_programfile.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', '2', '1', 'H', 'I', 'S', 'T', 'O'};
+constexpr std::uint32_t kVersion = 1;
+/// Alignment of the records, that of their numbers.
+constexpr std::uint64_t kAlignment = 8;
+
+/// Holds an exclusive lock of a file while in scope. Where the file system
+/// has no locks the file is used unlocked.
+class Lock {
+ public:
+  explicit Lock(int fd) noexcept : fd_(fd) {
+    while (flock(fd_, LOCK_EX) != 0 && errno == EINTR) continue;
+  }
+  ~Lock() { flock(fd_, LOCK_UN); }
+  Lock(const Lock&) = delete;
+  Lock& operator=(const Lock&) = delete;
+
+ private:
+  int fd_;
+};
+
+/// Returns the bits of @p x, the same for both zeros.
+std::uint64_t Bits(double x) noexcept {
+  if (x == 0) x = 0.0;
+  std::uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+HistoryFile::HistoryFile(const std::string& path, std::size_t capacity) {
+  capacity = capacity / kAlignment * kAlignment;
+  if (capacity < sizeof(Header)) throw std::invalid_argument("Invalid input");
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0) throw std::invalid_argument("Invalid input");
+  try {
+    Map(capacity);
+  } catch (...) {
+    close(fd_);
+    throw;
+  }
+}
+
+HistoryFile::HistoryFile(HistoryFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+HistoryFile& HistoryFile::operator=(HistoryFile&& other) noexcept {
+  if (this != &other) {
+    if (data_) munmap(data_, size_);
+    if (fd_ >= 0) close(fd_);
+    fd_ = std::exchange(other.fd_, -1);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    end_ = std::exchange(other.end_, 0);
+    generation_ = other.generation_;
+    offsets_ = std::move(other.offsets_);
+    index_ = std::move(other.index_);
+  }
+  return *this;
+}
+
+HistoryFile::~HistoryFile() {
+  if (data_) munmap(data_, size_);
+  if (fd_ >= 0) close(fd_);
+}
+
+std::string HistoryFile::Normalize(std::string_view key) {
+  std::string normalized;
+  for (char c : key)
+    if (!std::isspace(static_cast<unsigned char>(c))) normalized += c;
+  return normalized;
+}
+
+/**
+ * @details The record is written past the end of the log, and the end in
+ * the header moves past it once it is whole.
+ */
+void HistoryFile::Append(std::string_view expression, std::string_view key,
+                         double x, double result, std::int64_t time) {
+  Lock lock(fd_);
+  Sync();
+  std::string normalized = Normalize(key);
+  constexpr std::size_t kMaxText = std::numeric_limits<std::uint32_t>::max();
+  if (expression.size() > kMaxText || normalized.size() > kMaxText)
+    throw std::invalid_argument("Invalid input");
+  if (x == 0) x = 0.0;
+  RecordHeader record{ProgramFile::Hash(normalized), x, result, time,
+                      static_cast<std::uint32_t>(expression.size()),
+                      static_cast<std::uint32_t>(normalized.size())};
+  std::uint64_t extent = Extent(record);
+  if (extent > (size_ - sizeof(Header)) / 2)
+    throw std::invalid_argument("Invalid input");
+  if (extent > size_ - end_) Shrink();
+
+  unsigned char* out = data_ + end_;
+  std::memcpy(out, &record, sizeof(RecordHeader));
+  out += sizeof(RecordHeader);
+  std::memcpy(out, expression.data(), expression.size());
+  out += expression.size();
+  std::memcpy(out, normalized.data(), normalized.size());
+  out += normalized.size();
+  std::memset(out, 0, data_ + end_ + extent - out);
+  offsets_.push_back(end_);
+  index_[IndexKey(normalized, x)] = end_;
+  SetEnd(end_ + extent);
+}
+
+std::optional<double> HistoryFile::Find(std::string_view key, double x) {
+  Lock lock(fd_);
+  Sync();
+  auto found = index_.find(IndexKey(Normalize(key), x));
+  if (found == index_.end()) return std::nullopt;
+  return At(found->second).result;
+}
+
+std::vector<HistoryFile::Record> HistoryFile::Recent(std::size_t count) {
+  Lock lock(fd_);
+  Sync();
+  std::vector<Record> records;
+  for (auto it = offsets_.rbegin();
+       it != offsets_.rend() && records.size() < count; ++it) {
+    RecordHeader record = At(*it);
+    const char* text =
+        reinterpret_cast<const char*>(data_ + *it + sizeof(RecordHeader));
+    records.push_back({std::string(text, record.expression_size), record.x,
+                       record.result, record.time});
+  }
+  return records;
+}
+
+void HistoryFile::Compact() {
+  Lock lock(fd_);
+  Sync();
+  Shrink();
+}
+
+/**
+ * @details The file must exist. It is checked and started afresh if needed
+ * under the lock, so two processes opening a new file do not both start it.
+ */
+void HistoryFile::Map(std::size_t capacity) {
+  Lock lock(fd_);
+  struct stat status {};
+  Header header{};
+  bool is_history =
+      fstat(fd_, &status) == 0 &&
+      static_cast<std::size_t>(status.st_size) >= sizeof(Header) &&
+      pread(fd_, &header, sizeof(Header), 0) ==
+          static_cast<ssize_t>(sizeof(Header)) &&
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+      header.version == kVersion &&
+      header.size == static_cast<std::uint64_t>(status.st_size) &&
+      header.size % kAlignment == 0 && header.end >= sizeof(Header) &&
+      header.end <= header.size;
+  if (!is_history) {
+    header = Header{{}, kVersion, 0, capacity, sizeof(Header)};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    bool is_created = ftruncate(fd_, 0) == 0 &&
+                      ftruncate(fd_, static_cast<off_t>(capacity)) == 0 &&
+                      pwrite(fd_, &header, sizeof(Header), 0) ==
+                          static_cast<ssize_t>(sizeof(Header));
+    if (!is_created) throw std::invalid_argument("Invalid input");
+  }
+  size_ = static_cast<std::size_t>(header.size);
+  void* data =
+      mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    throw std::invalid_argument("Invalid input");
+  }
+  data_ = static_cast<unsigned char*>(data);
+  generation_ = header.generation;
+  end_ = sizeof(Header);
+  Scan(header.end);
+}
+
+/**
+ * @details Another process may have appended records since the last call,
+ * which are read, or compacted the log, which is then read again from the
+ * start.
+ */
+void HistoryFile::Sync() {
+  Header header;
+  std::memcpy(&header, data_, sizeof(Header));
+  std::uint64_t end = std::clamp<std::uint64_t>(header.end, sizeof(Header),
+                                                size_);
+  if (header.generation != generation_ || end < end_) {
+    generation_ = header.generation;
+    end_ = sizeof(Header);
+    offsets_.clear();
+    index_.clear();
+  }
+  Scan(end);
+}
+
+/**
+ * @details The log ends before the first record that does not fit or whose
+ * key does not match its hash, which only a damaged file has.
+ */
+void HistoryFile::Scan(std::uint64_t end) {
+  std::uint64_t offset = end_;
+  while (end - offset >= sizeof(RecordHeader)) {
+    RecordHeader record = At(offset);
+    std::uint64_t extent = Extent(record);
+    if (extent > end - offset) break;
+    std::string_view key = KeyAt(offset);
+    if (ProgramFile::Hash(key) != record.hash) break;
+    offsets_.push_back(offset);
+    index_[IndexKey(key, record.x)] = offset;
+    offset += extent;
+  }
+  if (offset != end) {
+    SetEnd(offset);
+  } else {
+    end_ = end;
+  }
+}
+
+/**
+ * @details The records kept move towards the start of the file, in their
+ * order, so each one moves to where none of the others still is. The log is
+ * empty in the header while they move: a crash loses the history rather
+ * than leaving records half moved. The generation in the header changes
+ * first, so other processes read the log again.
+ */
+void HistoryFile::Shrink() {
+  std::vector<std::uint64_t> kept;
+  std::uint64_t used = 0;
+  for (std::uint64_t offset : offsets_) {
+    RecordHeader record = At(offset);
+    if (index_.at(IndexKey(KeyAt(offset), record.x)) != offset) continue;
+    kept.push_back(offset);
+    used += Extent(record);
+  }
+  std::size_t first = 0;
+  while (used > (size_ - sizeof(Header)) / 2)
+    used -= Extent(At(kept[first++]));
+
+  ++generation_;
+  std::memcpy(data_ + offsetof(Header, generation), &generation_,
+              sizeof(generation_));
+  SetEnd(sizeof(Header));
+  offsets_.clear();
+  index_.clear();
+  std::uint64_t end = sizeof(Header);
+  for (std::size_t k = first; k < kept.size(); ++k) {
+    RecordHeader record = At(kept[k]);
+    std::uint64_t extent = Extent(record);
+    std::memmove(data_ + end, data_ + kept[k], extent);
+    offsets_.push_back(end);
+    index_[IndexKey(KeyAt(end), record.x)] = end;
+    end += extent;
+  }
+  SetEnd(end);
+}
+
+std::string HistoryFile::IndexKey(std::string_view key, double x) {
+  std::uint64_t bits = Bits(x);
+  std::string index_key(reinterpret_cast<const char*>(&bits), sizeof(bits));
+  index_key += key;
+  return index_key;
+}
+
+std::string_view HistoryFile::KeyAt(std::uint64_t offset) const noexcept {
+  RecordHeader record = At(offset);
+  return std::string_view(
+      reinterpret_cast<const char*>(data_ + offset + sizeof(RecordHeader) +
+                                    record.expression_size),
+      record.key_size);
+}
+
+HistoryFile::RecordHeader HistoryFile::At(
+    std::uint64_t offset) const noexcept {
+  RecordHeader record;
+  std::memcpy(&record, data_ + offset, sizeof(RecordHeader));
+  return record;
+}
+
+std::uint64_t HistoryFile::Extent(const RecordHeader& record) noexcept {
+  std::uint64_t size = sizeof(RecordHeader) +
+                       std::uint64_t{record.expression_size} + record.key_size;
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+void HistoryFile::SetEnd(std::uint64_t end) noexcept {
+  end_ = end;
+  std::memcpy(data_ + offsetof(Header, end), &end, sizeof(end));
+}
+
+}  // namespace s21
@@ -0,0 +1,235 @@
+/**
+ * @file s21_historyfile.h
+ * @brief Header file containing the declaration of the HistoryFile, the
+ * memory-mapped log of past calculations.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_HISTORYFILE_H
+#define SMARTCALC_MODEL_S21_HISTORYFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class HistoryFile
+ *
+ * @brief An append-only log of calculations in a file of fixed size, mapped
+ * into memory.
+ *
+ * The file starts with a 32-byte header: the magic "S21HISTO", the format
+ * version, the number of compactions, the size of the file and the end of
+ * the log. The records follow
+ * in the order they were made, each 8-byte aligned: a 40-byte record header
+ * (the hash of the key, x, the result, the time in milliseconds since the
+ * Unix epoch and the sizes of the two texts), then the expression as typed
+ * and the key. The key is the expression as the parser sees it, with the
+ * user definitions inlined, so a result is recalled only while the
+ * definitions it used are the same. Everything is in host byte order.
+ *
+ * A record is written before the end in the header moves past it, so a
+ * record cut short by a crash is never read. The records are indexed by
+ * their key and x when the file is opened and as they are appended, and a
+ * lookup touches only the page of the record it finds.
+ *
+ * When a record does not fit, the log is compacted in place: the records
+ * superseded by a later one of the same key and x are dropped, then the
+ * oldest ones until at most half the file is used. The file never grows.
+ *
+ * Several instances, in one process or several, may share the file. Each
+ * call locks it with flock and first reads the records other instances
+ * appended since its last call, or the whole log again if one compacted it.
+ *
+ * Mapping uses the POSIX mmap interface.
+ */
+class HistoryFile {
+ public:
+  /// Size of a new file in bytes.
+  static constexpr std::size_t kCapacity = std::size_t{1} << 20;
+
+  /**
+   * @struct Record
+   * @brief A calculation of the log.
+   */
+  struct Record {
+    std::string expression;  ///< The expression as typed.
+    double x;
+    double result;
+    std::int64_t time;  ///< Milliseconds since the Unix epoch.
+  };
+
+  /**
+   * @brief Maps a history file for reading and writing, creating it if
+   * there is none.
+   *
+   * A file that is not a history file of the current version is started
+   * afresh.
+   *
+   * @param[in] path The file to open.
+   * @param[in] capacity The size of the file if it is created, in bytes.
+   * @throws std::invalid_argument if the file cannot be created or mapped,
+   * or @p capacity cannot hold a header.
+   */
+  explicit HistoryFile(const std::string& path,
+                       std::size_t capacity = kCapacity);
+
+  HistoryFile(HistoryFile&& other) noexcept;
+  HistoryFile& operator=(HistoryFile&& other) noexcept;
+  HistoryFile(const HistoryFile&) = delete;
+  HistoryFile& operator=(const HistoryFile&) = delete;
+
+  /**
+   * @brief Unmaps the file; the records stay in it.
+   */
+  ~HistoryFile();
+
+  /**
+   * @brief Returns the key of an expression without its blanks, which the
+   * parser ignores.
+   */
+  static std::string Normalize(std::string_view key);
+
+  /**
+   * @brief Returns the number of records.
+   */
+  std::size_t Size() const noexcept { return offsets_.size(); }
+
+  /**
+   * @brief Returns the bytes of the file in use, the header included.
+   */
+  std::size_t Used() const noexcept { return end_; }
+
+  /**
+   * @brief Returns the size of the file in bytes.
+   */
+  std::size_t Capacity() const noexcept { return size_; }
+
+  /**
+   * @brief Appends a calculation, compacting the log first if it is full.
+   *
+   * @param[in] expression The expression as typed.
+   * @param[in] key The expression with the user definitions inlined.
+   * @param[in] x The value of x.
+   * @param[in] result The result.
+   * @param[in] time Milliseconds since the Unix epoch.
+   * @throws std::invalid_argument if the record cannot fit in half the file.
+   */
+  void Append(std::string_view expression, std::string_view key, double x,
+              double result, std::int64_t time);
+
+  /**
+   * @brief Looks up the latest result of a key and x.
+   *
+   * @param[in] key The expression with the user definitions inlined.
+   * @param[in] x The value of x.
+   * @return The result, or std::nullopt if there is none.
+   */
+  std::optional<double> Find(std::string_view key, double x);
+
+  /**
+   * @brief Returns up to @p count records, the latest first.
+   */
+  std::vector<Record> Recent(std::size_t count);
+
+  /**
+   * @brief Drops the records superseded by a later one of the same key and
+   * x, then the oldest ones until at most half the file is used.
+   */
+  void Compact();
+
+ private:
+  /**
+   * @struct Header
+   * @brief The fixed part at the start of the file.
+   */
+  struct Header {
+    char magic[8];             ///< "S21HISTO".
+    std::uint32_t version;     ///< Format version, 1.
+    std::uint32_t generation;  ///< Incremented by each compaction.
+    std::uint64_t size;        ///< Size of the file in bytes.
+    std::uint64_t end;         ///< Offset past the last record.
+  };
+
+  /**
+   * @struct RecordHeader
+   * @brief The fixed part of a record.
+   */
+  struct RecordHeader {
+    std::uint64_t hash;  ///< Hash of the normalized key.
+    double x;
+    double result;
+    std::int64_t time;              ///< Milliseconds since the Unix epoch.
+    std::uint32_t expression_size;  ///< Bytes of the expression.
+    std::uint32_t key_size;         ///< Bytes of the normalized key.
+  };
+
+  /**
+   * @brief Checks the file, starting it afresh if it is not a history
+   * file, maps it and reads its records.
+   *
+   * @param[in] capacity The size of the file if it is started.
+   * @throws std::invalid_argument if the file cannot be started or mapped.
+   */
+  void Map(std::size_t capacity);
+
+  /**
+   * @brief Catches up with the changes other instances made to the file.
+   */
+  void Sync();
+
+  /**
+   * @brief Reads the records from end_ up to @p end into the index.
+   */
+  void Scan(std::uint64_t end);
+
+  /**
+   * @brief Compacts the log, with the file locked.
+   */
+  void Shrink();
+
+  /**
+   * @brief Returns the entry of the index for a normalized key and x: the
+   * bits of x followed by the key, so different calculations never share
+   * one.
+   */
+  static std::string IndexKey(std::string_view key, double x);
+
+  /**
+   * @brief Returns the normalized key of the record at @p offset.
+   */
+  std::string_view KeyAt(std::uint64_t offset) const noexcept;
+
+  /**
+   * @brief Returns the header of the record at @p offset.
+   */
+  RecordHeader At(std::uint64_t offset) const noexcept;
+
+  /**
+   * @brief Returns the bytes a record takes, padding included.
+   */
+  static std::uint64_t Extent(const RecordHeader& record) noexcept;
+
+  /**
+   * @brief Sets the end of the log, in the header as well.
+   */
+  void SetEnd(std::uint64_t end) noexcept;
+
+  int fd_ = -1;                    ///< The file, kept open for the lock.
+  unsigned char* data_ = nullptr;  ///< Start of the mapping.
+  std::size_t size_ = 0;           ///< Size of the mapping in bytes.
+  std::uint64_t end_ = 0;          ///< Offset past the last record.
+  std::uint32_t generation_ = 0;   ///< Compactions the index follows.
+  std::vector<std::uint64_t> offsets_;  ///< The records, oldest first.
+  /// The latest record of each key and x, by IndexKey.
+  std::unordered_map<std::string, std::uint64_t> index_;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_HISTORYFILE_H
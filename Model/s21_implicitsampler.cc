@@ -0,0 +1,257 @@
+/**
+ * @file s21_implicitsampler.cc
+ * @brief Implementation file for the s21_implicitsampler.h.
+ */
+
+#include "s21_implicitsampler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_interval.h"
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+/// Cells or corners evaluated by one thread pool task.
+constexpr std::size_t kGrain = 1 << 10;
+constexpr std::uint64_t kNone = std::numeric_limits<std::uint64_t>::max();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/// End of a segment without a neighbour.
+constexpr std::uint32_t kNoEnd = std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * @struct Cell
+ * @brief A cell of the quadtree by its lower left corner on the grid of the
+ * deepest level; the cells of a level share their size.
+ */
+struct Cell {
+  std::uint32_t i;
+  std::uint32_t j;
+};
+
+/**
+ * @struct Crossing
+ * @brief A point where the curve crosses an edge of the grid.
+ */
+struct Crossing {
+  std::uint64_t edge;  ///< The number of the edge, kNone for no point.
+  double x;
+  double y;
+};
+
+/// Returns true if [low, high] is a finite non-empty range.
+bool IsRange(double low, double high) noexcept {
+  return std::isfinite(low) && std::isfinite(high) && low < high &&
+         std::isfinite(high - low);
+}
+
+/// Returns true if @p a has finite bounds.
+bool IsBounded(Interval a) noexcept {
+  return std::isfinite(a.low) && std::isfinite(a.high);
+}
+
+}  // namespace
+
+/**
+ * @details The grid of the deepest level has n + 1 corners on a side, the
+ * last one placed at the edge of the viewport itself, so the coordinates of
+ * a corner are the same doubles at every level. A corner is numbered
+ * j (n + 1) + i, and an edge twice the number of its lower left corner, plus
+ * one if it is vertical: the crossings of neighbour cells are found by the
+ * number of the edge they share.
+ */
+CurveSampler::Curve ImplicitSampler::Sample(
+    ProgramView f, const CurveSampler::Viewport& viewport) const {
+  bool is_valid = IsRange(viewport.x_min, viewport.x_max) &&
+                  IsRange(viewport.y_min, viewport.y_max) &&
+                  viewport.width > 0 && viewport.height > 0 &&
+                  std::isfinite(viewport.width) &&
+                  std::isfinite(viewport.height);
+  if (!is_valid || f.Empty()) throw std::invalid_argument("Invalid input");
+
+  int depth = 0;
+  double pixels = std::max(viewport.width, viewport.height) / kCell;
+  while (depth < kMaxDepth && std::ldexp(1.0, depth) < pixels) ++depth;
+  std::uint32_t n = std::uint32_t{1} << depth;
+  std::uint64_t row = std::uint64_t{n} + 1;  // Corners on a side
+  double x_step = (viewport.x_max - viewport.x_min) / n;
+  double y_step = (viewport.y_max - viewport.y_min) / n;
+  auto x_at = [&](std::uint32_t i) {
+    return i == n ? viewport.x_max : viewport.x_min + i * x_step;
+  };
+  auto y_at = [&](std::uint32_t j) {
+    return j == n ? viewport.y_max : viewport.y_min + j * y_step;
+  };
+  ThreadPool& pool = ThreadPool::Shared();
+
+  // Divides the cells holding a zero, level by level
+  std::vector<Cell> cells{{0, 0}}, next;
+  std::vector<Interval> xs, ys, ranges;
+  std::uint32_t size = n;  // Side of the cells of the level, in leaf cells
+  for (;;) {
+    std::size_t count = cells.size();
+    xs.resize(count);
+    ys.resize(count);
+    ranges.resize(count);
+    pool.ParallelFor(
+        count,
+        [&](std::size_t begin, std::size_t end) {
+          for (std::size_t k = begin; k < end; ++k) {
+            xs[k] = Interval(x_at(cells[k].i), x_at(cells[k].i + size));
+            ys[k] = Interval(y_at(cells[k].j), y_at(cells[k].j + size));
+          }
+          f.EvaluateXY(xs.data() + begin, ys.data() + begin,
+                       ranges.data() + begin, end - begin);
+        },
+        kGrain);
+    next.clear();
+    for (std::size_t k = 0; k < count; ++k)
+      if (ranges[k].Contains(0.0)) next.push_back(cells[k]);
+    if (size == 1 || next.size() * 4 > kMaxLeaves) break;
+    cells.clear();
+    size /= 2;
+    for (const Cell& cell : next) {
+      cells.push_back({cell.i, cell.j});
+      cells.push_back({cell.i + size, cell.j});
+      cells.push_back({cell.i, cell.j + size});
+      cells.push_back({cell.i + size, cell.j + size});
+    }
+  }
+  std::vector<Cell>& leaves = next;
+  std::vector<bool> is_unbounded(leaves.size());
+  for (std::size_t k = 0, m = 0; k < ranges.size(); ++k)
+    if (ranges[k].Contains(0.0)) is_unbounded[m++] = !IsBounded(ranges[k]);
+
+  // Evaluates f at the corners of every leaf, counterclockwise from the
+  // lower left; a corner shared by several leaves gets the same value in
+  // each, so their crossings on a shared edge are the same points
+  std::size_t corners = leaves.size() * 4;
+  std::vector<double> cx(corners), cy(corners), values(corners);
+  pool.ParallelFor(
+      leaves.size(),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+          double x_low = x_at(leaves[k].i), x_high = x_at(leaves[k].i + size);
+          double y_low = y_at(leaves[k].j), y_high = y_at(leaves[k].j + size);
+          double* x = &cx[4 * k];
+          double* y = &cy[4 * k];
+          x[0] = x[3] = x_low;
+          x[1] = x[2] = x_high;
+          y[0] = y[1] = y_low;
+          y[2] = y[3] = y_high;
+        }
+        f.EvaluateXY(cx.data() + 4 * begin, cy.data() + 4 * begin,
+                     values.data() + 4 * begin, 4 * (end - begin));
+      },
+      kGrain);
+
+  // Marching squares: up to two segments per leaf
+  std::vector<std::array<Crossing, 4>> segments(leaves.size());
+  pool.ParallelFor(
+      leaves.size(),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+          const Cell& leaf = leaves[k];
+          std::array<Crossing, 4>& out = segments[k];
+          out[0].edge = out[2].edge = kNone;
+          const double* v = &values[4 * k];
+          if (std::isnan(v[0] + v[1] + v[2] + v[3])) continue;
+          bool is_crossed[4];
+          int crossings = 0;
+          for (int e = 0; e < 4; ++e) {
+            is_crossed[e] = (v[e] > 0) != (v[(e + 1) % 4] > 0);
+            crossings += is_crossed[e];
+          }
+          if (crossings == 0) continue;
+          if (is_unbounded[k]) {
+            bool is_pole = false;
+            for (int e = 0; e < 4 && !is_pole; ++e) {
+              if (!is_crossed[e]) continue;
+              std::size_t a = 4 * k + (e == 3 ? 0 : e);
+              std::size_t b = 4 * k + (e == 3 ? 3 : e + 1);
+              Interval x(std::min(cx[a], cx[b]), std::max(cx[a], cx[b]));
+              Interval y(std::min(cy[a], cy[b]), std::max(cy[a], cy[b]));
+              is_pole = !IsBounded(f.EvaluateXY(x, y));
+            }
+            if (is_pole) continue;
+          }
+          // Bottom, right, top and left, numbered by their lower left corner
+          std::uint64_t lower_left = std::uint64_t{leaf.j} * row + leaf.i;
+          std::uint64_t edges[4] = {2 * lower_left, 2 * (lower_left + size) + 1,
+                                    2 * (lower_left + size * row),
+                                    2 * lower_left + 1};
+          // Each edge is interpolated from its lower left corner, as the
+          // neighbour sharing it does
+          auto crossing = [&](int e) {
+            std::size_t a = 4 * k + (e == 2 ? 3 : e == 3 ? 0 : e);
+            std::size_t b = 4 * k + (e == 2 ? 2 : e == 3 ? 3 : e + 1);
+            double t = values[a] / (values[a] - values[b]);
+            return Crossing{edges[e], cx[a] + t * (cx[b] - cx[a]),
+                            cy[a] + t * (cy[b] - cy[a])};
+          };
+          if (crossings == 2) {
+            for (int e = 0, m = 0; e < 4; ++e)
+              if (is_crossed[e]) out[m++] = crossing(e);
+            continue;
+          }
+          // A saddle: the center joins the corners of its own sign
+          bool is_center = (v[0] + v[1] + v[2] + v[3]) / 4 > 0;
+          int order[2][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}};
+          for (int m = 0; m < 4; ++m)
+            out[m] = crossing(order[is_center == (v[0] > 0) ? 0 : 1][m]);
+        }
+      },
+      kGrain);
+
+  // Joins the segments sharing an edge into pieces. The ends are numbered
+  // 2 s and 2 s + 1 for segment s, and sorted by edge to pair them up.
+  std::vector<Crossing> ends;
+  for (const auto& leaf : segments)
+    for (int m = 0; m < 4 && leaf[m].edge != kNone; m += 2)
+      ends.insert(ends.end(), {leaf[m], leaf[m + 1]});
+  std::vector<std::uint32_t> order(ends.size());
+  for (std::uint32_t e = 0; e < order.size(); ++e) order[e] = e;
+  std::sort(order.begin(), order.end(),
+            [&ends](std::uint32_t a, std::uint32_t b) {
+              return ends[a].edge < ends[b].edge;
+            });
+  std::vector<std::uint32_t> partner(ends.size(), kNoEnd);
+  for (std::size_t r = 0; r + 1 < order.size(); ++r) {
+    if (ends[order[r]].edge != ends[order[r + 1]].edge) continue;
+    partner[order[r]] = order[r + 1];
+    partner[order[r + 1]] = order[r];
+  }
+
+  CurveSampler::Curve curve;
+  auto add = [&curve](double x, double y) {
+    curve.t.push_back(static_cast<double>(curve.t.size()));
+    curve.x.push_back(x);
+    curve.y.push_back(y);
+  };
+  std::vector<bool> is_drawn(ends.size() / 2);
+  auto trace = [&](std::uint32_t end) {
+    if (!curve.t.empty()) add(kNaN, kNaN);
+    add(ends[end].x, ends[end].y);
+    for (; end != kNoEnd && !is_drawn[end / 2]; end = partner[end ^ 1]) {
+      is_drawn[end / 2] = true;
+      add(ends[end ^ 1].x, ends[end ^ 1].y);
+    }
+  };
+  // Open pieces from one of their ends, then the closed ones
+  for (std::uint32_t end = 0; end < ends.size(); ++end)
+    if (!is_drawn[end / 2] && partner[end] == kNoEnd) trace(end);
+  for (std::uint32_t end = 0; end < ends.size(); end += 2)
+    if (!is_drawn[end / 2]) trace(end);
+  return curve;
+}
+
+}  // namespace s21
@@ -0,0 +1,71 @@
+/**
+ * @file s21_implicitsampler.h
+ * @brief Header file containing the declaration of the ImplicitSampler for
+ * curves f(x, y) = 0.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_IMPLICITSAMPLER_H
+#define SMARTCALC_MODEL_S21_IMPLICITSAMPLER_H
+
+#include <cstddef>
+
+#include "s21_curvesampler.h"
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class ImplicitSampler
+ *
+ * @brief Samples the curve f(x, y) = 0 in the visible rectangle of a plot.
+ *
+ * The rectangle is divided by a quadtree down to cells of about kCell
+ * pixels. Every level of the tree bounds f over all of its cells at once
+ * with the interval evaluation of the program, and only the cells whose
+ * range holds zero are divided further, so the work follows the curve
+ * rather than the area. The evaluations of a level, and those of the corners
+ * of the leaf cells afterwards, are spread over the thread pool.
+ *
+ * Each leaf cell is then drawn by marching squares: the curve crosses an
+ * edge whose corners have values of opposite signs, at the zero of the
+ * linear interpolation between them, and a cell crossed on all four edges
+ * is resolved by the mean of its corners. Cells with a corner where f is
+ * not a number are left out.
+ *
+ * Where f has no bound over a cell, a sign change may be a pole rather than
+ * a zero, as for 1/x = y. Such a cell is drawn only if the edges it is
+ * crossed on have bounded ranges of their own.
+ *
+ * The segments of the cells are joined at their shared edges into pieces,
+ * returned as a curve whose parameter numbers the points and whose breaks
+ * separate the pieces, as CurveSampler returns it.
+ */
+class ImplicitSampler {
+ public:
+  /// Largest side of a leaf cell, in pixels.
+  static constexpr double kCell = 2.0;
+  /// Deepest level of the quadtree.
+  static constexpr int kMaxDepth = 12;
+  /// Largest number of leaf cells; a curve filling the plot, as for f = 0,
+  /// stops the division at a coarser level.
+  static constexpr std::size_t kMaxLeaves = std::size_t{1} << 20;
+
+  ImplicitSampler() noexcept = default;
+  ~ImplicitSampler() = default;
+
+  /**
+   * @brief Samples the curve f(x, y) = 0 in @p viewport.
+   *
+   * @param[in] f The compiled f(x, y).
+   * @param[in] viewport The plot the curve is sampled for.
+   * @return The curve, empty if it does not cross the viewport.
+   * @throws std::invalid_argument if the program is empty or if the
+   * viewport is empty or not finite.
+   */
+  CurveSampler::Curve Sample(ProgramView f,
+                             const CurveSampler::Viewport& viewport) const;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_IMPLICITSAMPLER_H
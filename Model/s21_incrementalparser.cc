@@ -0,0 +1,304 @@
+/**
+ * @file s21_incrementalparser.cc
+ * @brief Implementation file for the s21_incrementalparser.h.
+ */
+
+#include "s21_incrementalparser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace s21 {
+
+namespace {
+
+/// The Model takes expressions shorter than this.
+constexpr std::size_t kMaxLength = 256;
+
+/// Operators and functions by name, with the priorities of the Model.
+const std::map<std::string, std::pair<OpCode, int>> kOperations{
+    {"cos", {OpCode::kCos, 6}},     {"sin", {OpCode::kSin, 6}},
+    {"tan", {OpCode::kTan, 6}},     {"acos", {OpCode::kAcos, 6}},
+    {"asin", {OpCode::kAsin, 6}},   {"atan", {OpCode::kAtan, 6}},
+    {"ln", {OpCode::kLn, 6}},       {"log", {OpCode::kLog, 6}},
+    {"if", {OpCode::kIf, 6}},       {"min", {OpCode::kMin, 6}},
+    {"max", {OpCode::kMax, 6}},     {"abs", {OpCode::kAbs, 6}},
+    {"~", {OpCode::kNegate, 5}},    {"sqrt", {OpCode::kSqrt, 4}},
+    {"^", {OpCode::kPow, 4}},       {"%", {OpCode::kMod, 3}},
+    {"*", {OpCode::kMul, 3}},       {"/", {OpCode::kDiv, 3}},
+    {"-", {OpCode::kSub, 2}},       {"+", {OpCode::kAdd, 2}},
+    {"<", {OpCode::kLess, 1}},      {"<=", {OpCode::kLessEqual, 1}},
+    {">", {OpCode::kGreater, 1}},   {">=", {OpCode::kGreaterEqual, 1}},
+    {"==", {OpCode::kEqual, 1}},    {"!=", {OpCode::kNotEqual, 1}}};
+
+bool IsOperator(char c) noexcept {
+  return c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%';
+}
+
+bool IsComparison(char c) noexcept {
+  return c == '<' || c == '>' || c == '=' || c == '!';
+}
+
+/// Returns the number of separators a call takes, 0 for other operations.
+int CountSeparators(OpCode op) noexcept {
+  if (op == OpCode::kIf) return 2;
+  return (op == OpCode::kMin || op == OpCode::kMax) ? 1 : 0;
+}
+
+}  // namespace
+
+IncrementalParser::IncrementalParser() : states_(1) {}
+
+void IncrementalParser::SetX(double x) {
+  if (x == x_) return;
+  x_ = x;
+  text_.clear();
+  states_.resize(1);
+}
+
+void IncrementalParser::Assign(const std::string& text) {
+  std::size_t common =
+      std::mismatch(text_.begin(),
+                    text_.begin() + std::min(text_.size(), text.size()),
+                    text.begin())
+          .first -
+      text_.begin();
+  Erase(text_.size() - common);
+  Append(text.substr(common));
+}
+
+void IncrementalParser::Append(const std::string& text) {
+  for (char c : text) {
+    text_ += c;
+    State state = states_.back();
+    Parse(state, c, text_.size() - 1);
+    states_.push_back(std::move(state));
+  }
+}
+
+void IncrementalParser::Erase(std::size_t count) noexcept {
+  text_.resize(text_.size() - std::min(count, text_.size()));
+  states_.resize(text_.size() + 1);
+}
+
+/**
+ * @details The end of the text is fed as a space, which ends the number,
+ * the name or the sign being read, as the end of the text does for the
+ * Model, and the open parentheses are then closed. The operators left are
+ * applied in turn; a parenthesis among them was closed once too often.
+ */
+std::optional<double> IncrementalParser::Preview() const {
+  const State& last = states_.back();
+  bool is_valid = !text_.empty() && text_.size() < kMaxLength &&
+                  std::strchr("*/^%", text_.front()) == nullptr &&
+                  last.has_operand && last.status == Status::kValid &&
+                  !last.is_exponent;
+  if (!is_valid) return std::nullopt;
+
+  State state = last;
+  Feed(state, ' ');
+  for (int depth = state.depth; depth > 0; --depth) Feed(state, ')');
+  if (state.depth < 0 || !state.calls.empty()) return std::nullopt;
+  for (; !state.operators.empty(); state.operators.pop_back()) {
+    if (state.operators.back().is_parenthesis) return std::nullopt;
+    Perform(state, state.operators.back());
+  }
+  if (state.status != Status::kValid || state.values.size() != 1)
+    return std::nullopt;
+  return state.values.front();
+}
+
+/**
+ * @details Scientific notation is read as the Model replaces it: an 'e'
+ * after a digit, beyond the second character, is fed as "*10^", and must be
+ * followed by a digit or a sign. Any other 'e' is a letter of a name.
+ */
+void IncrementalParser::Parse(State& state, char c,
+                              std::size_t position) const {
+  if (state.status != Status::kValid) return;
+  if (state.is_exponent) {
+    state.is_exponent = false;
+    if (!std::isdigit(c) && c != '+' && c != '-') {
+      state.status = Status::kInvalid;
+      return;
+    }
+  }
+  state.has_operand = state.has_operand || std::isdigit(c) || c == 'x' ||
+                      c == 'y';
+  if (c == 'e' && position > 0 && std::isdigit(text_[position - 1])) {
+    if (position < 2) {
+      state.status = Status::kInvalid;
+      return;
+    }
+    for (char replacement : {'*', '1', '0', '^'}) Feed(state, replacement);
+    state.is_exponent = true;
+    return;
+  }
+  Feed(state, c);
+}
+
+/**
+ * @details A sign is unary at the start, after an opening parenthesis, a
+ * separator, a comparison or an operator, and also, as for the Model,
+ * before an operator: a sign that is not unary by the characters before it
+ * waits for the next one. A comparison waits for a second '=' the same way.
+ */
+void IncrementalParser::Feed(State& state, char c) const {
+  if (state.status != Status::kValid) return;
+  if (state.pending != 0) {
+    char pending = state.pending;
+    state.pending = 0;
+    if (pending == '+' || pending == '-') {
+      if (!IsOperator(c))
+        PushOperator(state, std::string(1, pending));
+      else if (pending == '-')
+        PushOperator(state, "~");
+    } else if (c == '=') {
+      PushOperator(state, std::string{pending, '='});
+      state.previous = c;
+      return;
+    } else {
+      PushOperator(state, std::string(1, pending));
+    }
+  }
+
+  if (c == '.' && !state.number.empty()) ++state.dot_count;
+  if (std::isdigit(c) || c == '.')
+    state.number += c;
+  else if (!state.number.empty())
+    PushNumber(state);
+  if (std::isalpha(c))
+    state.identifier += c;
+  else if (!state.identifier.empty())
+    PushIdentifier(state);
+  if (state.status != Status::kValid) return;
+
+  if (IsOperator(c)) {
+    char previous = state.previous;
+    bool is_unary = previous == 0 || previous == '(' || previous == ',' ||
+                    IsComparison(previous) || IsOperator(previous);
+    if ((c == '+' || c == '-') && !is_unary)
+      state.pending = c;
+    else if (c == '-')
+      PushOperator(state, "~");
+    else if (c != '+')
+      PushOperator(state, std::string(1, c));
+  }
+  if (IsComparison(c)) state.pending = c;
+
+  if (c == '(') {
+    if (!state.operators.empty() && !state.operators.back().is_parenthesis &&
+        CountSeparators(state.operators.back().op))
+      state.calls.push_back(
+          {state.operators.back().op, state.operators.size() + 1, 0});
+    state.operators.push_back({OpCode::kConstant, 7, true});
+    ++state.depth;
+  }
+
+  if (c == ',') {
+    Unwind(state);
+    bool is_separator = !state.calls.empty() &&
+                        state.operators.size() == state.calls.back().level &&
+                        ++state.calls.back().arguments <=
+                            CountSeparators(state.calls.back().function);
+    if (!is_separator) state.status = Status::kInvalid;
+  }
+
+  if (c == ')') {
+    Unwind(state);
+    --state.depth;
+    if (!state.calls.empty() &&
+        state.operators.size() == state.calls.back().level) {
+      const Call& call = state.calls.back();
+      if (call.arguments != CountSeparators(call.function)) {
+        state.status = Status::kInvalid;
+        return;
+      }
+      state.operators.pop_back();  // Pop '('
+      Perform(state, state.operators.back());
+      state.operators.pop_back();  // Pop the function
+      state.calls.pop_back();
+    } else if (!state.operators.empty()) {
+      state.operators.pop_back();  // Pop '('
+    }
+  }
+  state.previous = c;
+}
+
+void IncrementalParser::PushNumber(State& state) const {
+  if (state.dot_count > 1) state.status = Status::kInvalid;
+  state.dot_count = 0;
+  try {
+    state.values.push_back(std::stod(state.number));
+  } catch (...) {
+    state.status = Status::kInvalid;
+  }
+  state.number.clear();
+}
+
+/**
+ * @details Sums and products, and names the Model may know as user
+ * definitions, are left to it.
+ */
+void IncrementalParser::PushIdentifier(State& state) const {
+  std::string name = std::move(state.identifier);
+  state.identifier.clear();
+  if (name == "x") {
+    state.values.push_back(x_);
+    return;
+  }
+  auto found = kOperations.find(name);
+  if (name == "y") {
+    state.status = Status::kInvalid;  // Only for plotting
+  } else if (found == kOperations.end()) {
+    state.status = Status::kUnsupported;
+  } else {
+    state.operators.push_back({found->second.first, found->second.second,
+                               false});
+  }
+}
+
+void IncrementalParser::PushOperator(State& state,
+                                     const std::string& operation) const {
+  auto found = kOperations.find(operation);
+  if (found == kOperations.end()) {
+    state.status = Status::kInvalid;
+    return;
+  }
+  int priority = found->second.second;
+  while (!state.operators.empty() && !state.operators.back().is_parenthesis &&
+         state.operators.back().priority >= priority) {
+    Perform(state, state.operators.back());
+    state.operators.pop_back();
+  }
+  state.operators.push_back({found->second.first, priority, false});
+}
+
+/**
+ * @details The operation runs on the kernels of the Program, so the values
+ * are those the Model computes. A missing operand makes the text invalid,
+ * as it is for the Model.
+ */
+void IncrementalParser::Perform(State& state, const Token& token) const {
+  std::size_t arity = static_cast<std::size_t>(Arity(token.op));
+  if (state.values.size() < arity) {
+    state.status = Status::kInvalid;
+    return;
+  }
+  double* a = state.values.data() + state.values.size() - arity;
+  s21::Apply(token.op, a, arity > 1 ? a + 1 : nullptr,
+             arity > 2 ? a + 2 : nullptr, 1);
+  state.values.resize(state.values.size() - arity + 1);
+}
+
+void IncrementalParser::Unwind(State& state) const {
+  while (!state.operators.empty() && !state.operators.back().is_parenthesis) {
+    Perform(state, state.operators.back());
+    state.operators.pop_back();
+  }
+}
+
+}  // namespace s21
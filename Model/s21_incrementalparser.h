@@ -0,0 +1,171 @@
+/**
+ * @file s21_incrementalparser.h
+ * @brief Header file containing the declaration of the IncrementalParser,
+ * which previews the value of an expression while it is being typed.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_INCREMENTALPARSER_H
+#define SMARTCALC_MODEL_S21_INCREMENTALPARSER_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class IncrementalParser
+ *
+ * @brief Parses an expression one character at a time, keeping the state
+ * reached after each character, and previews its value.
+ *
+ * The parser follows the shunting yard of the Model character by character,
+ * with the same priorities and the same rules for unary signs, scientific
+ * notation and calls of if, min and max. Instead of writing the postfix
+ * form, each operation leaving the operators stack is applied at once to a
+ * stack of values, so the state after a character holds the operators still
+ * waiting, the values computed so far, the number or name being read and
+ * the open calls. Typing a character extends the last state, and deleting
+ * one returns to the state before it, so the work per key press does not
+ * grow with the length of the expression.
+ *
+ * The preview is the value the expression would have with every open
+ * parenthesis closed, found from a copy of the last state. There is none
+ * while the expression ends in an operator or a name, nor once it is
+ * invalid. Sums, products and names other than the built-in functions and
+ * x, such as user definitions, are left to the Model: there is no preview
+ * for an expression holding them.
+ */
+class IncrementalParser {
+ public:
+  IncrementalParser();
+  ~IncrementalParser() = default;
+
+  /**
+   * @brief Sets the value of 'x'; the text parsed with another value is
+   * dropped.
+   */
+  void SetX(double x);
+
+  /**
+   * @brief Makes @p text the parsed text, keeping the states of the prefix
+   * it shares with the current one and parsing the rest.
+   */
+  void Assign(const std::string& text);
+
+  /**
+   * @brief Parses @p text as typed after the current text.
+   */
+  void Append(const std::string& text);
+
+  /**
+   * @brief Deletes the last @p count characters, or every one if there are
+   * fewer, returning to the state before them.
+   */
+  void Erase(std::size_t count) noexcept;
+
+  /**
+   * @brief Returns the parsed text.
+   */
+  const std::string& Text() const noexcept { return text_; }
+
+  /**
+   * @brief Returns the value of the text with every open parenthesis closed.
+   *
+   * @return The value, or std::nullopt if the text is incomplete, invalid or
+   * left to the Model.
+   */
+  std::optional<double> Preview() const;
+
+ private:
+  /// Whether the text parsed so far can still be previewed.
+  enum class Status { kValid, kInvalid, kUnsupported };
+
+  /**
+   * @struct Token
+   * @brief An operation or an opening parenthesis on the operators stack.
+   */
+  struct Token {
+    OpCode op;
+    int priority;
+    bool is_parenthesis;
+  };
+
+  /**
+   * @struct Call
+   * @brief State of a call of if, min or max being parsed.
+   */
+  struct Call {
+    OpCode function;
+    std::size_t level;  ///< Size of the operators stack inside the call.
+    int arguments;      ///< Number of separators seen so far.
+  };
+
+  /**
+   * @struct State
+   * @brief Everything the parser knows after a character.
+   */
+  struct State {
+    std::vector<double> values;   ///< Results of the operations applied.
+    std::vector<Token> operators;
+    std::vector<Call> calls;
+    std::string number;      ///< The number being read.
+    std::string identifier;  ///< The name being read.
+    int dot_count = 0;       ///< Dots counted in the number, as the Model.
+    int depth = 0;           ///< Open parentheses less closed ones.
+    char pending = 0;   ///< A sign or comparison waiting for the next one.
+    char previous = 0;  ///< The last character fed.
+    bool is_exponent = false;  ///< After the 'e' of scientific notation.
+    bool has_operand = false;  ///< A digit or a variable was seen.
+    Status status = Status::kValid;
+  };
+
+  /**
+   * @brief Parses the character @p c at @p position of the text.
+   */
+  void Parse(State& state, char c, std::size_t position) const;
+
+  /**
+   * @brief Feeds one character of the text, after scientific notation is
+   * replaced, to the shunting yard.
+   */
+  void Feed(State& state, char c) const;
+
+  /**
+   * @brief Pushes the number being read to the values.
+   */
+  void PushNumber(State& state) const;
+
+  /**
+   * @brief Handles the name being read: 'x', or a function pushed to the
+   * operators stack.
+   */
+  void PushIdentifier(State& state) const;
+
+  /**
+   * @brief Pushes a binary or unary operator, applying the operators of
+   * higher or equal priority first.
+   */
+  void PushOperator(State& state, const std::string& operation) const;
+
+  /**
+   * @brief Applies the operation of @p token to the values.
+   */
+  void Perform(State& state, const Token& token) const;
+
+  /**
+   * @brief Applies the operators up to the innermost opening parenthesis.
+   */
+  void Unwind(State& state) const;
+
+  std::string text_;
+  std::vector<State> states_;  ///< The state after each prefix of text_.
+  double x_ = 0.0;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_INCREMENTALPARSER_H
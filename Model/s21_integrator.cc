@@ -0,0 +1,185 @@
+/**
+ * @file s21_integrator.cc
+ * @brief Implementation file for the s21_integrator.h.
+ */
+
+#include "s21_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+/// Kronrod nodes on [-1, 1]; odd indices are the Gauss nodes, the last one
+/// is the center.
+constexpr double kNodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0};
+
+/// Kronrod weights for kNodes.
+constexpr double kKronrodWeights[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+
+/// Gauss weights for kNodes[1], kNodes[3], kNodes[5] and the center.
+constexpr double kGaussWeights[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+constexpr std::size_t kPanelNodes = 15;
+constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+
+/// Panels estimated by one thread pool task.
+constexpr std::size_t kPanelGrain = 64;
+/// Upper bound on the number of panels, guards against runaway subdivision.
+constexpr std::size_t kMaxPanels = 1 << 20;
+
+}  // namespace
+
+Integrator::Result Integrator::Integrate(ProgramView program, double a,
+                                         double b, double tolerance) const {
+  if (!std::isfinite(a) || !std::isfinite(b) || program.Empty())
+    throw std::invalid_argument("Invalid input");
+  if (a == b) return {0.0, 0.0};
+  if (a > b) {
+    Result result = Integrate(program, b, a, tolerance);
+    return {-result.value, result.error};
+  }
+
+  std::vector<Panel> panels{{a, b}};
+  Estimate(program, panels);
+  for (;;) {
+    double error = 0.0, magnitude = 0.0;
+    std::vector<std::size_t> finite, singular;
+    for (std::size_t i = 0; i < panels.size(); ++i) {
+      const Panel& panel = panels[i];
+      double mid = 0.5 * (panel.a + panel.b);
+      bool is_splittable = mid > panel.a && mid < panel.b &&
+                           panel.b - panel.a >
+                               8 * kEpsilon * std::max(std::abs(panel.a),
+                                                       std::abs(panel.b));
+      if (std::isfinite(panel.value) && std::isfinite(panel.error)) {
+        error += panel.error;
+        magnitude += panel.magnitude;
+        if (is_splittable) finite.push_back(i);
+      } else if (is_splittable && !panel.bisected_singular) {
+        singular.push_back(i);
+      }
+    }
+
+    // The panels with the largest errors are bisected until their share
+    // covers the excess over the tolerance, one panel per round for an
+    // endpoint singularity and many at once for an oscillating integrand.
+    double excess = error - tolerance * magnitude;
+    std::sort(finite.begin(), finite.end(), [&panels](std::size_t l,
+                                                      std::size_t r) {
+      return panels[l].error > panels[r].error ||
+             (panels[l].error == panels[r].error && panels[l].a < panels[r].a);
+    });
+    std::vector<std::size_t> selected = singular;
+    for (std::size_t i = 0; i < finite.size() && excess > 0; ++i) {
+      selected.push_back(finite[i]);
+      excess -= panels[finite[i]].error;
+    }
+    if (selected.empty() || panels.size() + selected.size() > kMaxPanels)
+      break;
+
+    std::vector<Panel> children;
+    for (std::size_t i : selected) {
+      Panel& panel = panels[i];
+      bool is_singular = !std::isfinite(panel.value);
+      double mid = 0.5 * (panel.a + panel.b);
+      children.push_back({panel.a, mid});
+      children.push_back({mid, panel.b});
+      children[children.size() - 2].bisected_singular = is_singular;
+      children.back().bisected_singular = is_singular;
+      panel.b = panel.a;  // Marks the parent for removal
+    }
+    Estimate(program, children);
+    panels.erase(std::remove_if(panels.begin(), panels.end(),
+                                [](const Panel& p) { return p.a == p.b; }),
+                 panels.end());
+    panels.insert(panels.end(), children.begin(), children.end());
+  }
+
+  // Panels are summed in interval order, so the result does not depend on
+  // the number of threads.
+  std::sort(panels.begin(), panels.end(),
+            [](const Panel& l, const Panel& r) { return l.a < r.a; });
+  Result result{0.0, 0.0};
+  for (const Panel& panel : panels) {
+    result.value += panel.value;
+    result.error += panel.error;
+  }
+  return result;
+}
+
+/**
+ * @details Follows the error estimate of QUADPACK's QK15: the raw difference
+ * between the Kronrod and Gauss rules is scaled by the variation of f over
+ * the panel, and bounded below by the rounding error of the sum.
+ */
+void Integrator::Estimate(ProgramView program, std::vector<Panel>& panels) {
+  ThreadPool::Shared().ParallelFor(
+      panels.size(),
+      [&](std::size_t begin, std::size_t end) {
+        std::size_t count = end - begin;
+        std::vector<double> x(count * kPanelNodes), f(count * kPanelNodes);
+        for (std::size_t p = 0; p < count; ++p) {
+          const Panel& panel = panels[begin + p];
+          double center = 0.5 * (panel.a + panel.b);
+          double half = 0.5 * (panel.b - panel.a);
+          double* nodes = x.data() + p * kPanelNodes;
+          for (int j = 0; j < 7; ++j) {
+            nodes[2 * j] = center - half * kNodes[j];
+            nodes[2 * j + 1] = center + half * kNodes[j];
+          }
+          nodes[14] = center;
+        }
+        program.Evaluate(x.data(), f.data(), x.size());
+
+        for (std::size_t p = 0; p < count; ++p) {
+          Panel& panel = panels[begin + p];
+          const double* fp = f.data() + p * kPanelNodes;
+          double half = 0.5 * (panel.b - panel.a);
+          double kronrod = fp[14] * kKronrodWeights[7];
+          double gauss = fp[14] * kGaussWeights[3];
+          double absolute = std::abs(kronrod);
+          for (int j = 0; j < 7; ++j) {
+            double sum = fp[2 * j] + fp[2 * j + 1];
+            kronrod += kKronrodWeights[j] * sum;
+            absolute += kKronrodWeights[j] *
+                        (std::abs(fp[2 * j]) + std::abs(fp[2 * j + 1]));
+            if (j % 2 == 1) gauss += kGaussWeights[j / 2] * sum;
+          }
+          double mean = 0.5 * kronrod;
+          double variation = kKronrodWeights[7] * std::abs(fp[14] - mean);
+          for (int j = 0; j < 7; ++j)
+            variation += kKronrodWeights[j] * (std::abs(fp[2 * j] - mean) +
+                                               std::abs(fp[2 * j + 1] - mean));
+
+          double error = std::abs((kronrod - gauss) * half);
+          variation *= half;
+          if (variation != 0 && error != 0)
+            error = variation * std::min(1.0, std::pow(200 * error / variation,
+                                                       1.5));
+          panel.value = kronrod * half;
+          panel.magnitude = absolute * half;
+          panel.error = std::max(50 * kEpsilon * panel.magnitude, error);
+        }
+      },
+      kPanelGrain);
+}
+
+}  // namespace s21
@@ -0,0 +1,82 @@
+/**
+ * @file s21_integrator.h
+ * @brief Header file containing the declaration of the Integrator abstraction
+ * for definite integrals of a compiled expression.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_INTEGRATOR_H
+#define SMARTCALC_MODEL_S21_INTEGRATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class Integrator
+ *
+ * @brief Adaptive 15-point Gauss-Kronrod quadrature of f(x) over [a, b].
+ *
+ * The integration proceeds in rounds. Every round bisects the panels with
+ * the largest errors, just enough of them to cover the excess over the
+ * tolerance, and estimates the new panels in parallel, evaluating the Kronrod
+ * nodes of a whole group of panels in one batch call. Panels with a
+ * non-finite estimate, e.g. with a pole at a node, are bisected once more;
+ * if they stay non-finite the integral is reported as divergent instead of
+ * subdividing endlessly. Integrable endpoint singularities converge, as the
+ * Kronrod nodes never touch the panel bounds.
+ */
+class Integrator {
+ public:
+  /**
+   * @struct Result
+   * @brief The integral and its estimated absolute error.
+   */
+  struct Result {
+    double value;  ///< Approximation of the integral.
+    double error;  ///< Estimated absolute error of the value.
+  };
+
+  /// Default relative tolerance, measured against the integral of |f|.
+  static constexpr double kDefaultTolerance = 1e-10;
+
+  Integrator() noexcept = default;
+  ~Integrator() = default;
+
+  /**
+   * @brief Integrates @p program over [a, b].
+   *
+   * @param[in] program The compiled expression.
+   * @param[in] a The lower limit.
+   * @param[in] b The upper limit, may be less than @p a.
+   * @param[in] tolerance The requested relative accuracy.
+   * @return The integral and its error estimate.
+   * @throws std::invalid_argument if a limit is not finite.
+   */
+  Result Integrate(ProgramView program, double a, double b,
+                   double tolerance = kDefaultTolerance) const;
+
+ private:
+  /**
+   * @struct Panel
+   * @brief A subinterval together with its Gauss-Kronrod estimate.
+   */
+  struct Panel {
+    double a, b;
+    double value = 0.0;     ///< Kronrod estimate of the integral.
+    double error = 0.0;     ///< Error estimate of the value.
+    double magnitude = 0.0; ///< Kronrod estimate of the integral of |f|.
+    bool bisected_singular = false;  ///< Child of a non-finite panel.
+  };
+
+  /**
+   * @brief Computes the estimates of @p panels in parallel.
+   */
+  static void Estimate(ProgramView program, std::vector<Panel>& panels);
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_INTEGRATOR_H
@@ -0,0 +1,347 @@
+/**
+ * @file s21_interval.cc
+ * @brief Implementation file for the s21_interval.h.
+ */
+
+#include "s21_interval.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace s21 {
+
+namespace {
+
+constexpr double kPi = M_PI;
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kMax = std::numeric_limits<double>::max();
+/// Below this magnitude the rounding error of a product or a quotient may
+/// be lost under the subnormals, where it cannot be recovered exactly.
+constexpr double kTiny = 0x1p-969;
+/// Relative error allowed for the library functions, at least four units in
+/// the last place: twice the largest error glibc documents for those used
+/// here.
+constexpr double kLibraryError = 0x1p-50;
+/// Absolute error allowed for them among the subnormals.
+constexpr double kSubnormals = 0x1p-1070;
+/// Relative error allowed for the multiples of π, which are only known to
+/// the rounding of their doubles.
+constexpr double kSlack = 1e-15;
+
+double Down(double v) noexcept { return std::nextafter(v, -kInf); }
+
+double Up(double v) noexcept { return std::nextafter(v, kInf); }
+
+/// Returns a lower bound of a result of the library with @p v as its value:
+/// |v| 2^-50 is at least four units in the last place of v, and the
+/// subtraction rounds it by half a unit at most.
+double Below(double v) noexcept {
+  if (std::isinf(v)) return v > 0 ? kMax : v;
+  return v - (std::abs(v) * kLibraryError + kSubnormals);
+}
+
+/// Returns an upper bound of a result of the library with @p v as its value.
+double Above(double v) noexcept { return -Below(-v); }
+
+/// Returns @p v rounded from finite operands, kept finite if it overflowed
+/// upward, as a lower bound must be.
+double Finite(double v, double a, double b) noexcept {
+  return (v == kInf && std::isfinite(a) && std::isfinite(b)) ? kMax : v;
+}
+
+/// Returns a lower bound of a + b: the sum rounded to nearest, moved down
+/// if its error, found exactly by the two-sum algorithm, is negative.
+double SumDown(double a, double b) noexcept {
+  double s = a + b;
+  if (!std::isfinite(s)) return Finite(s, a, b);
+  double t = s - a;
+  return (a - (s - t)) + (b - t) < 0 ? Down(s) : s;
+}
+
+double SumUp(double a, double b) noexcept { return -SumDown(-a, -b); }
+
+/// Returns a lower bound of a * b, zero when either is zero, as the product
+/// of a zero bound with an unbounded one is. The error of the rounded
+/// product is found exactly by a fused multiply-add.
+double ProductDown(double a, double b) noexcept {
+  if (a == 0 || b == 0) return 0.0;
+  double p = a * b;
+  if (!std::isfinite(p)) return Finite(p, a, b);
+  if (std::abs(p) < kTiny) return Down(p);
+  return std::fma(a, b, -p) < 0 ? Down(p) : p;
+}
+
+double ProductUp(double a, double b) noexcept { return -ProductDown(-a, b); }
+
+/// Returns a lower bound of a / b for b other than zero. The remainder
+/// a - q b of the rounded quotient q is exact, and has the sign of the
+/// error times that of b.
+double QuotientDown(double a, double b) noexcept {
+  double q = a / b;
+  if (!std::isfinite(q)) return Finite(q, a, b);
+  if (!std::isfinite(b) || a == 0) return q;
+  if (std::abs(q) < kTiny) return Down(q);
+  double r = std::fma(-q, b, a);
+  return (r < 0 && b > 0) || (r > 0 && b < 0) ? Down(q) : q;
+}
+
+double QuotientUp(double a, double b) noexcept {
+  return -QuotientDown(-a, b);
+}
+
+/// Returns a lower bound of the square root of @p v, known to be correctly
+/// rounded; the error is found from the exact residual v - s s.
+double SqrtDown(double v) noexcept {
+  double s = std::sqrt(v);
+  if (s == 0 || !std::isfinite(s)) return s;
+  if (v < kTiny) return Down(s);
+  return std::fma(-s, s, v) < 0 ? Down(s) : s;
+}
+
+double SqrtUp(double v) noexcept {
+  double s = std::sqrt(v);
+  if (s == 0 || !std::isfinite(s)) return s;
+  if (v < kTiny) return Up(s);
+  return std::fma(-s, s, v) > 0 ? Up(s) : s;
+}
+
+/// Returns the interval spanned by the lower bounds @p down and the upper
+/// bounds @p up of an operation at the corners of @p a and @p b. NaN bounds,
+/// as inf / inf, are left out.
+template <typename Down, typename Up>
+Interval Corners(Interval a, Interval b, Down down, Up up) noexcept {
+  return Interval(std::fmin(std::fmin(down(a.low, b.low), down(a.low, b.high)),
+                            std::fmin(down(a.high, b.low),
+                                      down(a.high, b.high))),
+                  std::fmax(std::fmax(up(a.low, b.low), up(a.low, b.high)),
+                            std::fmax(up(a.high, b.low), up(a.high, b.high))));
+}
+
+/// Returns the interval between two results of the library, in any order.
+Interval Between(double u, double v) noexcept {
+  return Interval(Below(std::min(u, v)), Above(std::max(u, v)));
+}
+
+/// Returns the largest magnitude in @p a.
+double Magnitude(Interval a) noexcept {
+  return std::max(std::abs(a.low), std::abs(a.high));
+}
+
+/// Returns true if @p a may hold phase + k period for some integer k. The
+/// point is computed with the rounded phase and period, so points within
+/// the relative error kSlack of an end are taken to be in @p a.
+bool HasPoint(Interval a, double phase, double period) noexcept {
+  double slack = kSlack * std::max(1.0, Magnitude(a));
+  double k = std::ceil((a.low - slack - phase) / period);
+  return phase + k * period <= a.high + slack;
+}
+
+/// Returns true if @p a holds an integer.
+bool HasInteger(Interval a) noexcept { return std::ceil(a.low) <= a.high; }
+
+/// Returns the range over @p a of sin or cos, given as @p wave, with its
+/// maxima at @p peak + 2kπ and its minima half a period away. The library
+/// reduces large arguments exactly, so the ends are accurate for any a.
+template <typename Wave>
+Interval Periodic(Interval a, Wave wave, double peak) noexcept {
+  if (a.Empty()) return a;
+  if (!(a.high - a.low < 2 * kPi)) return Interval(-1.0, 1.0);
+  Interval r = Between(wave(a.low), wave(a.high));
+  r.low = HasPoint(a, peak + kPi, 2 * kPi) ? -1.0 : std::max(r.low, -1.0);
+  r.high = HasPoint(a, peak, 2 * kPi) ? 1.0 : std::min(r.high, 1.0);
+  return r;
+}
+
+}  // namespace
+
+Interval operator+(Interval a, Interval b) noexcept {
+  return Interval(SumDown(a.low, b.low), SumUp(a.high, b.high));
+}
+
+Interval operator-(Interval a, Interval b) noexcept {
+  return Interval(SumDown(a.low, -b.high), SumUp(a.high, -b.low));
+}
+
+Interval operator*(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty()) return Interval();
+  return Corners(a, b, ProductDown, ProductUp);
+}
+
+/**
+ * @details A divisor that may be zero gives every number: x / 0 is infinite
+ * and the quotient is unbounded around it.
+ */
+Interval operator/(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty()) return Interval();
+  if (b.Contains(0.0)) return Interval::Entire();
+  return Corners(a, b, QuotientDown, QuotientUp);
+}
+
+Interval operator-(Interval a) noexcept { return Interval(-a.high, -a.low); }
+
+Interval Hull(Interval a, Interval b) noexcept {
+  if (a.Empty()) return b;
+  if (b.Empty()) return a;
+  return Interval(std::min(a.low, b.low), std::max(a.high, b.high));
+}
+
+/**
+ * @details An integer exponent is taken by its parity, so x^2 stays
+ * non-negative; a square is a product, rounded as tightly as one. Other
+ * exponents are defined for a non-negative base, where the power is
+ * monotonic in each operand and so bounded by the corners; a negative base
+ * with an exponent range holding integers may give any value.
+ */
+Interval Pow(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty()) return Interval();
+  if (b.low == b.high && b.low == std::round(b.low)) {
+    double n = b.low;
+    if (n == 0) return Interval(1.0);
+    bool is_even = std::fmod(n, 2.0) == 0;
+    if (is_even) {
+      Interval m = Abs(a);
+      if (n == 2) return m * m;  // Exact where the square is
+      Interval r = Between(std::pow(m.low, n), std::pow(m.high, n));
+      return Interval(std::max(r.low, 0.0), r.high);
+    }
+    if (n < 0 && a.Contains(0.0)) return Interval::Entire();
+    return Between(std::pow(a.low, n), std::pow(a.high, n));
+  }
+  if (a.low < 0 && HasInteger(b)) return Interval::Entire();
+  if (a.high < 0) return Interval();
+  double base = std::max(a.low, 0.0);
+  auto down = [](double u, double v) { return Below(std::pow(u, v)); };
+  auto up = [](double u, double v) { return Above(std::pow(u, v)); };
+  Interval r = Corners(Interval(base, a.high), b, down, up);
+  return Interval(std::max(r.low, 0.0), r.high);
+}
+
+/**
+ * @details The remainder has the sign of x and is smaller than both |x| and
+ * |y|. It is exact when y is a single number and x stays within one period
+ * of it: fmod is exact, and the remainder grows with x there, while it falls
+ * back by |y| at each multiple crossed. The ends of x are then told apart
+ * by the growth of the remainder, where |y| is well above their rounding.
+ */
+Interval Mod(Interval a, Interval b) noexcept {
+  bool is_zero = b.low == 0 && b.high == 0;  // x mod 0 is not a number
+  if (a.Empty() || b.Empty() || is_zero) return Interval();
+  double c = std::abs(b.low);
+  double m = std::min(Magnitude(a), Magnitude(b));
+  if (b.low == b.high && std::isfinite(c) && std::isfinite(a.low) &&
+      std::isfinite(a.high) &&
+      c > 8 * std::numeric_limits<double>::epsilon() * Magnitude(a)) {
+    double u = std::fmod(a.low, c), v = std::fmod(a.high, c);
+    if (std::abs((v - u) - (a.high - a.low)) < c / 2) return Interval(u, v);
+  }
+  return Interval(a.low < 0 ? -m : 0.0, a.high > 0 ? m : 0.0);
+}
+
+Interval Cos(Interval a) noexcept {
+  return Periodic(a, [](double v) { return std::cos(v); }, 0.0);
+}
+
+Interval Sin(Interval a) noexcept {
+  return Periodic(a, [](double v) { return std::sin(v); }, kPi / 2);
+}
+
+Interval Tan(Interval a) noexcept {
+  if (a.Empty()) return a;
+  if (!(a.high - a.low < kPi) || HasPoint(a, kPi / 2, kPi))
+    return Interval::Entire();
+  return Interval(Below(std::tan(a.low)), Above(std::tan(a.high)));
+}
+
+// The inverse functions are cut to their domains, where they are monotonic.
+
+Interval Acos(Interval a) noexcept {
+  double low = std::max(a.low, -1.0), high = std::min(a.high, 1.0);
+  if (!(low <= high)) return Interval();
+  return Interval(std::max(Below(std::acos(high)), 0.0),
+                  Above(std::acos(low)));
+}
+
+Interval Asin(Interval a) noexcept {
+  double low = std::max(a.low, -1.0), high = std::min(a.high, 1.0);
+  if (!(low <= high)) return Interval();
+  return Interval(Below(std::asin(low)), Above(std::asin(high)));
+}
+
+Interval Atan(Interval a) noexcept {
+  return Interval(Below(std::atan(a.low)), Above(std::atan(a.high)));
+}
+
+Interval Sqrt(Interval a) noexcept {
+  if (!(a.high >= 0)) return Interval();
+  return Interval(SqrtDown(std::max(a.low, 0.0)), SqrtUp(a.high));
+}
+
+Interval Ln(Interval a) noexcept {
+  if (!(a.high >= 0)) return Interval();
+  return Interval(Below(std::log(std::max(a.low, 0.0))),
+                  Above(std::log(a.high)));
+}
+
+Interval Log(Interval a) noexcept {
+  if (!(a.high >= 0)) return Interval();
+  return Interval(Below(std::log10(std::max(a.low, 0.0))),
+                  Above(std::log10(a.high)));
+}
+
+Interval Abs(Interval a) noexcept {
+  if (a.Empty() || a.low >= 0) return a;
+  if (a.high <= 0) return -a;
+  return Interval(0.0, std::max(-a.low, a.high));
+}
+
+// Min and Max keep the first operand when the second is not a number, as
+// they do for doubles.
+
+Interval Min(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty()) return a;
+  return Interval(std::min(a.low, b.low), std::min(a.high, b.high));
+}
+
+Interval Max(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty()) return a;
+  return Interval(std::max(a.low, b.low), std::max(a.high, b.high));
+}
+
+// A comparison with NaN is false, so the empty interval compares as 0.
+
+Interval Less(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty() || a.low >= b.high) return Interval(0.0);
+  return a.high < b.low ? Interval(1.0) : Interval(0.0, 1.0);
+}
+
+Interval LessEqual(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty() || a.low > b.high) return Interval(0.0);
+  return a.high <= b.low ? Interval(1.0) : Interval(0.0, 1.0);
+}
+
+Interval Greater(Interval a, Interval b) noexcept { return Less(b, a); }
+
+Interval GreaterEqual(Interval a, Interval b) noexcept {
+  return LessEqual(b, a);
+}
+
+Interval Equal(Interval a, Interval b) noexcept {
+  if (a.Empty() || b.Empty() || a.high < b.low || b.high < a.low)
+    return Interval(0.0);
+  bool is_single = a.low == a.high && b.low == b.high;
+  return is_single ? Interval(1.0) : Interval(0.0, 1.0);
+}
+
+Interval NotEqual(Interval a, Interval b) noexcept {
+  return Interval(1.0) - Equal(a, b);
+}
+
+Interval If(Interval condition, Interval a, Interval b) noexcept {
+  if (condition.Empty()) return condition;
+  if (!condition.Contains(0.0)) return a;
+  if (condition.low == 0 && condition.high == 0) return b;
+  return Hull(a, b);
+}
+
+}  // namespace s21
@@ -0,0 +1,122 @@
+/**
+ * @file s21_interval.h
+ * @brief Header file containing the declaration of the Interval, a range of
+ * values an expression is evaluated over.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_INTERVAL_H
+#define SMARTCALC_MODEL_S21_INTERVAL_H
+
+#include <limits>
+
+namespace s21 {
+
+/**
+ * @struct Interval
+ *
+ * @brief The closed range [low, high] of the values an expression takes
+ * while its variables run over ranges of their own.
+ *
+ * Every operation on intervals returns a range holding the result of the
+ * operation for every choice of the operands in theirs, so a program run
+ * over intervals bounds the values of the expression over a whole region at
+ * once. A result that is not a number for every choice is the empty
+ * interval, with NaN bounds; one that is not a number for some choices
+ * covers the others, as the domain of sqrt is cut at zero. Infinite bounds
+ * stand for results without a bound, as near a pole.
+ *
+ * The bounds are rounded outward, so the range holds the exact result and
+ * not only the rounded one. Sums, products, quotients and square roots are
+ * rounded to nearest and moved one step outward where their error, found
+ * exactly, points out of the range; the results of the other functions of
+ * the library are widened by a few units in the last place. The periods of
+ * sin, cos and tan are only known to the rounding of π, so an extremum or a
+ * pole near an end of the range is taken to lie within it.
+ */
+struct Interval {
+  double low;
+  double high;
+
+  /**
+   * @brief Makes the empty interval.
+   */
+  Interval() noexcept
+      : low(std::numeric_limits<double>::quiet_NaN()),
+        high(std::numeric_limits<double>::quiet_NaN()) {}
+
+  /**
+   * @brief Makes the interval holding @p value alone.
+   */
+  explicit Interval(double value) noexcept : low(value), high(value) {}
+
+  /**
+   * @brief Makes the interval [@p l, @p h]; empty unless l <= h.
+   */
+  Interval(double l, double h) noexcept : low(l), high(h) {}
+
+  /**
+   * @brief Returns the interval of all numbers.
+   */
+  static Interval Entire() noexcept {
+    return Interval(-std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity());
+  }
+
+  /**
+   * @brief Returns true if the interval holds no number.
+   */
+  bool Empty() const noexcept { return !(low <= high); }
+
+  /**
+   * @brief Returns true if @p value lies in the interval.
+   */
+  bool Contains(double value) const noexcept {
+    return low <= value && value <= high;
+  }
+};
+
+Interval operator+(Interval a, Interval b) noexcept;
+Interval operator-(Interval a, Interval b) noexcept;
+Interval operator*(Interval a, Interval b) noexcept;
+Interval operator/(Interval a, Interval b) noexcept;
+Interval operator-(Interval a) noexcept;
+
+/**
+ * @brief Returns the smallest interval holding both @p a and @p b.
+ */
+Interval Hull(Interval a, Interval b) noexcept;
+
+Interval Pow(Interval a, Interval b) noexcept;
+Interval Mod(Interval a, Interval b) noexcept;
+Interval Cos(Interval a) noexcept;
+Interval Sin(Interval a) noexcept;
+Interval Tan(Interval a) noexcept;
+Interval Acos(Interval a) noexcept;
+Interval Asin(Interval a) noexcept;
+Interval Atan(Interval a) noexcept;
+Interval Sqrt(Interval a) noexcept;
+Interval Ln(Interval a) noexcept;
+Interval Log(Interval a) noexcept;
+Interval Abs(Interval a) noexcept;
+Interval Min(Interval a, Interval b) noexcept;
+Interval Max(Interval a, Interval b) noexcept;
+
+// Comparisons give [1, 1] where they hold for every choice of the operands,
+// [0, 0] where they hold for none and [0, 1] otherwise.
+
+Interval Less(Interval a, Interval b) noexcept;
+Interval LessEqual(Interval a, Interval b) noexcept;
+Interval Greater(Interval a, Interval b) noexcept;
+Interval GreaterEqual(Interval a, Interval b) noexcept;
+Interval Equal(Interval a, Interval b) noexcept;
+Interval NotEqual(Interval a, Interval b) noexcept;
+
+/**
+ * @brief Returns @p a where @p condition is not zero and @p b where it is,
+ * the hull of both where the condition may be either.
+ */
+Interval If(Interval condition, Interval a, Interval b) noexcept;
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_INTERVAL_H
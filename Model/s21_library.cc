@@ -0,0 +1,293 @@
+/**
+ * @file s21_library.cc
+ * @brief Implementation file for the s21_library.h.
+ */
+
+#include "s21_library.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "s21_model.h"
+
+namespace s21 {
+
+namespace {
+
+/// Names the parser already gives a meaning to.
+const std::set<std::string> kReserved{
+    "x",    "y",  "e",   "cos", "sin",  "tan", "acos", "asin", "atan",
+    "sqrt", "ln", "log", "sum", "prod", "if",  "min",  "max",  "abs"};
+
+/// Returns the position of the '=' separating name and body, or npos.
+std::size_t FindAssignment(const std::string& input) noexcept {
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    if (input[i] != '=') continue;
+    bool is_comparison =
+        (i + 1 < input.size() && input[i + 1] == '=') ||
+        (i > 0 && std::string("<>=!").find(input[i - 1]) != std::string::npos);
+    if (!is_comparison) return i;
+  }
+  return std::string::npos;
+}
+
+bool IsName(const std::string& name) noexcept {
+  return !name.empty() &&
+         std::all_of(name.begin(), name.end(),
+                     [](unsigned char c) { return std::isalpha(c); }) &&
+         !kReserved.count(name);
+}
+
+/// Returns @p text without its leading and trailing blanks.
+std::string Trim(const std::string& text) {
+  std::size_t begin = text.find_first_not_of(' ');
+  if (begin == std::string::npos) return std::string();
+  return text.substr(begin, text.find_last_not_of(' ') + 1 - begin);
+}
+
+/// Splits the arguments of a call, from the '(' at @p open or after blanks,
+/// at the commas outside parentheses. Returns the position after the ')',
+/// or npos if there is no '(' or it is not closed.
+std::size_t SplitArguments(const std::string& text, std::size_t open,
+                           std::vector<std::string>& list) {
+  while (open < text.size() && text[open] == ' ') ++open;
+  if (open == text.size() || text[open] != '(') return std::string::npos;
+  std::size_t begin = open + 1;
+  int depth = 0;
+  for (std::size_t i = open + 1; i < text.size(); ++i) {
+    if (text[i] == '(') ++depth;
+    if (text[i] == ')' && depth-- == 0) {
+      list.push_back(text.substr(begin, i - begin));
+      return i + 1;
+    }
+    if (text[i] == ',' && depth == 0) {
+      list.push_back(text.substr(begin, i - begin));
+      begin = i + 1;
+    }
+  }
+  return std::string::npos;
+}
+
+}  // namespace
+
+bool Library::IsDefinition(const std::string& input) noexcept {
+  return FindAssignment(input) != std::string::npos;
+}
+
+std::string Library::Define(const std::string& definition) {
+  auto [name, parsed] = Parse(definition);
+  std::string invocation = name;
+  if (!parsed.parameters.empty()) {
+    invocation += '(';
+    for (std::size_t i = 0; i < parsed.parameters.size(); ++i)
+      invocation += (i == 0) ? "x" : ",x";
+    invocation += ')';
+  }
+
+  auto previous = definitions_.find(name);
+  bool is_new = previous == definitions_.end();
+  Definition replaced = is_new ? Definition{} : previous->second;
+  definitions_[name] = std::move(parsed);
+  try {
+    Model model;
+    model.SetLibrary(this);
+    model.SetInput(invocation);
+    model.CompileMathExpression();
+  } catch (...) {
+    if (is_new)
+      definitions_.erase(name);
+    else
+      definitions_[name] = std::move(replaced);
+    throw std::invalid_argument("Invalid input");
+  }
+  return name;
+}
+
+bool Library::Remove(const std::string& name) noexcept {
+  return definitions_.erase(name) > 0;
+}
+
+std::string Library::Expand(const std::string& expression,
+                            std::set<std::string>* used) const {
+  std::string out;
+  if (definitions_.empty()) return expression;
+  std::vector<std::string> active, bound;
+  ExpandInto(expression, nullptr, active, bound, used, out);
+  return out;
+}
+
+std::vector<std::string> Library::List() const {
+  std::vector<std::string> list;
+  for (const auto& [name, definition] : definitions_) {
+    std::string line = name;
+    if (!definition.parameters.empty()) {
+      line += '(';
+      for (std::size_t i = 0; i < definition.parameters.size(); ++i)
+        line += (i == 0 ? "" : ",") + definition.parameters[i];
+      line += ')';
+    }
+    list.push_back(line + "=" + definition.body);
+  }
+  return list;
+}
+
+bool Library::Save(const std::string& path) const noexcept {
+  try {
+    std::ofstream file(path, std::ios::trunc);
+    for (const std::string& line : List()) file << line << '\n';
+    return static_cast<bool>(file);
+  } catch (...) {
+    return false;
+  }
+}
+
+bool Library::Load(const std::string& path) noexcept {
+  try {
+    std::ifstream file(path);
+    if (!file) return false;
+    definitions_.clear();
+    for (std::string line; std::getline(file, line);) {
+      try {
+        definitions_.insert(Parse(line));
+      } catch (const std::invalid_argument&) {
+        continue;  // Skips lines edited by hand into an invalid form
+      }
+    }
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+std::pair<std::string, Library::Definition> Library::Parse(
+    const std::string& definition) {
+  std::string text;
+  std::copy_if(definition.begin(), definition.end(), std::back_inserter(text),
+               [](unsigned char c) { return !std::isspace(c); });
+  std::size_t assignment = FindAssignment(text);
+  if (assignment == std::string::npos || assignment + 1 == text.size())
+    throw std::invalid_argument("Invalid input");
+
+  std::string head = text.substr(0, assignment);
+  Definition parsed{{}, text.substr(assignment + 1)};
+  std::size_t open = head.find('(');
+  std::string name = head.substr(0, open);
+  if (open != std::string::npos) {
+    if (head.back() != ')') throw std::invalid_argument("Invalid input");
+    std::string list = head.substr(open + 1, head.size() - open - 2);
+    for (std::size_t begin = 0;;) {
+      std::size_t comma = list.find(',', begin);
+      parsed.parameters.push_back(list.substr(begin, comma - begin));
+      if (comma == std::string::npos) break;
+      begin = comma + 1;
+    }
+  }
+
+  if (!IsName(name)) throw std::invalid_argument("Invalid input");
+  for (std::size_t i = 0; i < parsed.parameters.size(); ++i) {
+    const std::string& parameter = parsed.parameters[i];
+    if (!IsName(parameter) || parameter == name ||
+        std::count(parsed.parameters.begin(), parsed.parameters.begin() + i,
+                   parameter))
+      throw std::invalid_argument("Invalid input");
+  }
+  return {name, std::move(parsed)};
+}
+
+/**
+ * @details The index of a sum or product is bound inside its body, so it is
+ * left as it is there even if a definition or parameter has its name. The
+ * body of a definition is expanded with no names bound, as a definition only
+ * sees its own parameters.
+ */
+void Library::ExpandInto(const std::string& text,
+                         const std::map<std::string, std::string>* arguments,
+                         std::vector<std::string>& active,
+                         std::vector<std::string>& bound,
+                         std::set<std::string>* used, std::string& out) const {
+  for (std::size_t i = 0; i < text.size();) {
+    if (out.size() > kMaxExpansion)
+      throw std::invalid_argument("Invalid input");
+    if (!std::isalpha(static_cast<unsigned char>(text[i]))) {
+      out += text[i++];
+      continue;
+    }
+    std::size_t end = i;
+    while (end < text.size() &&
+           std::isalpha(static_cast<unsigned char>(text[end])))
+      ++end;
+    std::string name = text.substr(i, end - i);
+    i = end;
+
+    if (std::find(bound.begin(), bound.end(), name) != bound.end()) {
+      out += name;
+      continue;
+    }
+    if (name == "sum" || name == "prod") {
+      std::vector<std::string> list;
+      std::size_t after = SplitArguments(text, i, list);
+      std::string index = list.empty() ? std::string() : Trim(list[0]);
+      if (after == std::string::npos || list.size() != 4 || !IsName(index)) {
+        out += name;  // Left to the parser to reject
+        continue;
+      }
+      out += name + '(' + list[0] + ',';
+      ExpandInto(list[1], arguments, active, bound, used, out);
+      out += ',';
+      ExpandInto(list[2], arguments, active, bound, used, out);
+      out += ',';
+      bound.push_back(index);
+      ExpandInto(list[3], arguments, active, bound, used, out);
+      bound.pop_back();
+      out += ')';
+      i = after;
+      continue;
+    }
+    if (arguments != nullptr) {
+      auto argument = arguments->find(name);
+      if (argument != arguments->end()) {
+        out += '(' + argument->second + ')';
+        continue;
+      }
+    }
+    auto found = definitions_.find(name);
+    if (found == definitions_.end()) {
+      out += name;
+      continue;
+    }
+    if (std::find(active.begin(), active.end(), name) != active.end())
+      throw std::invalid_argument("Invalid input");
+    if (used != nullptr) used->insert(name);
+
+    // Arguments are expanded in the context of the caller
+    const Definition& definition = found->second;
+    std::map<std::string, std::string> values;
+    if (!definition.parameters.empty()) {
+      std::vector<std::string> list;
+      i = SplitArguments(text, i, list);
+      if (i == std::string::npos || list.size() != definition.parameters.size())
+        throw std::invalid_argument("Invalid input");
+      for (std::size_t p = 0; p < list.size(); ++p) {
+        std::string& value = values[definition.parameters[p]];
+        ExpandInto(list[p], arguments, active, bound, used, value);
+      }
+    }
+
+    active.push_back(name);
+    std::vector<std::string> unbound;
+    out += '(';
+    ExpandInto(definition.body, &values, active, unbound, used, out);
+    out += ')';
+    active.pop_back();
+  }
+  if (out.size() > kMaxExpansion) throw std::invalid_argument("Invalid input");
+}
+
+}  // namespace s21
@@ -0,0 +1,155 @@
+/**
+ * @file s21_library.h
+ * @brief Header file containing the declaration of the Library of user-defined
+ * functions and named constants.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_LIBRARY_H
+#define SMARTCALC_MODEL_S21_LIBRARY_H
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class Library
+ *
+ * @brief Stores definitions such as "f(a,b)=a^2+b" or "rate=0.07" and inlines
+ * them into expressions.
+ *
+ * Expand replaces every call of a user function by its body in parentheses,
+ * with each parameter replaced by the corresponding argument in parentheses,
+ * and every named constant by its value. The index of a sum or product is
+ * never replaced inside its body. The parser never sees the names, so
+ * a compiled Program contains the definitions inline and calling a user
+ * function costs nothing at evaluation time.
+ *
+ * A definition is checked by compiling it when it is added, including
+ * recursion through other definitions. Saved definitions were checked before,
+ * so Load only parses the file.
+ */
+class Library {
+ public:
+  /// Characters an expression may expand to. Each level of nested calls
+  /// repeats its arguments, so without a bound a short definition could
+  /// expand to gigabytes.
+  static constexpr std::size_t kMaxExpansion = std::size_t{1} << 16;
+
+  Library() noexcept = default;
+  ~Library() = default;
+
+  /**
+   * @brief Checks if the input is a definition rather than an expression.
+   *
+   * @param[in] input The text entered by the user.
+   * @return True if the input contains an '=' that is not part of a
+   * comparison.
+   */
+  static bool IsDefinition(const std::string& input) noexcept;
+
+  /**
+   * @brief Adds or replaces a definition.
+   *
+   * @param[in] definition The text "name=body" or "name(a,b,...)=body".
+   * @return The name of the defined function or constant.
+   * @throws std::invalid_argument if the definition is malformed, shadows a
+   * built-in name, or does not compile. The library is unchanged then.
+   */
+  std::string Define(const std::string& definition);
+
+  /**
+   * @brief Removes a definition.
+   *
+   * @param[in] name The name of the function or constant.
+   * @return True if the definition existed.
+   */
+  bool Remove(const std::string& name) noexcept;
+
+  /**
+   * @brief Inlines the definitions used by an expression.
+   *
+   * @param[in] expression The expression to expand.
+   * @param[out] used If not null, receives the names of the definitions the
+   * expansion went through, directly or via other definitions.
+   * @return The expression without user-defined names.
+   * @throws std::invalid_argument if a call has the wrong number of arguments,
+   * the definitions are recursive or the expansion is longer than
+   * kMaxExpansion characters.
+   */
+  std::string Expand(const std::string& expression,
+                     std::set<std::string>* used = nullptr) const;
+
+  /**
+   * @brief Returns every definition in its "name(a,b)=body" form, sorted by
+   * name.
+   */
+  std::vector<std::string> List() const;
+
+  /**
+   * @brief Returns true if there are no definitions.
+   */
+  bool Empty() const noexcept { return definitions_.empty(); }
+
+  /**
+   * @brief Writes the definitions to a text file, one per line.
+   *
+   * @param[in] path The file to write.
+   * @return True on success.
+   */
+  bool Save(const std::string& path) const noexcept;
+
+  /**
+   * @brief Replaces the definitions with those from a file written by Save.
+   *
+   * Malformed lines are skipped.
+   *
+   * @param[in] path The file to read.
+   * @return True if the file could be read.
+   */
+  bool Load(const std::string& path) noexcept;
+
+ private:
+  /**
+   * @struct Definition
+   * @brief The parameters and the body of a definition.
+   */
+  struct Definition {
+    std::vector<std::string> parameters;  ///< Empty for a constant.
+    std::string body;
+  };
+
+  /**
+   * @brief Splits a definition into its name and its parts.
+   *
+   * @throws std::invalid_argument if the definition is malformed.
+   */
+  static std::pair<std::string, Definition> Parse(
+      const std::string& definition);
+
+  /**
+   * @brief Expands @p text into @p out.
+   *
+   * @param[in] arguments The expanded arguments of the enclosing call, keyed
+   * by parameter name, or nullptr at the top level.
+   * @param[in, out] active The definitions being expanded, to catch recursion.
+   * @param[in, out] bound The indices of the sums and products around
+   * @p text, which are not expanded.
+   * @throws std::invalid_argument if a call is malformed, the definitions
+   * are recursive or @p out grows past kMaxExpansion characters.
+   */
+  void ExpandInto(const std::string& text,
+                  const std::map<std::string, std::string>* arguments,
+                  std::vector<std::string>& active,
+                  std::vector<std::string>& bound, std::set<std::string>* used,
+                  std::string& out) const;
+
+  std::map<std::string, Definition> definitions_;  ///< Definitions by name.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_LIBRARY_H
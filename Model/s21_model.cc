@@ -12,6 +12,11 @@
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <utility>
+
+#include "s21_format.h"
+#include "s21_library.h"
+#include "s21_tracer.h"
 
 s21::Model::Model() noexcept
     : expression_(),
@@ -21,27 +26,43 @@ s21::Model::Model() noexcept
       operators_(),
       calculation_(),
       result_(),
-      priorities_{{")", 6},    {"(", 6},    {"cos", 5},  {"sin", 5}, {"tan", 5},
-                  {"acos", 5}, {"asin", 5}, {"atan", 5}, {"ln", 5},  {"log", 5},
-                  {"~", 4},    {"sqrt", 3}, {"^", 3},    {"%", 2},   {"*", 2},
-                  {"/", 2},    {"-", 1},    {"+", 1}} {}
+      calls_(),
+      library_(nullptr),
+      dependencies_(),
+      priorities_{{")", 7},   {"(", 7},    {"cos", 6},  {"sin", 6},
+                  {"tan", 6},   {"acos", 6}, {"asin", 6}, {"atan", 6},
+                  {"ln", 6},    {"log", 6},  {"sum", 6},  {"prod", 6},
+                  {"if", 6},    {"min", 6},  {"max", 6},  {"abs", 6},
+                  {"~", 5},     {"sqrt", 4}, {"^", 4},    {"%", 3},
+                  {"*", 3},     {"/", 3},    {"-", 2},    {"+", 2},
+                  {"<", 1},     {"<=", 1},   {">", 1},    {">=", 1},
+                  {"==", 1},    {"!=", 1}} {}
 
 void s21::Model::SetInput(const std::string& input) {
-  ValidateInput(input);
-  expression_ = input;
+  Tracer::Span span("Model::SetInput", "model");
+  if (input.size() >= 256) throw std::invalid_argument("Invalid input");
+  dependencies_.clear();
+  std::string expression =
+      library_ != nullptr ? library_->Expand(input, &dependencies_) : input;
+  ValidateInput(expression);
+  expression_ = expression;
+}
+
+void s21::Model::SetLibrary(const Library* library) noexcept {
+  library_ = library;
 }
 
 void s21::Model::SetX(const double x) noexcept { x_ = x; }
 
 void s21::Model::ValidateInput(const std::string& input) {
-  bool is_valid_size = !input.empty() && input.size() < 256;
+  bool is_valid_size = !input.empty();
   bool is_valid_parenthesis = std::count(input.begin(), input.end(), '(') ==
                               std::count(input.begin(), input.end(), ')');
   bool is_valid_first_unary = !input.empty() && input[0] != '*' &&
                               input[0] != '/' && input[0] != '^' &&
                               input[0] != '%';
   bool is_math_expression = std::any_of(input.begin(), input.end(), [](char c) {
-    return std::isdigit(c) || c == 'x';
+    return std::isdigit(c) || c == 'x' || c == 'y';
   });
 
   if (!(is_valid_size && is_valid_parenthesis && is_math_expression &&
@@ -51,12 +72,58 @@ void s21::Model::ValidateInput(const std::string& input) {
 }
 
 double s21::Model::CalculateMathExpression() {
-  ReplaceScientificNotation();
-  ToPostfix();
+  {
+    Tracer::Span span("Model::ToPostfix", "model");
+    ReplaceScientificNotation();
+    ToPostfix();
+  }
+  Tracer::Span span("Model::Calculate", "model");
   Calculate();
   return result_;
 }
 
+s21::Program s21::Model::CompileMathExpression() {
+  {
+    Tracer::Span span("Model::ToPostfix", "model");
+    ReplaceScientificNotation();
+    ToPostfix();
+  }
+  Tracer::Span span("Model::Compile", "model");
+  return CompilePostfix(nullptr);
+}
+
+s21::Program s21::Model::CompilePostfix(std::string* closing) {
+  Program program;
+  while (!postfix_.empty()) {
+    Token token = postfix_.top();
+    postfix_.pop();
+    if (token.value == "x") {
+      program.PushVariable(0);
+    } else if (token.value == "y") {
+      program.PushVariable(1);
+    } else if (token.value[0] == '#') {
+      program.PushVariable(std::stoul(token.value.substr(1)));
+    } else if (token.value[0] == '{') {
+      std::string reduction;
+      Program body = CompilePostfix(&reduction);
+      program.PushReduction(ToOpCode(reduction), std::move(body),
+                            std::stoul(token.value.substr(1)));
+    } else if (IsReduction(token.value)) {
+      if (closing == nullptr) throw std::invalid_argument("Invalid input");
+      *closing = token.value;
+      program.Validate();
+      return program;
+    } else if (token.priority == 0) {
+      program.PushConstant(std::stod(token.value));
+    } else {
+      program.PushOperation(ToOpCode(token.value));
+    }
+  }
+  if (closing != nullptr) throw std::invalid_argument("Invalid input");
+  program.Validate();
+  return program;
+}
+
 void s21::Model::ReplaceScientificNotation() {
   size_t pos = expression_.find('e');
   while (pos != std::string::npos) {
@@ -74,6 +141,9 @@ void s21::Model::ReplaceScientificNotation() {
 }
 
 void s21::Model::ToPostfix() {
+  postfix_ = {};
+  operators_ = {};
+  calls_.clear();
   std::string number;
   std::string operation;
   for (auto it = expression_.begin(); it != expression_.end(); ++it) {
@@ -89,31 +159,36 @@ void s21::Model::ToPostfix() {
     else if (!number.empty())
       PushNumberToPostfix(number);
 
-    // Replace x to number
-    if (c == 'x') postfix_.push({DoubleToString(x_), 0});
-
-    // Write trigonometry or functions
-    if (isalpha(c) && c != 'x')
+    // Write variables, trigonometry or functions
+    if (isalpha(c))
       operation += c;
     else if (!operation.empty())
-      PushOperationToOperators(operators_, operation);
+      PushIdentifier(operation);
 
     // Write arithmetic operators
     if (IsOperator(c)) {
       if (c == '+' && IsUnary(it)) continue;
       if (c == '-' && IsUnary(it)) c = '~';
-      while (!operators_.empty() &&
-             GetTokenPriority(operators_) >=
-                 SetTokenPriority(std::string(1, c)) &&
-             GetTokenValue(operators_) != "(") {
-        postfix_.push(operators_.top());
-        operators_.pop();
-      }
+      PushOperator(std::string(1, c));
+    }
+
+    // Write comparison operators, possibly two characters long
+    if (IsComparison(c)) {
+      std::string comparison(1, c);
+      if (it + 1 != expression_.end() && *(it + 1) == '=') comparison += *++it;
+      PushOperator(comparison);
+    }
+
+    // Write parenthesis, opening the argument list of multi-argument calls
+    if (c == '(') {
+      if (!operators_.empty() && CountSeparators(GetTokenValue(operators_)))
+        calls_.push_back(
+            {GetTokenValue(operators_), operators_.size() + 1, 0, "", 0});
       PushOperationToOperators(operators_, c);
     }
 
-    // Write parenthesis
-    if (c == '(') PushOperationToOperators(operators_, c);
+    // Write argument separator
+    if (c == ',') PushSeparator();
 
     if (c == ')') {
       while (!operators_.empty() && GetTokenValue(operators_) != "(") {
@@ -121,14 +196,17 @@ void s21::Model::ToPostfix() {
             {GetTokenValue(operators_), GetTokenPriority(operators_)});
         operators_.pop();
       }
-      if (!operators_.empty()) {
+      if (!calls_.empty() && operators_.size() == calls_.back().level) {
+        CloseCall();
+      } else if (!operators_.empty()) {
         operators_.pop();  // Pop '('
       }
     }
   }
 
   if (!number.empty()) PushNumberToPostfix(number);
-  if (!operation.empty()) PushOperationToOperators(operators_, operation);
+  if (!operation.empty()) PushIdentifier(operation);
+  if (!calls_.empty()) throw std::invalid_argument("Invalid input");
 
   while (!operators_.empty()) {
     postfix_.push({GetTokenValue(operators_), GetTokenPriority(operators_)});
@@ -138,6 +216,94 @@ void s21::Model::ToPostfix() {
   ReverseStack();
 }
 
+void s21::Model::PushIdentifier(std::string& identifier) {
+  if (!calls_.empty() && IsReduction(calls_.back().function) &&
+      calls_.back().arguments == 0 &&
+      operators_.size() == calls_.back().level) {
+    Call& call = calls_.back();
+    if (!call.index.empty() || identifier == "x" || identifier == "y" ||
+        priorities_.count(identifier))
+      throw std::invalid_argument("Invalid input");
+    call.index = identifier;
+    identifier.clear();
+    return;
+  }
+
+  // The innermost sum or prod declaring the index wins
+  for (auto it = calls_.rbegin(); it != calls_.rend(); ++it) {
+    if (IsReduction(it->function) && it->arguments == 3 &&
+        it->index == identifier) {
+      postfix_.push({"#" + std::to_string(it->slot), 0});
+      identifier.clear();
+      return;
+    }
+  }
+
+  // Write variable, substituted by Calculate or kept by the Program
+  if (identifier == "x" || identifier == "y") {
+    postfix_.push({identifier, 0});
+    identifier.clear();
+    return;
+  }
+  PushOperationToOperators(operators_, identifier);
+}
+
+void s21::Model::PushOperator(const std::string& operation) {
+  int priority = SetTokenPriority(operation);
+  while (!operators_.empty() && GetTokenPriority(operators_) >= priority &&
+         GetTokenValue(operators_) != "(") {
+    postfix_.push(operators_.top());
+    operators_.pop();
+  }
+  operators_.push({operation, priority});
+}
+
+void s21::Model::PushSeparator() {
+  while (!operators_.empty() && GetTokenValue(operators_) != "(") {
+    postfix_.push(operators_.top());
+    operators_.pop();
+  }
+  if (calls_.empty() || operators_.size() != calls_.back().level)
+    throw std::invalid_argument("Invalid input");
+
+  Call& call = calls_.back();
+  if (++call.arguments > CountSeparators(call.function))
+    throw std::invalid_argument("Invalid input");
+  if (!IsReduction(call.function)) return;
+  if (call.index.empty()) throw std::invalid_argument("Invalid input");
+  if (call.arguments == 3) {
+    // The body starts here; its index takes the slot after those of the
+    // variables and of the enclosing bodies.
+    call.slot = kVariableCount +
+                std::count_if(calls_.begin(), calls_.end() - 1,
+                              [this](const Call& c) {
+                                return IsReduction(c.function) &&
+                                       c.arguments == 3;
+                              });
+    postfix_.push({"{" + std::to_string(call.slot), 0});
+  }
+}
+
+void s21::Model::CloseCall() {
+  if (calls_.back().arguments != CountSeparators(calls_.back().function))
+    throw std::invalid_argument("Invalid input");
+  operators_.pop();  // Pop '('
+  postfix_.push(operators_.top());
+  operators_.pop();  // Pop the function
+  calls_.pop_back();
+}
+
+bool s21::Model::IsReduction(const std::string& operation) noexcept {
+  return operation == "sum" || operation == "prod";
+}
+
+int s21::Model::CountSeparators(const std::string& operation) noexcept {
+  if (IsReduction(operation)) return 3;
+  if (operation == "if") return 2;
+  if (operation == "min" || operation == "max") return 1;
+  return 0;
+}
+
 void s21::Model::PushNumberToPostfix(std::string& number) {
   if (dot_count_ > 1) throw std::invalid_argument("Invalid input");
   dot_count_ = 0;
@@ -174,6 +340,15 @@ bool s21::Model::IsOperator(char c) noexcept {
   return (c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%');
 }
 
+bool s21::Model::IsComparison(char c) noexcept {
+  return (c == '<' || c == '>' || c == '=' || c == '!');
+}
+
+bool s21::Model::IsConditional(const std::string& operation) noexcept {
+  return operation == "if" || operation == "min" || operation == "max" ||
+         IsComparison(operation[0]);
+}
+
 int s21::Model::SetTokenPriority(const std::string& operation) {
   try {
     return priorities_.at(operation);
@@ -183,7 +358,8 @@ int s21::Model::SetTokenPriority(const std::string& operation) {
 }
 
 bool s21::Model::IsUnary(std::string::iterator it) {
-  return it == expression_.begin() || *(it - 1) == '(' ||
+  return it == expression_.begin() || *(it - 1) == '(' || *(it - 1) == ',' ||
+         IsComparison(*(it - 1)) ||
          IsOperator(*(it - 1)) || IsOperator(*(it + 1));
 }
 
@@ -201,8 +377,18 @@ void s21::Model::Calculate() {
     double num = 0.0;
     std::string token = GetTokenValue(postfix_);
     bool is_number = GetTokenPriority(postfix_) == 0;
-    if (is_number) {
+    if (token == "x") {
+      calculation_.push({DoubleToString(x_), 0});
+    } else if (token == "y") {
+      throw std::invalid_argument("Invalid input");  // Only for plotting
+    } else if (token[0] == '{') {
+      postfix_.pop();
+      CalculateReduction(std::stoul(token.substr(1)));
+      continue;
+    } else if (is_number) {
       calculation_.push(postfix_.top());
+    } else if (IsConditional(token)) {
+      CalculateConditional(token);
     } else if (IsOperator(token[0])) {
       num = std::stod(GetTokenValue(calculation_));
       calculation_.pop();
@@ -222,6 +408,49 @@ void s21::Model::Calculate() {
   if (!calculation_.empty()) throw std::invalid_argument("Invalid input");
 }
 
+void s21::Model::CalculateConditional(const std::string& operation) {
+  std::size_t arity = operation == "if" ? 3 : 2;
+  if (calculation_.size() < arity) throw std::invalid_argument("Invalid input");
+  double args[3];
+  for (std::size_t i = arity; i-- > 0; calculation_.pop())
+    args[i] = std::stod(GetTokenValue(calculation_));
+
+  double result = 0.0;
+  if (operation == "if") {
+    if (std::isnan(args[0]))
+      result = args[0];
+    else if (args[0] != 0)
+      result = args[1];
+    else
+      result = args[2];
+  }
+  if (operation == "min") result = (args[1] < args[0]) ? args[1] : args[0];
+  if (operation == "max") result = (args[0] < args[1]) ? args[1] : args[0];
+  if (operation == "<") result = args[0] < args[1];
+  if (operation == "<=") result = args[0] <= args[1];
+  if (operation == ">") result = args[0] > args[1];
+  if (operation == ">=") result = args[0] >= args[1];
+  if (operation == "==") result = args[0] == args[1];
+  if (operation == "!=") result = args[0] != args[1];
+  calculation_.push({DoubleToString(result), 0});
+}
+
+void s21::Model::CalculateReduction(std::uint32_t slot) {
+  std::string reduction;
+  Program body = CompilePostfix(&reduction);
+  if (calculation_.size() < 2) throw std::invalid_argument("Invalid input");
+  double upper = std::stod(GetTokenValue(calculation_));
+  calculation_.pop();
+  double lower = std::stod(GetTokenValue(calculation_));
+  calculation_.pop();
+
+  Program program;
+  program.PushConstant(lower);
+  program.PushConstant(upper);
+  program.PushReduction(ToOpCode(reduction), std::move(body), slot);
+  calculation_.push({DoubleToString(program.Evaluate(x_)), 0});
+}
+
 void s21::Model::CalculateArithmetic(double num1, double num2,
                                      char operation) noexcept {
   double result = 0.0;
@@ -262,12 +491,29 @@ void s21::Model::CalculateTrigonometry(double num,
   if (operation == "sqrt") result = sqrt(num);
   if (operation == "log") result = log10(num);
   if (operation == "ln") result = log(num);
+  if (operation == "abs") result = fabs(num);
   if (operation == "~") result = -num;
   calculation_.push({DoubleToString(result), 0});
 }
 
 std::string s21::Model::DoubleToString(double num) {
-  char buff[255];
-  sprintf(buff, "%.7lf", num);
-  return std::string(buff);
+  char buffer[Format::kBufferSize];
+  return std::string(Format::Shortest(num, buffer));
+}
+
+s21::OpCode s21::Model::ToOpCode(const std::string& operation) {
+  static const std::map<std::string, OpCode> kOpCodes{
+      {"+", OpCode::kAdd},     {"-", OpCode::kSub},     {"*", OpCode::kMul},
+      {"/", OpCode::kDiv},     {"^", OpCode::kPow},     {"%", OpCode::kMod},
+      {"~", OpCode::kNegate},  {"cos", OpCode::kCos},   {"sin", OpCode::kSin},
+      {"tan", OpCode::kTan},   {"acos", OpCode::kAcos}, {"asin", OpCode::kAsin},
+      {"atan", OpCode::kAtan}, {"sqrt", OpCode::kSqrt}, {"ln", OpCode::kLn},
+      {"log", OpCode::kLog},   {"sum", OpCode::kSum},   {"prod", OpCode::kProduct},
+      {"abs", OpCode::kAbs},   {"min", OpCode::kMin},   {"max", OpCode::kMax},
+      {"if", OpCode::kIf},     {"<", OpCode::kLess},    {"<=", OpCode::kLessEqual},
+      {">", OpCode::kGreater}, {">=", OpCode::kGreaterEqual},
+      {"==", OpCode::kEqual},  {"!=", OpCode::kNotEqual}};
+  auto it = kOpCodes.find(operation);
+  if (it == kOpCodes.end()) throw std::invalid_argument("Invalid input");
+  return it->second;
 }
@@ -7,12 +7,20 @@
 #ifndef SMARTCALC_MODEL_S21_MODEL_H
 #define SMARTCALC_MODEL_S21_MODEL_H
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <set>
 #include <stack>
 #include <string>
+#include <vector>
+
+#include "s21_program.h"
 
 namespace s21 {
 
+class Library;
+
 /**
  * @class Model
  *
@@ -33,11 +41,29 @@ class Model {
    * @brief Sets the input mathematical expression after validating and
    * processing it.
    *
+   * User-defined functions and constants of the attached Library are inlined
+   * before the validation; the length limit applies to the input as typed.
+   *
    * @param[in] input The mathematical expression to be set.
    * @throws std::invalid_argument if the input is invalid.
    */
   void SetInput(const std::string& input);
 
+  /**
+   * @brief Attaches the library of user definitions used by SetInput.
+   *
+   * @param[in] library The library, which must outlive the model, or nullptr.
+   */
+  void SetLibrary(const Library* library) noexcept;
+
+  /**
+   * @brief Returns the names of the user definitions inlined by the last
+   * SetInput call.
+   */
+  const std::set<std::string>& GetDependencies() const noexcept {
+    return dependencies_;
+  }
+
   /**
    * @brief Sets the value of 'x_'.
    *
@@ -59,6 +85,20 @@ class Model {
    */
   double CalculateMathExpression();
 
+  /**
+   * @brief Compiles the mathematical expression into a Program.
+   *
+   * Runs the same conversion to postfix notation as CalculateMathExpression,
+   * but keeps the variable 'x' symbolic, so the returned Program can be
+   * evaluated for any number of x values without parsing the input again.
+   * The expression may also read the variable 'y', which only a Program
+   * evaluates; CalculateMathExpression rejects it.
+   *
+   * @return The compiled expression.
+   * @throws std::invalid_argument if the expression is invalid.
+   */
+  Program CompileMathExpression();
+
  private:
   /**
    * @struct Token
@@ -71,17 +111,34 @@ class Model {
     int priority;
   };
 
+  /**
+   * @struct Call
+   * @brief State of a multi-argument call being parsed: sum, prod, if, min or
+   * max.
+   *
+   * The postfix form of sum(k, a, b, f) is "a b {slot f sum", where the body
+   * f refers to the index as "#slot". Other calls are plain postfix, e.g.
+   * "c a b if".
+   */
+  struct Call {
+    std::string function;  ///< Name of the called function.
+    std::size_t level;     ///< Size of the operators stack inside the call.
+    int arguments;         ///< Number of separators seen so far.
+    std::string index;     ///< Name of the index variable of sum and prod.
+    std::uint32_t slot;    ///< Variable slot of the index in the body.
+  };
+
   /**
    * @brief Validates the input mathematical expression.
    *
    * This function checks the validity of the input mathematical expression
    * based on the following criteria:
    *
-   * - The input should not be empty and its size should be less than 256
-   * characters.
+   * - The input should not be empty.
    * - The number of opening '(' and closing ')' parentheses should be equal.
    * - The first character should not be '*' or '/'.
-   * - The expression should contain at least one digit or the variable 'x'.
+   * - The expression should contain at least one digit or a variable, 'x'
+   *   or 'y'.
    *
    * @param input The input mathematical expression to be validated.
    *
@@ -137,6 +194,67 @@ class Model {
    */
   void PushNumberToPostfix(std::string& number);
 
+  /**
+   * @brief Handles a complete alphabetic token.
+   *
+   * The token declares the index of an open sum or prod, refers to the index
+   * of an enclosing body, is a variable, or is pushed to the operators
+   * stack as a function.
+   *
+   * @param[in, out] identifier The token, cleared afterwards.
+   * @throws std::invalid_argument if the index name is invalid.
+   */
+  void PushIdentifier(std::string& identifier);
+
+  /**
+   * @brief Pushes a binary operator, popping operators of higher or equal
+   * priority to the postfix stack first.
+   *
+   * @param[in] operation The arithmetic or comparison operator.
+   * @throws std::invalid_argument if the operator is unknown.
+   */
+  void PushOperator(const std::string& operation);
+
+  /**
+   * @brief Handles a ',' separating the arguments of a multi-argument call.
+   *
+   * @throws std::invalid_argument if the separator is misplaced.
+   */
+  void PushSeparator();
+
+  /**
+   * @brief Handles the ')' closing the arguments of a multi-argument call.
+   *
+   * @throws std::invalid_argument if the call lacks arguments.
+   */
+  void CloseCall();
+
+  /**
+   * @brief Checks if the given token is a sum or prod function.
+   *
+   * @param operation The token to check.
+   * @return True if the token is "sum" or "prod", otherwise false.
+   */
+  bool IsReduction(const std::string& operation) noexcept;
+
+  /**
+   * @brief Returns the number of separators a function call takes.
+   *
+   * @param operation The function name.
+   * @return 3 for sum and prod, 2 for if, 1 for min and max, otherwise 0.
+   */
+  int CountSeparators(const std::string& operation) noexcept;
+
+  /**
+   * @brief Compiles tokens from the postfix stack into a Program.
+   *
+   * @param[out] closing If not null, compilation stops at the sum or prod
+   * token closing the current body, which is stored here.
+   * @return The compiled tokens.
+   * @throws std::invalid_argument if the tokens do not form an expression.
+   */
+  Program CompilePostfix(std::string* closing);
+
   /**
    * @brief Pushes an operation to the operators stack.
    *
@@ -178,6 +296,22 @@ class Model {
    */
   bool IsOperator(char c) noexcept;
 
+  /**
+   * @brief Checks if the given character starts a comparison operator.
+   *
+   * @param c The character to check.
+   * @return True for '<', '>', '=' and '!', otherwise false.
+   */
+  bool IsComparison(char c) noexcept;
+
+  /**
+   * @brief Checks if the given token is a comparison, if, min or max.
+   *
+   * @param operation The token to check.
+   * @return True if the token is a conditional operation, otherwise false.
+   */
+  bool IsConditional(const std::string& operation) noexcept;
+
   /**
    * @brief Returns the priority of the given arithmetic operation.
    *
@@ -246,17 +380,48 @@ class Model {
   void CalculateTrigonometry(double num, std::string operation) noexcept;
 
   /**
-   * @brief Converts a double value to a string with a fixed precision of 7
-   * decimal places.
+   * @brief Calculates a comparison, if, min or max and updates the
+   * calculation stack.
+   *
+   * Comparisons yield 1 or 0; if(c, a, b) yields a for a non-zero c, b for a
+   * zero c and NaN for a NaN c.
+   *
+   * @param[in] operation The conditional operation.
+   * @throws std::invalid_argument if operands are missing.
+   */
+  void CalculateConditional(const std::string& operation);
+
+  /**
+   * @brief Calculates a sum or a product and updates the calculation stack.
    *
-   * This function converts a double value to a string with a fixed precision of
-   * 7 decimal places and returns the resulting string.
+   * The body of the reduction is taken from the postfix stack and compiled,
+   * the bounds are taken from the calculation stack.
+   *
+   * @param[in] slot The variable slot of the index.
+   */
+  void CalculateReduction(std::uint32_t slot);
+
+  /**
+   * @brief Converts a double value to the shortest string that reads back as
+   * the same value.
+   *
+   * Intermediate results of the string-based evaluation keep their full
+   * precision, and very large values cannot overflow a fixed buffer.
    *
    * @param[in] num The double value to be converted to a string.
    * @return The string representation of the double value.
    */
   std::string DoubleToString(double num);
 
+  /**
+   * @brief Converts an operator or function token to the Program operation.
+   *
+   * @param[in] operation The token value, e.g. "sin" or "+".
+   * @return The matching operation code.
+   * @throws std::invalid_argument if the token is not an operation.
+   */
+  OpCode ToOpCode(const std::string& operation);
+
  private:
   std::string expression_;  ///< Stores the original string value containing the
                             ///< mathematical expression.
@@ -270,6 +435,10 @@ class Model {
       calculation_;  ///< Stack for holding intermediate calculation results
                      ///< during expression evaluation.
   double result_;    ///< Stores the solution to the mathematical expression.
+  std::vector<Call> calls_;  ///< Open multi-argument calls during ToPostfix.
+  const Library* library_;   ///< User definitions, may be nullptr.
+  std::set<std::string>
+      dependencies_;  ///< User definitions inlined into expression_.
   const std::map<std::string, int>
       priorities_;  ///< Map to store operator priorities.
 };
@@ -0,0 +1,240 @@
+/**
+ * @file s21_portfolio.cc
+ * @brief Implementation file for the s21_portfolio.h.
+ */
+
+#include "s21_portfolio.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+/// Loans per block; fixed so the rounding of the sums is reproducible.
+constexpr std::size_t kBlockLoans = 4096;
+/// Loans priced in one pass of the kernel, sized to stay in L1.
+constexpr std::size_t kLanes = 256;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/**
+ * @struct Sum
+ * @brief Neumaier compensated sum.
+ */
+struct Sum {
+  double sum = 0.0;
+  double compensation = 0.0;
+
+  void Add(double term) noexcept {
+    double t = sum + term;
+    if (std::abs(sum) >= std::abs(term))
+      compensation += (sum - t) + term;
+    else
+      compensation += (term - t) + sum;
+    sum = t;
+  }
+
+  double Total() const noexcept { return sum + compensation; }
+};
+
+}  // namespace
+
+template <typename Block>
+Portfolio::Summary Portfolio::Reduce(std::size_t size, Block block) {
+  struct Totals {
+    Summary summary;
+    Sum amount, payment, overpayment, total;
+  };
+  Totals totals = ThreadPool::Shared().ParallelReduce(
+      size, kBlockLoans, Totals(), block,
+      [](Totals& totals, const Summary& part) {
+        totals.summary.count += part.count;
+        totals.summary.invalid += part.invalid;
+        totals.amount.Add(part.amount);
+        totals.payment.Add(part.payment);
+        totals.overpayment.Add(part.overpayment);
+        totals.total.Add(part.total);
+        totals.summary.max_payment =
+            std::max(totals.summary.max_payment, part.max_payment);
+      });
+
+  Summary& summary = totals.summary;
+  summary.amount = totals.amount.Total();
+  summary.payment = totals.payment.Total();
+  summary.overpayment = totals.overpayment.Total();
+  summary.total = totals.total.Total();
+  return summary;
+}
+
+Portfolio::Summary Portfolio::Calculate(const Loans& loans,
+                                        const Payments& payments) const {
+  return Reduce(loans.size, [&](std::size_t begin, std::size_t end) {
+    return CalculateBlock(loans, payments, begin, end);
+  });
+}
+
+Portfolio::Summary Portfolio::CalculateVariable(
+    const VariableLoans& loans, const Payments& payments) const {
+  return Reduce(loans.size, [&](std::size_t begin, std::size_t end) {
+    return CalculateVariableBlock(loans, payments, begin, end);
+  });
+}
+
+std::size_t Portfolio::Solve(CreditModel::Unknown unknown, const Loans& loans,
+                             const double* payment, double* solution) const {
+  using Unknown = CreditModel::Unknown;
+  std::size_t blocks = (loans.size + kBlockLoans - 1) / kBlockLoans;
+  std::vector<std::size_t> failures(blocks);
+  ThreadPool::Shared().ParallelFor(
+      blocks,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+          std::size_t last = std::min(loans.size, (b + 1) * kBlockLoans);
+          for (std::size_t i = b * kBlockLoans; i < last; ++i) {
+            double amount = unknown == Unknown::kAmount ? 0.0 : loans.amount[i];
+            double rate = unknown == Unknown::kRate ? 0.0 : loans.rate[i];
+            int periods =
+                unknown == Unknown::kPeriods ? 0 : loans.term[i] * loans.k[i];
+            solution[i] = CreditModel::Solve(unknown, amount, periods, rate,
+                                             payment[i], loans.type[i]);
+            failures[b] += std::isnan(solution[i]);
+          }
+        }
+      },
+      1);
+  std::size_t count = 0;
+  for (std::size_t failed : failures) count += failed;
+  return count;
+}
+
+/**
+ * @details Each run of kLanes loans goes through three loops over the lanes.
+ * With r = rate / 12 / 100 and n = term * k periods:
+ *   annuity:         payment = amount * r * g / (g - 1), g = (1 + r)^n,
+ *                    overpayment = payment * n - amount;
+ *   differentiated:  payment = amount / n + amount * r,
+ *                    overpayment = amount * (n + 1) / 2 * r.
+ * Since n is an integer, g is computed by binary exponentiation with one
+ * pass over the lanes per bit of the largest n, which replaces the pow call
+ * by multiplications and selects the compiler can vectorize. The run totals
+ * are then summed in lane order into the block accumulators.
+ */
+Portfolio::Summary Portfolio::CalculateBlock(const Loans& loans,
+                                             const Payments& payments,
+                                             std::size_t begin,
+                                             std::size_t end) {
+  Summary summary;
+  Sum amount, payment, overpayment, total;
+  double n[kLanes], r[kLanes], base[kLanes], growth[kLanes];
+  for (std::size_t run = begin; run < end; run += kLanes) {
+    std::size_t lanes = std::min(end - run, kLanes);
+    const double* a = loans.amount + run;
+    const char* type = loans.type + run;
+    double* pay = payments.payment + run;
+    double* over = payments.overpayment + run;
+    double* sum = payments.total + run;
+
+    int periods = 0;
+    for (std::size_t i = 0; i < lanes; ++i) {
+      int count = loans.term[run + i] * loans.k[run + i];
+      periods = std::max(periods, count);
+      n[i] = count;
+      r[i] = loans.rate[run + i] / 12.0 / 100.0;
+      base[i] = 1 + r[i];
+      growth[i] = 1.0;
+    }
+    for (int bit = 1; bit > 0 && bit <= periods; bit <<= 1) {
+      for (std::size_t i = 0; i < lanes; ++i) {
+        bool is_set = static_cast<int>(n[i]) & bit;
+        growth[i] *= is_set ? base[i] : 1.0;
+        base[i] *= base[i];
+      }
+    }
+    for (std::size_t i = 0; i < lanes; ++i) {
+      bool is_annuity = type[i] == 'a';
+      bool is_valid = n[i] > 0 && (is_annuity || type[i] == 'd');
+      double annuity = (r[i] == 0) ? a[i] / n[i]
+                                   : a[i] * r[i] * growth[i] / (growth[i] - 1);
+      double p = is_annuity ? annuity : a[i] / n[i] + a[i] * r[i];
+      double o = is_annuity ? annuity * n[i] - a[i]
+                            : a[i] * (n[i] + 1) / 2 * r[i];
+      pay[i] = is_valid ? p : kNaN;
+      over[i] = is_valid ? o : kNaN;
+      sum[i] = is_valid ? a[i] + o : kNaN;
+    }
+
+    std::size_t count = 0;
+    double run_amount = 0.0, run_payment = 0.0, run_overpayment = 0.0,
+           run_total = 0.0, run_max = 0.0;
+    for (std::size_t i = 0; i < lanes; ++i) {
+      bool is_valid = pay[i] == pay[i];
+      count += is_valid;
+      run_amount += is_valid ? a[i] : 0.0;
+      run_payment += is_valid ? pay[i] : 0.0;
+      run_overpayment += is_valid ? over[i] : 0.0;
+      run_total += is_valid ? sum[i] : 0.0;
+      run_max = std::max(run_max, is_valid ? pay[i] : 0.0);
+    }
+    summary.count += count;
+    summary.invalid += lanes - count;
+    amount.Add(run_amount);
+    payment.Add(run_payment);
+    overpayment.Add(run_overpayment);
+    total.Add(run_total);
+    summary.max_payment = std::max(summary.max_payment, run_max);
+  }
+  summary.amount = amount.Total();
+  summary.payment = payment.Total();
+  summary.overpayment = overpayment.Total();
+  summary.total = total.Total();
+  return summary;
+}
+
+Portfolio::Summary Portfolio::CalculateVariableBlock(
+    const VariableLoans& loans, const Payments& payments, std::size_t begin,
+    std::size_t end) {
+  Summary summary;
+  Sum amount, payment, overpayment, total;
+  for (std::size_t i = begin; i < end; ++i) {
+    std::size_t first = loans.offsets[i], last = loans.offsets[i + 1];
+    CreditModel::Segment segment{0, 0.0, kNaN};
+    double o = kNaN;
+    if (first < last) {
+      // Only the first segment is kept; its payment is the first payment
+      o = CreditModel::CalculateSegments(
+          loans.amount[i], loans.term[i] * loans.k[i], loans.type[i],
+          loans.resets + first, last - first, nullptr);
+      if (o == o)
+        CreditModel::CalculateSegments(loans.amount[i],
+                                       loans.term[i] * loans.k[i],
+                                       loans.type[i], loans.resets + first, 1,
+                                       &segment);
+    }
+    bool is_valid = o == o;
+    payments.payment[i] = is_valid ? segment.payment : kNaN;
+    payments.overpayment[i] = o;
+    payments.total[i] = loans.amount[i] + o;
+    if (!is_valid) {
+      ++summary.invalid;
+      continue;
+    }
+    ++summary.count;
+    amount.Add(loans.amount[i]);
+    payment.Add(segment.payment);
+    overpayment.Add(o);
+    total.Add(loans.amount[i] + o);
+    summary.max_payment = std::max(summary.max_payment, segment.payment);
+  }
+  summary.amount = amount.Total();
+  summary.payment = payment.Total();
+  summary.overpayment = overpayment.Total();
+  summary.total = total.Total();
+  return summary;
+}
+
+}  // namespace s21
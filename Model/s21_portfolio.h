@@ -0,0 +1,156 @@
+/**
+ * @file s21_portfolio.h
+ * @brief Header file containing the declaration of the Portfolio abstraction
+ * pricing many credits at once.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_PORTFOLIO_H
+#define SMARTCALC_MODEL_S21_PORTFOLIO_H
+
+#include <cstddef>
+
+#include "s21_creditmodel.h"
+
+namespace s21 {
+
+/**
+ * @class Portfolio
+ *
+ * @brief Batch version of CreditModel::CalculateResult over columnar arrays.
+ *
+ * Every loan is priced with the closed forms of CreditModel: the annuity
+ * payment and the differentiated first payment and overpayment. The loop
+ * body has no branches; both forms are computed and the loan type selects
+ * between them, so a block of loans runs through the same instructions
+ * whatever the mix of types. Blocks of fixed size are spread across the
+ * thread pool, and the statistics of the blocks are merged in block order,
+ * so the aggregates do not depend on the number of threads.
+ */
+class Portfolio {
+ public:
+  /**
+   * @struct Loans
+   * @brief Input columns, one element per loan.
+   */
+  struct Loans {
+    const double* amount;  ///< Loan amounts.
+    const int* term;       ///< Terms, in units of 1 / k years.
+    const double* rate;    ///< Annual interest rates in percent.
+    const char* type;      ///< 'a' for annuity, 'd' for differentiated.
+    const int* k;          ///< Periods per unit of the term, 12 or 1.
+    std::size_t size;      ///< Number of loans.
+  };
+
+  /**
+   * @struct VariableLoans
+   * @brief Input columns of variable-rate loans.
+   *
+   * The rate path of loan i is resets[offsets[i], offsets[i + 1]), sorted by
+   * strictly increasing period and starting at period 1, as taken by
+   * CreditModel::CalculateSegments. Paths may share nothing or be laid out
+   * back to back; only the offsets tie them to the loans.
+   */
+  struct VariableLoans {
+    const double* amount;  ///< Loan amounts.
+    const int* term;       ///< Terms, in units of 1 / k years.
+    const char* type;      ///< 'a' for annuity, 'd' for differentiated.
+    const int* k;          ///< Periods per unit of the term, 12 or 1.
+    const std::size_t* offsets;              ///< size + 1 offsets into resets.
+    const CreditModel::RateReset* resets;    ///< The rate paths.
+    std::size_t size;                        ///< Number of loans.
+  };
+
+  /**
+   * @struct Payments
+   * @brief Output columns, at least Loans::size elements each.
+   *
+   * Invalid loans get NaN in every column.
+   */
+  struct Payments {
+    double* payment;      ///< Monthly payment, the first one if differentiated.
+    double* overpayment;  ///< Total interest.
+    double* total;        ///< Amount plus interest.
+  };
+
+  /**
+   * @struct Summary
+   * @brief Aggregate statistics over the valid loans.
+   */
+  struct Summary {
+    std::size_t count = 0;     ///< Number of valid loans.
+    std::size_t invalid = 0;   ///< Loans with a non-positive term or bad type.
+    double amount = 0.0;       ///< Sum of the amounts.
+    double payment = 0.0;      ///< Sum of the payments.
+    double overpayment = 0.0;  ///< Sum of the overpayments.
+    double total = 0.0;        ///< Sum of the totals.
+    double max_payment = 0.0;  ///< Largest payment.
+  };
+
+  Portfolio() noexcept = default;
+  ~Portfolio() = default;
+
+  /**
+   * @brief Prices every loan and aggregates the results.
+   *
+   * @param[in] loans The input columns.
+   * @param[out] payments The output columns.
+   * @return The aggregate statistics.
+   */
+  Summary Calculate(const Loans& loans, const Payments& payments) const;
+
+  /**
+   * @brief Prices every variable-rate loan and aggregates the results.
+   *
+   * Each loan costs one closed form per segment of its rate path. The
+   * payment column receives the payment of the first period.
+   *
+   * @param[in] loans The input columns and the rate paths.
+   * @param[out] payments The output columns.
+   * @return The aggregate statistics; loans with an invalid path count as
+   * invalid.
+   */
+  Summary CalculateVariable(const VariableLoans& loans,
+                            const Payments& payments) const;
+
+  /**
+   * @brief Solves every loan for one parameter given its payment.
+   *
+   * The column of the unknown parameter is not read and may be null; for
+   * CreditModel::Unknown::kPeriods the term column is not read either.
+   *
+   * @param[in] unknown The parameter to find.
+   * @param[in] loans The input columns.
+   * @param[in] payment The payments, the first ones if differentiated.
+   * @param[out] solution The rates in percent, the numbers of periods or the
+   * amounts; NaN for loans without a solution.
+   * @return The number of loans without a solution.
+   */
+  std::size_t Solve(CreditModel::Unknown unknown, const Loans& loans,
+                    const double* payment, double* solution) const;
+
+ private:
+  /**
+   * @brief Prices loans [begin, end) and returns their statistics.
+   */
+  static Summary CalculateBlock(const Loans& loans, const Payments& payments,
+                                std::size_t begin, std::size_t end);
+
+  /**
+   * @brief Prices variable-rate loans [begin, end) and returns their
+   * statistics.
+   */
+  static Summary CalculateVariableBlock(const VariableLoans& loans,
+                                        const Payments& payments,
+                                        std::size_t begin, std::size_t end);
+
+  /**
+   * @brief Runs @p block over fixed blocks of @p size loans in parallel and
+   * merges the statistics in block order.
+   */
+  template <typename Block>
+  static Summary Reduce(std::size_t size, Block block);
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_PORTFOLIO_H
@@ -0,0 +1,1085 @@
+/**
+ * @file s21_program.cc
+ * @brief Implementation file for the s21_program.h.
+ */
+
+#include "s21_program.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "s21_programfile.h"
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @struct Dual
+ * @brief Dual number used for forward-mode automatic differentiation.
+ */
+struct Dual {
+  double value;
+  double derivative;
+
+  Dual() noexcept : value(), derivative() {}
+  explicit Dual(double v, double d = 0.0) noexcept : value(v), derivative(d) {}
+};
+
+Dual operator+(Dual a, Dual b) noexcept {
+  return Dual(a.value + b.value, a.derivative + b.derivative);
+}
+
+Dual operator-(Dual a, Dual b) noexcept {
+  return Dual(a.value - b.value, a.derivative - b.derivative);
+}
+
+Dual operator*(Dual a, Dual b) noexcept {
+  return Dual(a.value * b.value,
+              a.derivative * b.value + a.value * b.derivative);
+}
+
+Dual operator/(Dual a, Dual b) noexcept {
+  return Dual(a.value / b.value,
+              (a.derivative * b.value - a.value * b.derivative) /
+                  (b.value * b.value));
+}
+
+Dual operator-(Dual a) noexcept { return Dual(-a.value, -a.derivative); }
+
+double Pow(double a, double b) noexcept {
+  return b == 2 ? a * a : std::pow(a, b);  // Squares are the common case
+}
+double Mod(double a, double b) noexcept { return std::fmod(a, b); }
+double Cos(double a) noexcept { return std::cos(a); }
+double Sin(double a) noexcept { return std::sin(a); }
+double Tan(double a) noexcept { return std::tan(a); }
+double Acos(double a) noexcept { return std::acos(a); }
+double Asin(double a) noexcept { return std::asin(a); }
+double Atan(double a) noexcept { return std::atan(a); }
+double Sqrt(double a) noexcept { return std::sqrt(a); }
+double Ln(double a) noexcept { return std::log(a); }
+double Log(double a) noexcept { return std::log10(a); }
+
+Dual Pow(Dual a, Dual b) noexcept {
+  double value = std::pow(a.value, b.value);
+  double derivative = 0.0;
+  // Terms are skipped when their factor is zero to avoid 0 * inf at a = 0.
+  if (a.derivative != 0.0)
+    derivative += b.value * std::pow(a.value, b.value - 1) * a.derivative;
+  if (b.derivative != 0.0)
+    derivative += value * std::log(a.value) * b.derivative;
+  return Dual(value, derivative);
+}
+
+Dual Mod(Dual a, Dual b) noexcept {
+  return Dual(std::fmod(a.value, b.value),
+              a.derivative - std::trunc(a.value / b.value) * b.derivative);
+}
+
+Dual Cos(Dual a) noexcept {
+  return Dual(std::cos(a.value), -std::sin(a.value) * a.derivative);
+}
+
+Dual Sin(Dual a) noexcept {
+  return Dual(std::sin(a.value), std::cos(a.value) * a.derivative);
+}
+
+Dual Tan(Dual a) noexcept {
+  double t = std::tan(a.value);
+  return Dual(t, (1 + t * t) * a.derivative);
+}
+
+Dual Acos(Dual a) noexcept {
+  return Dual(std::acos(a.value),
+              -a.derivative / std::sqrt(1 - a.value * a.value));
+}
+
+Dual Asin(Dual a) noexcept {
+  return Dual(std::asin(a.value),
+              a.derivative / std::sqrt(1 - a.value * a.value));
+}
+
+Dual Atan(Dual a) noexcept {
+  return Dual(std::atan(a.value), a.derivative / (1 + a.value * a.value));
+}
+
+Dual Sqrt(Dual a) noexcept {
+  double s = std::sqrt(a.value);
+  return Dual(s, a.derivative / (2 * s));
+}
+
+Dual Ln(Dual a) noexcept {
+  return Dual(std::log(a.value), a.derivative / a.value);
+}
+
+Dual Log(Dual a) noexcept {
+  return Dual(std::log10(a.value), a.derivative / (a.value * M_LN10));
+}
+
+/// Returns the value part of a lane.
+double Value(double a) noexcept { return a; }
+double Value(Dual a) noexcept { return a.value; }
+
+double Abs(double a) noexcept { return std::abs(a); }
+
+Dual Abs(Dual a) noexcept {
+  return Dual(std::abs(a.value), a.value < 0 ? -a.derivative : a.derivative);
+}
+
+// The piecewise operations are written as selects rather than branches, so
+// the compiler turns the loops over stack rows into compares and blends.
+// Comparisons are flat, their derivative is zero. The Interval overloads of
+// s21_interval.h are picked over these templates.
+
+template <typename T>
+T Min(T a, T b) noexcept {
+  return Value(b) < Value(a) ? b : a;
+}
+
+template <typename T>
+T Max(T a, T b) noexcept {
+  return Value(a) < Value(b) ? b : a;
+}
+
+template <typename T>
+T Flag(bool condition) noexcept {
+  return T(condition ? 1.0 : 0.0);
+}
+
+template <typename T>
+T If(T condition, T a, T b) noexcept {
+  double c = Value(condition);
+  return c == 0 ? b : (c == c ? a : condition);
+}
+
+template <typename T>
+T Less(T a, T b) noexcept {
+  return Flag<T>(Value(a) < Value(b));
+}
+
+template <typename T>
+T LessEqual(T a, T b) noexcept {
+  return Flag<T>(Value(a) <= Value(b));
+}
+
+template <typename T>
+T Greater(T a, T b) noexcept {
+  return Flag<T>(Value(a) > Value(b));
+}
+
+template <typename T>
+T GreaterEqual(T a, T b) noexcept {
+  return Flag<T>(Value(a) >= Value(b));
+}
+
+template <typename T>
+T Equal(T a, T b) noexcept {
+  return Flag<T>(Value(a) == Value(b));
+}
+
+template <typename T>
+T NotEqual(T a, T b) noexcept {
+  return Flag<T>(Value(a) != Value(b));
+}
+
+/**
+ * @struct Neumaier
+ * @brief Compensated sum that also corrects terms larger than the sum.
+ */
+struct Neumaier {
+  double sum = 0.0;
+  double compensation = 0.0;
+
+  void Add(double term) noexcept {
+    double t = sum + term;
+    if (std::abs(sum) >= std::abs(term))
+      compensation += (sum - t) + term;
+    else
+      compensation += (term - t) + sum;
+    sum = t;
+  }
+
+  void Add(const Neumaier& other) noexcept {
+    Add(other.sum);
+    Add(other.compensation);
+  }
+
+  double Total() const noexcept { return sum + compensation; }
+};
+
+/**
+ * @struct Accumulator
+ * @brief Partial sum and product of a block of terms of type T.
+ */
+template <typename T>
+struct Accumulator;
+
+template <>
+struct Accumulator<double> {
+  Neumaier sum;
+  double product = 1.0;
+
+  void Add(double term) noexcept { sum.Add(term); }
+  void Merge(const Accumulator& other) noexcept { sum.Add(other.sum); }
+  double Total() const noexcept { return sum.Total(); }
+};
+
+template <>
+struct Accumulator<Dual> {
+  Neumaier value, derivative;
+  Dual product{1.0};
+
+  void Add(Dual term) noexcept {
+    value.Add(term.value);
+    derivative.Add(term.derivative);
+  }
+  void Merge(const Accumulator& other) noexcept {
+    value.Add(other.value);
+    derivative.Add(other.derivative);
+  }
+  Dual Total() const noexcept {
+    return Dual(value.Total(), derivative.Total());
+  }
+};
+
+/// Applies @p f to every element of a stack row in place.
+template <typename T, typename F>
+void Unary(T* a, std::size_t lanes, F f) noexcept {
+  for (std::size_t i = 0; i < lanes; ++i) a[i] = f(a[i]);
+}
+
+/// Combines two stack rows element-wise, storing the result in @p a.
+template <typename T, typename F>
+void Binary(T* a, const T* b, std::size_t lanes, F f) noexcept {
+  for (std::size_t i = 0; i < lanes; ++i) a[i] = f(a[i], b[i]);
+}
+
+/// Combines three stack rows element-wise, storing the result in @p a.
+template <typename T, typename F>
+void Ternary(T* a, const T* b, const T* c, std::size_t lanes, F f) noexcept {
+  for (std::size_t i = 0; i < lanes; ++i) a[i] = f(a[i], b[i], c[i]);
+}
+
+/**
+ * @brief Applies an operation other than a push, a sum or a product to rows
+ * of @p lanes values: the result replaces the first operand @p a, @p b and
+ * @p c are the second and the third.
+ */
+template <typename T>
+void Operate(OpCode op, T* a, const T* b, const T* c,
+             std::size_t lanes) noexcept {
+  switch (op) {
+    case OpCode::kAdd:
+      Binary(a, b, lanes, [](T u, T v) { return u + v; });
+      break;
+    case OpCode::kSub:
+      Binary(a, b, lanes, [](T u, T v) { return u - v; });
+      break;
+    case OpCode::kMul:
+      Binary(a, b, lanes, [](T u, T v) { return u * v; });
+      break;
+    case OpCode::kDiv:
+      Binary(a, b, lanes, [](T u, T v) { return u / v; });
+      break;
+    case OpCode::kPow:
+      Binary(a, b, lanes, [](T u, T v) { return Pow(u, v); });
+      break;
+    case OpCode::kMod:
+      Binary(a, b, lanes, [](T u, T v) { return Mod(u, v); });
+      break;
+    case OpCode::kNegate:
+      Unary(a, lanes, [](T u) { return -u; });
+      break;
+    case OpCode::kCos:
+      Unary(a, lanes, [](T u) { return Cos(u); });
+      break;
+    case OpCode::kSin:
+      Unary(a, lanes, [](T u) { return Sin(u); });
+      break;
+    case OpCode::kTan:
+      Unary(a, lanes, [](T u) { return Tan(u); });
+      break;
+    case OpCode::kAcos:
+      Unary(a, lanes, [](T u) { return Acos(u); });
+      break;
+    case OpCode::kAsin:
+      Unary(a, lanes, [](T u) { return Asin(u); });
+      break;
+    case OpCode::kAtan:
+      Unary(a, lanes, [](T u) { return Atan(u); });
+      break;
+    case OpCode::kSqrt:
+      Unary(a, lanes, [](T u) { return Sqrt(u); });
+      break;
+    case OpCode::kLn:
+      Unary(a, lanes, [](T u) { return Ln(u); });
+      break;
+    case OpCode::kLog:
+      Unary(a, lanes, [](T u) { return Log(u); });
+      break;
+    case OpCode::kAbs:
+      Unary(a, lanes, [](T u) { return Abs(u); });
+      break;
+    case OpCode::kMin:
+      Binary(a, b, lanes, [](T u, T v) { return Min(u, v); });
+      break;
+    case OpCode::kMax:
+      Binary(a, b, lanes, [](T u, T v) { return Max(u, v); });
+      break;
+    case OpCode::kLess:
+      Binary(a, b, lanes, [](T u, T v) { return Less(u, v); });
+      break;
+    case OpCode::kLessEqual:
+      Binary(a, b, lanes, [](T u, T v) { return LessEqual(u, v); });
+      break;
+    case OpCode::kGreater:
+      Binary(a, b, lanes, [](T u, T v) { return Greater(u, v); });
+      break;
+    case OpCode::kGreaterEqual:
+      Binary(a, b, lanes, [](T u, T v) { return GreaterEqual(u, v); });
+      break;
+    case OpCode::kEqual:
+      Binary(a, b, lanes, [](T u, T v) { return Equal(u, v); });
+      break;
+    case OpCode::kNotEqual:
+      Binary(a, b, lanes, [](T u, T v) { return NotEqual(u, v); });
+      break;
+    case OpCode::kIf:
+      Ternary(a, b, c, lanes, [](T w, T u, T v) { return If(w, u, v); });
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @struct Bound
+ * @brief Range of the values of a row of the single-precision stack, NaN
+ * lanes left out, and an estimate of the largest error among them.
+ *
+ * The fast batch mode keeps one Bound per stack row instead of an error per
+ * lane, so its rows are plain floats. The ranges of arithmetic results are
+ * derived from those of the operands, the others are scanned from the row.
+ */
+struct Bound {
+  float low;
+  float high;
+  float error;
+};
+
+/// Unit roundoff of float, the relative error of a rounded result.
+constexpr float kUnit = 0x1p-24f;
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+/// Values evaluated together by the fast batch mode. Blocks that are not
+/// accurate enough are evaluated again in double, so they are kept short.
+constexpr std::size_t kSingleBlock = 64;
+
+/// Returns the bound of a row of NaN only.
+Bound Empty() noexcept { return {kInfinity, -kInfinity, 0.0f}; }
+
+/// True for a row of NaN only.
+bool IsEmpty(const Bound& a) noexcept { return !(a.low <= a.high); }
+
+/// Returns the largest magnitude in a row.
+float Magnitude(const Bound& a) noexcept {
+  return IsEmpty(a) ? 0.0f : std::max(std::abs(a.low), std::abs(a.high));
+}
+
+/// Returns the smallest magnitude in a row.
+float Smallest(const Bound& a) noexcept {
+  if (IsEmpty(a)) return kInfinity;
+  if (a.low <= 0 && a.high >= 0) return 0.0f;
+  return std::min(std::abs(a.low), std::abs(a.high));
+}
+
+/// Scales an operand error by a derivative; an exact operand stays exact
+/// where the derivative is infinite.
+float Propagate(float error, float factor) noexcept {
+  return error == 0.0f ? 0.0f : error * factor;
+}
+
+/// Adds the rounding of the results, @p units of roundoff of the largest.
+Bound Rounded(Bound r, float units) noexcept {
+  r.error += units * kUnit * Magnitude(r);
+  return r;
+}
+
+/// Returns the range of a row with the error @p error.
+Bound Scan(const float* a, std::size_t lanes, float error) noexcept {
+  float low = kInfinity, high = -kInfinity;
+  for (std::size_t i = 0; i < lanes; ++i) {
+    low = std::min(low, a[i]);  // NaN is skipped by the order of the operands
+    high = std::max(high, a[i]);
+  }
+  return {low, high, error};
+}
+
+Bound Add(const Bound& a, const Bound& b) noexcept {
+  if (IsEmpty(a) || IsEmpty(b)) return Empty();
+  return Rounded({a.low + b.low, a.high + b.high, a.error + b.error}, 1);
+}
+
+Bound Sub(const Bound& a, const Bound& b) noexcept {
+  if (IsEmpty(a) || IsEmpty(b)) return Empty();
+  return Rounded({a.low - b.high, a.high - b.low, a.error + b.error}, 1);
+}
+
+Bound Mul(const Bound& a, const Bound& b) noexcept {
+  if (IsEmpty(a) || IsEmpty(b)) return Empty();
+  auto [low, high] = std::minmax({a.low * b.low, a.low * b.high,
+                                  a.high * b.low, a.high * b.high});
+  return Rounded({low, high,
+                  Propagate(a.error, Magnitude(b)) +
+                      Propagate(b.error, Magnitude(a)) + a.error * b.error},
+                 1);
+}
+
+Bound Div(const Bound& a, const Bound& b) noexcept {
+  if (IsEmpty(a) || IsEmpty(b)) return Empty();
+  float margin = Smallest(b) - b.error;  // Nearest b may get to zero
+  if (!(margin > 0)) return {-kInfinity, kInfinity, kInfinity};
+  auto [low, high] = std::minmax({a.low / b.low, a.low / b.high,
+                                  a.high / b.low, a.high / b.high});
+  Bound r{low, high, 0.0f};
+  r.error = (a.error + Propagate(b.error, Magnitude(r))) / margin;
+  return Rounded(r, 1);
+}
+
+/// Programs with a smaller stack are evaluated without heap allocation.
+constexpr std::size_t kInlineStack = 64;
+
+/// Terms of a sum or a product combined into one partial result. The block
+/// size is fixed so the rounding does not depend on the number of threads.
+constexpr std::size_t kReductionBlock = 4096;
+/// Blocks of a reduction run together on one thread; a reduction of fewer
+/// blocks is not worth a thread pool round trip.
+constexpr std::size_t kParallelBlocks = 8;
+/// Larger index ranges evaluate to NaN instead of running for hours.
+constexpr double kMaxTerms = 1e10;
+/// Value of 'y' for the evaluations given x alone.
+constexpr double kUndefined = std::numeric_limits<double>::quiet_NaN();
+
+}  // namespace
+
+/// Intervals are reduced term by term, see the definition at the end.
+template <>
+Interval ProgramView::Reduce(OpCode op, const ProgramView& body,
+                             std::uint32_t slot, const Interval* outer,
+                             Interval lower, Interval upper);
+
+int Arity(OpCode op) noexcept {
+  switch (op) {
+    case OpCode::kConstant:
+    case OpCode::kVariable:
+      return 0;
+    case OpCode::kAdd:
+    case OpCode::kSub:
+    case OpCode::kMul:
+    case OpCode::kDiv:
+    case OpCode::kPow:
+    case OpCode::kMod:
+    case OpCode::kSum:
+    case OpCode::kProduct:
+    case OpCode::kMin:
+    case OpCode::kMax:
+    case OpCode::kLess:
+    case OpCode::kLessEqual:
+    case OpCode::kGreater:
+    case OpCode::kGreaterEqual:
+    case OpCode::kEqual:
+    case OpCode::kNotEqual:
+      return 2;
+    case OpCode::kIf:
+      return 3;
+    default:
+      return 1;
+  }
+}
+
+void Apply(OpCode op, double* a, const double* b, const double* c,
+           std::size_t lanes) noexcept {
+  Operate(op, a, b, c, lanes);
+}
+
+void Program::PushConstant(double value) {
+  code_.push_back(
+      {OpCode::kConstant, static_cast<std::uint32_t>(constants_.size())});
+  constants_.push_back(value);
+  max_depth_ = std::max(max_depth_, ++depth_);
+}
+
+void Program::PushVariable(std::uint32_t slot) {
+  code_.push_back({OpCode::kVariable, slot});
+  max_depth_ = std::max(max_depth_, ++depth_);
+}
+
+void Program::PushOperation(OpCode op) {
+  int arity = Arity(op);
+  if (op == OpCode::kConstant || op == OpCode::kVariable ||
+      op == OpCode::kSum || op == OpCode::kProduct ||
+      depth_ < static_cast<std::size_t>(arity))
+    throw std::invalid_argument("Invalid input");
+  code_.push_back({op, 0});
+  depth_ = depth_ - arity + 1;
+  max_depth_ = std::max(max_depth_, depth_);
+}
+
+void Program::PushReduction(OpCode op, Program body, std::uint32_t slot) {
+  if ((op != OpCode::kSum && op != OpCode::kProduct) || depth_ < 2 ||
+      slot < kVariableCount)
+    throw std::invalid_argument("Invalid input");
+  body.Validate();
+  code_.push_back({op, static_cast<std::uint32_t>(reductions_.size())});
+  reductions_.push_back({std::move(body), slot});
+  --depth_;
+}
+
+void Program::Validate() const {
+  if (depth_ != 1) throw std::invalid_argument("Invalid input");
+}
+
+double Program::Evaluate(double x) const {
+  return ProgramView(*this).Evaluate(x);
+}
+
+double Program::EvaluateWithDerivative(double x, double& derivative) const {
+  return ProgramView(*this).EvaluateWithDerivative(x, derivative);
+}
+
+void Program::Evaluate(const double* x, double* result,
+                       std::size_t count) const {
+  ProgramView(*this).Evaluate(x, result, count);
+}
+
+void Program::EvaluateWithDerivative(const double* x, double* result,
+                                     double* derivative,
+                                     std::size_t count) const {
+  ProgramView(*this).EvaluateWithDerivative(x, result, derivative, count);
+}
+
+double Program::EvaluateXY(double x, double y) const {
+  return ProgramView(*this).EvaluateXY(x, y);
+}
+
+void Program::EvaluateXY(const double* x, const double* y, double* result,
+                         std::size_t count) const {
+  ProgramView(*this).EvaluateXY(x, y, result, count);
+}
+
+Interval Program::EvaluateXY(Interval x, Interval y) const {
+  return ProgramView(*this).EvaluateXY(x, y);
+}
+
+void Program::EvaluateXY(const Interval* x, const Interval* y,
+                         Interval* result, std::size_t count) const {
+  ProgramView(*this).EvaluateXY(x, y, result, count);
+}
+
+std::size_t Program::EvaluateFast(const double* x, double* result,
+                                  std::size_t count, double tolerance) const {
+  return ProgramView(*this).EvaluateFast(x, result, count, tolerance);
+}
+
+ProgramView::ProgramView(const Program& program) noexcept
+    : code_(program.code_.data()),
+      size_(program.code_.size()),
+      constants_(program.constants_.data()),
+      max_depth_(program.max_depth_),
+      reductions_(program.reductions_.data()) {}
+
+double ProgramView::Evaluate(double x) const {
+  return EvaluateXY(x, kUndefined);
+}
+
+double ProgramView::EvaluateXY(double x, double y) const {
+  const double* variables[] = {&x, &y};
+  double result = 0.0;
+  if (max_depth_ <= kInlineStack) {
+    std::array<double, kInlineStack> stack;
+    Run(variables, &result, 1, 1, stack.data());
+  } else {
+    std::vector<double> stack(max_depth_);
+    Run(variables, &result, 1, 1, stack.data());
+  }
+  return result;
+}
+
+double ProgramView::EvaluateWithDerivative(double x,
+                                           double& derivative) const {
+  Dual argument(x, 1.0), undefined(kUndefined);
+  const Dual* variables[] = {&argument, &undefined};
+  Dual result;
+  if (max_depth_ <= kInlineStack) {
+    std::array<Dual, kInlineStack> stack;
+    Run(variables, &result, 1, 1, stack.data());
+  } else {
+    std::vector<Dual> stack(max_depth_);
+    Run(variables, &result, 1, 1, stack.data());
+  }
+  derivative = result.derivative;
+  return result.value;
+}
+
+void ProgramView::Evaluate(const double* x, double* result,
+                           std::size_t count) const {
+  std::vector<double> undefined(kBlockSize, kUndefined);
+  std::vector<double> stack(max_depth_ * kBlockSize);
+  for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+    std::size_t lanes = std::min(kBlockSize, count - begin);
+    const double* variables[] = {x + begin, undefined.data()};
+    Run(variables, result + begin, lanes, kBlockSize, stack.data());
+  }
+}
+
+void ProgramView::EvaluateXY(const double* x, const double* y, double* result,
+                             std::size_t count) const {
+  std::vector<double> stack(max_depth_ * kBlockSize);
+  for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+    std::size_t lanes = std::min(kBlockSize, count - begin);
+    const double* variables[] = {x + begin, y + begin};
+    Run(variables, result + begin, lanes, kBlockSize, stack.data());
+  }
+}
+
+Interval ProgramView::EvaluateXY(Interval x, Interval y) const {
+  const Interval* variables[] = {&x, &y};
+  Interval result;
+  std::vector<Interval> stack(max_depth_);
+  Run(variables, &result, 1, 1, stack.data());
+  return result;
+}
+
+void ProgramView::EvaluateXY(const Interval* x, const Interval* y,
+                             Interval* result, std::size_t count) const {
+  std::vector<Interval> stack(max_depth_ * kBlockSize);
+  for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+    std::size_t lanes = std::min(kBlockSize, count - begin);
+    const Interval* variables[] = {x + begin, y + begin};
+    Run(variables, result + begin, lanes, kBlockSize, stack.data());
+  }
+}
+
+void ProgramView::EvaluateWithDerivative(const double* x, double* result,
+                                         double* derivative,
+                                         std::size_t count) const {
+  std::vector<Dual> stack(max_depth_ * kBlockSize);
+  std::vector<Dual> arguments(kBlockSize);
+  std::vector<Dual> undefined(kBlockSize, Dual(kUndefined));
+  std::vector<Dual> results(kBlockSize);
+  for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+    std::size_t lanes = std::min(kBlockSize, count - begin);
+    for (std::size_t i = 0; i < lanes; ++i)
+      arguments[i] = Dual(x[begin + i], 1.0);
+    const Dual* variables[] = {arguments.data(), undefined.data()};
+    Run(variables, results.data(), lanes, kBlockSize, stack.data());
+    for (std::size_t i = 0; i < lanes; ++i) {
+      result[begin + i] = results[i].value;
+      derivative[begin + i] = results[i].derivative;
+    }
+  }
+}
+
+/**
+ * @details A block that is not accurate enough is evaluated again in double
+ * as a whole, which keeps the float rows free of per-lane bookkeeping.
+ */
+std::size_t ProgramView::EvaluateFast(const double* x, double* result,
+                                      std::size_t count,
+                                      double tolerance) const {
+  if (!(tolerance > 0)) {
+    Evaluate(x, result, count);
+    return count;
+  }
+  std::vector<float> stack(max_depth_ * kSingleBlock);
+  std::vector<float> arguments(kSingleBlock), results(kSingleBlock);
+  std::vector<Bound> bounds(max_depth_);
+  std::vector<double> exact_stack;  // Allocated on the first fallback
+  std::vector<double> undefined;
+  std::size_t fallbacks = 0;
+  for (std::size_t begin = 0; begin < count; begin += kSingleBlock) {
+    std::size_t lanes = std::min(kSingleBlock, count - begin);
+    for (std::size_t i = 0; i < lanes; ++i)
+      arguments[i] = static_cast<float>(x[begin + i]);
+    // The last block is padded with its last value, which leaves its range
+    std::fill(arguments.begin() + lanes, arguments.end(), arguments[lanes - 1]);
+    Bound argument = Scan(arguments.data(), kSingleBlock, 0.0f);
+    argument.error = kUnit * Magnitude(argument);
+    float error = RunSingle(arguments.data(), argument, results.data(),
+                            stack.data(), bounds.data());
+    if (error <= tolerance) {
+      std::copy_n(results.data(), lanes, result + begin);
+      continue;
+    }
+    if (exact_stack.empty()) {
+      exact_stack.resize(max_depth_ * kSingleBlock);
+      undefined.assign(kSingleBlock, kUndefined);
+    }
+    const double* variables[] = {x + begin, undefined.data()};
+    Run(variables, result + begin, lanes, kSingleBlock, exact_stack.data());
+    fallbacks += lanes;
+  }
+  return fallbacks;
+}
+
+ProgramView ProgramView::Body(std::uint32_t index,
+                              std::uint32_t& slot) const noexcept {
+  if (reductions_) {
+    slot = reductions_[index].slot;
+    return ProgramView(reductions_[index].body);
+  }
+  return ProgramFile::Record(image_, bodies_[index], slot);
+}
+
+template <typename T>
+void ProgramView::Run(const T* const* variables, T* result, std::size_t lanes,
+                      std::size_t stride, T* stack) const {
+  std::size_t top = 0;  // Number of occupied stack rows
+  auto row = [stack, stride](std::size_t i) { return stack + i * stride; };
+
+  for (const Instruction* it = code_; it != code_ + size_; ++it) {
+    const Instruction& instruction = *it;
+    int arity = Arity(instruction.op);
+    if (arity > 1) top -= arity - 1;
+    T* a = (top > 0) ? row(top - 1) : nullptr;
+    T* b = row(top);
+
+    switch (instruction.op) {
+      case OpCode::kConstant:
+        std::fill_n(b, lanes, T(constants_[instruction.operand]));
+        ++top;
+        break;
+      case OpCode::kVariable:
+        std::copy_n(variables[instruction.operand], lanes, b);
+        ++top;
+        break;
+      case OpCode::kSum:
+      case OpCode::kProduct: {
+        std::uint32_t slot = 0;
+        ProgramView body = Body(instruction.operand, slot);
+        std::vector<T> outer(slot);
+        for (std::size_t i = 0; i < lanes; ++i) {
+          for (std::uint32_t v = 0; v < slot; ++v) outer[v] = variables[v][i];
+          a[i] = Reduce(instruction.op, body, slot, outer.data(), a[i], b[i]);
+        }
+        break;
+      }
+      default:
+        Operate(instruction.op, a, b, row(top + 1), lanes);
+        break;
+    }
+  }
+  std::copy_n(row(0), lanes, result);
+}
+
+/**
+ * @details The rows hold the float values and the bounds their ranges and
+ * errors, so every operation is a plain loop over floats followed by a few
+ * scalar operations on the bounds. The functions whose derivative depends on
+ * where the lanes are, and those with a restricted domain, take the
+ * relevant extreme in the same pass as the values; lanes well outside the
+ * domain are NaN in double as well and do not count.
+ */
+template <typename B>
+float ProgramView::RunSingle(const float* x, const B& x_bound, float* result,
+                             float* stack, B* bounds) const {
+  // Whole blocks only: a constant trip count lets the loops be vectorized
+  constexpr std::size_t lanes = kSingleBlock;
+  std::size_t top = 0;  // Number of occupied stack rows
+  auto row = [stack](std::size_t i) { return stack + i * kSingleBlock; };
+
+  for (const Instruction* it = code_; it != code_ + size_; ++it) {
+    const Instruction& instruction = *it;
+    int arity = Arity(instruction.op);
+    if (arity > 1) top -= arity - 1;
+    float* a = (top > 0) ? row(top - 1) : nullptr;
+    float* b = row(top);
+    // The bound of a is replaced by that of the result
+    B& p = bounds[top > 0 ? top - 1 : 0];
+    const B& q = bounds[top];
+    float error = (top > 0) ? p.error : 0.0f;
+
+    switch (instruction.op) {
+      case OpCode::kConstant: {
+        double constant = constants_[instruction.operand];
+        float value = static_cast<float>(constant);
+        std::fill_n(b, lanes, value);
+        bounds[top++] = {value, value,
+                         static_cast<float>(std::abs(value - constant))};
+        break;
+      }
+      case OpCode::kVariable:
+        if (instruction.operand != 0) return kInfinity;  // 'y' is NaN here
+        std::copy_n(x, lanes, b);
+        bounds[top++] = x_bound;
+        break;
+      case OpCode::kAdd:
+        Binary(a, b, lanes, [](float u, float v) { return u + v; });
+        p = Add(p, q);
+        break;
+      case OpCode::kSub:
+        Binary(a, b, lanes, [](float u, float v) { return u - v; });
+        p = Sub(p, q);
+        break;
+      case OpCode::kMul:
+        Binary(a, b, lanes, [](float u, float v) { return u * v; });
+        p = Mul(p, q);
+        break;
+      case OpCode::kDiv:
+        Binary(a, b, lanes, [](float u, float v) { return u / v; });
+        p = Div(p, q);
+        break;
+      case OpCode::kPow:
+        if (q.low == 2 && q.high == 2 && q.error == 0) {
+          Unary(a, lanes, [](float u) { return u * u; });
+          p = Mul(p, p);
+        } else {
+          float base = Smallest(p), magnitude = Magnitude(p);
+          Binary(a, b, lanes,
+                 [](float u, float v) { return std::pow(u, v); });
+          B r = Scan(a, lanes, 0.0f);
+          float log = std::max(std::abs(std::log(base)),
+                               std::abs(std::log(magnitude)));
+          r.error = Propagate(error, Magnitude(r) * Magnitude(q) / base) +
+                    Propagate(q.error, Magnitude(r) * log);
+          p = Rounded(r, 2);
+        }
+        break;
+      case OpCode::kMod: {
+        // Exact, but the remainder wraps around near zero and near b
+        float quotient = 0.0f, wrap = kInfinity;
+        for (std::size_t i = 0; i < lanes; ++i) {
+          float r = std::fmod(a[i], b[i]);
+          quotient = std::max(quotient, std::abs(std::trunc(a[i] / b[i])));
+          wrap = std::min(wrap, std::min(std::abs(r),
+                                         std::abs(b[i]) - std::abs(r)));
+          a[i] = r;
+        }
+        error += Propagate(q.error, quotient);
+        p = Scan(a, lanes, error > 0 && wrap <= error ? kInfinity : error);
+        break;
+      }
+      case OpCode::kNegate:
+        Unary(a, lanes, [](float u) { return -u; });
+        p = {-p.high, -p.low, error};
+        break;
+      case OpCode::kCos:
+        Unary(a, lanes, [](float u) { return std::cos(u); });
+        p = {-1.0f, 1.0f, error + 2 * kUnit};
+        break;
+      case OpCode::kSin:
+        Unary(a, lanes, [](float u) { return std::sin(u); });
+        p = {-1.0f, 1.0f, error + 2 * kUnit};
+        break;
+      case OpCode::kTan: {
+        // tanf of glibc is slower than tan, the double result is rounded
+        Unary(a, lanes, [](float u) {
+          return static_cast<float>(std::tan(static_cast<double>(u)));
+        });
+        B r = Scan(a, lanes, 0.0f);
+        float magnitude = Magnitude(r);
+        r.error = Propagate(error, 1 + magnitude * magnitude);
+        p = Rounded(r, 2);
+        break;
+      }
+      case OpCode::kAcos:
+      case OpCode::kAsin: {
+        float largest = 0.0f;  // Of the lanes that may lie in the domain
+        for (std::size_t i = 0; i < lanes; ++i)
+          if (std::abs(a[i]) <= 1 + error)
+            largest = std::max(largest, std::abs(a[i]));
+        if (instruction.op == OpCode::kAcos)
+          Unary(a, lanes, [](float u) { return std::acos(u); });
+        else
+          Unary(a, lanes, [](float u) { return std::asin(u); });
+        float factor =
+            largest < 1 ? 1 / std::sqrt(1 - largest * largest) : kInfinity;
+        float low = std::max(p.low, -1.0f), high = std::min(p.high, 1.0f);
+        B r = (instruction.op == OpCode::kAcos)
+                  ? B{std::acos(high), std::acos(low), 0.0f}
+                  : B{std::asin(low), std::asin(high), 0.0f};
+        r.error = Propagate(error, factor);
+        p = Rounded(r, 2);
+        break;
+      }
+      case OpCode::kAtan: {
+        float smallest = Smallest(p);
+        Unary(a, lanes, [](float u) { return std::atan(u); });
+        B r = {std::atan(p.low), std::atan(p.high),
+               Propagate(error, 1 / (1 + smallest * smallest))};
+        p = Rounded(r, 2);
+        break;
+      }
+      case OpCode::kSqrt:
+      case OpCode::kLn:
+      case OpCode::kLog: {
+        float smallest = kInfinity;  // Of the lanes that may lie in the domain
+        for (std::size_t i = 0; i < lanes; ++i)
+          if (a[i] > -error) smallest = std::min(smallest, a[i]);
+        // The functions increase, the range follows from its ends
+        float low = std::max(smallest, 0.0f), high = p.high;
+        float factor = kInfinity;
+        B r;
+        if (instruction.op == OpCode::kSqrt) {
+          Unary(a, lanes, [](float u) { return std::sqrt(u); });
+          if (smallest > 0) factor = 0.5f / std::sqrt(smallest);
+          r = {std::sqrt(low), std::sqrt(high), 0.0f};
+        } else if (instruction.op == OpCode::kLn) {
+          Unary(a, lanes, [](float u) { return std::log(u); });
+          if (smallest > 0) factor = 1 / smallest;
+          r = {std::log(low), std::log(high), 0.0f};
+        } else {
+          Unary(a, lanes, [](float u) { return std::log10(u); });
+          if (smallest > 0)
+            factor = 1 / (smallest * static_cast<float>(M_LN10));
+          r = {std::log10(low), std::log10(high), 0.0f};
+        }
+        r.error = Propagate(error, factor);
+        p = Rounded(r, instruction.op == OpCode::kSqrt ? 1 : 2);
+        break;
+      }
+      case OpCode::kAbs:
+        Unary(a, lanes, [](float u) { return std::abs(u); });
+        if (!IsEmpty(p)) p = {Smallest(p), Magnitude(p), error};
+        break;
+      case OpCode::kMin:
+        Binary(a, b, lanes, [](float u, float v) { return Min(u, v); });
+        p = {std::min(p.low, q.low), std::min(p.high, q.high),
+             std::max(error, q.error)};
+        break;
+      case OpCode::kMax:
+        Binary(a, b, lanes, [](float u, float v) { return Max(u, v); });
+        p = {std::max(p.low, q.low), std::max(p.high, q.high),
+             std::max(error, q.error)};
+        break;
+      case OpCode::kLess:
+      case OpCode::kLessEqual:
+      case OpCode::kGreater:
+      case OpCode::kGreaterEqual:
+      case OpCode::kEqual:
+      case OpCode::kNotEqual: {
+        // A comparison is unreliable where the operands are within their
+        // errors of each other
+        float gap = kInfinity;
+        for (std::size_t i = 0; i < lanes; ++i)
+          gap = std::min(gap, std::abs(a[i] - b[i]));
+        Operate<float>(instruction.op, a, b, nullptr, lanes);
+        error += q.error;
+        p = {0.0f, 1.0f, error > 0 && gap <= error ? kInfinity : 0.0f};
+        break;
+      }
+      case OpCode::kIf: {
+        // The branch taken is unreliable where the condition may be zero
+        const B& otherwise = bounds[top + 1];
+        bool is_unsure = error > 0 && Smallest(p) <= error;
+        Ternary(a, b, row(top + 1), lanes,
+                [](float c, float u, float v) { return If(c, u, v); });
+        p = {std::min(q.low, otherwise.low), std::max(q.high, otherwise.high),
+             is_unsure ? kInfinity : std::max(q.error, otherwise.error)};
+        break;
+      }
+      case OpCode::kSum:
+      case OpCode::kProduct:
+        // Evaluated in double: the block falls back
+        return kInfinity;
+    }
+  }
+  std::copy_n(row(0), lanes, result);
+  return bounds[0].error;
+}
+
+/**
+ * @details The index range is cut into blocks of kReductionBlock terms. A
+ * block evaluates its terms kBlockSize at a time with the enclosing variables
+ * broadcast to every lane, and reduces them into its own accumulator. The
+ * accumulators are merged in block order at the end by the thread pool.
+ */
+template <typename T>
+T ProgramView::Reduce(OpCode op, const ProgramView& body, std::uint32_t slot,
+                      const T* outer, T lower, T upper) {
+  bool is_sum = op == OpCode::kSum;
+  double first = Value(lower);
+  double terms = std::floor(Value(upper) - first) + 1;
+  if (!(terms <= kMaxTerms)) return T(std::numeric_limits<double>::quiet_NaN());
+  if (terms < 1) return T(is_sum ? 0.0 : 1.0);
+
+  std::size_t count = static_cast<std::size_t>(terms);
+  auto reduce_block = [&](std::size_t begin, std::size_t end) {
+    std::size_t slots = slot + 1;
+    std::vector<T> rows(slots * kBlockSize), terms_row(kBlockSize);
+    std::vector<T> stack(body.max_depth_ * kBlockSize);
+    std::vector<const T*> variables(slots);
+    for (std::size_t v = 0; v < slots; ++v) {
+      variables[v] = rows.data() + v * kBlockSize;
+      if (v < slot)
+        std::fill_n(rows.data() + v * kBlockSize, kBlockSize, outer[v]);
+    }
+    T* index = rows.data() + slot * kBlockSize;
+
+    Accumulator<T> partial;
+    for (std::size_t k = begin; k < end; k += kBlockSize) {
+      std::size_t lanes = std::min(kBlockSize, end - k);
+      for (std::size_t i = 0; i < lanes; ++i)
+        index[i] = T(first + static_cast<double>(k + i));
+      body.Run(variables.data(), terms_row.data(), lanes, kBlockSize,
+               stack.data());
+      for (std::size_t i = 0; i < lanes; ++i) {
+        if (is_sum)
+          partial.Add(terms_row[i]);
+        else
+          partial.product = partial.product * terms_row[i];
+      }
+    }
+    return partial;
+  };
+  Accumulator<T> total = ThreadPool::Shared().ParallelReduce(
+      count, kReductionBlock, Accumulator<T>(), reduce_block,
+      [is_sum](Accumulator<T>& total, const Accumulator<T>& partial) {
+        if (is_sum)
+          total.Merge(partial);
+        else
+          total.product = total.product * partial.product;
+      },
+      kParallelBlocks);
+  return is_sum ? total.Total() : total.product;
+}
+
+/**
+ * @details The terms are added one at a time, and only for bounds that are
+ * single numbers: a range of bounds, or more terms than a block of the
+ * parallel reduction, gives every number rather than a long loop.
+ */
+template <>
+Interval ProgramView::Reduce(OpCode op, const ProgramView& body,
+                             std::uint32_t slot, const Interval* outer,
+                             Interval lower, Interval upper) {
+  bool is_sum = op == OpCode::kSum;
+  if (lower.Empty() || upper.Empty()) return Interval();
+  if (lower.low != lower.high || upper.low != upper.high)
+    return Interval::Entire();
+  double terms = std::floor(upper.low - lower.low) + 1;
+  if (!(terms <= kMaxTerms)) return Interval();
+  if (terms < 1) return Interval(is_sum ? 0.0 : 1.0);
+  if (terms > kParallelBlocks * kReductionBlock) return Interval::Entire();
+
+  std::vector<Interval> values(outer, outer + slot);
+  values.emplace_back();
+  std::vector<const Interval*> variables;
+  for (const Interval& value : values) variables.push_back(&value);
+  std::vector<Interval> stack(body.max_depth_);
+  Interval total(is_sum ? 0.0 : 1.0), term;
+  for (std::size_t k = 0; k < static_cast<std::size_t>(terms); ++k) {
+    values[slot] = Interval(lower.low + static_cast<double>(k));
+    body.Run(variables.data(), &term, 1, 1, stack.data());
+    total = is_sum ? total + term : total * term;
+  }
+  return total;
+}
+
+}  // namespace s21
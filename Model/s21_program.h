@@ -0,0 +1,458 @@
+/**
+ * @file s21_program.h
+ * @brief Header file containing the declaration of the Program abstraction, a
+ * compiled form of a mathematical expression.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_PROGRAM_H
+#define SMARTCALC_MODEL_S21_PROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "s21_interval.h"
+
+namespace s21 {
+
+class ProgramView;
+
+/**
+ * @enum OpCode
+ * @brief Operations understood by the Program stack machine.
+ */
+enum class OpCode : std::uint8_t {
+  kConstant,  ///< Pushes constants_[operand].
+  kVariable,  ///< Pushes variable slot 'operand': 'x', 'y', then indices.
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kPow,
+  kMod,
+  kNegate,
+  kCos,
+  kSin,
+  kTan,
+  kAcos,
+  kAsin,
+  kAtan,
+  kSqrt,
+  kLn,
+  kLog,
+  kSum,      ///< Pops lower and upper bounds, pushes reductions_[operand].
+  kProduct,  ///< Same as kSum with multiplication.
+  kAbs,
+  kMin,
+  kMax,
+  kLess,  ///< Comparisons push 1 if true and 0 otherwise.
+  kLessEqual,
+  kGreater,
+  kGreaterEqual,
+  kEqual,
+  kNotEqual,
+  kIf  ///< Pops condition, then and else values; NaN condition gives NaN.
+};
+
+/// The last operation code, for checking stored programs.
+constexpr OpCode kLastOpCode = OpCode::kIf;
+
+/// Variable slots of a whole expression, 0 for 'x' and 1 for 'y'; the
+/// indices of sums and products take the slots after them.
+constexpr std::uint32_t kVariableCount = 2;
+
+/**
+ * @struct Instruction
+ * @brief A single instruction of the compiled expression.
+ */
+struct Instruction {
+  OpCode op;
+  std::uint32_t operand;  ///< Constant, variable slot or reduction index.
+};
+
+/**
+ * @brief Returns the number of stack values consumed by an operation; the
+ * bounds for a sum or a product.
+ */
+int Arity(OpCode op) noexcept;
+
+/**
+ * @brief Applies an operation other than a push, a sum or a product to rows
+ * of values.
+ *
+ * @param[in] op The operation.
+ * @param[in, out] a The first operand, replaced by the result.
+ * @param[in] b The second operand, if any.
+ * @param[in] c The third operand, if any.
+ * @param[in] lanes The number of values in each row.
+ */
+void Apply(OpCode op, double* a, const double* b, const double* c,
+           std::size_t lanes) noexcept;
+
+/**
+ * @class Program
+ *
+ * @brief Postfix expression compiled into opcodes for repeated evaluation.
+ *
+ * A Program is produced by Model::CompileMathExpression and is immutable
+ * afterwards, so a single instance may be evaluated from several threads at
+ * once. Besides the scalar evaluation it offers a batch mode that runs every
+ * instruction over a block of x values at a time, a single-precision
+ * variant of it for plotting and a forward-mode automatic differentiation
+ * pass that yields f'(x) alongside f(x).
+ *
+ * An expression may also read a second variable 'y', for the curves
+ * f(x, y) = 0. The evaluations given x alone leave y undefined, so such an
+ * expression is NaN there. Over intervals of x and y, the program gives a
+ * range holding every value of the expression in the rectangle.
+ *
+ * Sums and products over an index, sum(k, a, b, f) and prod(k, a, b, f), keep
+ * their body f as a nested Program reading the index from a variable slot.
+ * The terms are evaluated in batches over consecutive indices, in blocks of
+ * fixed size spread across the thread pool, and the block results are
+ * combined in index order, so the value does not depend on the number of
+ * threads. Sums use Neumaier's compensated summation.
+ *
+ * Piecewise expressions built from if, comparisons, min, max and abs do not
+ * branch in the batch mode: both arms of an if are computed for the whole
+ * block, and the condition row selects between them lane by lane, so the
+ * loops stay vectorizable.
+ *
+ * The evaluation itself is done by ProgramView, which reads the instructions
+ * in place and so also runs programs stored in a ProgramFile.
+ */
+class Program {
+ public:
+  Program() noexcept = default;
+  ~Program() = default;
+
+  /**
+   * @brief Appends a constant push to the program.
+   *
+   * @param[in] value The constant to push.
+   */
+  void PushConstant(double value);
+
+  /**
+   * @brief Appends a variable push to the program.
+   *
+   * @param[in] slot The variable slot, 0 for 'x' and 1 for 'y'.
+   */
+  void PushVariable(std::uint32_t slot = 0);
+
+  /**
+   * @brief Appends an operation to the program.
+   *
+   * @param[in] op The operation code of an operator or a function.
+   * @throws std::invalid_argument if the operation lacks operands.
+   */
+  void PushOperation(OpCode op);
+
+  /**
+   * @brief Appends a sum or a product over an index to the program.
+   *
+   * The lower and upper bounds must already be on the stack. The index runs
+   * over lower, lower + 1, ... while it does not exceed upper.
+   *
+   * @param[in] op kSum or kProduct.
+   * @param[in] body The term, reading the index from variable @p slot and
+   * the enclosing variables from the slots below it.
+   * @param[in] slot The variable slot of the index.
+   * @throws std::invalid_argument if the bounds or the body are missing.
+   */
+  void PushReduction(OpCode op, Program body, std::uint32_t slot);
+
+  /**
+   * @brief Checks that the program leaves exactly one value on the stack.
+   *
+   * @throws std::invalid_argument if the program is incomplete.
+   */
+  void Validate() const;
+
+  /**
+   * @brief Evaluates the program for a single x value.
+   *
+   * @param[in] x The value of the variable 'x'.
+   * @return The result of the expression.
+   */
+  double Evaluate(double x) const;
+
+  /**
+   * @brief Evaluates the program and its derivative for a single x value.
+   *
+   * @param[in] x The value of the variable 'x'.
+   * @param[out] derivative The value of f'(x).
+   * @return The result of the expression.
+   */
+  double EvaluateWithDerivative(double x, double& derivative) const;
+
+  /**
+   * @brief Evaluates the program for an array of x values.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] result The output array, at least @p count elements.
+   * @param[in] count The number of values to evaluate.
+   */
+  void Evaluate(const double* x, double* result, std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program and its derivative for an array of x values.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] result The output array for f(x).
+   * @param[out] derivative The output array for f'(x).
+   * @param[in] count The number of values to evaluate.
+   */
+  void EvaluateWithDerivative(const double* x, double* result,
+                              double* derivative, std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program at a single point (x, y).
+   */
+  double EvaluateXY(double x, double y) const;
+
+  /**
+   * @brief Evaluates the program at an array of points (x, y).
+   */
+  void EvaluateXY(const double* x, const double* y, double* result,
+                  std::size_t count) const;
+
+  /**
+   * @brief Bounds the program over a rectangle, see ProgramView::EvaluateXY.
+   */
+  Interval EvaluateXY(Interval x, Interval y) const;
+
+  /**
+   * @brief Bounds the program over an array of rectangles.
+   */
+  void EvaluateXY(const Interval* x, const Interval* y, Interval* result,
+                  std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program for an array of x values in single
+   * precision where that is accurate enough, see ProgramView::EvaluateFast.
+   */
+  std::size_t EvaluateFast(const double* x, double* result, std::size_t count,
+                           double tolerance) const;
+
+  /**
+   * @brief Returns true if the program holds no instructions.
+   */
+  bool Empty() const noexcept { return code_.empty(); }
+
+ private:
+  friend class ProgramView;
+  friend class ProgramFile;
+
+  struct Reduction;
+
+  std::vector<Instruction> code_;      ///< Instructions in postfix order.
+  std::vector<double> constants_;      ///< Constant pool.
+  std::vector<Reduction> reductions_;  ///< Bodies of sums and products.
+  std::size_t depth_ = 0;              ///< Current stack depth while building.
+  std::size_t max_depth_ = 0;          ///< Stack size required for evaluation.
+};
+
+/**
+ * @struct Program::Reduction
+ * @brief The body of a sum or a product and the slot of its index.
+ */
+struct Program::Reduction {
+  Program body;
+  std::uint32_t slot;
+};
+
+/**
+ * @class ProgramView
+ *
+ * @brief Evaluates a compiled expression without owning it.
+ *
+ * A view points at the instructions and constants of a Program, or of a
+ * program mapped from a ProgramFile, and is valid as long as they are. It is
+ * a few pointers, so it is passed by value and made for free; a Program
+ * converts to a view implicitly, so the functions taking a view accept
+ * either.
+ */
+class ProgramView {
+ public:
+  ProgramView() noexcept = default;
+
+  /**
+   * @brief Views @p program, which must outlive the view and stay unchanged.
+   */
+  ProgramView(const Program& program) noexcept;
+
+  /**
+   * @brief Evaluates the program for a single x value.
+   *
+   * @param[in] x The value of the variable 'x'.
+   * @return The result of the expression.
+   */
+  double Evaluate(double x) const;
+
+  /**
+   * @brief Evaluates the program and its derivative for a single x value.
+   *
+   * @param[in] x The value of the variable 'x'.
+   * @param[out] derivative The value of f'(x).
+   * @return The result of the expression.
+   */
+  double EvaluateWithDerivative(double x, double& derivative) const;
+
+  /**
+   * @brief Evaluates the program for an array of x values.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] result The output array, at least @p count elements.
+   * @param[in] count The number of values to evaluate.
+   */
+  void Evaluate(const double* x, double* result, std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program and its derivative for an array of x values.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] result The output array for f(x).
+   * @param[out] derivative The output array for f'(x).
+   * @param[in] count The number of values to evaluate.
+   */
+  void EvaluateWithDerivative(const double* x, double* result,
+                              double* derivative, std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program at a single point (x, y).
+   *
+   * @param[in] x The value of the variable 'x'.
+   * @param[in] y The value of the variable 'y'.
+   * @return The result of the expression.
+   */
+  double EvaluateXY(double x, double y) const;
+
+  /**
+   * @brief Evaluates the program at an array of points (x, y).
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[in] y The values of the variable 'y'.
+   * @param[out] result The output array, at least @p count elements.
+   * @param[in] count The number of points to evaluate.
+   */
+  void EvaluateXY(const double* x, const double* y, double* result,
+                  std::size_t count) const;
+
+  /**
+   * @brief Bounds the program over the rectangle of @p x and @p y.
+   *
+   * @param[in] x The range of the variable 'x'.
+   * @param[in] y The range of the variable 'y'.
+   * @return A range holding the value of the expression at every point of
+   * the rectangle where it is a number, empty if it is nowhere.
+   */
+  Interval EvaluateXY(Interval x, Interval y) const;
+
+  /**
+   * @brief Bounds the program over an array of rectangles.
+   *
+   * @param[in] x The ranges of the variable 'x'.
+   * @param[in] y The ranges of the variable 'y'.
+   * @param[out] result The output array, at least @p count elements.
+   * @param[in] count The number of rectangles to evaluate.
+   */
+  void EvaluateXY(const Interval* x, const Interval* y, Interval* result,
+                  std::size_t count) const;
+
+  /**
+   * @brief Evaluates the program for an array of x values in single
+   * precision, falling back to double where that is not accurate enough.
+   *
+   * Meant for plotting, which needs the values to a fraction of a pixel.
+   * The stack rows hold floats, so twice as many values fit in a vector
+   * register, and the float library functions are cheaper. Each row carries
+   * the range of its values and an estimate of their largest rounding error,
+   * carried through the program from the error of x. A block of values whose
+   * estimate exceeds @p tolerance, as after a cancellation, for a large
+   * argument of a trigonometric function or near a pole, is evaluated again
+   * in double, as are blocks containing a sum or a product.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] result The output array, at least @p count elements.
+   * @param[in] count The number of values to evaluate.
+   * @param[in] tolerance The absolute error allowed; zero or less evaluates
+   * everything in double.
+   * @return The number of values evaluated in double.
+   */
+  std::size_t EvaluateFast(const double* x, double* result, std::size_t count,
+                           double tolerance) const;
+
+  /**
+   * @brief Returns true if the program holds no instructions.
+   */
+  bool Empty() const noexcept { return size_ == 0; }
+
+ private:
+  friend class ProgramFile;
+  friend class ProgramSet;
+
+  /// Number of x values evaluated together by the batch mode.
+  static constexpr std::size_t kBlockSize = 256;
+
+  /**
+   * @brief Returns the body of reduction @p index and stores the slot of its
+   * index in @p slot.
+   */
+  ProgramView Body(std::uint32_t index, std::uint32_t& slot) const noexcept;
+
+  /**
+   * @brief Runs the instructions over @p lanes values of type T.
+   *
+   * The stack is laid out as rows of @p stride elements, one row per stack
+   * slot, so each instruction is a tight loop over a contiguous row.
+   *
+   * @param[in] variables One row of @p lanes values per variable slot.
+   */
+  template <typename T>
+  void Run(const T* const* variables, T* result, std::size_t lanes,
+           std::size_t stride, T* stack) const;
+
+  /**
+   * @brief Runs the instructions over a block of float values of x.
+   *
+   * @param[in] x_bound The range and the error of the values of x.
+   * @param[in] stack One row per stack slot.
+   * @param[in] bounds One bound per stack slot, B being the Bound of the
+   * implementation.
+   * @return The estimated largest error of the results, infinite if the
+   * program cannot be run in float.
+   */
+  template <typename B>
+  float RunSingle(const float* x, const B& x_bound, float* result,
+                  float* stack, B* bounds) const;
+
+  /**
+   * @brief Computes a sum or a product for a single set of enclosing values.
+   *
+   * @param[in] op kSum or kProduct.
+   * @param[in] body The term.
+   * @param[in] slot The variable slot of the index.
+   * @param[in] outer The values of the variable slots below the index.
+   * @param[in] lower The lower bound of the index.
+   * @param[in] upper The upper bound of the index.
+   */
+  template <typename T>
+  static T Reduce(OpCode op, const ProgramView& body, std::uint32_t slot,
+                  const T* outer, T lower, T upper);
+
+  const Instruction* code_ = nullptr;  ///< Instructions in postfix order.
+  std::size_t size_ = 0;               ///< Number of instructions.
+  const double* constants_ = nullptr;  ///< Constant pool.
+  std::size_t max_depth_ = 0;          ///< Stack size required.
+  /// Bodies of the sums and products of a Program, or nullptr.
+  const Program::Reduction* reductions_ = nullptr;
+  /// Start of the mapped file of a stored program, or nullptr.
+  const unsigned char* image_ = nullptr;
+  /// Offsets of the bodies of a stored program in the file.
+  const std::uint64_t* bodies_ = nullptr;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_PROGRAM_H
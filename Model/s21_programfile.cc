@@ -0,0 +1,295 @@
+/**
+ * @file s21_programfile.cc
+ * @brief Implementation file for the s21_programfile.h.
+ */
+
+#include "s21_programfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "s21_library.h"
+#include "s21_model.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', '2', '1', 'P', 'R', 'O', 'G', 'S'};
+constexpr std::uint32_t kVersion = 2;
+/// Slot of a whole expression: it may read the variables, up to 'y'.
+constexpr std::uint32_t kTopSlot = kVariableCount - 1;
+/// Alignment of the records, that of their constants.
+constexpr std::size_t kAlignment = 8;
+/// Deepest nesting of sums and products accepted from a file.
+constexpr std::uint32_t kMaxNesting = 64;
+/// Largest stack accepted from a file; parsed programs stay far below it.
+constexpr std::uint32_t kMaxDepth = 4096;
+
+static_assert(sizeof(Instruction) == 8 &&
+                  std::is_trivially_copyable_v<Instruction>,
+              "instructions are stored as they are laid out in memory");
+
+/// Appends the bytes of @p value to @p out.
+template <typename T>
+void Append(const T* value, std::size_t count,
+            std::vector<unsigned char>& out) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(value);
+  out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+}
+
+/// Pads @p out with zeros to a multiple of kAlignment.
+void Align(std::vector<unsigned char>& out) {
+  out.resize((out.size() + kAlignment - 1) / kAlignment * kAlignment);
+}
+
+}  // namespace
+
+ProgramFile::ProgramFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::invalid_argument("Invalid input");
+  struct stat status {};
+  bool is_mapped = false;
+  if (fstat(fd, &status) == 0 &&
+      static_cast<std::size_t>(status.st_size) >= sizeof(Header)) {
+    size_ = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    is_mapped = data != MAP_FAILED;
+    if (is_mapped) data_ = static_cast<unsigned char*>(data);
+  }
+  close(fd);
+  if (!is_mapped) {
+    size_ = 0;
+    throw std::invalid_argument("Invalid input");
+  }
+
+  Header header;
+  std::memcpy(&header, data_, sizeof(Header));
+  count_ = header.count;
+  bool is_valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                  header.version == kVersion && header.size == size_ &&
+                  count_ <= (size_ - sizeof(Header)) / sizeof(Entry);
+  if (!is_valid) {
+    munmap(data_, size_);
+    throw std::invalid_argument("Invalid input");
+  }
+}
+
+/**
+ * @details The expressions are compiled first, so the sizes of the index and
+ * of the texts are known and the records can be appended with their final
+ * offsets. The file is written in one go.
+ */
+std::size_t ProgramFile::Compile(const std::string& path,
+                                 const std::vector<std::string>& expressions,
+                                 const Library* library) {
+  std::map<std::string, Program> programs;
+  for (const std::string& expression : expressions) {
+    try {
+      Model model;
+      model.SetLibrary(library);
+      model.SetInput(expression);
+      Program program = model.CompileMathExpression();
+      programs.emplace(library ? library->Expand(expression) : expression,
+                       std::move(program));
+    } catch (...) {
+      continue;
+    }
+  }
+
+  std::vector<Entry> entries;
+  std::uint64_t offset = sizeof(Header) + programs.size() * sizeof(Entry);
+  for (const auto& [text, program] : programs) {
+    entries.push_back({Hash(text), offset,
+                       static_cast<std::uint32_t>(text.size()), 0, 0});
+    offset += text.size();
+  }
+  std::vector<unsigned char> out(offset);
+  auto entry = entries.begin();
+  for (const auto& [text, program] : programs) {
+    std::memcpy(out.data() + entry->text, text.data(), text.size());
+    Align(out);
+    (entry++)->program = Write(program, kTopSlot, out);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+  Header header{{}, kVersion, static_cast<std::uint32_t>(entries.size()),
+                out.size(), 0};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  std::memcpy(out.data(), &header, sizeof(Header));
+  std::memcpy(out.data() + sizeof(Header), entries.data(),
+              entries.size() * sizeof(Entry));
+
+  std::string temporary = path + ".tmp";
+  std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(out.data()),
+             static_cast<std::streamsize>(out.size()));
+  file.close();
+  if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw std::invalid_argument("Invalid input");
+  }
+  return entries.size();
+}
+
+std::uint64_t ProgramFile::Hash(std::string_view text) noexcept {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for (char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+ProgramFile::ProgramFile(ProgramFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+ProgramFile& ProgramFile::operator=(ProgramFile&& other) noexcept {
+  if (this != &other) {
+    if (data_) munmap(data_, size_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    count_ = std::exchange(other.count_, 0);
+  }
+  return *this;
+}
+
+ProgramFile::~ProgramFile() {
+  if (data_) munmap(data_, size_);
+}
+
+std::optional<ProgramView> ProgramFile::Find(
+    std::string_view text) const noexcept {
+  const auto* entries =
+      reinterpret_cast<const Entry*>(data_ + sizeof(Header));
+  std::uint64_t hash = Hash(text);
+  const Entry* entry = std::lower_bound(
+      entries, entries + count_, hash,
+      [](const Entry& e, std::uint64_t h) { return e.hash < h; });
+  for (; entry != entries + count_ && entry->hash == hash; ++entry) {
+    bool is_match = entry->text <= size_ && entry->text_size == text.size() &&
+                    entry->text_size <= size_ - entry->text &&
+                    std::memcmp(data_ + entry->text, text.data(),
+                                text.size()) == 0;
+    if (!is_match) continue;
+    if (!IsValid(entry->program, kTopSlot)) return std::nullopt;
+    std::uint32_t slot = kTopSlot;
+    return Record(data_, entry->program, slot);
+  }
+  return std::nullopt;
+}
+
+/**
+ * @details The bodies are written before the program, so their offsets are
+ * known when its record is written and every body lies before its parent.
+ */
+std::uint64_t ProgramFile::Write(const Program& program, std::uint32_t slot,
+                                 std::vector<unsigned char>& out) {
+  std::vector<std::uint64_t> bodies;
+  for (const Program::Reduction& reduction : program.reductions_)
+    bodies.push_back(Write(reduction.body, reduction.slot, out));
+
+  Align(out);
+  std::uint64_t offset = out.size();
+  RecordHeader header{static_cast<std::uint32_t>(program.code_.size()),
+                      static_cast<std::uint32_t>(program.constants_.size()),
+                      static_cast<std::uint32_t>(bodies.size()),
+                      static_cast<std::uint32_t>(program.max_depth_), slot, 0};
+  Append(&header, 1, out);
+  for (const Instruction& instruction : program.code_) {
+    Instruction stored;  // Zeroed first, so the padding bytes are too
+    std::memset(&stored, 0, sizeof(Instruction));
+    stored.op = instruction.op;
+    stored.operand = instruction.operand;
+    Append(&stored, 1, out);
+  }
+  Append(program.constants_.data(), program.constants_.size(), out);
+  Append(bodies.data(), bodies.size(), out);
+  return offset;
+}
+
+ProgramView ProgramFile::Record(const unsigned char* image,
+                                std::uint64_t offset,
+                                std::uint32_t& slot) noexcept {
+  RecordHeader header;
+  std::memcpy(&header, image + offset, sizeof(RecordHeader));
+  const unsigned char* data = image + offset + sizeof(RecordHeader);
+  ProgramView view;
+  view.code_ = reinterpret_cast<const Instruction*>(data);
+  view.size_ = header.code_size;
+  data += sizeof(Instruction) * header.code_size;
+  view.constants_ = reinterpret_cast<const double*>(data);
+  data += sizeof(double) * header.constant_count;
+  view.max_depth_ = header.max_depth;
+  view.image_ = image;
+  view.bodies_ = reinterpret_cast<const std::uint64_t*>(data);
+  slot = header.slot;
+  return view;
+}
+
+/**
+ * @details The stack depth is replayed instruction by instruction as in
+ * Program::PushOperation, so a malformed file cannot make the evaluation
+ * read outside the stack, the constants, the variables or the file.
+ */
+bool ProgramFile::IsValid(std::uint64_t offset,
+                          std::uint32_t slot) const noexcept {
+  if (offset % kAlignment != 0 || offset < sizeof(Header) ||
+      offset > size_ - sizeof(RecordHeader))
+    return false;
+  RecordHeader header;
+  std::memcpy(&header, data_ + offset, sizeof(RecordHeader));
+  std::uint64_t bytes = sizeof(RecordHeader) +
+                        sizeof(Instruction) * std::uint64_t{header.code_size} +
+                        sizeof(double) * std::uint64_t{header.constant_count} +
+                        8 * std::uint64_t{header.reduction_count};
+  if (bytes > size_ - offset || header.slot != slot ||
+      header.max_depth > kMaxDepth)
+    return false;
+
+  ProgramView view = Record(data_, offset, slot);
+  std::size_t depth = 0;
+  for (std::size_t i = 0; i < view.size_; ++i) {
+    Instruction instruction;
+    std::memcpy(&instruction, view.code_ + i, sizeof(Instruction));
+    if (instruction.op > kLastOpCode) return false;
+    auto arity = static_cast<std::size_t>(Arity(instruction.op));
+    if (depth < arity) return false;
+    depth = depth - arity + 1;
+    if (depth > header.max_depth) return false;
+    std::uint32_t operand = instruction.operand;
+    switch (instruction.op) {
+      case OpCode::kConstant:
+        if (operand >= header.constant_count) return false;
+        break;
+      case OpCode::kVariable:
+        if (operand > slot) return false;
+        break;
+      case OpCode::kSum:
+      case OpCode::kProduct:
+        if (operand >= header.reduction_count || slot >= kMaxNesting ||
+            view.bodies_[operand] >= offset ||
+            !IsValid(view.bodies_[operand], slot + 1))
+          return false;
+        break;
+      default:
+        break;
+    }
+  }
+  return depth == 1;
+}
+
+}  // namespace s21
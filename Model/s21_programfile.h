@@ -0,0 +1,188 @@
+/**
+ * @file s21_programfile.h
+ * @brief Header file containing the declaration of the ProgramFile, a
+ * memory-mapped library of compiled expressions.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_PROGRAMFILE_H
+#define SMARTCALC_MODEL_S21_PROGRAMFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+class Library;
+
+/**
+ * @class ProgramFile
+ *
+ * @brief A binary file of compiled expressions, mapped into memory and
+ * evaluated in place.
+ *
+ * The file starts with a 32-byte header: the magic "S21PROGS", the format
+ * version, the number of expressions and the size of the file. An index
+ * follows with one 32-byte entry per expression, sorted by hash: the hash of
+ * the expression text, the offset and the size of the text and the offset of
+ * its program. Then come the texts and, from the next multiple of 8 bytes,
+ * the programs.
+ *
+ * A program is a 24-byte record header (the numbers of instructions,
+ * constants and reductions, the stack size and the variable slot of the
+ * reduction index, 1 for a whole expression, which reads 'x' and 'y')
+ * followed by its instructions, its constants and the offsets of the bodies
+ * of its sums and products, which are programs stored before it. Everything
+ * is in host byte order and 8-byte aligned, so a ProgramView points straight
+ * into the mapping.
+ *
+ * The texts are the expressions with the user definitions inlined, as the
+ * parser sees them. An expression whose definitions changed since the file
+ * was written expands to another text, hashes differently and is not found,
+ * so a stale file never gives a stale result.
+ *
+ * Opening the file checks its header only. Find checks the entry and the
+ * program it returns, which touches just their pages, so opening a library
+ * of thousands of expressions costs the same as opening one and nothing is
+ * allocated per expression.
+ *
+ * Mapping uses the POSIX mmap interface.
+ */
+class ProgramFile {
+ public:
+  /**
+   * @brief Maps an existing file for reading.
+   *
+   * @param[in] path The file to open.
+   * @throws std::invalid_argument if the file cannot be mapped or its header
+   * is not that of a program file of the current version.
+   */
+  explicit ProgramFile(const std::string& path);
+
+  /**
+   * @brief Compiles expressions and writes them to a file.
+   *
+   * Expressions that do not compile are skipped and repeated ones are
+   * written once. The file is written under a temporary name and renamed
+   * over @p path, so a running calculator that maps the old file keeps it
+   * whole and maps the new one at its next start.
+   *
+   * @param[in] path The file to create or overwrite.
+   * @param[in] expressions The expressions.
+   * @param[in] library The definitions the expressions may use, or nullptr.
+   * @return The number of expressions written.
+   * @throws std::invalid_argument if the file cannot be written.
+   */
+  static std::size_t Compile(const std::string& path,
+                             const std::vector<std::string>& expressions,
+                             const Library* library = nullptr);
+
+  /**
+   * @brief Returns the 64-bit FNV-1a hash of an expression text.
+   */
+  static std::uint64_t Hash(std::string_view text) noexcept;
+
+  ProgramFile(ProgramFile&& other) noexcept;
+  ProgramFile& operator=(ProgramFile&& other) noexcept;
+  ProgramFile(const ProgramFile&) = delete;
+  ProgramFile& operator=(const ProgramFile&) = delete;
+
+  /**
+   * @brief Unmaps the file, invalidating the views returned by Find.
+   */
+  ~ProgramFile();
+
+  /**
+   * @brief Returns the number of expressions.
+   */
+  std::size_t Size() const noexcept { return count_; }
+
+  /**
+   * @brief Looks up an expression.
+   *
+   * @param[in] text The expression with the user definitions inlined.
+   * @return A view of its program, valid while the file is open, or
+   * std::nullopt if the file has no such expression or its entry is
+   * malformed.
+   */
+  std::optional<ProgramView> Find(std::string_view text) const noexcept;
+
+ private:
+  friend class ProgramView;
+
+  /**
+   * @struct Header
+   * @brief The fixed part at the start of the file.
+   */
+  struct Header {
+    char magic[8];           ///< "S21PROGS".
+    std::uint32_t version;   ///< Format version, 1.
+    std::uint32_t count;     ///< Number of expressions.
+    std::uint64_t size;      ///< Size of the file in bytes.
+    std::uint64_t reserved;  ///< Zero.
+  };
+
+  /**
+   * @struct Entry
+   * @brief The index entry of an expression.
+   */
+  struct Entry {
+    std::uint64_t hash;       ///< Hash of the text.
+    std::uint64_t text;       ///< Offset of the text.
+    std::uint32_t text_size;  ///< Bytes of text.
+    std::uint32_t reserved;   ///< Zero.
+    std::uint64_t program;    ///< Offset of the program record.
+  };
+
+  /**
+   * @struct RecordHeader
+   * @brief The fixed part of a stored program.
+   */
+  struct RecordHeader {
+    std::uint32_t code_size;        ///< Number of instructions.
+    std::uint32_t constant_count;   ///< Number of constants.
+    std::uint32_t reduction_count;  ///< Number of sums and products.
+    std::uint32_t max_depth;        ///< Stack size required.
+    std::uint32_t slot;             ///< Variable slot of a reduction index.
+    std::uint32_t reserved;         ///< Zero.
+  };
+
+  ProgramFile() noexcept = default;
+
+  /**
+   * @brief Appends the record of @p program and of its bodies to @p out.
+   *
+   * @return The offset of the record of @p program.
+   */
+  static std::uint64_t Write(const Program& program, std::uint32_t slot,
+                             std::vector<unsigned char>& out);
+
+  /**
+   * @brief Returns a view of the program stored at @p offset of @p image and
+   * stores the variable slot of its index in @p slot.
+   */
+  static ProgramView Record(const unsigned char* image, std::uint64_t offset,
+                            std::uint32_t& slot) noexcept;
+
+  /**
+   * @brief Checks that the program at @p offset lies in the file, that its
+   * operands are in range and that it leaves one value on the stack.
+   *
+   * @param[in] slot The variable slot of its index, that of 'y' for a
+   * whole expression; the program may read the slots up to it.
+   */
+  bool IsValid(std::uint64_t offset, std::uint32_t slot) const noexcept;
+
+  unsigned char* data_ = nullptr;  ///< Start of the mapping.
+  std::size_t size_ = 0;           ///< Size of the mapping in bytes.
+  std::size_t count_ = 0;          ///< Number of expressions.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_PROGRAMFILE_H
@@ -0,0 +1,133 @@
+/**
+ * @file s21_programset.cc
+ * @brief Implementation file for the s21_programset.h.
+ */
+
+#include "s21_programset.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace s21 {
+
+std::size_t ProgramSet::Add(ProgramView program) {
+  if (program.Empty()) throw std::invalid_argument("Invalid input");
+  std::size_t index = outputs_.size();
+  const Instruction* end = program.code_ + program.size_;
+  bool is_fusable =
+      std::none_of(program.code_, end, [](const Instruction& instruction) {
+        return instruction.op == OpCode::kSum ||
+               instruction.op == OpCode::kProduct ||
+               (instruction.op == OpCode::kVariable &&
+                instruction.operand != 0);
+      });
+  if (!is_fusable) {
+    separate_.emplace_back(index, program);
+    outputs_.push_back(kNone);
+    return index;
+  }
+
+  std::vector<std::uint32_t> stack;
+  for (const Instruction* it = program.code_; it != end; ++it) {
+    Node node{it->op, {kNone, kNone, kNone}, 0.0};
+    if (it->op == OpCode::kConstant) {
+      node.constant = program.constants_[it->operand];
+    } else if (it->op != OpCode::kVariable) {  // Only x once fusable
+      for (int k = Arity(it->op) - 1; k >= 0; --k) {
+        node.operands[k] = stack.back();
+        stack.pop_back();
+      }
+      bool is_commutative = it->op == OpCode::kAdd ||
+                            it->op == OpCode::kMul ||
+                            it->op == OpCode::kEqual ||
+                            it->op == OpCode::kNotEqual;
+      if (is_commutative && node.operands[1] < node.operands[0])
+        std::swap(node.operands[0], node.operands[1]);
+    }
+    stack.push_back(Intern(node));
+  }
+  outputs_.push_back(stack.back());
+  return index;
+}
+
+/**
+ * @details The rows are planned once per call: an operation takes the row
+ * of its first operand when it is that operand's last reader, or else a
+ * free row, and the rows of its other operands read for the last time are
+ * freed after it. The results are copied out as soon as they are computed,
+ * before a later operation may write over them.
+ */
+void ProgramSet::Evaluate(const double* x, double* const* results,
+                          std::size_t count) const {
+  std::size_t size = nodes_.size();
+  std::vector<std::uint32_t> last(size, kNone);  // Last reader
+  for (std::uint32_t i = 0; i < size; ++i)
+    for (std::uint32_t operand : nodes_[i].operands)
+      if (operand != kNone) last[operand] = i;
+  std::vector<std::vector<std::size_t>> functions(size);
+  for (std::size_t f = 0; f < outputs_.size(); ++f)
+    if (outputs_[f] != kNone) functions[outputs_[f]].push_back(f);
+
+  std::vector<std::uint32_t> rows(size), free_rows;
+  std::vector<bool> is_in_place(size);
+  std::uint32_t row_count = 0;
+  for (std::uint32_t i = 0; i < size; ++i) {
+    const std::uint32_t* operands = nodes_[i].operands;
+    is_in_place[i] = operands[0] != kNone && last[operands[0]] == i;
+    if (is_in_place[i]) {
+      rows[i] = rows[operands[0]];
+    } else if (!free_rows.empty()) {
+      rows[i] = free_rows.back();
+      free_rows.pop_back();
+    } else {
+      rows[i] = row_count++;
+    }
+    for (int k = 1; k < 3; ++k) {
+      std::uint32_t operand = operands[k];
+      bool is_repeated = operand == operands[0] ||
+                         (k == 2 && operand == operands[1]);
+      if (operand != kNone && last[operand] == i && !is_repeated)
+        free_rows.push_back(rows[operand]);
+    }
+    if (last[i] == kNone) free_rows.push_back(rows[i]);  // Only an output
+  }
+
+  std::vector<double> stack(row_count * kBlockSize);
+  auto row = [&](std::uint32_t node) {
+    return node == kNone ? nullptr : stack.data() + rows[node] * kBlockSize;
+  };
+  for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+    std::size_t lanes = std::min(kBlockSize, count - begin);
+    for (std::uint32_t i = 0; i < size; ++i) {
+      const Node& node = nodes_[i];
+      double* target = row(i);
+      if (node.op == OpCode::kConstant) {
+        std::fill_n(target, lanes, node.constant);
+      } else if (node.op == OpCode::kVariable) {
+        std::copy_n(x + begin, lanes, target);
+      } else {
+        if (!is_in_place[i]) std::copy_n(row(node.operands[0]), lanes, target);
+        Apply(node.op, target, row(node.operands[1]), row(node.operands[2]),
+              lanes);
+      }
+      for (std::size_t f : functions[i])
+        std::copy_n(target, lanes, results[f] + begin);
+    }
+  }
+  for (const auto& [f, program] : separate_)
+    program.Evaluate(x, results[f], count);
+}
+
+std::uint32_t ProgramSet::Intern(const Node& node) {
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &node.constant, sizeof(bits));
+  Key key{node.op, node.operands[0], node.operands[1], node.operands[2],
+          bits};
+  auto [it, is_new] =
+      index_.emplace(key, static_cast<std::uint32_t>(nodes_.size()));
+  if (is_new) nodes_.push_back(node);
+  return it->second;
+}
+
+}  // namespace s21
@@ -0,0 +1,114 @@
+/**
+ * @file s21_programset.h
+ * @brief Header file containing the declaration of the ProgramSet, several
+ * compiled expressions evaluated together.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_PROGRAMSET_H
+#define SMARTCALC_MODEL_S21_PROGRAMSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class ProgramSet
+ *
+ * @brief Functions of x fused into one graph of operations, evaluated in a
+ * single pass over a shared array of x values.
+ *
+ * Adding a function replays its program on a stack of operation numbers.
+ * An operation already in the set with the same operands is reused, so a
+ * constant, x itself or a subexpression such as sin(x) shared by several
+ * functions, or repeated within one, is computed once per value of x. The
+ * operands of additions, multiplications and equality tests are put in a
+ * fixed order first, so x+1 and 1+x are one operation as well.
+ *
+ * The evaluation runs every operation over a block of x values at a time,
+ * as the batch mode of Program does, and with the same kernels, so each
+ * function gives exactly the values of its own program. The rows of the
+ * block are assigned so that a row is reused as soon as its last reader
+ * has run, and an operation whose first operand is not read again writes
+ * over it in place.
+ *
+ * Sums and products cannot be fused; a function containing one, or reading
+ * the variable 'y', is kept as a view and evaluated on its own.
+ */
+class ProgramSet {
+ public:
+  ProgramSet() = default;
+
+  /**
+   * @brief Adds a function to the set.
+   *
+   * @param[in] program The compiled function; with a sum, a product or 'y'
+   * it must outlive the set.
+   * @return The index of the function.
+   * @throws std::invalid_argument if the program is empty.
+   */
+  std::size_t Add(ProgramView program);
+
+  /**
+   * @brief Returns the number of functions.
+   */
+  std::size_t Size() const noexcept { return outputs_.size(); }
+
+  /**
+   * @brief Returns the number of distinct operations of the fused functions.
+   */
+  std::size_t Operations() const noexcept { return nodes_.size(); }
+
+  /**
+   * @brief Evaluates every function for an array of x values.
+   *
+   * @param[in] x The values of the variable 'x'.
+   * @param[out] results One output array of @p count elements per function,
+   * in the order they were added.
+   * @param[in] count The number of values to evaluate.
+   */
+  void Evaluate(const double* x, double* const* results,
+                std::size_t count) const;
+
+ private:
+  /// Number of x values evaluated together.
+  static constexpr std::size_t kBlockSize = 256;
+  /// Operand or output slot that is not used.
+  static constexpr std::uint32_t kNone = UINT32_MAX;
+
+  /**
+   * @struct Node
+   * @brief An operation of the graph; operands precede it.
+   */
+  struct Node {
+    OpCode op;
+    std::uint32_t operands[3];  ///< Operation numbers, kNone past the arity.
+    double constant;            ///< The value of a kConstant.
+  };
+
+  /// Identity of an operation: the code, the operands and the bits of the
+  /// constant.
+  using Key = std::tuple<OpCode, std::uint32_t, std::uint32_t, std::uint32_t,
+                         std::uint64_t>;
+
+  /**
+   * @brief Returns the number of an operation, adding it if it is new.
+   */
+  std::uint32_t Intern(const Node& node);
+
+  std::vector<Node> nodes_;                 ///< In evaluation order.
+  std::map<Key, std::uint32_t> index_;      ///< Numbers of the operations.
+  std::vector<std::uint32_t> outputs_;      ///< Result of each function.
+  std::vector<std::pair<std::size_t, ProgramView>>
+      separate_;  ///< Functions with a sum or a product, by index.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_PROGRAMSET_H
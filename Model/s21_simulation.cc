@@ -0,0 +1,274 @@
+/**
+ * @file s21_simulation.cc
+ * @brief Implementation file for the s21_simulation.h.
+ */
+
+#include "s21_simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+/// Paths per block; fixed so the merged statistics are reproducible.
+constexpr std::uint64_t kBlockPaths = 4096;
+/// Blocks per chunk of a window; the blocks of a window are simulated
+/// together and merged, in order, before the next window starts.
+constexpr std::size_t kWindowChunkBlocks = 16;
+/// Paths advanced together through the resets, sized to stay in L1.
+constexpr std::size_t kLanes = 256;
+/// Histogram bins; bin 0 counts zero interest.
+constexpr int kBins = 8192;
+/// Bin of the value 1, leaving room down to about 1e-9.
+constexpr int kOffset = 2048;
+const double kGamma = (1 + Simulation::kAccuracy) / (1 - Simulation::kAccuracy);
+const double kLogGamma = std::log(kGamma);
+constexpr double kTwoPi = 6.283185307179586;
+
+/**
+ * @brief Philox4x32-10 counter-based generator.
+ *
+ * Returns four random words for the counter {c0, c1, c2, 0} under the
+ * 64-bit key; equal inputs always give equal outputs.
+ */
+void Philox(std::uint64_t key, std::uint64_t path, std::uint32_t stream,
+            std::uint32_t out[4]) noexcept {
+  std::uint32_t c[4] = {static_cast<std::uint32_t>(path),
+                        static_cast<std::uint32_t>(path >> 32), stream, 0};
+  std::uint32_t k0 = static_cast<std::uint32_t>(key);
+  std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t p0 = std::uint64_t{0xD2511F53} * c[0];
+    std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * c[2];
+    std::uint32_t next[4] = {
+        static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0,
+        static_cast<std::uint32_t>(p1),
+        static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1,
+        static_cast<std::uint32_t>(p0)};
+    std::copy(next, next + 4, c);
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+  std::copy(c, c + 4, out);
+}
+
+/// Maps two random words to a uniform number in (0, 1).
+double Uniform(std::uint32_t high, std::uint32_t low) noexcept {
+  std::uint64_t bits = ((std::uint64_t{high} << 32) | low) >> 11;
+  return (bits + 0.5) * 0x1p-53;
+}
+
+}  // namespace
+
+/**
+ * @struct Simulation::Block
+ * @brief Moments of the interest over one block of paths.
+ */
+struct Simulation::Block {
+  std::size_t count = 0;
+  std::size_t prepaid = 0;
+  double mean = 0.0;
+  double m2 = 0.0;  ///< Sum of squared deviations from the mean.
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+
+  /// Merges @p other with the parallel update of Chan et al.
+  void Merge(const Block& other) noexcept {
+    if (other.count == 0) return;
+    double total = static_cast<double>(count + other.count);
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    count += other.count;
+    prepaid += other.prepaid;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+};
+
+/**
+ * @struct Simulation::Histogram
+ * @brief Counts of the interest in bins of geometric width kGamma.
+ */
+struct Simulation::Histogram {
+  std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(kBins);
+
+  void Add(double value) noexcept {
+    int bin = 0;
+    if (value > 0) {
+      double index = std::ceil(std::log(value) / kLogGamma) + kOffset;
+      bin = static_cast<int>(std::clamp(index, 1.0, kBins - 1.0));
+    }
+    ++counts[bin];
+  }
+
+  /// Returns the value of bin @p bin, within kAccuracy of its contents.
+  static double Value(int bin) noexcept {
+    if (bin == 0) return 0.0;
+    return 2 * std::pow(kGamma, bin - kOffset) / (kGamma + 1);
+  }
+};
+
+Simulation::Result Simulation::Simulate(
+    const Scenario& scenario, const std::vector<double>& probabilities) const {
+  if (scenario.k <= 0 || scenario.term <= 0 ||
+      !std::isfinite(scenario.amount) || !(scenario.rate >= 0) ||
+      !std::isfinite(scenario.rate) ||
+      (scenario.type != 'a' && scenario.type != 'd') ||
+      !(scenario.volatility >= 0) || !std::isfinite(scenario.volatility) ||
+      scenario.reset <= 0 || !(scenario.prepayment >= 0) ||
+      scenario.prepayment > 1 || scenario.paths == 0)
+    throw std::invalid_argument("Invalid input");
+  for (double p : probabilities) {
+    if (!(p >= 0 && p <= 1)) throw std::invalid_argument("Invalid input");
+  }
+
+  std::uint64_t paths = scenario.paths;
+  std::size_t blocks = (paths + kBlockPaths - 1) / kBlockPaths;
+  ThreadPool& pool = ThreadPool::Shared();
+  std::size_t window =
+      pool.Size() * ThreadPool::kChunksPerThread * kWindowChunkBlocks;
+  std::vector<Block> partial(std::min(blocks, window));
+  Histogram histogram;
+  std::mutex mutex;
+  Block total;
+  for (std::size_t first = 0; first < blocks; first += window) {
+    std::size_t count = std::min(window, blocks - first);
+    std::fill(partial.begin(), partial.begin() + count, Block());
+    pool.ParallelFor(
+        count,
+        [&](std::size_t begin, std::size_t end) {
+          Histogram local;
+          for (std::size_t b = begin; b < end; ++b) {
+            std::uint64_t path = (first + b) * kBlockPaths;
+            SimulateBlock(scenario, path,
+                          std::min<std::uint64_t>(paths, path + kBlockPaths),
+                          partial[b], local);
+          }
+          // Integer counts, so the order of the merges does not matter
+          std::lock_guard<std::mutex> lock(mutex);
+          for (int i = 0; i < kBins; ++i)
+            histogram.counts[i] += local.counts[i];
+        },
+        kWindowChunkBlocks);
+    for (std::size_t b = 0; b < count; ++b) total.Merge(partial[b]);
+  }
+
+  Result result;
+  result.paths = total.count;
+  result.prepaid = total.prepaid;
+  result.mean = total.mean;
+  result.deviation =
+      total.count > 1 ? std::sqrt(total.m2 / (total.count - 1)) : 0.0;
+  result.min = total.min;
+  result.max = total.max;
+  for (double p : probabilities) {
+    double rank = p * (total.count - 1);
+    if (rank == 0 || rank == total.count - 1) {
+      result.quantiles.push_back(rank == 0 ? total.min : total.max);
+      continue;
+    }
+    std::uint64_t seen = 0;
+    int bin = 0;
+    for (; bin < kBins - 1; ++bin) {
+      seen += histogram.counts[bin];
+      if (seen > rank) break;
+    }
+    result.quantiles.push_back(
+        std::clamp(Histogram::Value(bin), total.min, total.max));
+  }
+  return result;
+}
+
+/**
+ * @details Each run of kLanes paths steps through the resets together. With
+ * balance B, periodic rate r and L periods left in the segment before the
+ * next reset or the prepayment, the segment adds, as in
+ * CreditModel::CalculateSegments:
+ *   annuity:         P * L - (B - B'), with P the payment over the periods
+ *                    left in the term and B' = B + (g - 1) * (B - P / r),
+ *                    g = (1 + r)^L;
+ *   differentiated:  r * (L * B - d * L * (L - 1) / 2), d = amount / n.
+ * The prepayment period is the first success of a Bernoulli trial per period,
+ * drawn by inversion as ceil(log(u) / log(1 - p)). The rate shock of reset s
+ * uses stream s of the path and the prepayment uses stream 0.
+ */
+void Simulation::SimulateBlock(const Scenario& scenario, std::uint64_t begin,
+                               std::uint64_t end, Block& block,
+                               Histogram& histogram) noexcept {
+  const int n = scenario.term * scenario.k;
+  const double part = scenario.amount / n;
+  const double log_survival = std::log1p(-scenario.prepayment);
+  double balance[kLanes], rate[kLanes], interest[kLanes];
+  int last[kLanes];
+  std::uint32_t words[4];
+
+  for (std::uint64_t run = begin; run < end; run += kLanes) {
+    std::size_t lanes = static_cast<std::size_t>(std::min<std::uint64_t>(
+        end - run, kLanes));
+    int horizon = 0;
+    for (std::size_t i = 0; i < lanes; ++i) {
+      Philox(scenario.seed, run + i, 0, words);
+      double periods = std::ceil(std::log(Uniform(words[0], words[1])) /
+                                 log_survival);
+      last[i] = periods < n ? std::max(1, static_cast<int>(periods)) : n;
+      horizon = std::max(horizon, last[i]);
+      balance[i] = scenario.amount;
+      rate[i] = scenario.rate;
+      interest[i] = 0.0;
+    }
+
+    for (int month = 1, reset = 0; month <= horizon;
+         month += scenario.reset, ++reset) {
+      if (reset > 0 && scenario.volatility > 0) {
+        for (std::size_t i = 0; i < lanes; ++i) {
+          Philox(scenario.seed, run + i, reset, words);
+          double u = Uniform(words[0], words[1]);
+          double v = Uniform(words[2], words[3]);
+          double shock = std::sqrt(-2 * std::log(u)) * std::cos(kTwoPi * v);
+          rate[i] = std::max(0.0, rate[i] + scenario.volatility * shock);
+        }
+      }
+      int stop = month + scenario.reset - 1;
+      for (std::size_t i = 0; i < lanes; ++i) {
+        int length = std::max(0, std::min(stop, last[i]) - month + 1);
+        double r = rate[i] / 12.0 / 100;
+        double b = balance[i];
+        if (scenario.type == 'a') {
+          double log_growth = std::log1p(r);
+          double payment =
+              (r == 0) ? b / (n - month + 1)
+                       : b * r / -std::expm1(-(n - month + 1) * log_growth);
+          double after = (r == 0) ? b - payment * length
+                                  : b + std::expm1(length * log_growth) *
+                                            (b - payment / r);
+          interest[i] += payment * length - (b - after);
+          balance[i] = after;
+        } else {
+          interest[i] +=
+              r * (length * b - part * length * (length - 1.0) / 2);
+          balance[i] = b - part * length;
+        }
+      }
+    }
+
+    for (std::size_t i = 0; i < lanes; ++i) {
+      Block path;
+      path.count = 1;
+      path.prepaid = last[i] < n;
+      path.mean = path.min = path.max = interest[i];
+      block.Merge(path);
+      histogram.Add(interest[i]);
+    }
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,104 @@
+/**
+ * @file s21_simulation.h
+ * @brief Header file containing the declaration of the Simulation abstraction
+ * estimating the distribution of the interest paid on a credit.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_SIMULATION_H
+#define SMARTCALC_MODEL_S21_SIMULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class Simulation
+ *
+ * @brief Monte Carlo simulation of a credit under random rate paths and
+ * prepayments.
+ *
+ * Every path resets the annual rate every few periods by a normal shock,
+ * floored at zero, and the borrower repays the remaining balance at the end
+ * of each period with a fixed probability. Between two resets the rate is
+ * constant, so a path costs one closed form per reset, as in
+ * CreditModel::CalculateSegments, and the prepayment period is drawn once
+ * from its geometric distribution.
+ *
+ * The random numbers are a function of the seed, the path and the reset
+ * only (Philox4x32-10), so any path can be generated by any thread, and the
+ * paths are processed in fixed blocks whose statistics are merged in block
+ * order. The result depends on the seed, never on the number of threads.
+ * The blocks run in windows of a few per thread, each merged before the
+ * next one starts, so the memory does not grow with the number of paths.
+ *
+ * No path is stored. Quantiles come from a log-scale histogram whose bins
+ * are at most 2 * kAccuracy wide relative to their values; its counts are
+ * integers, so merging is exact.
+ */
+class Simulation {
+ public:
+  /**
+   * @struct Scenario
+   * @brief The credit and the random processes applied to it.
+   */
+  struct Scenario {
+    int k;                    ///< Periods per unit of the term, 12 or 1.
+    double amount;            ///< Loan amount.
+    int term;                 ///< Term, in units of 1 / k years.
+    double rate;              ///< Initial annual interest rate in percent.
+    char type;                ///< 'a' for annuity, 'd' for differentiated.
+    double volatility;        ///< Standard deviation of a rate shock, percent.
+    int reset;                ///< Periods between two rate resets.
+    double prepayment;        ///< Probability to repay in full each period.
+    std::size_t paths;        ///< Number of simulated paths.
+    std::uint64_t seed;       ///< Seed of the random streams.
+  };
+
+  /**
+   * @struct Result
+   * @brief Statistics of the total interest over all paths.
+   */
+  struct Result {
+    std::size_t paths = 0;           ///< Number of simulated paths.
+    std::size_t prepaid = 0;         ///< Paths repaid before the term.
+    double mean = 0.0;               ///< Mean interest.
+    double deviation = 0.0;          ///< Sample standard deviation.
+    double min = 0.0;                ///< Smallest interest.
+    double max = 0.0;                ///< Largest interest.
+    std::vector<double> quantiles;   ///< One per requested probability.
+  };
+
+  /// Relative accuracy of the quantiles.
+  static constexpr double kAccuracy = 0.005;
+
+  Simulation() noexcept = default;
+  ~Simulation() = default;
+
+  /**
+   * @brief Simulates the credit.
+   *
+   * @param[in] scenario The credit and the random processes.
+   * @param[in] probabilities The quantiles to estimate, each in [0, 1].
+   * @return The statistics of the total interest.
+   * @throws std::invalid_argument if a parameter is invalid.
+   */
+  Result Simulate(const Scenario& scenario,
+                  const std::vector<double>& probabilities) const;
+
+ private:
+  struct Block;
+  struct Histogram;
+
+  /**
+   * @brief Simulates paths [begin, end) into @p block and @p histogram.
+   */
+  static void SimulateBlock(const Scenario& scenario, std::uint64_t begin,
+                            std::uint64_t end, Block& block,
+                            Histogram& histogram) noexcept;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_SIMULATION_H
@@ -0,0 +1,219 @@
+/**
+ * @file s21_solver.cc
+ * @brief Implementation file for the s21_solver.h.
+ */
+
+#include "s21_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "s21_threadpool.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr int kMaxIterations = 100;
+constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Grid points evaluated by one thread pool task.
+constexpr std::size_t kGridGrain = 1 << 14;
+/// Brackets refined by one thread pool task.
+constexpr std::size_t kBracketGrain = 64;
+
+/// Absolute tolerance for an abscissa near @p x.
+double Tolerance(double x) noexcept {
+  return 4 * kEpsilon * std::abs(x) + std::numeric_limits<double>::min();
+}
+
+/**
+ * @brief Brent's method for a root of @p g bracketed by [a, b].
+ *
+ * @return The last iterate, the end of the final bracket where |g| is smaller.
+ */
+template <typename Function>
+std::pair<double, double> Brent(Function g, double a, double b, double fa,
+                                double fb) {
+  double c = a, fc = fa;
+  double d = b - a, e = d;
+  for (int i = 0; i < kMaxIterations; ++i) {
+    if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+      c = a;
+      fc = fa;
+      d = e = b - a;
+    }
+    if (std::abs(fc) < std::abs(fb)) {
+      a = b, b = c, c = a;
+      fa = fb, fb = fc, fc = fa;
+    }
+    double tol = Tolerance(b);
+    double m = 0.5 * (c - b);
+    if (std::abs(m) <= tol || fb == 0) break;
+
+    if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+      // Secant or inverse quadratic interpolation
+      double s = fb / fa, p, q;
+      if (a == c) {
+        p = 2 * m * s;
+        q = 1 - s;
+      } else {
+        double r = fb / fc;
+        q = fa / fc;
+        p = s * (2 * m * q * (q - r) - (b - a) * (r - 1));
+        q = (q - 1) * (r - 1) * (s - 1);
+      }
+      if (p > 0)
+        q = -q;
+      else
+        p = -p;
+      if (2 * p < std::min(3 * m * q - std::abs(tol * q), std::abs(e * q))) {
+        e = d;
+        d = p / q;
+      } else {
+        d = e = m;
+      }
+    } else {
+      d = e = m;
+    }
+    a = b;
+    fa = fb;
+    b += (std::abs(d) > tol) ? d : (m > 0 ? tol : -tol);
+    fb = g(b);
+  }
+  return {b, fb};
+}
+
+}  // namespace
+
+Solver::Result Solver::Solve(ProgramView program, double xmin, double xmax,
+                             std::size_t samples) const {
+  if (!(xmin < xmax) || !std::isfinite(xmin) || !std::isfinite(xmax) ||
+      samples == 0 || program.Empty())
+    throw std::invalid_argument("Invalid input");
+
+  // Batch evaluation of f and f' on the grid
+  std::size_t n = samples + 1;
+  double h = (xmax - xmin) / samples;
+  std::vector<double> x(n), f(n), df(n);
+  ThreadPool::Shared().ParallelFor(
+      n,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+          x[i] = (i == samples) ? xmax : xmin + h * i;
+        program.EvaluateWithDerivative(x.data() + begin, f.data() + begin,
+                                       df.data() + begin, end - begin);
+      },
+      kGridGrain);
+
+  // Bracketing of sign changes; exact zeros become degenerate brackets
+  std::vector<Bracket> roots, minima, maxima;
+  for (std::size_t i = 0; i < n; ++i) {
+    bool has_next = i + 1 < n;
+    if (f[i] == 0)
+      roots.push_back({x[i], x[i], 0, 0});
+    else if (has_next && f[i] * f[i + 1] < 0)
+      roots.push_back({x[i], x[i + 1], f[i], f[i + 1]});
+
+    if (df[i] == 0) {
+      if (i > 0 && has_next && df[i - 1] * df[i + 1] < 0)
+        (df[i - 1] < 0 ? minima : maxima).push_back({x[i], x[i], 0, 0});
+    } else if (has_next && df[i] * df[i + 1] < 0) {
+      (df[i] < 0 ? minima : maxima)
+          .push_back({x[i], x[i + 1], df[i], df[i + 1]});
+    }
+  }
+
+  auto refine_extremum = [&program](const Bracket& bracket) {
+    return RefineExtremum(program, bracket);
+  };
+  Result result;
+  result.roots = RefineAll(roots, [&program](const Bracket& bracket) {
+    return RefineRoot(program, bracket);
+  });
+  result.minima = RefineAll(minima, refine_extremum);
+  result.maxima = RefineAll(maxima, refine_extremum);
+  for (double m : result.minima)
+    result.minimum_values.push_back(program.Evaluate(m));
+  for (double m : result.maxima)
+    result.maximum_values.push_back(program.Evaluate(m));
+  return result;
+}
+
+template <typename Refine>
+std::vector<double> Solver::RefineAll(const std::vector<Bracket>& brackets,
+                                      Refine refine) {
+  std::vector<double> points(brackets.size(), kNaN);
+  ThreadPool::Shared().ParallelFor(
+      brackets.size(),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+          points[i] = refine(brackets[i]);
+      },
+      kBracketGrain);
+  points.erase(std::remove_if(points.begin(), points.end(),
+                              [](double p) { return std::isnan(p); }),
+               points.end());
+  return points;
+}
+
+/**
+ * @details Safeguarded Newton iteration: the bracket [lo, hi] with
+ * f(lo) < 0 < f(hi) shrinks on every step, and a bisection step replaces the
+ * Newton step whenever the latter leaves the bracket or converges too slowly.
+ * A sign change that is not a root makes |f| grow while the bracket shrinks,
+ * which is how poles and jumps are rejected.
+ */
+double Solver::RefineRoot(ProgramView program, const Bracket& bracket) {
+  if (bracket.a == bracket.b) return bracket.a;
+  double lo = bracket.a, hi = bracket.b;
+  if (bracket.fa > 0) std::swap(lo, hi);
+
+  double x = 0.5 * (lo + hi);
+  double dx_old = std::abs(hi - lo), dx = dx_old;
+  double derivative = 0.0;
+  double fx = program.EvaluateWithDerivative(x, derivative);
+  for (int i = 0; i < kMaxIterations && fx != 0; ++i) {
+    (fx < 0 ? lo : hi) = x;
+    double newton = x - fx / derivative;
+    bool use_newton = std::isfinite(newton) &&
+                      (newton - lo) * (newton - hi) < 0 &&
+                      std::abs(2 * fx) <= std::abs(dx_old * derivative);
+    dx_old = dx;
+    if (use_newton) {
+      dx = x - newton;
+      x = newton;
+    } else {
+      dx = 0.5 * (hi - lo);
+      x = lo + dx;
+    }
+    if (std::abs(dx) <= Tolerance(x)) break;
+    fx = program.EvaluateWithDerivative(x, derivative);
+  }
+
+  fx = program.Evaluate(x);
+  bool is_root = std::abs(fx) <= std::min(std::abs(bracket.fa),
+                                          std::abs(bracket.fb));
+  return is_root ? x : kNaN;
+}
+
+double Solver::RefineExtremum(ProgramView program, const Bracket& bracket) {
+  if (bracket.a == bracket.b) return bracket.a;
+  auto derivative = [&program](double x) {
+    double df = 0.0;
+    program.EvaluateWithDerivative(x, df);
+    return df;
+  };
+  auto [x, dfx] =
+      Brent(derivative, bracket.a, bracket.b, bracket.fa, bracket.fb);
+  bool is_extremum = std::abs(dfx) <= std::min(std::abs(bracket.fa),
+                                               std::abs(bracket.fb));
+  return is_extremum ? x : kNaN;
+}
+
+}  // namespace s21
@@ -0,0 +1,102 @@
+/**
+ * @file s21_solver.h
+ * @brief Header file containing the declaration of the Solver abstraction that
+ * locates roots and extrema of a compiled expression.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_SOLVER_H
+#define SMARTCALC_MODEL_S21_SOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_program.h"
+
+namespace s21 {
+
+/**
+ * @class Solver
+ *
+ * @brief Finds every root and local extremum of f(x) on a closed interval.
+ *
+ * The interval is sampled on a uniform grid, where f and f' are evaluated in
+ * batches. Sign changes of f bracket the roots and sign changes of f' bracket
+ * the extrema. The brackets are refined in parallel: roots with a safeguarded
+ * Newton iteration using the derivative of the Program, extrema with Brent's
+ * method applied to f'. Sign changes caused by poles or jumps are discarded.
+ */
+class Solver {
+ public:
+  /**
+   * @struct Result
+   * @brief The points found by Solve, each list sorted in ascending order.
+   */
+  struct Result {
+    std::vector<double> roots;           ///< Points where f(x) = 0.
+    std::vector<double> minima;          ///< Points of local minimum.
+    std::vector<double> maxima;          ///< Points of local maximum.
+    std::vector<double> minimum_values;  ///< f(x) at each minimum.
+    std::vector<double> maximum_values;  ///< f(x) at each maximum.
+  };
+
+  /// Default number of grid intervals used to bracket roots and extrema.
+  static constexpr std::size_t kDefaultSamples = 1 << 20;
+
+  Solver() noexcept = default;
+  ~Solver() = default;
+
+  /**
+   * @brief Finds roots and extrema of @p program on [xmin, xmax].
+   *
+   * Two roots closer than (xmax - xmin) / samples may be missed, as they do
+   * not produce a sign change on the grid. Roots of even multiplicity, such
+   * as x = 0 of x^2, do not change sign and are reported as extrema only.
+   *
+   * @param[in] program The compiled expression.
+   * @param[in] xmin The lower bound of the interval.
+   * @param[in] xmax The upper bound of the interval.
+   * @param[in] samples The number of grid intervals.
+   * @return The roots, minima and maxima.
+   * @throws std::invalid_argument if the interval or sample count is invalid.
+   */
+  Result Solve(ProgramView program, double xmin, double xmax,
+               std::size_t samples = kDefaultSamples) const;
+
+ private:
+  /**
+   * @struct Bracket
+   * @brief An interval holding a single sign change of f or f'.
+   */
+  struct Bracket {
+    double a, b;    ///< Interval bounds.
+    double fa, fb;  ///< Values of f (roots) or f' (extrema) at the bounds.
+  };
+
+  /**
+   * @brief Refines a root of f in @p bracket.
+   *
+   * Newton steps are taken while they stay inside the shrinking bracket,
+   * bisection otherwise.
+   *
+   * @return The root or NaN if the sign change is a pole or a jump.
+   */
+  static double RefineRoot(ProgramView program, const Bracket& bracket);
+
+  /**
+   * @brief Refines a root of f' in @p bracket with Brent's method.
+   *
+   * @return The extremum or NaN if the sign change is a pole or a jump.
+   */
+  static double RefineExtremum(ProgramView program, const Bracket& bracket);
+
+  /**
+   * @brief Refines every bracket in parallel and keeps the accepted points.
+   */
+  template <typename Refine>
+  static std::vector<double> RefineAll(const std::vector<Bracket>& brackets,
+                                       Refine refine);
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_SOLVER_H
@@ -0,0 +1,240 @@
+/**
+ * @file s21_threadpool.cc
+ * @brief Implementation file for the s21_threadpool.h.
+ */
+
+#include "s21_threadpool.h"
+
+#include <deque>
+#include <exception>
+#include <iterator>
+
+#include "s21_tracer.h"
+
+namespace s21 {
+
+namespace {
+
+/// Number of ThreadPool::Priority values, one lane each.
+constexpr std::size_t kLanes = 2;
+
+/// The pool the current thread works for, if it is a worker, and its deque.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+}  // namespace
+
+/**
+ * @struct ThreadPool::Job
+ * @brief A single ParallelFor call shared between the caller and workers.
+ */
+struct ThreadPool::Job {
+  const Body* body;
+  std::size_t count;
+  std::size_t chunk;   ///< Iterations per chunk.
+  std::size_t chunks;  ///< Total number of chunks.
+  std::size_t lane;    ///< The priority, as a lane of the deques.
+  CancellationToken token;
+  std::atomic<std::size_t> done{0};    ///< Number of finished chunks.
+  std::atomic<std::size_t> queued{0};  ///< Tasks waiting in the deques.
+  std::atomic<bool> is_stopped{false};    ///< Chunks left are skipped.
+  std::atomic<bool> is_cancelled{false};  ///< Skipped for the token.
+  std::mutex mutex;
+  std::condition_variable changed;  ///< Signals chunks done or queued.
+  std::exception_ptr error;
+};
+
+/**
+ * @struct ThreadPool::Task
+ * @brief The chunks [first, last) of a job.
+ */
+struct ThreadPool::Task {
+  std::shared_ptr<Job> job;
+  std::size_t first = 0;
+  std::size_t last = 0;
+};
+
+/**
+ * @struct ThreadPool::Queue
+ * @brief The deque of a worker, one lane per priority.
+ */
+struct ThreadPool::Queue {
+  std::mutex mutex;
+  std::deque<Task> lanes[kLanes];
+};
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  for (std::size_t i = 1; i < threads; ++i)
+    queues_.push_back(std::make_unique<Queue>());
+  for (std::size_t i = 1; i < threads; ++i)
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i - 1);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+ThreadPool& ThreadPool::Shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+/**
+ * @details A worker queues the loop in its own deque, and any other thread
+ * in the deque of the next worker in turn, so loops from outside the pool
+ * start spread over it.
+ */
+void ThreadPool::ParallelFor(std::size_t count, const Body& body,
+                             std::size_t grain, Priority priority,
+                             const CancellationToken& token) {
+  if (count == 0) return;
+  if (token.IsCancelled()) throw Cancelled();
+  grain = std::max<std::size_t>(grain, 1);
+  std::size_t chunks =
+      std::min((count + grain - 1) / grain, Size() * kChunksPerThread);
+  if (chunks <= 1 || workers_.empty()) {
+    body(0, count);
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->body = &body;
+  job->count = count;
+  job->chunk = (count + chunks - 1) / chunks;
+  job->chunks = (count + job->chunk - 1) / job->chunk;
+  job->lane = static_cast<std::size_t>(priority);
+  job->token = token;
+  std::size_t own = current_pool == this ? current_queue
+                                         : next_queue_++ % queues_.size();
+  Push(*queues_[own], {job, 0, job->chunks});
+  Help(*job, own);
+  if (job->error) std::rethrow_exception(job->error);
+  if (job->is_cancelled) throw Cancelled();
+}
+
+/**
+ * @details The counts change under the lock of the deque, so they never
+ * fall behind the tasks a thread may take. A worker going to sleep counts
+ * itself before it checks queued_, and a push counts its task before it
+ * checks sleeping_, so one of them sees the other.
+ */
+void ThreadPool::Push(Queue& queue, Task task) {
+  Job& job = *task.job;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.lanes[job.lane].push_back(std::move(task));
+    ++job.queued;
+    ++queued_;
+  }
+  if (sleeping_ > 0) {
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    wake_.notify_one();
+  }
+  { std::lock_guard<std::mutex> lock(job.mutex); }
+  job.changed.notify_all();
+}
+
+bool ThreadPool::Take(std::size_t own, const Job* only, Task& task) {
+  if (queued_ == 0) return false;
+  std::size_t n = queues_.size();
+  for (std::size_t lane = 0; lane < kLanes; ++lane) {
+    if (only && only->lane != lane) continue;
+    for (std::size_t k = 0; k < n; ++k) {
+      Queue& queue = *queues_[(own + k) % n];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      std::deque<Task>& tasks = queue.lanes[lane];
+      auto is_wanted = [only](const Task& t) {
+        return !only || t.job.get() == only;
+      };
+      auto found = tasks.end();
+      if (k == 0) {
+        auto back = std::find_if(tasks.rbegin(), tasks.rend(), is_wanted);
+        if (back != tasks.rend()) found = std::prev(back.base());
+      } else {
+        found = std::find_if(tasks.begin(), tasks.end(), is_wanted);
+      }
+      if (found == tasks.end()) continue;
+      task = std::move(*found);
+      tasks.erase(found);
+      --task.job->queued;
+      --queued_;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @details The chunks of a stopped job are counted as done without running,
+ * and without splitting them first.
+ */
+void ThreadPool::Run(Task task, std::size_t own) {
+  Job& job = *task.job;
+  std::size_t finished = 1;
+  if (job.is_stopped) {
+    finished = task.last - task.first;
+  } else {
+    while (task.last - task.first > 1) {
+      std::size_t middle = task.first + (task.last - task.first) / 2;
+      Push(*queues_[own], {task.job, middle, task.last});
+      task.last = middle;
+    }
+    if (job.token.IsCancelled()) {
+      job.is_cancelled = true;
+      job.is_stopped = true;
+    } else {
+      std::size_t begin = task.first * job.chunk;
+      std::size_t end = std::min(job.count, begin + job.chunk);
+      Tracer::Span span("ThreadPool::chunk", "pool");
+      try {
+        (*job.body)(begin, end);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (!job.error) job.error = std::current_exception();
+        job.is_stopped = true;
+      }
+    }
+  }
+  if ((job.done += finished) == job.chunks) {
+    std::lock_guard<std::mutex> lock(job.mutex);
+    job.changed.notify_all();
+  }
+}
+
+void ThreadPool::Help(Job& job, std::size_t own) {
+  Task task;
+  while (job.done < job.chunks) {
+    if (Take(own, &job, task)) {
+      Run(std::move(task), own);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.changed.wait(lock, [&job] {
+      return job.done == job.chunks || job.queued > 0;
+    });
+  }
+}
+
+void ThreadPool::WorkerLoop(std::size_t own) {
+  current_pool = this;
+  current_queue = own;
+  for (;;) {
+    Task task;
+    if (Take(own, nullptr, task)) {
+      Run(std::move(task), own);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++sleeping_;
+    wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    --sleeping_;
+    if (stop_) return;
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,240 @@
+/**
+ * @file s21_threadpool.h
+ * @brief Header file containing the declaration of the ThreadPool used by the
+ * Model to spread numerical work across cores.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_THREADPOOL_H
+#define SMARTCALC_MODEL_S21_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class CancellationToken
+ *
+ * @brief A flag shared by the copies of a token, checked by the thread pool
+ * before each chunk of a loop.
+ *
+ * A default token is never cancelled; Create makes one that can be. Work
+ * already started finishes, so the body of a loop is never interrupted.
+ */
+class CancellationToken {
+ public:
+  CancellationToken() noexcept = default;
+
+  /**
+   * @brief Returns a token that can be cancelled.
+   */
+  static CancellationToken Create() {
+    CancellationToken token;
+    token.flag_ = std::make_shared<std::atomic<bool>>(false);
+    return token;
+  }
+
+  /**
+   * @brief Cancels the work of every copy of the token.
+   */
+  void Cancel() const noexcept {
+    if (flag_) flag_->store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns true once the token is cancelled.
+   */
+  bool IsCancelled() const noexcept {
+    return flag_ && flag_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+/**
+ * @class Cancelled
+ * @brief Thrown by a loop whose token was cancelled before it finished.
+ */
+class Cancelled : public std::runtime_error {
+ public:
+  Cancelled() : std::runtime_error("Cancelled") {}
+};
+
+/**
+ * @class ThreadPool
+ *
+ * @brief Fixed set of worker threads executing parallel loops by work
+ * stealing.
+ *
+ * A loop is cut into chunks, and a task is a range of chunks. Each worker
+ * has its own deque of tasks: it splits the range it runs in halves, keeps
+ * the first one and pushes the other to the back of its deque, then takes
+ * its next task from the back, where the smallest and most recent ranges
+ * are. An idle worker steals from the front of the deques of the others,
+ * where the largest ranges are, so a loop spreads over the pool in a few
+ * steals and the chunks stay with the thread that split them otherwise.
+ *
+ * Every deque holds one lane per priority. Workers take the interactive
+ * tasks of every deque before any background task, so a plot issued while a
+ * batch job runs waits for the chunks already started, not for the job.
+ *
+ * The calling thread always takes part in its own loop, running only tasks
+ * of that loop, so a ParallelFor issued from inside another one (or on a
+ * pool without workers) still completes instead of waiting for a free
+ * worker.
+ */
+class ThreadPool {
+ public:
+  /// The lane a loop is queued in; the first one is served first.
+  enum class Priority { kInteractive, kBackground };
+
+  /// The body of a loop, called on each chunk.
+  using Body = std::function<void(std::size_t, std::size_t)>;
+
+  /// Chunks a loop is cut into at most, per thread.
+  static constexpr std::size_t kChunksPerThread = 8;
+
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param[in] threads The total number of threads including the caller.
+   */
+  explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+
+  /**
+   * @brief Stops and joins the worker threads.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Returns the pool shared by all models of the application.
+   */
+  static ThreadPool& Shared();
+
+  /**
+   * @brief Returns the number of threads taking part in a loop.
+   */
+  std::size_t Size() const noexcept { return workers_.size() + 1; }
+
+  /**
+   * @brief Runs @p body over [0, count) split into contiguous chunks.
+   *
+   * @param[in] count The number of loop iterations.
+   * @param[in] body Called as body(begin, end) for every chunk.
+   * @param[in] grain The minimal number of iterations in a chunk.
+   * @param[in] priority The lane the chunks are queued in.
+   * @param[in] token Skips the chunks not started once it is cancelled.
+   * @throws Rethrows the first exception thrown by @p body, after which the
+   * chunks not started are skipped; throws Cancelled if chunks were skipped
+   * for @p token.
+   */
+  void ParallelFor(std::size_t count, const Body& body, std::size_t grain = 1,
+                   Priority priority = Priority::kInteractive,
+                   const CancellationToken& token = CancellationToken());
+
+  /**
+   * @brief Reduces [0, count) by blocks of @p block iterations.
+   *
+   * The blocks do not depend on the number of threads, and their results
+   * are combined in order on the calling thread, so a floating-point
+   * reduction gives the same result on every machine.
+   *
+   * @param[in] count The number of iterations.
+   * @param[in] block The number of iterations of a block.
+   * @param[in] init The initial value of the result.
+   * @param[in] map Called as map(begin, end) for every block, returning its
+   * result; the type must be default constructible.
+   * @param[in] combine Called as combine(result, part) for every block.
+   * @param[in] grain The minimal number of blocks in a chunk.
+   * @param[in] priority The lane the chunks are queued in.
+   * @param[in] token Cancels the reduction.
+   * @return The result.
+   * @throws As ParallelFor does.
+   */
+  template <typename T, typename Map, typename Combine>
+  T ParallelReduce(std::size_t count, std::size_t block, T init, Map map,
+                   Combine combine, std::size_t grain = 1,
+                   Priority priority = Priority::kInteractive,
+                   const CancellationToken& token = CancellationToken());
+
+ private:
+  struct Job;
+  struct Task;
+  struct Queue;
+
+  /**
+   * @brief Queues @p task at the back of @p queue and wakes a thread.
+   */
+  void Push(Queue& queue, Task task);
+
+  /**
+   * @brief Takes a task, the back of the deque @p own first, then the front
+   * of the others, an interactive one before a background one.
+   *
+   * @param[in] own The deque of the thread.
+   * @param[in] only The job the task must belong to, or nullptr for any.
+   * @param[out] task The task taken.
+   * @return False if there was none.
+   */
+  bool Take(std::size_t own, const Job* only, Task& task);
+
+  /**
+   * @brief Runs the first chunk of @p task, pushing the rest to @p own in
+   * halves.
+   */
+  void Run(Task task, std::size_t own);
+
+  /**
+   * @brief Runs the tasks of @p job from any deque until it is finished.
+   */
+  void Help(Job& job, std::size_t own);
+
+  /**
+   * @brief Main loop of a worker thread.
+   */
+  void WorkerLoop(std::size_t own);
+
+  std::vector<std::thread> workers_;            ///< Worker threads.
+  std::vector<std::unique_ptr<Queue>> queues_;  ///< One deque per worker.
+  std::atomic<std::size_t> queued_{0};    ///< Tasks in all the deques.
+  std::atomic<std::size_t> sleeping_{0};  ///< Workers waiting for tasks.
+  std::atomic<std::size_t> next_queue_{0};  ///< Home of outside loops.
+  std::mutex mutex_;                        ///< Guards stop_ for wake_.
+  std::condition_variable wake_;            ///< Signals new tasks or stop.
+  bool stop_ = false;                       ///< Set by the destructor.
+};
+
+template <typename T, typename Map, typename Combine>
+T ThreadPool::ParallelReduce(std::size_t count, std::size_t block, T init,
+                             Map map, Combine combine, std::size_t grain,
+                             Priority priority,
+                             const CancellationToken& token) {
+  block = std::max<std::size_t>(block, 1);
+  std::size_t blocks = (count + block - 1) / block;
+  std::vector<decltype(map(std::size_t{}, std::size_t{}))> parts(blocks);
+  ParallelFor(
+      blocks,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b)
+          parts[b] = map(b * block, std::min(count, (b + 1) * block));
+      },
+      grain, priority, token);
+  for (const auto& part : parts) combine(init, part);
+  return init;
+}
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_THREADPOOL_H
@@ -0,0 +1,176 @@
+/**
+ * @file s21_tracer.cc
+ * @brief Implementation file for the s21_tracer.h.
+ */
+
+#include "s21_tracer.h"
+
+#include <chrono>
+#include <string_view>
+#include <utility>
+
+#include "s21_format.h"
+
+namespace s21 {
+
+namespace {
+
+/// Nesting of the open spans of the current thread.
+thread_local int span_depth = 0;
+
+}  // namespace
+
+/**
+ * @struct Tracer::Event
+ * @brief A finished span.
+ */
+struct Tracer::Event {
+  const char* name;
+  const char* category;
+  std::int64_t begin;  ///< Steady clock in ns.
+  std::int64_t end;
+};
+
+/**
+ * @struct Tracer::Ring
+ * @brief Single-producer single-consumer ring of the events of one thread.
+ *
+ * The owning thread writes events at head and the drain, holding the mutex,
+ * reads them up to head and then advances tail. Both counters only grow.
+ */
+struct Tracer::Ring {
+  explicit Ring(std::uint32_t id) : tid(id), events(new Event[kCapacity]) {}
+
+  std::uint32_t tid;  ///< Thread id in the file.
+  std::unique_ptr<Event[]> events;
+  std::atomic<std::size_t> head{0};
+  std::atomic<std::size_t> tail{0};
+};
+
+Tracer::Span::Span(const char* name, const char* category) noexcept
+    : name_(name), category_(category) {
+  if (!Tracer::Shared().Enabled()) return;
+  ++span_depth;
+  begin_ = Now();
+}
+
+Tracer::Span::~Span() { End(); }
+
+void Tracer::Span::End() noexcept {
+  if (begin_ < 0) return;
+  Tracer& tracer = Tracer::Shared();
+  tracer.Record(name_, category_, std::exchange(begin_, -1), Now());
+  if (--span_depth > 0) return;
+  Ring* ring = tracer.LocalRing();
+  if (ring && ring->head.load(std::memory_order_relaxed) -
+                      ring->tail.load(std::memory_order_acquire) >=
+                  kCapacity / 2)
+    tracer.Flush();
+}
+
+Tracer& Tracer::Shared() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::~Tracer() { Stop(); }
+
+bool Tracer::Start(const std::string& path) noexcept {
+  Stop();
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_ = std::fopen(path.c_str(), "w");
+  if (!file_) return false;
+  std::fputs("{\"traceEvents\":[", file_);
+  has_events_ = false;
+  dropped_.store(0, std::memory_order_relaxed);
+  // Events of a previous trace still in the rings are skipped by Drain
+  start_.store(Now(), std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+  return true;
+}
+
+void Tracer::Stop() noexcept {
+  enabled_.store(false, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_) return;
+  Drain();
+  std::fprintf(file_,
+               "\n],\"displayTimeUnit\":\"ms\","
+               "\"otherData\":{\"dropped\":\"%zu\"}}\n",
+               Dropped());
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+void Tracer::Flush() noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_) {
+    Drain();
+    std::fflush(file_);
+  }
+}
+
+std::int64_t Tracer::Now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::Record(const char* name, const char* category,
+                    std::int64_t begin, std::int64_t end) noexcept {
+  if (!Enabled()) return;
+  Ring* ring = LocalRing();
+  if (!ring) return;
+  std::size_t head = ring->head.load(std::memory_order_relaxed);
+  if (head - ring->tail.load(std::memory_order_acquire) >= kCapacity) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring->events[head % kCapacity] = {name, category, begin, end};
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+Tracer::Ring* Tracer::LocalRing() noexcept {
+  thread_local Ring* ring = nullptr;
+  if (ring) return ring;
+  try {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(
+        std::make_unique<Ring>(static_cast<std::uint32_t>(rings_.size() + 1)));
+    ring = rings_.back().get();
+  } catch (...) {
+    return nullptr;  // Out of memory, the thread records nothing
+  }
+  return ring;
+}
+
+/**
+ * @details Times are written in microseconds from the start of the trace,
+ * the unit of the trace-event format.
+ */
+void Tracer::Drain() noexcept {
+  std::int64_t start = start_.load(std::memory_order_relaxed);
+  char ts[Format::kBufferSize], dur[Format::kBufferSize];
+  for (const auto& ring : rings_) {
+    std::size_t head = ring->head.load(std::memory_order_acquire);
+    std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      const Event& event = ring->events[tail % kCapacity];
+      if (event.begin < start) continue;
+      std::string_view begin =
+          Format::Fixed((event.begin - start) / 1e3, 3, ts);
+      std::string_view length =
+          Format::Fixed((event.end - event.begin) / 1e3, 3, dur);
+      std::fprintf(file_,
+                   "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                   "\"ts\":%.*s,\"dur\":%.*s,\"pid\":1,\"tid\":%u}",
+                   has_events_ ? "," : "", event.name, event.category,
+                   static_cast<int>(begin.size()), begin.data(),
+                   static_cast<int>(length.size()), length.data(), ring->tid);
+      has_events_ = true;
+    }
+    ring->tail.store(head, std::memory_order_release);
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,158 @@
+/**
+ * @file s21_tracer.h
+ * @brief Header file containing the declaration of the Tracer recording
+ * spans of work as a Chrome trace-event file.
+ */
+
+#ifndef SMARTCALC_MODEL_S21_TRACER_H
+#define SMARTCALC_MODEL_S21_TRACER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @class Tracer
+ *
+ * @brief Opt-in recorder of timed spans, written as Chrome trace-event JSON
+ * that chrome://tracing and Perfetto open.
+ *
+ * Code marks its work with a Span on the stack. While tracing is off a span
+ * costs one relaxed atomic load. While it is on, the end of a span appends a
+ * complete event to a ring buffer owned by the current thread: the thread is
+ * the only writer and publishes the event with a release store, so recording
+ * takes no lock. The rings are drained into the file when a thread finishes
+ * its outermost span with its ring half full, and when tracing stops. Events
+ * arriving on a full ring are dropped and counted.
+ *
+ * Names and categories must be string literals, as only the pointers are
+ * recorded.
+ */
+class Tracer {
+ public:
+  /**
+   * @class Span
+   * @brief Records the time from its construction to its destruction.
+   */
+  class Span {
+   public:
+    /**
+     * @brief Starts the span if tracing is on.
+     *
+     * @param[in] name The name shown for the span, a string literal.
+     * @param[in] category The category of the span, a string literal.
+     */
+    Span(const char* name, const char* category) noexcept;
+
+    /**
+     * @brief Ends the span and records it, unless End did.
+     */
+    ~Span();
+
+    /**
+     * @brief Ends the span before the end of its scope and records it.
+     */
+    void End() noexcept;
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+   private:
+    const char* name_;
+    const char* category_;
+    std::int64_t begin_ = -1;  ///< Start in ns, negative when not tracing.
+  };
+
+  /// Events held by the ring of a thread.
+  static constexpr std::size_t kCapacity = std::size_t{1} << 14;
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  /**
+   * @brief Returns the tracer of the application.
+   */
+  static Tracer& Shared();
+
+  /**
+   * @brief Returns true while tracing is on.
+   */
+  bool Enabled() const noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Starts tracing into a new file, stopping a previous trace first.
+   *
+   * @param[in] path The JSON file to write.
+   * @return True if the file could be created.
+   */
+  bool Start(const std::string& path) noexcept;
+
+  /**
+   * @brief Stops tracing, writes the pending events and closes the file.
+   *
+   * Spans still open on other threads when tracing stops are not recorded.
+   */
+  void Stop() noexcept;
+
+  /**
+   * @brief Writes the events recorded so far to the file.
+   */
+  void Flush() noexcept;
+
+  /**
+   * @brief Returns the number of events dropped on full rings since Start.
+   */
+  std::size_t Dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Event;
+  struct Ring;
+
+  Tracer() noexcept = default;
+  ~Tracer();
+
+  /**
+   * @brief Returns the steady clock in nanoseconds.
+   */
+  static std::int64_t Now() noexcept;
+
+  /**
+   * @brief Records a finished span on the ring of the current thread.
+   */
+  void Record(const char* name, const char* category, std::int64_t begin,
+              std::int64_t end) noexcept;
+
+  /**
+   * @brief Returns the ring of the current thread, creating it on first use.
+   */
+  Ring* LocalRing() noexcept;
+
+  /**
+   * @brief Writes the events of every ring to the file; mutex_ is held.
+   */
+  void Drain() noexcept;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<std::size_t> dropped_{0};
+  /// Start of the trace in ns; earlier events are left out of the file.
+  std::atomic<std::int64_t> start_{0};
+  std::mutex mutex_;  ///< Guards the file, rings_ and the ring tails.
+  std::FILE* file_ = nullptr;
+  bool has_events_ = false;  ///< True once an event was written.
+  std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_MODEL_S21_TRACER_H
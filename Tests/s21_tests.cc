@@ -1,13 +1,42 @@
 #include "../Model/s21_model.h"
+#include "../Model/s21_batchfile.h"
 #include "../Model/s21_creditmodel.h"
+#include "../Model/s21_curvesampler.h"
+#include "../Model/s21_depositmodel.h"
+#include "../Model/s21_format.h"
+#include "../Model/s21_graphsampler.h"
+#include "../Model/s21_historyfile.h"
+#include "../Model/s21_implicitsampler.h"
+#include "../Model/s21_incrementalparser.h"
+#include "../Model/s21_integrator.h"
+#include "../Model/s21_interval.h"
+#include "../Model/s21_library.h"
+#include "../Model/s21_portfolio.h"
+#include "../Model/s21_program.h"
+#include "../Model/s21_programfile.h"
+#include "../Model/s21_programset.h"
+#include "../Model/s21_simulation.h"
+#include "../Model/s21_solver.h"
+#include "../Model/s21_threadpool.h"
+#include "../Model/s21_tracer.h"
 
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
 #include <string>
 #include <tuple>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
 
 TEST(Calc, Sum) {
   s21::Model m;
@@ -345,3 +374,1585 @@ TEST(CreditCalc, Diff_2) {
   ASSERT_EQ(std::floor(precentage), 520'833);
   ASSERT_EQ(std::floor(total), 10'520'833);
 }
+
+TEST(Program, Compile) {
+  s21::Model m;
+  m.SetInput("ln(x)*cos(x)");
+  s21::Program p = m.CompileMathExpression();
+  ASSERT_NEAR(p.Evaluate(6), 1.7203942, 1e-6);
+  ASSERT_NEAR(p.Evaluate(2), std::log(2) * std::cos(2), 1e-12);
+}
+
+TEST(Program, Batch) {
+  s21::Model m;
+  m.SetInput("-x^2+3*sin(x)/(1+x%2)");
+  s21::Program p = m.CompileMathExpression();
+  std::vector<double> x(1000), y(1000);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = -5 + 0.01 * i;
+  p.Evaluate(x.data(), y.data(), x.size());
+  for (size_t i = 0; i < x.size(); ++i) ASSERT_EQ(y[i], p.Evaluate(x[i]));
+}
+
+TEST(Program, FastWithinTolerance) {
+  std::vector<double> x(1000), exact(1000), fast(1000);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = -10 + 0.02 * i;
+  for (const char* expression :
+       {"x*sin(x)+cos(x)", "(x+1)*(x-1)/(x^2+1)", "sqrt(x)-ln(x)+log(x)",
+        "tan(x)", "asin(x/10)+atan(x)", "if(x<0,x^3/20,abs(x)%3)"}) {
+    s21::Model m;
+    m.SetInput(expression);
+    s21::Program p = m.CompileMathExpression();
+    p.Evaluate(x.data(), exact.data(), x.size());
+    p.EvaluateFast(x.data(), fast.data(), x.size(), 1e-3);
+    for (size_t i = 0; i < x.size(); ++i) {
+      if (std::isnan(exact[i]))
+        ASSERT_TRUE(std::isnan(fast[i])) << expression << " at " << x[i];
+      else
+        ASSERT_NEAR(fast[i], exact[i], 1e-3) << expression << " at " << x[i];
+    }
+  }
+}
+
+TEST(Program, FastFallsBack) {
+  std::vector<double> x(1000), exact(1000), fast(1000);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = 1 + 0.001 * i;
+  // Cancellation, a large argument, a sum; then double on request
+  for (const char* expression :
+       {"(x+1e8)-1e8", "sin(x*1e6)", "sum(k,1,3,x/k)", "x"}) {
+    s21::Model m;
+    m.SetInput(expression);
+    s21::Program p = m.CompileMathExpression();
+    p.Evaluate(x.data(), exact.data(), x.size());
+    double tolerance = expression[0] == 'x' ? 0.0 : 1e-3;
+    ASSERT_EQ(p.EvaluateFast(x.data(), fast.data(), x.size(), tolerance),
+              x.size());
+    ASSERT_EQ(fast, exact) << expression;
+  }
+}
+
+TEST(Program, Derivative) {
+  s21::Model m;
+  m.SetInput("x^3*sin(x)+sqrt(x)/ln(x)");
+  s21::Program p = m.CompileMathExpression();
+  double x = 2.5, d = 0.0;
+  double f = p.EvaluateWithDerivative(x, d);
+  double expected = 3 * x * x * std::sin(x) + x * x * x * std::cos(x) +
+                    (std::log(x) - 2) / (2 * std::sqrt(x) * std::log(x) *
+                                         std::log(x));
+  ASSERT_DOUBLE_EQ(f, p.Evaluate(x));
+  ASSERT_NEAR(d, expected, 1e-12);
+}
+
+TEST(Program, ErrorCompile) {
+  s21::Model m;
+  m.SetInput("5+");
+  EXPECT_THROW(m.CompileMathExpression(), std::invalid_argument);
+}
+
+TEST(Program, TwoVariables) {
+  s21::Model m;
+  m.SetInput("x*y+sum(k,1,3,k*y)");
+  s21::Program p = m.CompileMathExpression();
+  ASSERT_DOUBLE_EQ(p.EvaluateXY(2, 3), 24);
+  ASSERT_TRUE(std::isnan(p.Evaluate(2)));
+  std::vector<double> x(1000), y(1000), f(1000);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = -5 + 0.01 * i;
+    y[i] = 3 - 0.005 * i;
+  }
+  p.EvaluateXY(x.data(), y.data(), f.data(), x.size());
+  for (size_t i = 0; i < x.size(); ++i)
+    ASSERT_EQ(f[i], p.EvaluateXY(x[i], y[i]));
+  m.SetInput("y+1");
+  EXPECT_THROW(m.CalculateMathExpression(), std::invalid_argument);
+  m.SetInput("sum(y,1,2,y)");
+  EXPECT_THROW(m.CompileMathExpression(), std::invalid_argument);
+}
+
+TEST(Interval, EnclosesValues) {
+  std::vector<std::string> expressions = {
+      "x^2-2*x*y", "sin(x)*cos(y)", "tan(x)+y", "sqrt(x)+ln(y)",
+      "log(x*y)", "asin(x/4)+acos(y/4)", "atan(x)/y", "x%y",
+      "x^y", "abs(x-y)", "min(x,y)-max(x,y)", "if(x<y,x^3,-y)",
+      "(x<=y)+(x>=y)+(x==y)+(x!=y)", "sum(k,1,4,x^k)*y"};
+  const double boxes[][4] = {{-2, 3, -1, 2},     {0.5, 0.75, 1, 4},
+                             {1.4, 1.7, -3, -2}, {-0.1, 0.1, -0.1, 0.1},
+                             {2, 2, -4, 4},      {-7, 30, 0.5, 0.5}};
+  for (const std::string& expression : expressions) {
+    s21::Model m;
+    m.SetInput(expression);
+    s21::Program p = m.CompileMathExpression();
+    for (const auto& box : boxes) {
+      s21::Interval range = p.EvaluateXY(s21::Interval(box[0], box[1]),
+                                         s21::Interval(box[2], box[3]));
+      for (int i = 0; i <= 40; ++i) {
+        for (int j = 0; j <= 40; ++j) {
+          double x = box[0] + (box[1] - box[0]) * i / 40;
+          double y = box[2] + (box[3] - box[2]) * j / 40;
+          double f = p.EvaluateXY(x, y);
+          if (std::isnan(f)) continue;
+          ASSERT_TRUE(range.Contains(f))
+              << expression << " at " << x << ", " << y << ": " << f
+              << " not in [" << range.low << ", " << range.high << "]";
+        }
+      }
+    }
+  }
+  s21::Interval square = s21::Pow(s21::Interval(-1, 2), s21::Interval(2));
+  EXPECT_EQ(square.low, 0);
+  EXPECT_EQ(square.high, 4);
+  EXPECT_TRUE(s21::Sqrt(s21::Interval(-2, -1)).Empty());
+  EXPECT_EQ(s21::Cos(s21::Interval(-1, 7)).low, -1);
+  EXPECT_TRUE(std::isinf(s21::Tan(s21::Interval(1.5, 1.6)).high));
+}
+
+TEST(Interval, RoundsOutward) {
+  // The exact sum of the doubles 0.1 and 0.2 lies below the rounded one
+  s21::Interval sum = s21::Interval(0.1) + s21::Interval(0.2);
+  EXPECT_EQ(sum.high, 0.1 + 0.2);
+  EXPECT_EQ(sum.low, std::nextafter(0.1 + 0.2, 0.0));
+  s21::Interval third = s21::Interval(1.0) / s21::Interval(3.0);
+  EXPECT_EQ(third.high, std::nextafter(third.low, 1.0));
+  s21::Interval root = s21::Sqrt(s21::Interval(2.0));
+  EXPECT_EQ(root.high, std::nextafter(root.low, 2.0));
+  // Exact results stay single numbers
+  s21::Interval exact =
+      s21::Interval(1.5) * s21::Interval(-4) + s21::Interval(1);
+  EXPECT_EQ(exact.low, -5);
+  EXPECT_EQ(exact.high, -5);
+  EXPECT_EQ(s21::Sqrt(s21::Interval(0, 4)).high, 2);
+  EXPECT_EQ(s21::Mod(s21::Interval(0.5, 0.75), s21::Interval(1)).low, 0.5);
+  EXPECT_EQ(s21::Mod(s21::Interval(0.5, 1.5), s21::Interval(1)).low, 0);
+  EXPECT_TRUE(s21::Mod(s21::Interval(1, 2), s21::Interval(0)).Empty());
+  // Products too large for a double stay unbounded only above
+  s21::Interval big = s21::Interval(1e300) * s21::Interval(1e300);
+  EXPECT_EQ(big.low, std::numeric_limits<double>::max());
+  EXPECT_TRUE(std::isinf(big.high));
+  // Domains
+  EXPECT_TRUE(std::isinf(s21::Ln(s21::Interval(-1, 1)).low));
+  EXPECT_TRUE(s21::Log(s21::Interval(-2, -1)).Empty());
+  EXPECT_TRUE(s21::Acos(s21::Interval(1.5, 2)).Empty());
+  EXPECT_TRUE(s21::Asin(s21::Interval(0.5, 2)).Contains(M_PI / 2));
+  EXPECT_GE(s21::Acos(s21::Interval(0.5, 1)).low, 0);
+  EXPECT_LE(s21::Sin(s21::Interval(-100, 100)).high, 1);
+}
+
+TEST(Interval, PeriodicForLargeArguments) {
+  for (double start : {1e6, 1e10, 1e15, 123456789.123}) {
+    for (double width : {1e-6, 0.1, 1.0, 3.0}) {
+      s21::Interval a(start, start + width);
+      s21::Interval s = s21::Sin(a), c = s21::Cos(a), t = s21::Tan(a);
+      for (int i = 0; i <= 100; ++i) {
+        double x = std::min(start + width * i / 100, a.high);
+        ASSERT_TRUE(s.Contains(std::sin(x))) << start << " + " << width;
+        ASSERT_TRUE(c.Contains(std::cos(x))) << start << " + " << width;
+        ASSERT_TRUE(t.Contains(std::tan(x))) << start << " + " << width;
+      }
+    }
+  }
+  // A pole of tan a rounding of π away from an end is taken to be inside
+  double pole = 1e6 * M_PI + M_PI / 2;
+  EXPECT_TRUE(std::isinf(s21::Tan(s21::Interval(pole - 1, pole)).high));
+}
+
+TEST(Solver, RootsAndExtrema) {
+  s21::Model m;
+  m.SetInput("x^3-3*x");
+  s21::Solver::Result r =
+      s21::Solver().Solve(m.CompileMathExpression(), -3, 3, 1000);
+  ASSERT_EQ(r.roots.size(), 3u);
+  ASSERT_NEAR(r.roots[0], -std::sqrt(3), 1e-12);
+  ASSERT_NEAR(r.roots[1], 0, 1e-12);
+  ASSERT_NEAR(r.roots[2], std::sqrt(3), 1e-12);
+  ASSERT_EQ(r.minima.size(), 1u);
+  ASSERT_EQ(r.maxima.size(), 1u);
+  ASSERT_NEAR(r.minima[0], 1, 1e-12);
+  ASSERT_NEAR(r.maxima[0], -1, 1e-12);
+  ASSERT_NEAR(r.minimum_values[0], -2, 1e-12);
+}
+
+TEST(Solver, SkipsPoles) {
+  s21::Model m;
+  m.SetInput("tan(x)");
+  s21::Solver::Result r =
+      s21::Solver().Solve(m.CompileMathExpression(), -4, 4, 1001);
+  ASSERT_EQ(r.roots.size(), 3u);
+  for (double root : r.roots)
+    ASSERT_NEAR(std::remainder(root, M_PI), 0, 1e-12);
+}
+
+TEST(Solver, ManyRoots) {
+  s21::Model m;
+  m.SetInput("sin(1/x)");
+  s21::Solver::Result r =
+      s21::Solver().Solve(m.CompileMathExpression(), 0.001, 1);
+  // Roots are 1/(k*pi) for k = 1 ... 318
+  ASSERT_EQ(r.roots.size(), 318u);
+  for (double root : r.roots)
+    ASSERT_NEAR(std::remainder(1 / root, M_PI), 0, 1e-6);
+}
+
+TEST(Solver, ErrorInterval) {
+  s21::Model m;
+  m.SetInput("x");
+  EXPECT_THROW(s21::Solver().Solve(m.CompileMathExpression(), 1, 1),
+               std::invalid_argument);
+}
+
+TEST(Integrator, Polynomial) {
+  s21::Model m;
+  m.SetInput("3*x^2-2*x+1");
+  auto r = s21::Integrator().Integrate(m.CompileMathExpression(), -1, 2);
+  ASSERT_NEAR(r.value, 9, 1e-12);
+  ASSERT_LE(r.error, 1e-9);
+}
+
+TEST(Integrator, Oscillatory) {
+  s21::Model m;
+  m.SetInput("sin(100*x)");
+  auto r = s21::Integrator().Integrate(m.CompileMathExpression(), 0, 1000);
+  double expected = (1 - std::cos(100'000.0)) / 100;
+  ASSERT_NEAR(r.value, expected, 1e-7);
+  ASSERT_LE(std::abs(r.value - expected), 10 * r.error);
+}
+
+TEST(Integrator, EndpointSingularity) {
+  s21::Model m;
+  m.SetInput("1/sqrt(x)");
+  auto r = s21::Integrator().Integrate(m.CompileMathExpression(), 0, 1);
+  ASSERT_NEAR(r.value, 2, 1e-8);
+}
+
+TEST(Integrator, ReversedLimits) {
+  s21::Model m;
+  m.SetInput("ln(x)");
+  auto r = s21::Integrator().Integrate(m.CompileMathExpression(), 1, 0);
+  ASSERT_NEAR(r.value, 1, 1e-9);
+}
+
+TEST(Integrator, Divergent) {
+  s21::Model m;
+  m.SetInput("sqrt(x)");
+  auto r = s21::Integrator().Integrate(m.CompileMathExpression(), -1, 1);
+  ASSERT_FALSE(std::isfinite(r.value));
+}
+
+TEST(Reduction, Sum) {
+  s21::Model m;
+  m.SetInput("sum(k,1,100,k)");
+  ASSERT_NEAR(m.CalculateMathExpression(), 5050, 1e-6);
+}
+
+TEST(Reduction, Prod) {
+  s21::Model m;
+  m.SetInput("prod(i,1,10,i)-1");
+  ASSERT_NEAR(m.CalculateMathExpression(), 3'628'799, 1e-6);
+}
+
+TEST(Reduction, WithX) {
+  s21::Model m;
+  m.SetInput("2*sum(k,0,20,x^k/prod(j,1,k,j))");
+  m.SetX(1.5);
+  ASSERT_NEAR(m.CalculateMathExpression(), 2 * std::exp(1.5), 1e-6);
+}
+
+TEST(Reduction, Nested) {
+  s21::Model m;
+  m.SetInput("sum(i,1,10,sum(j,i,10,i*j))");
+  s21::Program p = m.CompileMathExpression();
+  ASSERT_DOUBLE_EQ(p.Evaluate(0), 1705);
+}
+
+TEST(Reduction, EmptyRange) {
+  s21::Model m;
+  m.SetInput("sum(k,5,1,k)+prod(k,5,1,k)");
+  ASSERT_NEAR(m.CalculateMathExpression(), 1, 1e-6);
+}
+
+TEST(Reduction, MillionTerms) {
+  s21::Model m;
+  m.SetInput("sum(k,1,1000000,1/k^2)");
+  s21::Program p = m.CompileMathExpression();
+  double expected = M_PI * M_PI / 6 - 1.0 / 1'000'000 + 0.5e-12;
+  ASSERT_NEAR(p.Evaluate(0), expected, 1e-15);
+  ASSERT_EQ(p.Evaluate(0), p.Evaluate(0));
+}
+
+TEST(Reduction, Derivative) {
+  s21::Model m;
+  m.SetInput("sum(k,1,5,x^k)");
+  double d = 0.0;
+  m.CompileMathExpression().EvaluateWithDerivative(2, d);
+  ASSERT_DOUBLE_EQ(d, 1 + 2 * 2 + 3 * 4 + 4 * 8 + 5 * 16);
+}
+
+TEST(Reduction, ErrorReduction_1) {
+  s21::Model m;
+  m.SetInput("sum(1,1,10,k)");
+  EXPECT_THROW(m.CalculateMathExpression(), std::invalid_argument);
+}
+
+TEST(Reduction, ErrorReduction_2) {
+  s21::Model m;
+  m.SetInput("sum(k,1,10)");
+  EXPECT_THROW(m.CalculateMathExpression(), std::invalid_argument);
+}
+
+TEST(Reduction, ErrorReduction_3) {
+  s21::Model m;
+  m.SetInput("sin(1,2)+k");
+  EXPECT_THROW(m.CompileMathExpression(), std::invalid_argument);
+}
+
+TEST(Conditional, If) {
+  s21::Model m;
+  m.SetInput("if(x<0,-x,x^2)+if(x>=1,1,0)");
+  m.SetX(-2);
+  ASSERT_NEAR(m.CalculateMathExpression(), 2, 1e-6);
+  m.SetX(3);
+  ASSERT_NEAR(m.CalculateMathExpression(), 10, 1e-6);
+}
+
+TEST(Conditional, Comparisons) {
+  s21::Model m;
+  m.SetInput("(1<2)+(2<=2)*2+(3>4)*4+(4==4)*8+(5!=5)*16");
+  ASSERT_NEAR(m.CalculateMathExpression(), 11, 1e-6);
+}
+
+TEST(Conditional, MinMaxAbs) {
+  s21::Model m;
+  m.SetInput("min(max(x,-1),1)+abs(x-10)");
+  m.SetX(5);
+  ASSERT_NEAR(m.CalculateMathExpression(), 6, 1e-6);
+  m.SetX(-5);
+  ASSERT_NEAR(m.CalculateMathExpression(), 14, 1e-6);
+}
+
+TEST(Conditional, Batch) {
+  s21::Model m;
+  m.SetInput("if(x<1000,x*0.01,min(x*0.02,50))+abs(x-1500)");
+  s21::Program p = m.CompileMathExpression();
+  std::vector<double> x(1000), y(x.size()), d(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) x[i] = 3.7 * i - 100;
+  p.EvaluateWithDerivative(x.data(), y.data(), d.data(), x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    double derivative = 0.0;
+    ASSERT_DOUBLE_EQ(y[i], p.EvaluateWithDerivative(x[i], derivative));
+    ASSERT_DOUBLE_EQ(d[i], derivative);
+  }
+  ASSERT_DOUBLE_EQ(p.Evaluate(2000), 40 + 500);
+}
+
+TEST(Conditional, NaNCondition) {
+  s21::Model m;
+  m.SetInput("if(ln(x),1,2)");
+  ASSERT_TRUE(std::isnan(m.CompileMathExpression().Evaluate(-1)));
+}
+
+TEST(Conditional, ErrorConditional_1) {
+  s21::Model m;
+  m.SetInput("if(x<0,1)");
+  EXPECT_THROW(m.CompileMathExpression(), std::invalid_argument);
+}
+
+TEST(Conditional, ErrorConditional_2) {
+  s21::Model m;
+  m.SetInput("x=1");
+  EXPECT_THROW(m.CalculateMathExpression(), std::invalid_argument);
+}
+
+TEST(Library, Function) {
+  s21::Library library;
+  ASSERT_EQ(library.Define("f(a,b) = a^2 + b"), "f");
+  ASSERT_EQ(library.Define("rate=0.07"), "rate");
+  s21::Model m;
+  m.SetLibrary(&library);
+  m.SetInput("f(3,1)*rate+f(x,f(1,1))");
+  m.SetX(2);
+  ASSERT_NEAR(m.CalculateMathExpression(), 10 * 0.07 + 6, 1e-6);
+  ASSERT_EQ(m.GetDependencies(), (std::set<std::string>{"f", "rate"}));
+}
+
+TEST(Library, Inlined) {
+  s21::Library library;
+  library.Define("sq(a)=a*a");
+  library.Define("g(a)=sq(a)+sq(2)");
+  ASSERT_EQ(library.Expand("g(x+1)"), "((((x+1))*((x+1)))+((2)*(2)))");
+  s21::Model m;
+  m.SetLibrary(&library);
+  m.SetInput("g(x+1)");
+  ASSERT_DOUBLE_EQ(m.CompileMathExpression().Evaluate(2), 13);
+}
+
+TEST(Library, Redefinition) {
+  s21::Library library;
+  library.Define("rate=0.07");
+  library.Define("f(a)=a*rate");
+  library.Define("rate=0.1");
+  s21::Model m;
+  m.SetLibrary(&library);
+  m.SetInput("f(50)");
+  ASSERT_NEAR(m.CalculateMathExpression(), 5, 1e-6);
+}
+
+TEST(Library, SumIndex) {
+  s21::Library library;
+  library.Define("k=2");
+  ASSERT_EQ(library.Expand("sum(k,1,3,k)+k"), "sum(k,1,3,k)+(2)");
+  library.Define("f(t)=sum(t,1,3,t)");
+  library.Define("g(a)=sum(k,1,a,k*f(k))");
+  library.Define("h(k)=prod(j,1,3,j+k)");
+  s21::Model m;
+  m.SetLibrary(&library);
+  m.SetInput("sum(k, 1, 3, k)+k");
+  ASSERT_DOUBLE_EQ(m.CalculateMathExpression(), 8);
+  m.SetInput("g(4)");
+  ASSERT_DOUBLE_EQ(m.CalculateMathExpression(), 60);
+  m.SetInput("h(k)+prod(j,1,k,j+k)");
+  ASSERT_DOUBLE_EQ(m.CalculateMathExpression(), 60 + 12);
+}
+
+TEST(Library, ExpansionLimit) {
+  s21::Library library;
+  library.Define("fa(a)=a+a");
+  library.Define("fb(a)=fa(fa(a))");
+  library.Define("fc(a)=fb(fb(a))");
+  library.Define("fd(a)=fc(fc(a))");
+  EXPECT_THROW(library.Define("fe(a)=fd(fd(a))"), std::invalid_argument);
+  EXPECT_THROW(library.Expand("fd(fd(fd(x)))"), std::invalid_argument);
+  ASSERT_EQ(library.List().size(), 4u);
+}
+
+TEST(Library, SaveLoad) {
+  std::string path = "s21_library_test.txt";
+  s21::Library library;
+  library.Define("f(a,b)=a^2+b");
+  library.Define("rate=0.07");
+  ASSERT_TRUE(library.Save(path));
+  s21::Library loaded;
+  ASSERT_TRUE(loaded.Load(path));
+  std::remove(path.c_str());
+  ASSERT_EQ(loaded.List(), library.List());
+  ASSERT_EQ(loaded.List()[0], "f(a,b)=a^2+b");
+}
+
+TEST(Library, IsDefinition) {
+  ASSERT_TRUE(s21::Library::IsDefinition("f(a)=a"));
+  ASSERT_FALSE(s21::Library::IsDefinition("x<=1"));
+  ASSERT_FALSE(s21::Library::IsDefinition("x==1"));
+}
+
+TEST(Library, ErrorLibrary_1) {
+  s21::Library library;
+  EXPECT_THROW(library.Define("sin(a)=a"), std::invalid_argument);
+  EXPECT_THROW(library.Define("f(a,a)=a"), std::invalid_argument);
+  EXPECT_THROW(library.Define("f(a)=a+"), std::invalid_argument);
+  ASSERT_TRUE(library.Empty());
+}
+
+TEST(Library, ErrorLibrary_2) {
+  s21::Library library;
+  library.Define("f(a)=a+1");
+  library.Define("g(a)=f(a)*2");
+  EXPECT_THROW(library.Define("f(a)=g(a)"), std::invalid_argument);
+  ASSERT_EQ(library.Expand("f(1)"), "((1)+1)");
+  EXPECT_THROW(library.Expand("f(1,2)"), std::invalid_argument);
+}
+
+TEST(CreditSchedule, Annuity) {
+  s21::CreditModel m;
+  s21::CreditModel::Schedule schedule;
+  m.CalculateSchedule(12, 300000, 5, 16.0, 'a', schedule);
+  ASSERT_EQ(schedule.Size(), 60u);
+  auto [payment, percentage, total] = m.CalculateResult(12, 300000, 5, 16.0, 1, 'a');
+  double interest = 0.0, principal = 0.0;
+  for (std::size_t i = 0; i < schedule.Size(); ++i) {
+    ASSERT_NEAR(schedule.payment[i], payment, 1e-9);
+    interest += schedule.interest[i];
+    principal += schedule.principal[i];
+  }
+  ASSERT_NEAR(interest, percentage, 1e-6);
+  ASSERT_NEAR(principal, 300000, 1e-6);
+  ASSERT_NEAR(schedule.interest[0], 4000, 1e-9);
+  ASSERT_EQ(schedule.balance.back(), 0.0);
+}
+
+TEST(CreditSchedule, Differential) {
+  s21::CreditModel m;
+  s21::CreditModel::Schedule schedule;
+  m.CalculateSchedule(12, 300000, 5, 16.0, 'd', schedule);
+  for (int month = 1; month <= 60; ++month) {
+    auto [payment, percentage, total] = m.CalculateResult(12, 300000, 5, 16.0, month, 'd');
+    ASSERT_NEAR(schedule.payment[month - 1], payment, 1e-9);
+    ASSERT_NEAR(schedule.principal[month - 1], 5000, 1e-9);
+  }
+  ASSERT_NEAR(schedule.balance[29], 150000, 1e-6);
+}
+
+TEST(CreditSchedule, Period) {
+  s21::CreditModel m;
+  s21::CreditModel::Schedule schedule;
+  for (char type : {'a', 'd'}) {
+    for (double rate : {0.0, 5.0, 16.0}) {
+      m.CalculateSchedule(12, 10'000'000, 30, rate, type, schedule);
+      for (int month : {1, 2, 180, 359, 360}) {
+        auto period = m.CalculatePeriod(12, 10'000'000, 30, rate, month, type);
+        ASSERT_NEAR(period.payment, schedule.payment[month - 1], 1e-6);
+        ASSERT_NEAR(period.interest, schedule.interest[month - 1], 1e-6);
+        ASSERT_NEAR(period.principal, schedule.principal[month - 1], 1e-6);
+        ASSERT_NEAR(period.balance, schedule.balance[month - 1], 1e-6);
+      }
+    }
+  }
+}
+
+TEST(CreditSchedule, ErrorSchedule) {
+  s21::CreditModel m;
+  s21::CreditModel::Schedule schedule;
+  EXPECT_THROW(m.CalculateSchedule(12, 1000, 0, 5, 'a', schedule), std::invalid_argument);
+  EXPECT_THROW(m.CalculatePeriod(12, 1000, 1, 5, 13, 'd'), std::invalid_argument);
+}
+
+TEST(Portfolio, MatchesCreditModel) {
+  std::vector<double> amount, rate;
+  std::vector<int> term, k;
+  std::vector<char> type;
+  for (int i = 0; i < 10000; ++i) {
+    amount.push_back(1000.0 + 37 * i);
+    term.push_back(1 + i % 30);
+    rate.push_back((i % 7 == 0) ? 0.0 : 0.5 + (i % 200) * 0.1);
+    type.push_back(i % 3 ? 'a' : 'd');
+    k.push_back(i % 2 ? 12 : 1);
+  }
+  std::size_t n = amount.size();
+  std::vector<double> payment(n), overpayment(n), total(n);
+  s21::Portfolio::Summary summary = s21::Portfolio().Calculate(
+      {amount.data(), term.data(), rate.data(), type.data(), k.data(), n},
+      {payment.data(), overpayment.data(), total.data()});
+
+  s21::CreditModel m;
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (rate[i] == 0) continue;
+    auto [p, o, t] = m.CalculateResult(k[i], amount[i], term[i], rate[i], 1, type[i]);
+    ASSERT_NEAR(payment[i], p, 1e-9 * p);
+    ASSERT_NEAR(overpayment[i], o, 1e-8 * t);
+    ASSERT_NEAR(total[i], t, 1e-8 * t);
+  }
+  for (double t : total) sum += t;
+  ASSERT_EQ(summary.count, n);
+  ASSERT_NEAR(summary.total, sum, 1e-12 * sum);
+}
+
+TEST(Portfolio, Deterministic) {
+  std::size_t n = 100000;
+  std::vector<double> amount(n), rate(n), payment(n), overpayment(n), total(n);
+  std::vector<int> term(n, 10), k(n, 12);
+  std::vector<char> type(n, 'a');
+  for (std::size_t i = 0; i < n; ++i) {
+    amount[i] = 1e6 / (i + 1);
+    rate[i] = 1 + i % 13;
+  }
+  term[5] = 0;
+  type[6] = 'x';
+  s21::Portfolio::Loans loans{amount.data(), term.data(), rate.data(),
+                              type.data(),   k.data(),    n};
+  s21::Portfolio::Payments payments{payment.data(), overpayment.data(), total.data()};
+  auto first = s21::Portfolio().Calculate(loans, payments);
+  auto second = s21::Portfolio().Calculate(loans, payments);
+  ASSERT_EQ(first.invalid, 2u);
+  ASSERT_TRUE(std::isnan(payment[5]) && std::isnan(total[6]));
+  ASSERT_EQ(first.total, second.total);
+  ASSERT_EQ(first.overpayment, second.overpayment);
+}
+
+namespace {
+
+/// Reference variable-rate credit that steps through the term period by
+/// period, recomputing the annuity payment at every reset.
+double SimulateVariableCredit(double amount, int periods, char type,
+                              std::vector<s21::CreditModel::RateReset> resets) {
+  double balance = amount, interest = 0, payment = 0, r = 0;
+  std::size_t next = 0;
+  for (int month = 1; month <= periods; ++month) {
+    bool reset = false;
+    for (; next < resets.size() && resets[next].month == month; ++next) {
+      r = resets[next].rate / 12 / 100;
+      reset = true;
+    }
+    int left = periods - month + 1;
+    if (reset && type == 'a')
+      payment = r == 0 ? balance / left
+                       : balance * r / (1 - std::pow(1 + r, -left));
+    double charge = balance * r;
+    double principal = type == 'a' ? payment - charge : amount / periods;
+    interest += charge;
+    balance -= principal;
+  }
+  return interest;
+}
+
+}  // namespace
+
+TEST(VariableCredit, MatchesSimulation) {
+  s21::CreditModel m;
+  std::vector<s21::CreditModel::RateReset> resets{
+      {120, 3.5}, {13, 9.0}, {61, 0.0}, {200, 12.0}, {13, 7.25}};
+  std::vector<s21::CreditModel::RateReset> sorted{
+      {1, 5.0}, {13, 7.25}, {61, 0.0}, {120, 3.5}, {200, 12.0}};
+  for (char type : {'a', 'd'}) {
+    auto credit = m.CalculateVariableCredit(12, 2'500'000, 20, 5.0, type, resets);
+    ASSERT_EQ(credit.segments.size(), 5u);
+    ASSERT_EQ(credit.segments[1].month, 13);
+    ASSERT_EQ(credit.segments[1].rate, 7.25);
+    double expected = SimulateVariableCredit(2'500'000, 240, type, sorted);
+    ASSERT_NEAR(credit.overpayment, expected, 1e-6);
+    ASSERT_NEAR(credit.total, 2'500'000 + expected, 1e-6);
+  }
+}
+
+TEST(VariableCredit, ConstantRate) {
+  s21::CreditModel m;
+  for (char type : {'a', 'd'}) {
+    auto [payment, percentage, total] = m.CalculateResult(12, 300000, 5, 16.0, 1, type);
+    auto credit = m.CalculateVariableCredit(12, 300000, 5, 9.0, type, {{1, 16.0}, {31, 16.0}});
+    ASSERT_NEAR(credit.segments[0].payment, payment, 1e-9);
+    ASSERT_NEAR(credit.segments[1].payment, type == 'a' ? payment : 5000 + 150000 * 16.0 / 1200, 1e-9);
+    ASSERT_NEAR(credit.overpayment, percentage, 1e-6);
+    ASSERT_NEAR(credit.total, total, 1e-6);
+  }
+}
+
+TEST(VariableCredit, Portfolio) {
+  std::size_t n = 5000;
+  std::vector<double> amount(n), payment(n), overpayment(n), total(n);
+  std::vector<int> term(n), k(n, 12);
+  std::vector<char> type(n);
+  std::vector<std::size_t> offsets{0};
+  std::vector<s21::CreditModel::RateReset> resets;
+  for (std::size_t i = 0; i < n; ++i) {
+    amount[i] = 10000.0 + 13 * i;
+    term[i] = 1 + i % 25;
+    type[i] = i % 4 ? 'a' : 'd';
+    for (int month = 1; i != 2 && month <= term[i] * 12; month += 1 + i % 40)
+      resets.push_back({month, 1.0 + (month + i) % 17});
+    offsets.push_back(resets.size());  // Loan 2 has no rate path
+  }
+  s21::Portfolio::VariableLoans loans{amount.data(), term.data(), type.data(), k.data(),
+                                      offsets.data(), resets.data(), n};
+  s21::Portfolio::Payments payments{payment.data(), overpayment.data(), total.data()};
+  auto summary = s21::Portfolio().CalculateVariable(loans, payments);
+  ASSERT_EQ(summary.invalid, 1u);
+  ASSERT_TRUE(std::isnan(payment[2]) && std::isnan(total[2]));
+
+  s21::CreditModel m;
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i == 2) continue;
+    std::vector<s21::CreditModel::RateReset> path(resets.begin() + offsets[i],
+                                                   resets.begin() + offsets[i + 1]);
+    auto credit = m.CalculateVariableCredit(12, amount[i], term[i], 0.0, type[i], path);
+    ASSERT_NEAR(overpayment[i], credit.overpayment, 1e-9 * credit.total);
+    ASSERT_NEAR(payment[i], credit.segments[0].payment, 1e-9 * credit.total);
+    sum += total[i];
+  }
+  ASSERT_NEAR(summary.total, sum, 1e-12 * sum);
+}
+
+TEST(VariableCredit, ErrorVariableCredit) {
+  s21::CreditModel m;
+  EXPECT_THROW(m.CalculateVariableCredit(12, 1000, 1, 5, 'a', {{13, 4.0}}), std::invalid_argument);
+  EXPECT_THROW(m.CalculateVariableCredit(12, 1000, 1, 5, 'd', {{0, 4.0}}), std::invalid_argument);
+  EXPECT_THROW(m.CalculateVariableCredit(12, 1000, 1, 5, 'a', {{3, -1.0}}), std::invalid_argument);
+  s21::CreditModel::RateReset late{2, 5.0};
+  ASSERT_TRUE(std::isnan(s21::CreditModel::CalculateSegments(1000, 12, 'a', &late, 1, nullptr)));
+}
+
+TEST(CreditGrid, MatchesCreditModel) {
+  s21::CreditModel m;
+  s21::CreditModel::Grid grid;
+  grid.rates = {16.0, 0.5, 7.25, 30.0};
+  grid.terms = {30, 1, 5, 2, 3, 4, 5, 10, 20};
+  for (char type : {'a', 'd'}) {
+    m.CalculateGrid(12, 300000, type, grid);
+    ASSERT_EQ(grid.payment.size(), 36u);
+    for (std::size_t i = 0; i < grid.rates.size(); ++i) {
+      for (std::size_t j = 0; j < grid.terms.size(); ++j) {
+        auto [payment, percentage, total] =
+            m.CalculateResult(12, 300000, grid.terms[j], grid.rates[i], 1, type);
+        ASSERT_NEAR(grid.payment[grid.At(i, j)], payment, 1e-12 * payment);
+        ASSERT_NEAR(grid.overpayment[grid.At(i, j)], percentage, 1e-10 * total);
+      }
+    }
+  }
+}
+
+TEST(CreditGrid, ZeroRate) {
+  s21::CreditModel::Grid grid{{0.0}, {1, 2}, {}, {}};
+  s21::CreditModel().CalculateGrid(1, 1200, 'a', grid);
+  ASSERT_EQ(grid.payment, (std::vector<double>{1200, 600}));
+  ASSERT_EQ(grid.overpayment, (std::vector<double>{0, 0}));
+  grid.terms.push_back(0);
+  EXPECT_THROW(s21::CreditModel().CalculateGrid(1, 1200, 'a', grid), std::invalid_argument);
+  grid.terms = {1};
+  grid.rates = {-1.0};
+  EXPECT_THROW(s21::CreditModel().CalculateGrid(1, 1200, 'd', grid), std::invalid_argument);
+}
+
+TEST(CreditSolve, Rate) {
+  s21::CreditModel m;
+  for (char type : {'a', 'd'}) {
+    for (double rate : {0.001, 3.5, 16.0, 95.0}) {
+      auto [payment, percentage, total] = m.CalculateResult(12, 300000, 30, rate, 1, type);
+      ASSERT_NEAR(m.SolveRate(12, 300000, 30, payment, type), rate, 1e-9);
+    }
+    ASSERT_EQ(m.SolveRate(12, 300000, 30, 300000 / 360.0, type), 0.0);
+  }
+}
+
+TEST(CreditSolve, PeriodsAndAmount) {
+  s21::CreditModel m;
+  for (char type : {'a', 'd'}) {
+    for (int term : {1, 7, 25}) {
+      auto [payment, percentage, total] = m.CalculateResult(12, 300000, term, 12.0, 1, type);
+      ASSERT_EQ(m.SolvePeriods(300000, 12.0, payment, type), term * 12);
+      ASSERT_LT(m.SolvePeriods(300000, 12.0, payment * 1.05, type), term * 12 + (term == 1));
+      ASSERT_NEAR(m.SolveAmount(12, term, 12.0, payment, type), 300000, 1e-6);
+    }
+  }
+  ASSERT_EQ(m.SolvePeriods(1000, 0.0, 300, 'a'), 4);
+}
+
+TEST(CreditSolve, Portfolio) {
+  std::size_t n = 20000;
+  std::vector<double> amount(n), rate(n), payment(n), overpayment(n), total(n), solution(n);
+  std::vector<int> term(n), k(n, 12);
+  std::vector<char> type(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    amount[i] = 5000.0 + 91 * i;
+    rate[i] = 0.25 + (i % 97) * 0.3;
+    term[i] = 1 + i % 30;
+    type[i] = i % 5 ? 'a' : 'd';
+  }
+  s21::Portfolio::Loans loans{amount.data(), term.data(), rate.data(), type.data(), k.data(), n};
+  s21::Portfolio portfolio;
+  portfolio.Calculate(loans, {payment.data(), overpayment.data(), total.data()});
+  using Unknown = s21::CreditModel::Unknown;
+  ASSERT_EQ(portfolio.Solve(Unknown::kRate, {amount.data(), term.data(), nullptr, type.data(), k.data(), n}, payment.data(), solution.data()), 0u);
+  for (std::size_t i = 0; i < n; ++i) ASSERT_NEAR(solution[i], rate[i], 1e-9);
+  ASSERT_EQ(portfolio.Solve(Unknown::kAmount, loans, payment.data(), solution.data()), 0u);
+  for (std::size_t i = 0; i < n; ++i) ASSERT_NEAR(solution[i], amount[i], 1e-8 * amount[i]);
+  ASSERT_EQ(portfolio.Solve(Unknown::kPeriods, loans, payment.data(), solution.data()), 0u);
+  for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(solution[i], term[i] * 12);
+  payment[3] = 1.0;
+  ASSERT_EQ(portfolio.Solve(Unknown::kRate, loans, payment.data(), solution.data()), 1u);
+  ASSERT_TRUE(std::isnan(solution[3]));
+}
+
+TEST(CreditSolve, ErrorSolve) {
+  s21::CreditModel m;
+  EXPECT_THROW(m.SolveRate(12, 12000, 1, 999, 'a'), std::invalid_argument);
+  EXPECT_THROW(m.SolveRate(12, 12000, 0, 2000, 'a'), std::invalid_argument);
+  EXPECT_THROW(m.SolvePeriods(100000, 12.0, 1000, 'a'), std::invalid_argument);
+  EXPECT_THROW(m.SolvePeriods(100000, 12.0, 1000, 'd'), std::invalid_argument);
+  EXPECT_THROW(m.SolveAmount(12, 5, -1.0, 1000, 'a'), std::invalid_argument);
+  EXPECT_THROW(m.SolveAmount(12, 5, 10.0, 0.0, 'd'), std::invalid_argument);
+}
+
+namespace {
+
+/// Reference deposit that steps through the term day by day.
+s21::DepositModel::Result SimulateDeposit(
+    const s21::DepositModel::Deposit& deposit, int period,
+    std::vector<s21::DepositModel::Event> events) {
+  using Type = s21::DepositModel::Event::Type;
+  std::stable_sort(events.begin(), events.end(),
+                   [](const auto& l, const auto& r) { return l.day < r.day; });
+  double balance = deposit.amount, accrued = 0, interest = 0;
+  double rate = deposit.rate / 100 / 365;
+  std::size_t e = 0;
+  auto apply = [&](int day) {
+    for (; e < events.size() && events[e].day == day; ++e) {
+      if (events[e].type == Type::kReplenishment) balance += events[e].value;
+      if (events[e].type == Type::kWithdrawal) balance -= events[e].value;
+      if (events[e].type == Type::kRateChange) rate = events[e].value / 100 / 365;
+    }
+  };
+  for (int day = 0; day < deposit.term; ++day) {
+    apply(day);
+    accrued += balance * rate;
+    if ((day + 1) % period == 0) {
+      interest += accrued;
+      if (deposit.capitalization) balance += accrued;
+      accrued = 0;
+    }
+  }
+  apply(deposit.term);
+  interest += accrued;
+  if (deposit.capitalization) balance += accrued;
+  return {interest, interest * deposit.tax_rate / 100, balance};
+}
+
+}  // namespace
+
+TEST(Deposit, Simple) {
+  s21::DepositModel m;
+  auto result = m.Calculate({100000, 365, 10, 13, s21::DepositModel::Periodicity::kAtEnd, false}, {});
+  ASSERT_NEAR(result.interest, 10000, 1e-6);
+  ASSERT_NEAR(result.tax, 1300, 1e-6);
+  ASSERT_NEAR(result.balance, 100000, 1e-6);
+}
+
+TEST(Deposit, DailyCapitalization) {
+  s21::DepositModel m;
+  auto result = m.Calculate({100000, 3650, 10, 0, s21::DepositModel::Periodicity::kDaily, true}, {});
+  ASSERT_NEAR(result.balance, 100000 * std::pow(1 + 0.1 / 365, 3650), 1e-6);
+  ASSERT_NEAR(result.interest, result.balance - 100000, 1e-6);
+}
+
+TEST(Deposit, Timeline) {
+  using Type = s21::DepositModel::Event::Type;
+  using Periodicity = s21::DepositModel::Periodicity;
+  std::vector<s21::DepositModel::Event> events;
+  for (int i = 0; i < 500; ++i) {
+    int day = (i * 7919) % 3000;
+    Type type = (i % 5 == 0) ? Type::kRateChange : (i % 3 ? Type::kReplenishment : Type::kWithdrawal);
+    double value = (type == Type::kRateChange) ? 2 + i % 11 : 100 + i;
+    events.push_back({day, type, value});
+  }
+  s21::DepositModel m;
+  for (auto [periodicity, period] : {std::pair{Periodicity::kDaily, 1}, {Periodicity::kWeekly, 7}, {Periodicity::kYearly, 365}}) {
+    for (bool capitalization : {false, true}) {
+      s21::DepositModel::Deposit deposit{1'000'000, 3000, 7.5, 13, periodicity, capitalization};
+      auto result = m.Calculate(deposit, events);
+      auto expected = SimulateDeposit(deposit, period, events);
+      ASSERT_NEAR(result.interest, expected.interest, 1e-6);
+      ASSERT_NEAR(result.balance, expected.balance, 1e-6);
+    }
+  }
+}
+
+TEST(Deposit, MonthlyCapitalization) {
+  s21::DepositModel m;
+  auto result = m.Calculate({100000, 365, 12, 0, s21::DepositModel::Periodicity::kMonthly, true}, {});
+  ASSERT_NEAR(result.balance, 100000 * std::pow(1.01, 12), 1e-6);
+}
+
+TEST(Deposit, ErrorDeposit) {
+  using Type = s21::DepositModel::Event::Type;
+  s21::DepositModel m;
+  s21::DepositModel::Deposit deposit{1000, 30, 5, 0, s21::DepositModel::Periodicity::kDaily, true};
+  EXPECT_THROW(m.Calculate(deposit, {{10, Type::kWithdrawal, 2000}}), std::invalid_argument);
+  EXPECT_THROW(m.Calculate(deposit, {{31, Type::kReplenishment, 1}}), std::invalid_argument);
+  deposit.term = 0;
+  EXPECT_THROW(m.Calculate(deposit, {}), std::invalid_argument);
+}
+
+TEST(Simulation, Deterministic) {
+  s21::Simulation::Scenario scenario{12, 300000, 5, 16.0, 'a', 0.0, 12, 0.0, 10000, 42};
+  auto [payment, percentage, total] = s21::CreditModel().CalculateResult(12, 300000, 5, 16.0, 1, 'a');
+  auto result = s21::Simulation().Simulate(scenario, {0.0, 0.5, 1.0});
+  ASSERT_EQ(result.paths, 10000u);
+  ASSERT_EQ(result.prepaid, 0u);
+  ASSERT_NEAR(result.mean, percentage, 1e-6);
+  ASSERT_NEAR(result.deviation, 0.0, 1e-6);
+  for (double quantile : result.quantiles) ASSERT_NEAR(quantile, percentage, 1e-6);
+}
+
+TEST(Simulation, Prepayment) {
+  double hazard = 0.01;
+  s21::CreditModel::Schedule schedule;
+  s21::CreditModel().CalculateSchedule(12, 1'000'000, 20, 8.0, 'd', schedule);
+  double expected = 0.0, survival = 1.0;
+  for (std::size_t i = 0; i < schedule.Size(); ++i, survival *= 1 - hazard)
+    expected += survival * schedule.interest[i];
+
+  s21::Simulation::Scenario scenario{12, 1'000'000, 20, 8.0, 'd', 0.0, 12, hazard, 200000, 7};
+  auto result = s21::Simulation().Simulate(scenario, {});
+  ASSERT_NEAR(result.mean, expected, 4 * result.deviation / std::sqrt(200000.0));
+  ASSERT_NEAR(result.prepaid / 200000.0, 1 - std::pow(1 - hazard, 239), 0.01);
+}
+
+TEST(Simulation, Quantiles) {
+  s21::Simulation::Scenario scenario{12, 500000, 15, 6.0, 'a', 0.75, 12, 0.005, 100000, 1};
+  std::vector<double> probabilities{0.0, 0.05, 0.5, 0.95, 1.0};
+  s21::Simulation simulation;
+  auto first = simulation.Simulate(scenario, probabilities);
+  auto second = simulation.Simulate(scenario, probabilities);
+  ASSERT_EQ(first.mean, second.mean);
+  ASSERT_EQ(first.deviation, second.deviation);
+  ASSERT_EQ(first.quantiles, second.quantiles);
+  ASSERT_EQ(first.quantiles.front(), first.min);
+  ASSERT_EQ(first.quantiles.back(), first.max);
+  ASSERT_TRUE(std::is_sorted(first.quantiles.begin(), first.quantiles.end()));
+  ASSERT_GT(first.quantiles[3], first.quantiles[1]);
+
+  scenario.seed = 2;
+  auto other = simulation.Simulate(scenario, probabilities);
+  ASSERT_NE(first.mean, other.mean);
+  ASSERT_NEAR(first.mean, other.mean, 0.02 * first.mean);
+  ASSERT_NEAR(first.quantiles[2], other.quantiles[2], 0.02 * first.quantiles[2]);
+}
+
+TEST(Simulation, ErrorSimulation) {
+  s21::Simulation simulation;
+  s21::Simulation::Scenario scenario{12, 1000, 1, 5.0, 'a', 0.5, 12, 0.0, 100, 0};
+  EXPECT_THROW(simulation.Simulate(scenario, {1.5}), std::invalid_argument);
+  scenario.prepayment = 1.5;
+  EXPECT_THROW(simulation.Simulate(scenario, {}), std::invalid_argument);
+  scenario.prepayment = 0.0;
+  scenario.reset = 0;
+  EXPECT_THROW(simulation.Simulate(scenario, {}), std::invalid_argument);
+  scenario.reset = 12;
+  scenario.paths = 0;
+  EXPECT_THROW(simulation.Simulate(scenario, {}), std::invalid_argument);
+}
+
+TEST(BatchFile, Run) {
+  std::string input = "s21_batch_input.bin", output = "s21_batch_output.bin";
+  std::size_t rows = s21::BatchFile::kBlockRows + 1000;
+  {
+    auto file = s21::BatchFile::Create(input, {"sin(x)", "f(x)"}, rows, 1);
+    double* x = file.Column(0);
+    for (std::size_t i = 0; i < rows; ++i) x[i] = -50 + 1e-4 * i;
+  }
+  s21::Library library;
+  library.Define("f(a)=a^2+1");
+  ASSERT_EQ(s21::BatchFile::Run(input, output, &library), rows);
+
+  s21::BatchFile source(input), target(output);
+  std::remove(input.c_str());
+  std::remove(output.c_str());
+  ASSERT_EQ(target.Rows(), rows);
+  ASSERT_EQ(target.Columns(), 2u);
+  ASSERT_EQ(target.Expressions(), (std::vector<std::string>{"sin(x)", "f(x)"}));
+  for (std::size_t i = 0; i < rows; i += 997) {
+    double x = source.Column(0)[i];
+    ASSERT_EQ(target.Column(0)[i], std::sin(x));
+    ASSERT_EQ(target.Column(1)[i], x * x + 1);
+  }
+  ASSERT_EQ(target.Column(1)[rows - 1], std::pow(source.Column(0)[rows - 1], 2) + 1);
+}
+
+TEST(BatchFile, ErrorBatchFile) {
+  std::string path = "s21_batch_error.bin";
+  EXPECT_THROW(s21::BatchFile("s21_batch_missing.bin"), std::invalid_argument);
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fputs("S21BATCH but not a batch file at all, just text", file);
+  std::fclose(file);
+  EXPECT_THROW(s21::BatchFile{path}, std::invalid_argument);
+  s21::BatchFile::Create(path, {"x"}, 10, 2);
+  EXPECT_THROW(s21::BatchFile::Run(path, "s21_batch_error_out.bin"), std::invalid_argument);
+  s21::BatchFile::Create(path, {"x+"}, 10, 1);
+  EXPECT_THROW(s21::BatchFile::Run(path, "s21_batch_error_out.bin"), std::invalid_argument);
+  EXPECT_THROW(s21::BatchFile::Create(path, {}, 0, std::size_t{1} << 32),
+               std::invalid_argument);
+  std::remove(path.c_str());
+  std::remove("s21_batch_error_out.bin");
+}
+
+TEST(Format, ShortestRoundTrip) {
+  char buffer[s21::Format::kBufferSize];
+  EXPECT_EQ(s21::Format::Shortest(0.1, buffer), "0.1");
+  EXPECT_EQ(s21::Format::Shortest(0.1 + 0.2, buffer), "0.30000000000000004");
+  EXPECT_EQ(s21::Format::Shortest(-2.5, buffer), "-2.5");
+  for (int i = 0; i < 10000; ++i) {
+    double value = std::sin(i * 0.61) * std::pow(10.0, i % 41 - 20.0);
+    std::string text(s21::Format::Shortest(value, buffer));
+    EXPECT_EQ(std::strtod(text.c_str(), nullptr), value);
+    EXPECT_LE(text.size(), 24u);
+  }
+}
+
+TEST(Format, FixedAndGeneral) {
+  char buffer[s21::Format::kBufferSize];
+  char expected[s21::Format::kBufferSize];
+  for (double value : {0.0, 0.005, 1.125, -2.675, 123456.789, 1e300, -1e-7}) {
+    std::snprintf(expected, sizeof(expected), "%.2f", value);
+    EXPECT_EQ(s21::Format::Fixed(value, 2, buffer), expected);
+    std::snprintf(expected, sizeof(expected), "%.8g", value);
+    EXPECT_EQ(s21::Format::General(value, 8, buffer), expected);
+  }
+  EXPECT_EQ(s21::Format::Fixed(1.5, -3, buffer), "2");
+  EXPECT_EQ(s21::Format::General(1.5, 0, buffer), "2");
+}
+
+TEST(Format, NotFinite) {
+  char buffer[s21::Format::kBufferSize];
+  double inf = std::numeric_limits<double>::infinity();
+  EXPECT_EQ(s21::Format::Shortest(inf, buffer), "inf");
+  EXPECT_EQ(s21::Format::Fixed(-inf, 2, buffer), "-inf");
+  EXPECT_EQ(s21::Format::General(std::nan(""), 8, buffer), "nan");
+  EXPECT_TRUE(std::isnan(std::stod(
+      std::string(s21::Format::Shortest(std::nan(""), buffer)))));
+}
+
+TEST(ProgramFile, FindAndEvaluate) {
+  std::string path = "s21_programs_test.bin";
+  std::vector<std::string> expressions = {
+      "x^2+sin(x)", "sum(k,1,10,k*x)", "sum(k,1,3,prod(j,1,k,j+x))",
+      "if(x<0,-x,x)", "x+", "x^2+sin(x)"};
+  EXPECT_EQ(s21::ProgramFile::Compile(path, expressions), 4u);
+  s21::ProgramFile file(path);
+  EXPECT_EQ(file.Size(), 4u);
+  for (std::size_t i = 0; i < 4; ++i) {
+    s21::Model m;
+    m.SetInput(expressions[i]);
+    s21::Program expected = m.CompileMathExpression();
+    auto stored = file.Find(expressions[i]);
+    ASSERT_TRUE(stored.has_value());
+    for (double x : {-1.5, 0.0, 2.25})
+      EXPECT_EQ(stored->Evaluate(x), expected.Evaluate(x));
+  }
+  EXPECT_FALSE(file.Find("x+").has_value());
+  EXPECT_FALSE(file.Find("x^3").has_value());
+  std::remove(path.c_str());
+}
+
+TEST(ProgramFile, StaleDefinitions) {
+  std::string path = "s21_programs_stale.bin";
+  s21::Library library;
+  library.Define("f(a)=a*2");
+  s21::ProgramFile::Compile(path, {"f(x)+1"}, &library);
+  s21::ProgramFile file(path);
+  auto stored = file.Find(library.Expand("f(x)+1"));
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_DOUBLE_EQ(stored->Evaluate(3), 7);
+  library.Define("f(a)=a*3");
+  EXPECT_FALSE(file.Find(library.Expand("f(x)+1")).has_value());
+  std::remove(path.c_str());
+}
+
+TEST(ProgramFile, ErrorProgramFile) {
+  std::string path = "s21_programs_error.bin";
+  EXPECT_THROW(s21::ProgramFile("s21_no_such_file.bin"),
+               std::invalid_argument);
+  s21::ProgramFile::Compile(path, {"sum(k,1,5,k*x)"});
+  std::FILE* file = std::fopen(path.c_str(), "r+b");
+  std::fseek(file, 0, SEEK_END);
+  long size = std::ftell(file);
+  // Points the first instruction of the body at a missing constant
+  for (long offset = size - 8; offset >= 0; offset -= 8) {
+    std::fseek(file, offset, SEEK_SET);
+    unsigned char bytes[8];
+    if (std::fread(bytes, 1, 8, file) != 8) break;
+    if (bytes[0] == static_cast<unsigned char>(s21::OpCode::kVariable) &&
+        bytes[4] == 2) {
+      bytes[0] = static_cast<unsigned char>(s21::OpCode::kConstant);
+      bytes[4] = 9;
+      std::fseek(file, offset, SEEK_SET);
+      std::fwrite(bytes, 1, 8, file);
+      break;
+    }
+  }
+  std::fclose(file);
+  EXPECT_FALSE(s21::ProgramFile(path).Find("sum(k,1,5,k*x)").has_value());
+  file = std::fopen(path.c_str(), "r+b");
+  std::fputs("S21BATCH", file);
+  std::fclose(file);
+  EXPECT_THROW(s21::ProgramFile{path}, std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+TEST(HistoryFile, FindAndRecent) {
+  std::string path = "s21_history_test.bin";
+  std::remove(path.c_str());
+  {
+    s21::HistoryFile history(path);
+    EXPECT_EQ(history.Size(), 0u);
+    history.Append("2 + x", "2 + x", 1, 3, 100);
+    history.Append("sq(x)", "((x)^2)", 0.0, 0, 200);
+    history.Append("2+x", "2+x", 1, 4, 300);
+    EXPECT_EQ(history.Find(" 2+ x", 1), 4);
+    EXPECT_EQ(history.Find("((x)^2)", -0.0), 0);
+    EXPECT_FALSE(history.Find("2+x", 2).has_value());
+    EXPECT_FALSE(history.Find("2-x", 1).has_value());
+  }
+  s21::HistoryFile history(path);
+  std::remove(path.c_str());
+  ASSERT_EQ(history.Size(), 3u);
+  EXPECT_EQ(history.Find("2+x", 1), 4);
+  std::vector<s21::HistoryFile::Record> recent = history.Recent(2);
+  ASSERT_EQ(recent.size(), 2u);
+  EXPECT_EQ(recent[0].expression, "2+x");
+  EXPECT_EQ(recent[0].time, 300);
+  EXPECT_EQ(recent[1].expression, "sq(x)");
+  EXPECT_EQ(recent[1].result, 0);
+}
+
+TEST(HistoryFile, Compact) {
+  std::string path = "s21_history_compact.bin";
+  std::remove(path.c_str());
+  s21::HistoryFile history(path, 4096);
+  for (int i = 0; i < 1000; ++i) {
+    std::string expression = "x*" + std::to_string(i % 300);
+    history.Append(expression, expression, 2, i, i);
+    ASSERT_LE(history.Used(), history.Capacity());
+  }
+  history.Append("x*7", "x*7", 2, -1, 1000);
+  EXPECT_EQ(history.Find("x*7", 2), -1);
+  EXPECT_EQ(history.Find("x*399", 2), std::nullopt);
+  EXPECT_EQ(history.Find("x*99", 2), 999);
+  std::size_t size = history.Size();
+  history.Compact();
+  EXPECT_LE(history.Used() - 32, (history.Capacity() - 32) / 2);
+  EXPECT_LE(history.Size(), size);
+  EXPECT_EQ(history.Find("x*7", 2), -1);
+
+  s21::HistoryFile reopened(path, s21::HistoryFile::kCapacity);
+  std::remove(path.c_str());
+  EXPECT_EQ(reopened.Capacity(), 4096u);
+  EXPECT_EQ(reopened.Size(), history.Size());
+  EXPECT_EQ(reopened.Recent(1)[0].result, -1);
+}
+
+TEST(HistoryFile, SharedFile) {
+  std::string path = "s21_history_shared.bin";
+  std::remove(path.c_str());
+  s21::HistoryFile first(path, 4096), second(path);
+  first.Append("x+1", "x+1", 1, 2, 0);
+  EXPECT_EQ(second.Find("x+1", 1), 2);
+  for (int i = 0; i < 200; ++i) {
+    std::string expression = "x*" + std::to_string(i);
+    second.Append(expression, expression, 1, i, i);
+  }
+  first.Append("x+2", "x+2", 1, 3, 1);
+  EXPECT_EQ(second.Find("x+2", 1), 3);
+  EXPECT_EQ(first.Find("x*199", 1), 199);
+  EXPECT_EQ(first.Find("x+1", 1), std::nullopt);
+  std::vector<s21::HistoryFile::Record> recent = first.Recent(1000);
+  EXPECT_EQ(recent.size(), second.Recent(1000).size());
+  EXPECT_EQ(recent.front().expression, "x+2");
+  EXPECT_EQ(recent[1].expression, "x*199");
+  std::remove(path.c_str());
+}
+
+TEST(HistoryFile, ErrorHistoryFile) {
+  std::string path = "s21_history_error.bin";
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fputs("S21HISTO but not a history file at all, just text", file);
+  std::fclose(file);
+  {
+    s21::HistoryFile history(path, 4096);
+    EXPECT_EQ(history.Size(), 0u);
+    EXPECT_EQ(history.Capacity(), 4096u);
+    EXPECT_THROW(history.Append(std::string(3000, 'x'), "x", 0, 0, 0),
+                 std::invalid_argument);
+    history.Append("x", "x", 0, 0, 0);
+  }
+  std::FILE* damaged = std::fopen(path.c_str(), "r+b");
+  std::uint64_t end = 4000;
+  std::fseek(damaged, 24, SEEK_SET);
+  std::fwrite(&end, sizeof(end), 1, damaged);
+  std::fclose(damaged);
+  s21::HistoryFile history(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(history.Size(), 1u);
+  EXPECT_EQ(history.Used(), 32u + 48u);
+  EXPECT_THROW(s21::HistoryFile("s21_missing_dir/history.bin"),
+               std::invalid_argument);
+  EXPECT_THROW(s21::HistoryFile(path, 16), std::invalid_argument);
+}
+
+TEST(ProgramSet, MatchesSeparatePrograms) {
+  std::vector<std::string> expressions = {
+      "sin(x)^2", "sin(x)^2+cos(x)^2", "x*sin(x)", "sin(x)*x",
+      "if(x<0,-x,sqrt(x))", "sum(k,1,3,x^k)", "sin(x)^2"};
+  std::vector<s21::Program> programs;
+  s21::ProgramSet set;
+  for (const std::string& expression : expressions) {
+    s21::Model m;
+    m.SetInput(expression);
+    programs.push_back(m.CompileMathExpression());
+  }
+  for (const s21::Program& program : programs) set.Add(program);
+  ASSERT_EQ(set.Size(), expressions.size());
+
+  std::vector<double> x(1000);
+  for (size_t i = 0; i < x.size(); ++i) x[i] = -5 + 0.01 * i;
+  std::vector<std::vector<double>> y(expressions.size(),
+                                     std::vector<double>(x.size()));
+  std::vector<double*> results;
+  for (auto& column : y) results.push_back(column.data());
+  set.Evaluate(x.data(), results.data(), x.size());
+  std::vector<double> expected(x.size());
+  for (size_t f = 0; f < programs.size(); ++f) {
+    programs[f].Evaluate(x.data(), expected.data(), x.size());
+    ASSERT_EQ(y[f], expected) << expressions[f];
+  }
+}
+
+TEST(ProgramSet, SharesOperations) {
+  s21::ProgramSet set;
+  for (const char* expression : {"sin(x)+1", "1+sin(x)", "sin(x)*2"}) {
+    s21::Model m;
+    m.SetInput(expression);
+    set.Add(m.CompileMathExpression());
+  }
+  // x, sin, 1, +, 2, *
+  ASSERT_EQ(set.Operations(), 6);
+  EXPECT_THROW(set.Add(s21::Program()), std::invalid_argument);
+}
+
+TEST(CurveSampler, ParametricCircle) {
+  s21::Model mx, my;
+  mx.SetInput("cos(x)");
+  my.SetInput("sin(x)");
+  s21::Program x = mx.CompileMathExpression();
+  s21::Program y = my.CompileMathExpression();
+  double pixel = 0.001;
+  s21::CurveSampler::Viewport viewport{-1, 1, -1, 1, 2000, 2000};
+  s21::CurveSampler::Curve curve =
+      s21::CurveSampler().Parametric(x, y, 0, 2 * M_PI, viewport, 16);
+  ASSERT_GT(curve.t.size(), 2 * M_PI / pixel / s21::CurveSampler::kStep);
+  EXPECT_EQ(curve.t.front(), 0);
+  EXPECT_EQ(curve.t.back(), 2 * M_PI);
+  for (size_t i = 0; i + 1 < curve.t.size(); ++i) {
+    ASSERT_LT(curve.t[i], curve.t[i + 1]);
+    ASSERT_LE(std::hypot(curve.x[i + 1] - curve.x[i],
+                         curve.y[i + 1] - curve.y[i]),
+              s21::CurveSampler::kStep * pixel);
+    ASSERT_NEAR(std::hypot(curve.x[i], curve.y[i]), 1, 1e-12);
+  }
+}
+
+TEST(CurveSampler, PolarSpiral) {
+  s21::Model m;
+  m.SetInput("x");
+  s21::Program r = m.CompileMathExpression();
+  s21::CurveSampler::Viewport viewport{-650, 650, -650, 650, 26000, 26000};
+  s21::CurveSampler::Curve curve =
+      s21::CurveSampler().Polar(r, 0, 200 * M_PI, viewport);
+  // Arc length of r = θ is about θ^2 / 2, sampled every 2 pixels at most
+  EXPECT_GT(curve.t.size(), 1e6);
+  EXPECT_LE(curve.t.size(), s21::CurveSampler::kMaxPoints);
+  for (size_t i = 0; i < curve.t.size(); i += 1000)
+    ASSERT_NEAR(std::hypot(curve.x[i], curve.y[i]), curve.t[i], 1e-9);
+
+  s21::CurveSampler::Curve thin = s21::CurveSampler::Thin(curve, viewport);
+  EXPECT_LT(thin.t.size(), curve.t.size());
+  EXPECT_EQ(thin.t.back(), curve.t.back());
+  for (size_t i = 1; i + 1 < thin.t.size(); ++i)
+    ASSERT_GE(std::max(std::abs(thin.x[i] - thin.x[i - 1]),
+                       std::abs(thin.y[i] - thin.y[i - 1])),
+              0.05);
+}
+
+TEST(CurveSampler, BreaksAtJumpsAndHoles) {
+  s21::Model mx, my;
+  mx.SetInput("x");
+  my.SetInput("tan(x)+sqrt(x^2-1)-sqrt(x^2-1)");
+  s21::Program x = mx.CompileMathExpression();
+  s21::Program y = my.CompileMathExpression();
+  s21::CurveSampler::Viewport viewport{-3, 3, -2, 2, 600, 400};
+  s21::CurveSampler::Curve curve =
+      s21::CurveSampler().Parametric(x, y, -3, 3, viewport);
+  // Undefined on (-1, 1) and broken at the poles of tan at ±π/2
+  size_t pieces = 0;
+  for (size_t i = 0; i < curve.t.size(); ++i) {
+    bool is_start = !std::isnan(curve.x[i]) &&
+                    (i == 0 || std::isnan(curve.x[i - 1]));
+    pieces += is_start;
+    if (!std::isnan(curve.x[i])) {
+      ASSERT_GE(std::abs(curve.t[i]), 1);
+    }
+  }
+  EXPECT_EQ(pieces, 4u);
+  EXPECT_THROW(s21::CurveSampler().Parametric(x, y, 1, 1, viewport),
+               std::invalid_argument);
+  EXPECT_THROW(s21::CurveSampler().Polar(s21::Program(), 0, 1, viewport),
+               std::invalid_argument);
+  viewport.height = 0;
+  EXPECT_THROW(s21::CurveSampler().Polar(x, 0, 1, viewport),
+               std::invalid_argument);
+}
+
+TEST(ImplicitSampler, Circle) {
+  s21::Model m;
+  m.SetInput("x^2+y^2-1");
+  s21::Program f = m.CompileMathExpression();
+  s21::CurveSampler::Viewport viewport{-2, 2, -2, 2, 800, 800};
+  s21::CurveSampler::Curve curve = s21::ImplicitSampler().Sample(f, viewport);
+  // One closed piece a few pixels from segment to segment
+  ASSERT_GT(curve.t.size(), 100u);
+  EXPECT_EQ(curve.x.front(), curve.x.back());
+  EXPECT_EQ(curve.y.front(), curve.y.back());
+  for (size_t i = 0; i < curve.t.size(); ++i) {
+    ASSERT_NEAR(std::hypot(curve.x[i], curve.y[i]), 1, 1e-4);
+    if (i > 0) {
+      ASSERT_LT(std::hypot(curve.x[i] - curve.x[i - 1],
+                           curve.y[i] - curve.y[i - 1]),
+                0.03);
+    }
+  }
+}
+
+TEST(ImplicitSampler, PolesAndEmptyViews) {
+  s21::Model m;
+  m.SetInput("1/x-y");
+  s21::Program f = m.CompileMathExpression();
+  s21::CurveSampler::Viewport viewport{-3, 3, -3, 3, 600, 600};
+  s21::CurveSampler::Curve curve = s21::ImplicitSampler().Sample(f, viewport);
+  // The two branches of the hyperbola, not joined across the pole
+  size_t pieces = 0;
+  for (size_t i = 0; i < curve.t.size(); ++i) {
+    bool is_start =
+        !std::isnan(curve.x[i]) && (i == 0 || std::isnan(curve.x[i - 1]));
+    pieces += is_start;
+    if (!std::isnan(curve.x[i])) {
+      ASSERT_NEAR(curve.x[i] * curve.y[i], 1, 0.05);
+    }
+  }
+  EXPECT_EQ(pieces, 2u);
+  m.SetInput("x^2+y^2+1");
+  EXPECT_TRUE(s21::ImplicitSampler()
+                  .Sample(m.CompileMathExpression(), viewport)
+                  .t.empty());
+  viewport.x_max = viewport.x_min;
+  EXPECT_THROW(s21::ImplicitSampler().Sample(f, viewport),
+               std::invalid_argument);
+}
+
+TEST(GraphSampler, SkipsBlocksOutsideThePlot) {
+  s21::Model m;
+  m.SetInput("x^2");
+  s21::Program f = m.CompileMathExpression();
+  std::vector<double> x;
+  for (int i = -1000; i <= 1000; ++i) x.push_back(i * 0.01);
+  auto graphs = s21::GraphSampler().Sample({f}, x, -1, 4, 0);
+  ASSERT_EQ(graphs.size(), 1u);
+  const std::vector<double>& y = graphs[0].y;
+  ASSERT_EQ(y.size(), x.size());
+  EXPECT_TRUE(graphs[0].breaks.empty());
+  size_t drawn = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    if (std::abs(x[i]) <= 2) {
+      ASSERT_EQ(y[i], x[i] * x[i]) << x[i];
+    } else if (std::abs(x[i]) > 3.2) {
+      ASSERT_TRUE(std::isnan(y[i])) << x[i];
+    }
+    drawn += !std::isnan(y[i]);
+  }
+  EXPECT_LT(drawn, x.size() / 2);
+  // A block another function is drawn in keeps its own values out
+  m.SetInput("x^2+100");
+  s21::Program g = m.CompileMathExpression();
+  auto both = s21::GraphSampler().Sample({f, g}, x, -1, 4, 0);
+  EXPECT_TRUE(std::equal(both[0].y.begin(), both[0].y.end(), y.begin(),
+                         [](double a, double b) {
+                           return a == b || (std::isnan(a) && std::isnan(b));
+                         }));
+  EXPECT_TRUE(std::all_of(both[1].y.begin(), both[1].y.end(),
+                          [](double v) { return std::isnan(v); }));
+  EXPECT_THROW(s21::GraphSampler().Sample({f}, x, 1, 1, 0),
+               std::invalid_argument);
+}
+
+TEST(GraphSampler, BreaksAtPolesOnly) {
+  std::vector<double> x;
+  for (int i = -1000; i <= 1000; ++i) x.push_back(i * 0.01 + 0.005);
+  auto breaks = [&x](const std::string& expression) {
+    s21::Model m;
+    m.SetInput(expression);
+    s21::Program f = m.CompileMathExpression();
+    auto graphs = s21::GraphSampler().Sample({f}, x, -10, 10, 1e-3);
+    std::vector<double> at;
+    for (size_t i : graphs[0].breaks) {
+      // Both samples around the break are kept
+      EXPECT_FALSE(std::isnan(graphs[0].y[i]));
+      EXPECT_FALSE(std::isnan(graphs[0].y[i + 1]));
+      at.push_back((x[i] + x[i + 1]) / 2);
+    }
+    return at;
+  };
+  // tan has poles at ±π/2 and ±3π/2 within [-10, 10]
+  std::vector<double> poles = breaks("tan(x)");
+  ASSERT_EQ(poles.size(), 6u);
+  for (double at : poles)
+    EXPECT_NEAR(std::remainder(at - M_PI / 2, M_PI), 0, 0.01);
+  // Steep but continuous, with steps far taller than the plot
+  EXPECT_TRUE(breaks("100*sin(50*x)").empty());
+  // A hole rather than a pole
+  EXPECT_TRUE(breaks("sin(x)/x").empty());
+  EXPECT_EQ(breaks("1/x").size(), 1u);
+}
+
+TEST(IncrementalParser, MatchesModel) {
+  const std::vector<std::string> expressions = {
+      "2+3*4-5/2",         "-2^2+3%2",          "sin(1)^2+cos(1)^2",
+      "3*-2*(4-(-1))",     "1.5e3+2.5e-1*x",    "if(x<2,x*2,-x)",
+      "max(1,min(x,3))+1", "2<=3==(4!=5)",      "sqrt(16)^0.5*ln(x)",
+      "(1+2)*(3+(4",       "atan(x)/log(100)",  "acos(.5)+asin(1.)"};
+  auto same = [](std::optional<double> a, std::optional<double> b) {
+    return a.has_value() == b.has_value() &&
+           (!a || *a == *b || (std::isnan(*a) && std::isnan(*b)));
+  };
+  s21::IncrementalParser parser;
+  parser.SetX(2.5);
+  for (const std::string& expression : expressions) {
+    parser.Assign("");
+    std::vector<std::optional<double>> previews;
+    for (char c : expression) {
+      parser.Append(std::string(1, c));
+      previews.push_back(parser.Preview());
+      if (!previews.back()) continue;
+      // The Model agrees once the open parentheses are closed
+      std::string closed = parser.Text();
+      long open = std::count(closed.begin(), closed.end(), '(') -
+                  std::count(closed.begin(), closed.end(), ')');
+      closed.append(std::max(open, 0L), ')');
+      s21::Model m;
+      m.SetInput(closed);
+      m.SetX(2.5);
+      EXPECT_TRUE(same(previews.back(), m.CalculateMathExpression()))
+          << closed;
+    }
+    EXPECT_TRUE(previews.back().has_value()) << expression;
+    // Deleting returns to the previews seen while typing
+    for (size_t size = expression.size(); size > 1; --size) {
+      parser.Erase(1);
+      EXPECT_TRUE(same(parser.Preview(), previews[size - 2]))
+          << parser.Text();
+    }
+  }
+  parser.Assign("2*(x+1");
+  parser.Assign("2*(x-1");
+  EXPECT_EQ(parser.Preview(), 3);
+  parser.SetX(1);
+  EXPECT_EQ(parser.Text(), "");
+  parser.Assign("2*(x-1");
+  EXPECT_EQ(parser.Preview(), 0);
+}
+
+TEST(IncrementalParser, NoPreview) {
+  s21::IncrementalParser parser;
+  for (const char* text :
+       {"", "2+", "sin", "2*(", "1e", "e5", "*2", "1..2", "2+y", "1=2",
+        "min(1)", "if(1,2,3,4)", "sum(x,1,3,x)", "pi*2", "2)", "calc_error",
+        "-", "cos()"}) {
+    parser.Assign(text);
+    EXPECT_FALSE(parser.Preview().has_value()) << text;
+  }
+  // The text stays invalid whatever follows it
+  parser.Assign("1..2");
+  parser.Append("+3");
+  EXPECT_FALSE(parser.Preview().has_value());
+  parser.Erase(4);
+  EXPECT_EQ(parser.Preview(), 1);
+}
+
+TEST(ThreadPool, RunsEveryIterationOnce) {
+  s21::ThreadPool pool(4);
+  std::vector<std::atomic<int>> visits(10000);
+  pool.ParallelFor(100, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      // Loops issued from a chunk complete on the same pool
+      pool.ParallelFor(100, [&](std::size_t first, std::size_t last) {
+        for (std::size_t j = first; j < last; ++j) ++visits[i * 100 + j];
+      });
+    }
+  });
+  EXPECT_TRUE(std::all_of(visits.begin(), visits.end(),
+                          [](const std::atomic<int>& v) { return v == 1; }));
+  EXPECT_THROW(pool.ParallelFor(100,
+                                [](std::size_t begin, std::size_t) {
+                                  if (begin > 0) throw std::out_of_range("");
+                                }),
+               std::out_of_range);
+}
+
+TEST(ThreadPool, ReducesTheSameOnAnyPool) {
+  auto harmonic = [](s21::ThreadPool& pool) {
+    return pool.ParallelReduce(
+        1'000'000, 1000, 0.0,
+        [](std::size_t begin, std::size_t end) {
+          double sum = 0.0;
+          for (std::size_t i = begin; i < end; ++i) sum += 1.0 / (i + 1);
+          return sum;
+        },
+        [](double& total, double part) { total += part; });
+  };
+  s21::ThreadPool single(1), pair(2), many(8);
+  double expected = harmonic(single);
+  EXPECT_NEAR(expected, std::log(1e6) + 0.5772156649, 1e-6);
+  EXPECT_EQ(harmonic(pair), expected);
+  EXPECT_EQ(harmonic(many), expected);
+  EXPECT_EQ(harmonic(s21::ThreadPool::Shared()), expected);
+}
+
+TEST(ThreadPool, Cancels) {
+  s21::ThreadPool pool(4);
+  s21::CancellationToken token = s21::CancellationToken::Create();
+  std::atomic<std::size_t> runs{0};
+  auto body = [&](std::size_t, std::size_t) {
+    ++runs;
+    token.Cancel();
+  };
+  EXPECT_THROW(pool.ParallelFor(1000, body, 1,
+                                s21::ThreadPool::Priority::kBackground, token),
+               s21::Cancelled);
+  // Chunks already started finish, one per thread at most
+  EXPECT_GE(runs, 1u);
+  EXPECT_LE(runs, pool.Size());
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_THROW(pool.ParallelFor(1, body, 1,
+                                s21::ThreadPool::Priority::kInteractive, token),
+               s21::Cancelled);
+  EXPECT_LE(runs, pool.Size());
+  // A default token is never cancelled
+  s21::CancellationToken none;
+  none.Cancel();
+  EXPECT_FALSE(none.IsCancelled());
+}
+
+TEST(Tracer, RecordsSpansOfAllThreads) {
+  std::string path = "s21_trace_test.json";
+  { s21::Tracer::Span span("untraced", "test"); }
+  ASSERT_TRUE(s21::Tracer::Shared().Start(path));
+  {
+    s21::Tracer::Span span("outer", "test");
+    s21::Model m;
+    m.SetInput("2+x");
+    m.SetX(1);
+    EXPECT_DOUBLE_EQ(m.CalculateMathExpression(), 3);
+  }
+  s21::ThreadPool pool(4);
+  pool.ParallelFor(16, [](std::size_t, std::size_t) {
+    s21::Tracer::Span span("chunk", "test");
+  });
+  s21::Tracer::Shared().Stop();
+  { s21::Tracer::Span span("untraced", "test"); }
+
+  std::ifstream file(path);
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  auto count = [&text](const std::string& needle) {
+    std::size_t n = 0;
+    for (auto at = text.find(needle); at != std::string::npos;
+         at = text.find(needle, at + 1))
+      ++n;
+    return n;
+  };
+  EXPECT_EQ(text.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_EQ(count("\"name\":\"outer\""), 1u);
+  EXPECT_EQ(count("\"name\":\"chunk\""), 16u);
+  EXPECT_EQ(count("\"name\":\"Model::Calculate\""), 1u);
+  EXPECT_EQ(count("untraced"), 0u);
+  EXPECT_EQ(count("\"ph\":\"X\""), count("\"dur\":"));
+  EXPECT_NE(text.find("\"dropped\":\"0\"}}"), std::string::npos);
+  std::remove(path.c_str());
+}
+
+TEST(Tracer, DropsEventsOnFullRing) {
+  std::string path = "s21_trace_full.json";
+  ASSERT_TRUE(s21::Tracer::Shared().Start(path));
+  {
+    // Inner spans cannot flush, so the ring of this thread fills up
+    s21::Tracer::Span outer("outer", "test");
+    for (std::size_t i = 0; i < s21::Tracer::kCapacity + 10; ++i)
+      s21::Tracer::Span span("inner", "test");
+  }
+  EXPECT_EQ(s21::Tracer::Shared().Dropped(), 11u);
+  s21::Tracer::Shared().Stop();
+  std::remove(path.c_str());
+}
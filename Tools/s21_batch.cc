@@ -0,0 +1,167 @@
+/**
+ * @file s21_batch.cc
+ * @brief Command line tool converting between CSV and batch files, running
+ * batch jobs and precompiling expression libraries.
+ *
+ * Built by `make tools`:
+ *
+ *   s21_batch pack <input.csv> <input.bin> <expression>...
+ *     Writes the first column of the CSV as the x column of a batch input
+ *     file evaluating the given expressions. A first line that is not a
+ *     number is taken as a header and skipped.
+ *   s21_batch run <input.bin> <output.bin>
+ *     Evaluates every expression of the input file into the output file.
+ *   s21_batch unpack <input.bin> <output.bin> <output.csv>
+ *     Writes x and the results as CSV with a header line.
+ *   s21_batch compile <expressions.txt> <programs.bin> [definitions.txt]
+ *     Compiles the expressions, one per line, into a program library, with
+ *     the user definitions of the given file inlined. The calculator maps
+ *     programs.bin from its data directory at start-up, next to the
+ *     definitions.txt it saves: the AppDataLocation of Qt, which is
+ *     ~/.local/share/SmartCalc on Linux and
+ *     ~/Library/Application Support/SmartCalc on macOS. Pass that
+ *     definitions.txt, as an expression is found only while the definitions
+ *     it uses are the same as when it was compiled.
+ *
+ * The CSV file is read twice when packing, once to count the rows and once
+ * to parse them straight into the mapped column, so neither side is held in
+ * memory.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Model/s21_batchfile.h"
+#include "../Model/s21_format.h"
+#include "../Model/s21_library.h"
+#include "../Model/s21_programfile.h"
+
+namespace {
+
+/// Parses the first field of a CSV line; returns false if it is no number.
+bool ParseFirst(const std::string& line, double& value) {
+  const char* begin = line.c_str();
+  char* end = nullptr;
+  value = std::strtod(begin, &end);
+  return end != begin && (*end == '\0' || *end == ',' || *end == '\r');
+}
+
+int Pack(const char* csv, const char* binary,
+         const std::vector<std::string>& expressions) {
+  std::ifstream file(csv);
+  if (!file) return std::fprintf(stderr, "cannot read %s\n", csv), 1;
+  std::size_t rows = 0;
+  bool has_header = false;
+  double value = 0.0;
+  for (std::string line; std::getline(file, line);) {
+    if (line.empty()) continue;
+    if (ParseFirst(line, value)) {
+      ++rows;
+    } else if (rows == 0 && !has_header) {
+      has_header = true;
+    } else {
+      return std::fprintf(stderr, "bad number: %s\n", line.c_str()), 1;
+    }
+  }
+
+  auto batch = s21::BatchFile::Create(binary, expressions, rows, 1);
+  double* x = batch.Column(0);
+  file.clear();
+  file.seekg(0);
+  std::size_t row = 0;
+  for (std::string line; std::getline(file, line);) {
+    if (!line.empty() && ParseFirst(line, value)) {
+      x[row] = value;
+      if (++row % s21::BatchFile::kBlockRows == 0)
+        batch.Release(0, row - s21::BatchFile::kBlockRows, row);
+    }
+  }
+  std::printf("%zu rows, %zu expressions\n", rows, expressions.size());
+  return 0;
+}
+
+int Run(const char* input, const char* output) {
+  auto start = std::chrono::steady_clock::now();
+  std::size_t rows = s21::BatchFile::Run(input, output);
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::printf("%zu rows in %.3f s\n", rows, elapsed);
+  return 0;
+}
+
+int Unpack(const char* input, const char* output, const char* csv) {
+  s21::BatchFile source(input), target(output);
+  if (source.Rows() != target.Rows() ||
+      target.Columns() != target.Expressions().size())
+    return std::fprintf(stderr, "files do not match\n"), 1;
+  std::FILE* file = std::fopen(csv, "w");
+  if (!file) return std::fprintf(stderr, "cannot write %s\n", csv), 1;
+  std::fputs("x", file);
+  for (const std::string& expression : target.Expressions())
+    std::fprintf(file, ",\"%s\"", expression.c_str());
+  std::fputc('\n', file);
+  // Values are written with the shortest text that reads back exactly
+  char number[s21::Format::kBufferSize];
+  std::string line;
+  for (std::size_t row = 0; row < source.Rows(); ++row) {
+    line = s21::Format::Shortest(source.Column(0)[row], number);
+    for (std::size_t c = 0; c < target.Columns(); ++c) {
+      line += ',';
+      line += s21::Format::Shortest(target.Column(c)[row], number);
+    }
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), file);
+  }
+  return std::fclose(file) == 0 ? 0 : 1;
+}
+
+int Compile(const char* expressions, const char* output,
+            const char* definitions) {
+  std::ifstream file(expressions);
+  if (!file) return std::fprintf(stderr, "cannot read %s\n", expressions), 1;
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty()) lines.push_back(line);
+  }
+  s21::Library library;
+  if (definitions && !library.Load(definitions))
+    return std::fprintf(stderr, "cannot read %s\n", definitions), 1;
+  std::size_t count = s21::ProgramFile::Compile(output, lines, &library);
+  std::printf("%zu of %zu expressions compiled\n", count, lines.size());
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    if (argc >= 5 && std::strcmp(argv[1], "pack") == 0)
+      return Pack(argv[2], argv[3],
+                  std::vector<std::string>(argv + 4, argv + argc));
+    if (argc == 4 && std::strcmp(argv[1], "run") == 0)
+      return Run(argv[2], argv[3]);
+    if (argc == 5 && std::strcmp(argv[1], "unpack") == 0)
+      return Unpack(argv[2], argv[3], argv[4]);
+    if ((argc == 4 || argc == 5) && std::strcmp(argv[1], "compile") == 0)
+      return Compile(argv[2], argv[3], argc == 5 ? argv[4] : nullptr);
+  } catch (const std::exception& error) {
+    std::fprintf(stderr, "error: %s\n", error.what());
+    return 1;
+  }
+  std::fprintf(stderr,
+               "usage: %s pack <input.csv> <input.bin> <expression>...\n"
+               "       %s run <input.bin> <output.bin>\n"
+               "       %s unpack <input.bin> <output.bin> <output.csv>\n"
+               "       %s compile <expressions.txt> <programs.bin> "
+               "[definitions.txt]\n",
+               argv[0], argv[0], argv[0], argv[0]);
+  return 1;
+}
@@ -2,16 +2,29 @@
  * @brief Entry point
  *
  * Execution of the program
- * starts here.
+ * starts here. With --startup-time the time from here to the first frame of
+ * the main window is printed on stderr. With --trace <file> the spans of the
+ * user actions are written to a Chrome trace-event JSON file.
  */
 
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QStringList>
 
 #include "s21_mainwindow.h"
 
 int main(int argc, char *argv[]) {
+  QElapsedTimer start;
+  start.start();
   QApplication a(argc, argv);
   s21::s21_MainWindow w;
+  QStringList arguments = a.arguments();
+  if (arguments.contains("--startup-time")) w.MeasureStartup(start);
+  int trace = arguments.indexOf("--trace");
+  if (trace > 0 && trace + 1 < arguments.size())
+    s21::Controller::StartTracing(arguments[trace + 1]);
   w.show();
-  return a.exec();
+  int status = a.exec();
+  s21::Controller::StopTracing();
+  return status;
 }
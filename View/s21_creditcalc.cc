@@ -5,7 +5,11 @@
 
 #include "s21_creditcalc.h"
 
+#include <QHeaderView>
 #include <QString>
+#include <algorithm>
+#include <cmath>
+#include <optional>
 #include <tuple>
 
 #include "Controller/s21_controller.h"
@@ -13,11 +17,18 @@
 
 namespace s21 {
 
-CreditCalc::CreditCalc(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::CreditCalc) {
+CreditCalc::CreditCalc(s21::Controller &controller, QWidget *parent)
+    : QMainWindow(parent), ui(new Ui::CreditCalc), controller_(controller) {
   ui->setupUi(this);
-  setFixedSize(550, 370);
+  setFixedSize(550, 660);
   ToggleVisibility(false);
+
+  // Fixed row heights let the view skip measuring rows it does not show
+  ui->Schedule_table->setModel(&schedule_table_);
+  ui->Schedule_table->verticalHeader()->setSectionResizeMode(
+      QHeaderView::Fixed);
+  ui->Schedule_table->horizontalHeader()->setSectionResizeMode(
+      QHeaderView::Stretch);
 }
 
 CreditCalc::~CreditCalc() { delete ui; }
@@ -33,9 +44,10 @@ void CreditCalc::ToggleVisibility(bool visible) {
 
 /**
  * @details Uses a tuple with value binding for return values: current payment,
- * percentage and total payment.
+ * percentage and total payment. The schedule table is refilled in place.
  */
 void CreditCalc::on_Eq_button_clicked() {
+  Controller::TraceSpan span("CreditCalc::on_Eq_button_clicked", "view");
   int k = ui->Months_button->isChecked() ? 1 : 12;
   double amount = ui->Amount_spinBox->value();
   int term = ui->Term_spinBox->value();
@@ -46,9 +58,80 @@ void CreditCalc::on_Eq_button_clicked() {
   auto [payment, precentage, total] =
       controller_.ProcessCreditExpression(k, amount, term, rate, month, type);
 
-  ui->Payment->setText(QString::number(payment, 'f', 2));
-  ui->Percentage->setText(QString::number(precentage, 'f', 2));
-  ui->All->setText(QString::number(total, 'f', 2));
+  ui->Payment->setText(Controller::FormatFixed(payment));
+  ui->Percentage->setText(Controller::FormatFixed(precentage));
+  ui->All->setText(Controller::FormatFixed(total));
+
+  schedule_table_.Update([&](CreditModel::Schedule &schedule) {
+    return controller_.ProcessCreditSchedule(k, amount, term, rate, type,
+                                             schedule);
+  });
+
+  // Rates within 5 points of the entered one, terms up to twice the entered
+  ui->Heatmap->Update([&](CreditModel::Grid &grid) {
+    grid.rates.clear();
+    grid.terms.clear();
+    for (double step = std::max(0.0, rate - 5); step <= rate + 5 + 1e-9;
+         step += 0.25)
+      grid.rates.push_back(step);
+    int last = std::min(std::max(2 * term, 12), ui->Term_spinBox->maximum());
+    for (int t = 1; t <= last; ++t) grid.terms.push_back(t);
+    return controller_.ProcessCreditGrid(k, amount, type, grid);
+  });
+}
+
+void CreditCalc::on_Rate_solve_button_clicked() {
+  Solve(CreditModel::Unknown::kRate);
+}
+
+void CreditCalc::on_Term_solve_button_clicked() {
+  Solve(CreditModel::Unknown::kPeriods);
+}
+
+void CreditCalc::on_Amount_solve_button_clicked() {
+  Solve(CreditModel::Unknown::kAmount);
+}
+
+/**
+ * @details A number of periods is shown in years when it is whole years or
+ * too long for the months field; the years are then rounded up, so the
+ * payment stays below the target.
+ */
+void CreditCalc::Solve(CreditModel::Unknown unknown) {
+  Controller::TraceSpan span("CreditCalc::Solve", "view");
+  int k = ui->Months_button->isChecked() ? 1 : 12;
+  std::optional<double> solution = controller_.ProcessCreditSolve(
+      unknown, k, ui->Amount_spinBox->value(), ui->Term_spinBox->value(),
+      ui->Rate_doubleSpinBox->value(), ui->Target_doubleSpinBox->value(),
+      ui->Ann_button->isChecked() ? 'a' : 'd');
+
+  bool fits = solution.has_value();
+  if (fits && unknown == CreditModel::Unknown::kRate) {
+    fits = *solution <= ui->Rate_doubleSpinBox->maximum();
+    if (fits) ui->Rate_doubleSpinBox->setValue(*solution);
+  } else if (fits && unknown == CreditModel::Unknown::kAmount) {
+    // The amount field holds whole units; rounding down keeps the payment
+    double amount = std::floor(*solution);
+    fits = amount >= ui->Amount_spinBox->minimum() &&
+           amount <= ui->Amount_spinBox->maximum();
+    if (fits) ui->Amount_spinBox->setValue(static_cast<int>(amount));
+  } else if (fits) {
+    int periods = static_cast<int>(*solution);
+    bool in_years = (k == 12 && periods % 12 == 0) ||
+                    periods > ui->Term_spinBox->maximum();
+    int term = in_years ? (periods + 11) / 12 : periods;
+    fits = term <= ui->Term_spinBox->maximum();
+    if (fits) {
+      (in_years ? ui->Years_button : ui->Months_button)->setChecked(true);
+      ui->Term_spinBox->setValue(term);
+    }
+  }
+
+  if (!fits) {
+    ui->Payment->setText("calc_error");
+    return;
+  }
+  on_Eq_button_clicked();
 }
 
 }  // namespace s21
@@ -11,6 +11,8 @@
 #include <QMainWindow>
 
 #include "../Controller/s21_controller.h"
+#include "s21_heatmap.h"
+#include "s21_scheduletable.h"
 
 namespace Ui {
 class CreditCalc;
@@ -29,9 +31,11 @@ class CreditCalc : public QMainWindow {
  public:
   /**
    * @brief Constructor for the CreditCalc class.
+   * @param controller The Controller of the application, shared with the
+   * main window so every window sees the same definitions and files.
    * @param parent The parent widget (default is nullptr).
    */
-  explicit CreditCalc(QWidget *parent = nullptr);
+  explicit CreditCalc(s21::Controller &controller, QWidget *parent = nullptr);
 
   /**
    * @brief Destructor for the CreditCalc class.
@@ -63,10 +67,36 @@ class CreditCalc : public QMainWindow {
    */
   void on_Eq_button_clicked();
 
+  /**
+   * @brief Slot triggered when the rate button is clicked to find the rate
+   * giving the target payment.
+   */
+  void on_Rate_solve_button_clicked();
+
+  /**
+   * @brief Slot triggered when the term button is clicked to find the term
+   * giving the target payment.
+   */
+  void on_Term_solve_button_clicked();
+
+  /**
+   * @brief Slot triggered when the amount button is clicked to find the
+   * amount giving the target payment.
+   */
+  void on_Amount_solve_button_clicked();
+
  private:
+  /**
+   * @brief Solves for one credit parameter from the target payment and the
+   * other fields, puts it in its field and recalculates.
+   * @param[in] unknown The parameter to find.
+   */
+  void Solve(CreditModel::Unknown unknown);
+
   Ui::CreditCalc *ui;  ///< A pointer to an interface object.
-  s21::Controller
-      controller_;  ///< The associated Controller handling credit calculations.
+  s21::Controller &controller_;  ///< The shared Controller handling credit
+                                ///< calculations.
+  s21::ScheduleTable schedule_table_;  ///< Periods shown by Schedule_table.
 };
 
 }  // namespace s21
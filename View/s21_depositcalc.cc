@@ -0,0 +1,105 @@
+/**
+ * @file s21_depositcalc.cc
+ * @brief Implementation file for the s21_depositcalc.h.
+ */
+
+#include "s21_depositcalc.h"
+
+#include <QComboBox>
+#include <QHeaderView>
+#include <QString>
+#include <QStringList>
+#include <QTableWidgetItem>
+#include <optional>
+#include <vector>
+
+#include "Controller/s21_controller.h"
+#include "ui_s21_depositcalc.h"
+
+namespace s21 {
+
+namespace {
+
+/// Columns of the events table.
+enum Column { kDay, kType, kValue };
+
+}  // namespace
+
+DepositCalc::DepositCalc(s21::Controller &controller, QWidget *parent)
+    : QMainWindow(parent), ui(new Ui::DepositCalc), controller_(controller) {
+  ui->setupUi(this);
+  setFixedSize(550, 580);
+  ui->Events_table->setHorizontalHeaderLabels(
+      {"День", "Операция", "Сумма или ставка"});
+  ui->Events_table->horizontalHeader()->setSectionResizeMode(
+      QHeaderView::Stretch);
+}
+
+DepositCalc::~DepositCalc() { delete ui; }
+
+void DepositCalc::on_Add_button_clicked() {
+  int row = ui->Events_table->rowCount();
+  ui->Events_table->insertRow(row);
+  ui->Events_table->setItem(row, kDay, new QTableWidgetItem("0"));
+  ui->Events_table->setItem(row, kValue, new QTableWidgetItem("0"));
+
+  // Item order matches DepositModel::Event::Type
+  QComboBox *type = new QComboBox(ui->Events_table);
+  type->addItems({"Пополнение", "Снятие", "Новая ставка"});
+  ui->Events_table->setCellWidget(row, kType, type);
+}
+
+void DepositCalc::on_Remove_button_clicked() {
+  int row = ui->Events_table->currentRow();
+  if (row >= 0) ui->Events_table->removeRow(row);
+}
+
+std::optional<std::vector<DepositModel::Event>> DepositCalc::ReadEvents()
+    const {
+  std::vector<DepositModel::Event> events;
+  for (int row = 0; row < ui->Events_table->rowCount(); ++row) {
+    const QTableWidgetItem *day = ui->Events_table->item(row, kDay);
+    const QTableWidgetItem *value = ui->Events_table->item(row, kValue);
+    const auto *type =
+        qobject_cast<const QComboBox *>(ui->Events_table->cellWidget(row, kType));
+    bool is_day = false, is_value = false;
+    DepositModel::Event event{};
+    if (day) event.day = day->text().toInt(&is_day);
+    if (value) event.value = value->text().toDouble(&is_value);
+    if (!is_day || !is_value || !type) return std::nullopt;
+    event.type = static_cast<DepositModel::Event::Type>(type->currentIndex());
+    events.push_back(event);
+  }
+  return events;
+}
+
+/**
+ * @details Invalid input, such as a withdrawal exceeding the balance, shows
+ * "calc_error" in place of the results.
+ */
+void DepositCalc::on_Eq_button_clicked() {
+  DepositModel::Deposit deposit{
+      ui->Amount_spinBox->value(),
+      ui->Term_spinBox->value(),
+      ui->Rate_doubleSpinBox->value(),
+      ui->Tax_doubleSpinBox->value(),
+      static_cast<DepositModel::Periodicity>(
+          ui->Periodicity_comboBox->currentIndex()),
+      ui->Capitalization_checkBox->isChecked()};
+
+  std::optional<DepositModel::Result> result;
+  if (auto events = ReadEvents())
+    result = controller_.ProcessDeposit(deposit, *events);
+
+  if (!result) {
+    ui->Interest->setText("calc_error");
+    ui->Tax_sum->setText("calc_error");
+    ui->Balance->setText("calc_error");
+    return;
+  }
+  ui->Interest->setText(Controller::FormatFixed(result->interest));
+  ui->Tax_sum->setText(Controller::FormatFixed(result->tax));
+  ui->Balance->setText(Controller::FormatFixed(result->balance));
+}
+
+}  // namespace s21
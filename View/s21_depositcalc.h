@@ -0,0 +1,78 @@
+/**
+ * @file s21_depositcalc.h
+ * @brief Header file containing the declaration of the DepositCalc for the
+ * View abstraction in the MVC pattern.
+ */
+
+#ifndef SMARTCALC_VIEW_S21_DEPOSITCALC_H
+#define SMARTCALC_VIEW_S21_DEPOSITCALC_H
+
+#include <QMainWindow>
+#include <optional>
+#include <vector>
+
+#include "../Controller/s21_controller.h"
+
+namespace Ui {
+class DepositCalc;
+}
+
+namespace s21 {
+
+/**
+ * @class DepositCalc
+ * @brief The View class responsible for presenting data to the user
+ * and receiving user input for deposit calculation.
+ */
+class DepositCalc : public QMainWindow {
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Constructor for the DepositCalc class.
+   * @param controller The Controller of the application, shared with the
+   * main window so every window sees the same definitions and files.
+   * @param parent The parent widget (default is nullptr).
+   */
+  explicit DepositCalc(s21::Controller &controller, QWidget *parent = nullptr);
+
+  /**
+   * @brief Destructor for the DepositCalc class.
+   */
+  ~DepositCalc();
+
+ private slots:
+  /**
+   * @brief Slot triggered when the add button is clicked.
+   * Appends an empty replenishment to the events table.
+   */
+  void on_Add_button_clicked();
+
+  /**
+   * @brief Slot triggered when the remove button is clicked.
+   * Removes the selected row of the events table.
+   */
+  void on_Remove_button_clicked();
+
+  /**
+   * @brief Slot triggered when the equal button is clicked to initiate
+   * deposit calculation.
+   */
+  void on_Eq_button_clicked();
+
+ private:
+  /**
+   * @brief Reads the events table.
+   *
+   * @return The events, or std::nullopt if a cell does not hold a number.
+   */
+  std::optional<std::vector<DepositModel::Event>> ReadEvents() const;
+
+  Ui::DepositCalc *ui;  ///< A pointer to an interface object.
+  s21::Controller &controller_;  ///< The shared Controller handling deposit
+                                ///< calculations.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_VIEW_S21_DEPOSITCALC_H
@@ -0,0 +1,100 @@
+/**
+ * @file s21_heatmap.cc
+ * @brief Implementation file for the s21_heatmap.h.
+ */
+
+#include "s21_heatmap.h"
+
+#include <QColor>
+#include <QPainter>
+#include <QString>
+#include <QToolTip>
+#include <algorithm>
+
+namespace s21 {
+
+namespace {
+
+constexpr int kLeft = 48;    ///< Width of the rate labels.
+constexpr int kBottom = 18;  ///< Height of the term labels.
+
+}  // namespace
+
+Heatmap::Heatmap(QWidget *parent) : QWidget(parent) { setMouseTracking(true); }
+
+bool Heatmap::Update(const std::function<bool(CreditModel::Grid &)> &fill) {
+  bool is_filled = fill(grid_);
+  if (!is_filled) grid_ = CreditModel::Grid();
+  if (!grid_.payment.empty()) {
+    auto [low, high] =
+        std::minmax_element(grid_.payment.begin(), grid_.payment.end());
+    min_ = *low;
+    max_ = *high;
+  }
+  update();
+  return is_filled;
+}
+
+QRect Heatmap::Plot() const {
+  return rect().adjusted(kLeft, 2, -2, -kBottom);
+}
+
+/**
+ * @details Cells are drawn from the matrix directly, one rectangle each; the
+ * labels show the first, middle and last value of every axis.
+ */
+void Heatmap::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  std::size_t rows = grid_.rates.size(), columns = grid_.terms.size();
+  if (rows == 0 || columns == 0) return;
+
+  QRect plot = Plot();
+  double width = static_cast<double>(plot.width()) / columns;
+  double height = static_cast<double>(plot.height()) / rows;
+  double range = max_ > min_ ? max_ - min_ : 1.0;
+  for (std::size_t i = 0; i < rows; ++i) {
+    double top = plot.bottom() - (i + 1) * height;
+    for (std::size_t j = 0; j < columns; ++j) {
+      double share = (grid_.payment[grid_.At(i, j)] - min_) / range;
+      painter.fillRect(QRectF(plot.left() + j * width, top, width, height),
+                       QColor::fromHsvF(0.66 * (1 - share), 0.85, 0.9));
+    }
+  }
+
+  painter.setPen(palette().color(QPalette::WindowText));
+  for (std::size_t i : {std::size_t{0}, rows / 2, rows - 1}) {
+    QRectF label(0, plot.bottom() - (i + 1) * height, kLeft - 4, height);
+    painter.drawText(label, Qt::AlignRight | Qt::AlignVCenter,
+                     Controller::FormatFixed(grid_.rates[i], 1) + "%");
+  }
+  for (std::size_t j : {std::size_t{0}, columns / 2, columns - 1}) {
+    QRectF label(plot.left() + j * width - 20, plot.bottom(), width + 40,
+                 kBottom);
+    painter.drawText(label, Qt::AlignCenter, QString::number(grid_.terms[j]));
+  }
+}
+
+void Heatmap::mouseMoveEvent(QMouseEvent *event) {
+  QRect plot = Plot();
+  std::size_t rows = grid_.rates.size(), columns = grid_.terms.size();
+  if (rows == 0 || columns == 0 || !plot.contains(event->pos())) {
+    QToolTip::hideText();
+    return;
+  }
+  auto j = static_cast<std::size_t>((event->pos().x() - plot.left()) *
+                                    columns / plot.width());
+  auto i = static_cast<std::size_t>((plot.bottom() - event->pos().y()) * rows /
+                                    plot.height());
+  i = std::min(i, rows - 1);
+  j = std::min(j, columns - 1);
+  QToolTip::showText(
+      event->globalPos(),
+      QString("Ставка %1%, срок %2\nПлатёж %3\nПроценты %4")
+          .arg(Controller::FormatFixed(grid_.rates[i]))
+          .arg(grid_.terms[j])
+          .arg(Controller::FormatFixed(grid_.payment[grid_.At(i, j)]))
+          .arg(Controller::FormatFixed(grid_.overpayment[grid_.At(i, j)])),
+      this);
+}
+
+}  // namespace s21
@@ -0,0 +1,63 @@
+/**
+ * @file s21_heatmap.h
+ * @brief Header file containing the declaration of the Heatmap, the widget
+ * presenting a credit sensitivity grid.
+ */
+
+#ifndef SMARTCALC_VIEW_S21_HEATMAP_H
+#define SMARTCALC_VIEW_S21_HEATMAP_H
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QWidget>
+#include <functional>
+
+#include "../Controller/s21_controller.h"
+
+namespace s21 {
+
+/**
+ * @class Heatmap
+ * @brief Draws the payments of a rate × term grid as colored cells.
+ *
+ * Rates grow upwards and terms to the right. The color goes from blue for
+ * the lowest payment of the grid to red for the highest, and the tooltip of
+ * a cell shows its rate, term, payment and overpayment.
+ */
+class Heatmap : public QWidget {
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Constructor for the Heatmap class.
+   * @param parent The parent widget (default is nullptr).
+   */
+  explicit Heatmap(QWidget *parent = nullptr);
+
+  /**
+   * @brief Refills the grid and repaints.
+   *
+   * @param[in] fill Writes the axes and the matrices into the grid, reusing
+   * its capacity, and returns false on invalid input.
+   * @return The value returned by @p fill; the widget is empty on false.
+   */
+  bool Update(const std::function<bool(CreditModel::Grid &)> &fill);
+
+ protected:
+  void paintEvent(QPaintEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+
+ private:
+  /**
+   * @brief Returns the area of the cells, inside the axis labels.
+   */
+  QRect Plot() const;
+
+  CreditModel::Grid grid_;  ///< The cells shown by the widget.
+  double min_ = 0.0;        ///< Lowest payment of the grid.
+  double max_ = 0.0;        ///< Highest payment of the grid.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_VIEW_S21_HEATMAP_H
@@ -5,16 +5,48 @@
 
 #include "s21_mainwindow.h"
 
+#include <QColor>
+#include <QElapsedTimer>
+#include <QAction>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QPaintEvent>
+#include <QPoint>
+#include <QPen>
+#include <QRect>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
 #include <QVector>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "./ui_s21_mainwindow.h"
 #include "Controller/s21_controller.h"
 #include "s21_creditcalc.h"
+#include "s21_depositcalc.h"
 
 namespace s21 {
 
+namespace {
+
+/// Colors of the graphs and curves, in the order they are plotted.
+const QColor kColors[] = {Qt::blue,      QColor(230, 143, 52),
+                          Qt::darkGreen, Qt::red,
+                          Qt::magenta,   Qt::darkCyan};
+
+/// Calculations of the history that can be browsed or shown in the menu.
+constexpr std::size_t kHistoryShown = 20;
+
+}  // namespace
+
 /**
  *  @details This constructor sets up the UI and connects various buttons to the
  * SymbClicked slot. It simplifies the process of managing multiple buttons by
@@ -26,8 +58,7 @@ namespace s21 {
 s21_MainWindow::s21_MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::s21_MainWindow) {
   ui->setupUi(this);
-  ui->Graph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
-  setFixedSize(795, 445);
+  setFixedSize(795, 490);
 
   QPushButton *buttons[] = {
       ui->Zero_Button,  ui->One_Button,  ui->Two_Button,  ui->Three_Button,
@@ -50,11 +81,39 @@ s21_MainWindow::s21_MainWindow(QWidget *parent)
           SLOT(Ymax_valueChanged(double)));
   connect(ui->Ymin, SIGNAL(valueChanged(double)), this,
           SLOT(Ymin_valueChanged(double)));
+  connect(ui->Double_Spin_Box, SIGNAL(valueChanged(double)), this,
+          SLOT(ShowPreview()));
+  ui->Calculation_label->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(ui->Calculation_label,
+          SIGNAL(customContextMenuRequested(const QPoint &)), this,
+          SLOT(ShowHistory(const QPoint &)));
+  ui->Calculation_label->setToolTip(controller_.GetDefinitions().join('\n'));
 }
 
 s21_MainWindow::~s21_MainWindow() { delete ui; }
 
+void s21_MainWindow::MeasureStartup(const QElapsedTimer &start) {
+  startup_ = start;
+}
+
+/**
+ * @details The window is painted first and its children after it within the
+ * same update, so a zero timer set here fires once the whole frame has been
+ * flushed.
+ */
+void s21_MainWindow::paintEvent(QPaintEvent *event) {
+  QMainWindow::paintEvent(event);
+  if (!startup_) return;
+  QElapsedTimer start = *startup_;
+  startup_.reset();
+  QTimer::singleShot(0, this, [start]() {
+    std::fprintf(stderr, "startup: first frame after %lld ms\n",
+                 static_cast<long long>(start.elapsed()));
+  });
+}
+
 void s21_MainWindow::SymbClicked() {
+  Controller::TraceSpan span("s21_MainWindow::SymbClicked", "view");
   ///@var current_input The expression at the moment the button is clicked.
   QString current_input = ui->Calculation_label->text();
 
@@ -75,6 +134,26 @@ void s21_MainWindow::SymbClicked() {
 
   // Update the expression
   ui->Calculation_label->setText(current_input + new_value);
+  ShowPreview();
+}
+
+void s21_MainWindow::keyPressEvent(QKeyEvent *event) {
+  QString text = event->text();
+  if (event->key() == Qt::Key_Backspace) {
+    on_Del_Button_clicked();
+  } else if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
+    on_Eq_Button_clicked();
+  } else if (event->key() == Qt::Key_Up || event->key() == Qt::Key_Down) {
+    BrowseHistory(event->key() == Qt::Key_Up ? 1 : -1);
+  } else if (text.size() == 1 && text[0].isPrint() && !text[0].isSpace()) {
+    QString current_input = ui->Calculation_label->text();
+    if (current_input == "0" || current_input == "calc_error")
+      current_input.clear();
+    ui->Calculation_label->setText(current_input + text);
+    ShowPreview();
+  } else {
+    QMainWindow::keyPressEvent(event);
+  }
 }
 
 void s21_MainWindow::CheckArithmetic(QString &cur_str,
@@ -88,12 +167,85 @@ void s21_MainWindow::on_Del_Button_clicked() {
   if (!ui->Calculation_label->text().isEmpty()) {
     ui->Calculation_label->setText(ui->Calculation_label->text().chopped(1));
   }
+  ShowPreview();
 }
 
-void s21_MainWindow::on_AC_Button_clicked() { ui->Calculation_label->clear(); }
+void s21_MainWindow::on_AC_Button_clicked() {
+  ui->Calculation_label->clear();
+  ShowPreview();
+}
 
 void s21_MainWindow::on_Dot_Button_clicked() {
   ui->Calculation_label->setText(ui->Calculation_label->text() + ".");
+  ShowPreview();
+}
+
+/**
+ * @details The Controller keeps the parser state of the last text, so a
+ * character typed or deleted at the end costs one step of parsing.
+ */
+void s21_MainWindow::ShowPreview() {
+  Controller::TraceSpan span("s21_MainWindow::ShowPreview", "view");
+  ui->Preview_label->setText(controller_.ProcessPreview(
+      ui->Calculation_label->text(), ui->Double_Spin_Box->value()));
+}
+
+void s21_MainWindow::ShowHistory(const QPoint &position) {
+  Controller::TraceSpan span("s21_MainWindow::ShowHistory", "view");
+  std::vector<s21::HistoryFile::Record> records =
+      controller_.GetHistory(kHistoryShown);
+  if (records.empty()) return;
+  QMenu menu(this);
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    QAction *action = menu.addAction(
+        QString("%1  (x = %2)  = %3")
+            .arg(QString::fromStdString(records[i].expression),
+                 Controller::FormatGeneral(records[i].x, 8),
+                 Controller::FormatGeneral(records[i].result, 8)));
+    action->setData(static_cast<int>(i));
+  }
+  QAction *chosen = menu.exec(ui->Calculation_label->mapToGlobal(position));
+  if (chosen) {
+    history_position_ = -1;
+    Recall(records[static_cast<std::size_t>(chosen->data().toInt())]);
+  }
+}
+
+/**
+ * @details Browsing starts again from the latest calculation once the label
+ * no longer shows the one reached, as after typing or pressing =.
+ */
+void s21_MainWindow::BrowseHistory(int step) {
+  QString current_input = ui->Calculation_label->text();
+  if (history_position_ >= 0 &&
+      current_input != QString::fromStdString(
+                           history_[history_position_].expression))
+    history_position_ = -1;
+  if (history_position_ < 0) {
+    if (step < 0) return;
+    history_ = controller_.GetHistory(kHistoryShown);
+    typed_ = current_input;
+  }
+  int position = std::clamp(history_position_ + step, -1,
+                            static_cast<int>(history_.size()) - 1);
+  if (position == history_position_) return;
+  history_position_ = position;
+  if (position < 0) {
+    ui->Calculation_label->setText(typed_);
+    ShowPreview();
+  } else {
+    Recall(history_[position]);
+  }
+}
+
+/**
+ * @details The stored result is shown as the preview, so a calculation of
+ * the history does not have to be evaluated again to be seen.
+ */
+void s21_MainWindow::Recall(const s21::HistoryFile::Record &record) {
+  ui->Calculation_label->setText(QString::fromStdString(record.expression));
+  ui->Double_Spin_Box->setValue(record.x);
+  ui->Preview_label->setText(Controller::FormatGeneral(record.result, 8));
 }
 
 void s21_MainWindow::Xmin_valueChanged(double value) {
@@ -113,6 +265,17 @@ void s21_MainWindow::Ymax_valueChanged(double value) {
 }
 
 void s21_MainWindow::on_Eq_Button_clicked() {
+  Controller::TraceSpan span("s21_MainWindow::on_Eq_Button_clicked", "view");
+  ui->Preview_label->clear();
+  if (controller_.IsDefinition(ui->Calculation_label->text())) {
+    ///@var is_defined Whether the definition was registered.
+    bool is_defined =
+        controller_.ProcessDefinition(ui->Calculation_label->text());
+    ui->Calculation_label->setText(is_defined ? "defined" : "calc_error");
+    ui->Calculation_label->setToolTip(controller_.GetDefinitions().join('\n'));
+    return;
+  }
+
   ///@var result The processed result or an error message.
   QString result = controller_.ProcessMathExpression(
       ui->Calculation_label->text(), ui->Double_Spin_Box->value());
@@ -120,48 +283,340 @@ void s21_MainWindow::on_Eq_Button_clicked() {
 }
 
 void s21_MainWindow::on_Graph_Button_clicked() {
-  ui->Graph->clearGraphs();
-  double h = 0.01;
-  QVector<double> x;
-  QVector<double> y;
+  Controller::TraceSpan span("s21_MainWindow::on_Graph_Button_clicked",
+                             "view");
+  if (!DrawGraph()) return;
+  Controller::TraceSpan replot("QCustomPlot::replot", "view");
+  Plot()->replot();
+}
+
+/**
+ * @details Curves are shown on the y range with the same scale on both axes,
+ * centered on the y axis, as a circle should look round; Xmin and Xmax then
+ * bound their parameter. Implicit curves are shown on both ranges, as the
+ * graphs of functions are.
+ */
+bool s21_MainWindow::DrawGraph() {
+  QCustomPlot *plot = Plot();
+  plot->clearPlottables();
+  functions_.clear();
+  grid_.clear();
+  graphs_.clear();
+  curves_.clear();
   double xmin = ui->Xmin->value();
   double xmax = ui->Xmax->value();
   double ymin = ui->Ymin->value();
   double ymax = ui->Ymax->value();
-  double delta = ymax - ymin;
+  plot->yAxis->setRange(ymin, ymax);
+  sampled_ = QCPRange(2 * ymin - ymax, 2 * ymax - ymin);
+  if (ui->Plot_Mode->currentIndex() == kFunction) {
+    double h = 0.01;
+    for (double i = xmin; i <= xmax; i += h) grid_.push_back(i);
+    plot->xAxis->setRange(xmin, xmax);
+    return AddFunctions();
+  }
+  if (ui->Plot_Mode->currentIndex() == kImplicit) {
+    plot->xAxis->setRange(xmin, xmax);
+    return AddCurves();
+  }
+  CurveSampler::Viewport viewport = PlotViewport();
+  double half = (ymax - ymin) / 2 * viewport.width / viewport.height;
+  plot->xAxis->setRange(-half, half);
+  return AddCurves();
+}
+
+void s21_MainWindow::on_Plot_Add_Button_clicked() {
+  bool is_function = ui->Plot_Mode->currentIndex() == kFunction;
+  if (is_function ? grid_.empty() : Plot()->plottableCount() == 0) {
+    on_Graph_Button_clicked();
+    return;
+  }
+  Controller::TraceSpan span("s21_MainWindow::on_Plot_Add_Button_clicked",
+                             "view");
+  if (!(is_function ? AddFunctions() : AddCurves())) return;
+  Controller::TraceSpan replot("QCustomPlot::replot", "view");
+  Plot()->replot();
+}
+
+void s21_MainWindow::on_Plot_Mode_currentIndexChanged(int index) {
+  static const char *const kParameters[] = {"X", "t", "θ", "X"};
+  ui->Xmin_Label->setText(QString("%1min =").arg(kParameters[index]));
+  ui->Xmax_Label->setText(QString("%1max =").arg(kParameters[index]));
+}
+
+/**
+ * @details Zooming changes the size of a pixel, and the curves are thinned
+ * again for it; dragging the plot keeps the points already thinned. An
+ * implicit curve only exists in the view it was sampled for, so it is
+ * sampled again on either. The graphs leave out what lies beyond the range
+ * of y they were sampled for, and are sampled again when the view reaches
+ * past it.
+ */
+void s21_MainWindow::Plot_beforeReplot() {
+  QCPRange visible = Plot()->yAxis->range();
+  if (!graphs_.empty() && (visible.lower < sampled_.lower ||
+                           visible.upper > sampled_.upper))
+    ResampleFunctions();
+  if (curves_.empty()) return;
+  CurveSampler::Viewport viewport = PlotViewport();
+  auto is_same = [](double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::abs(b);
+  };
+  bool is_same_scale =
+      is_same(viewport.x_max - viewport.x_min,
+              thinned_.x_max - thinned_.x_min) &&
+      is_same(viewport.y_max - viewport.y_min,
+              thinned_.y_max - thinned_.y_min) &&
+      viewport.width == thinned_.width && viewport.height == thinned_.height;
+  bool is_same_place =
+      viewport.x_min == thinned_.x_min && viewport.y_min == thinned_.y_min;
+  if (is_same_scale && is_same_place) return;
+  thinned_ = viewport;
+  for (PlottedCurve &plotted : curves_) {
+    if (!plotted.implicit.isEmpty()) {
+      auto curve = controller_.ProcessImplicit(plotted.implicit, viewport);
+      if (curve) plotted.curve = std::move(*curve);
+    } else if (is_same_scale) {
+      continue;
+    }
+    ShowCurve(plotted);
+  }
+}
+
+/**
+ * @details The expressions are separated by ';'. The values are sampled on
+ * the grid of the plot, for the range of y in sampled_: the Controller
+ * leaves out as NaN the parts of the graphs beyond it, which QCustomPlot
+ * draws as gaps, and reports the steps broken at poles.
+ */
+bool s21_MainWindow::AddFunctions() {
+  QStringList expressions;
+  for (const QString &part : ui->Calculation_label->text().split(';'))
+    if (!part.trimmed().isEmpty()) expressions.append(part.trimmed());
+  if (expressions.isEmpty()) return false;
+
+  Controller::TraceSpan sampling("s21_MainWindow::sample", "view");
+  QCustomPlot *plot = Plot();
+  std::vector<s21::GraphSampler::Graph> sampled;
+  if (!controller_.ProcessPlot(expressions, grid_, sampled, sampled_.lower,
+                               sampled_.upper, PlotTolerance())) {
+    ui->Calculation_label->setText("plot error");
+    return false;
+  }
+
+  for (std::size_t f = 0; f < sampled.size(); ++f) {
+    std::size_t color = (static_cast<std::size_t>(functions_.size()) +
+                         curves_.size() + f) %
+                        std::size(kColors);
+    QCPGraph *graph = plot->addGraph();
+    graph->setPen(QPen(kColors[color]));
+    SetGraphData(graph, sampled[f]);
+    graphs_.push_back(graph);
+  }
+  functions_ += expressions;
+  return true;
+}
+
+/**
+ * @details The new range reaches a plot height beyond the visible one on
+ * both sides, so that dragging the plot by less does not sample the graphs
+ * again.
+ */
+void s21_MainWindow::ResampleFunctions() {
+  Controller::TraceSpan span("s21_MainWindow::ResampleFunctions", "view");
+  QCPRange visible = Plot()->yAxis->range();
+  sampled_ = QCPRange(visible.lower - visible.size(),
+                      visible.upper + visible.size());
+  std::vector<s21::GraphSampler::Graph> sampled;
+  if (!controller_.ProcessPlot(functions_, grid_, sampled, sampled_.lower,
+                               sampled_.upper, PlotTolerance()))
+    return;
+  for (std::size_t f = 0; f < graphs_.size(); ++f)
+    SetGraphData(graphs_[f], sampled[f]);
+}
+
+/**
+ * @details A break is drawn as a point with a NaN value halfway along its
+ * step, so both samples around a pole stay on the graph.
+ */
+void s21_MainWindow::SetGraphData(QCPGraph *graph,
+                                  const s21::GraphSampler::Graph &sampled) {
+  int size = static_cast<int>(grid_.size() + sampled.breaks.size());
+  QVector<double> x, y;
+  x.reserve(size);
+  y.reserve(size);
+  auto next = sampled.breaks.begin();
+  for (std::size_t i = 0; i < grid_.size(); ++i) {
+    x.append(grid_[i]);
+    y.append(sampled.y[i]);
+    if (next != sampled.breaks.end() && *next == i) {
+      x.append((grid_[i] + grid_[i + 1]) / 2);
+      y.append(std::numeric_limits<double>::quiet_NaN());
+      ++next;
+    }
+  }
+  graph->setData(x, y, true);
+}
+
+/**
+ * @details Half a pixel is as close as the curve can be drawn; the widget is
+ * a bit taller than the axis rect, which keeps the tolerance on the safe
+ * side.
+ */
+double s21_MainWindow::PlotTolerance() {
+  QCustomPlot *plot = Plot();
+  return plot->yAxis->range().size() / std::max(1, plot->height()) / 2;
+}
 
-  for (double i = xmin; i <= xmax; i += h) {
-    QString str_result =
-        controller_.ProcessMathExpression(ui->Calculation_label->text(), i);
-    double result = str_result.toDouble();
+/**
+ * @details The expressions are separated by ';', x(t) and y(t) alternating
+ * for parametric curves. The curves are sampled for the current view, and
+ * implicit curves keep their expression to be sampled for the next ones.
+ */
+bool s21_MainWindow::AddCurves() {
+  QStringList expressions;
+  for (const QString &part : ui->Calculation_label->text().split(';'))
+    if (!part.trimmed().isEmpty()) expressions.append(part.trimmed());
+  int per_curve = ui->Plot_Mode->currentIndex() == kParametric ? 2 : 1;
+  if (expressions.isEmpty() || expressions.size() % per_curve != 0) {
+    ui->Calculation_label->setText("plot error");
+    return false;
+  }
 
-    if (str_result == "calc_error") {
+  Controller::TraceSpan sampling("s21_MainWindow::sample_curves", "view");
+  bool is_implicit = ui->Plot_Mode->currentIndex() == kImplicit;
+  thinned_ = PlotViewport();
+  for (int i = 0; i < expressions.size(); i += per_curve) {
+    auto curve = is_implicit
+                     ? controller_.ProcessImplicit(expressions[i], thinned_)
+                     : controller_.ProcessCurve(expressions.mid(i, per_curve),
+                                                ui->Xmin->value(),
+                                                ui->Xmax->value(), thinned_);
+    if (!curve) {
       ui->Calculation_label->setText("plot error");
-      return;
+      return false;
     }
+    std::size_t color = (static_cast<std::size_t>(functions_.size()) +
+                         curves_.size()) %
+                        std::size(kColors);
+    curves_.push_back({std::move(*curve), kColors[color], {},
+                       is_implicit ? expressions[i] : QString()});
+    ShowCurve(curves_.back());
+  }
+  return true;
+}
 
-    if (std::isnan(result) || std::isinf(result) ||
-        (!y.empty() && std::abs(y.last() - result) > delta)) {
-      if (!x.empty()) {
-        ui->Graph->addGraph()->setData(x, y);
-        x.clear();
-        y.clear();
+/**
+ * @details The thinned curve is split at its breaks into pieces, each drawn
+ * by a QCPCurve of its own. Thinning keeps the breaks, so the pieces stay
+ * the same when the curve is thinned again and only their data is replaced.
+ */
+void s21_MainWindow::ShowCurve(PlottedCurve &plotted) {
+  CurveSampler::Curve thin = Controller::ThinCurve(plotted.curve, thinned_);
+  std::size_t piece = 0, size = thin.t.size();
+  for (std::size_t begin = 0; begin < size;) {
+    std::size_t end = begin;
+    while (end < size && !std::isnan(thin.x[end])) ++end;
+    if (end > begin) {
+      if (piece == plotted.pieces.size()) {
+        plotted.pieces.push_back(new QCPCurve(Plot()->xAxis, Plot()->yAxis));
+        plotted.pieces.back()->setPen(QPen(plotted.color));
       }
-      continue;
+      plotted.pieces[piece++]->setData(
+          QVector<double>(thin.t.begin() + begin, thin.t.begin() + end),
+          QVector<double>(thin.x.begin() + begin, thin.x.begin() + end),
+          QVector<double>(thin.y.begin() + begin, thin.y.begin() + end),
+          true);
     }
+    begin = end + 1;
+  }
+  for (; piece < plotted.pieces.size(); ++piece)
+    plotted.pieces[piece]->data()->clear();
+}
+
+CurveSampler::Viewport s21_MainWindow::PlotViewport() {
+  QCustomPlot *plot = Plot();
+  QRect rect = plot->axisRect()->rect();
+  if (rect.isEmpty()) rect = plot->rect();  // Not laid out before a replot
+  return {plot->xAxis->range().lower,
+          plot->xAxis->range().upper,
+          plot->yAxis->range().lower,
+          plot->yAxis->range().upper,
+          static_cast<double>(std::max(1, rect.width())),
+          static_cast<double>(std::max(1, rect.height()))};
+}
+
+void s21_MainWindow::on_Roots_Button_clicked() {
+  Controller::TraceSpan span("s21_MainWindow::on_Roots_Button_clicked",
+                             "view");
+  if (ui->Plot_Mode->currentIndex() != kFunction) return;
+  auto result = controller_.ProcessRoots(ui->Calculation_label->text(),
+                                         ui->Xmin->value(), ui->Xmax->value());
+  if (!result) {
+    ui->Calculation_label->setText("calc_error");
+    return;
+  }
+
+  if (!DrawGraph()) return;
+  AddMarkers(result->roots, std::vector<double>(result->roots.size()),
+             QCPScatterStyle::ssCircle, QColor(230, 143, 52));
+  AddMarkers(result->minima, result->minimum_values,
+             QCPScatterStyle::ssTriangle, Qt::darkGreen);
+  AddMarkers(result->maxima, result->maximum_values,
+             QCPScatterStyle::ssTriangleInverted, Qt::red);
+  Controller::TraceSpan replot("QCustomPlot::replot", "view");
+  Plot()->replot();
+}
 
-    y.push_back(result);
-    x.push_back(i);
+void s21_MainWindow::on_Integral_Button_clicked() {
+  auto result = controller_.ProcessIntegral(ui->Calculation_label->text(),
+                                            ui->Integral_From->value(),
+                                            ui->Integral_To->value());
+  if (!result) {
+    ui->Integral_Label->setText("calc_error");
+  } else if (!std::isfinite(result->value)) {
+    ui->Integral_Label->setText("diverges");
+  } else {
+    ui->Integral_Label->setText(
+        QString("= %1 ± %2")
+            .arg(Controller::FormatGeneral(result->value, 10))
+            .arg(Controller::FormatGeneral(result->error, 2)));
   }
+}
 
-  if (!x.empty()) ui->Graph->addGraph()->setData(x, y);
-  ui->Graph->xAxis->setRange(xmin, xmax);
-  ui->Graph->yAxis->setRange(ymin, ymax);
-  ui->Graph->replot();
+void s21_MainWindow::AddMarkers(const std::vector<double> &x,
+                                const std::vector<double> &y,
+                                QCPScatterStyle::ScatterShape shape,
+                                const QColor &color) {
+  if (x.empty()) return;
+  QCPGraph *graph = Plot()->addGraph();
+  graph->setData(QVector<double>(x.begin(), x.end()),
+                 QVector<double>(y.begin(), y.end()), true);
+  graph->setLineStyle(QCPGraph::lsNone);
+  graph->setScatterStyle(QCPScatterStyle(shape, color, 7));
 }
 
+QCustomPlot *s21_MainWindow::Plot() {
+  if (plot_ == nullptr) {
+    plot_ = new QCustomPlot(ui->Graph_area);
+    plot_->setGeometry(ui->Graph_area->rect());
+    plot_->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    connect(plot_, SIGNAL(beforeReplot()), this, SLOT(Plot_beforeReplot()));
+    plot_->show();
+  }
+  return plot_;
+}
 
+void s21_MainWindow::on_Credit_Button_clicked() {
+  if (!credit_calc_)
+    credit_calc_ = std::make_unique<s21::CreditCalc>(controller_);
+  credit_calc_->show();
+}
 
-void s21_MainWindow::on_Credit_Button_clicked() { credit_calc_.show(); }
+void s21_MainWindow::on_Deposit_Button_clicked() {
+  if (!deposit_calc_)
+    deposit_calc_ = std::make_unique<s21::DepositCalc>(controller_);
+  deposit_calc_->show();
+}
 
 }  // namespace s21
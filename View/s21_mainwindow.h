@@ -9,11 +9,20 @@
 #ifndef SMARTCALC_VIEW_S21_MAINWINDOW_H
 #define SMARTCALC_VIEW_S21_MAINWINDOW_H
 
+#include <QColor>
+#include <QElapsedTimer>
+#include <QKeyEvent>
 #include <QMainWindow>
+#include <QPaintEvent>
+#include <QPoint>
 #include <QString>
+#include <QStringList>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "../Controller/s21_controller.h"
-#include "s21_creditcalc.h"
+#include "../third_party/qcustomplot.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -23,6 +32,9 @@ QT_END_NAMESPACE
 
 namespace s21 {
 
+class CreditCalc;
+class DepositCalc;
+
 /**
  * @class s21_MainWindow
  * @brief The View class responsible for presenting data to the user
@@ -31,6 +43,10 @@ namespace s21 {
  * In the context of the Model-View-Controller (MVC) pattern,
  * the View is responsible for the visual representation of the application's
  * data.
+ *
+ * The credit and deposit calculators and the plot are created the first
+ * time they are needed, as most sessions use none of them, which keeps them
+ * and their Controllers out of the start-up time.
  */
 class s21_MainWindow : public QMainWindow {
   Q_OBJECT
@@ -49,6 +65,32 @@ class s21_MainWindow : public QMainWindow {
    */
   ~s21_MainWindow();
 
+  /**
+   * @brief Reports the time to the first frame of the window on stderr.
+   *
+   * @param[in] start A timer started at the beginning of main.
+   */
+  void MeasureStartup(const QElapsedTimer &start);
+
+ protected:
+  /**
+   * @brief Paints the window and, when measuring the start-up, reports the
+   * time once the first frame is out.
+   */
+  void paintEvent(QPaintEvent *event) override;
+
+  /**
+   * @brief Lets the expression be typed from the keyboard.
+   *
+   * Printable characters are appended to the calculation label, which is
+   * the only way to enter functions without a button such as sum(k, a, b, f)
+   * and prod(k, a, b, f). Backspace and Enter act as the Del and = buttons,
+   * and Up and Down browse the history of calculations.
+   *
+   * @param event The key event.
+   */
+  void keyPressEvent(QKeyEvent *event) override;
+
  private slots:
 
   /**
@@ -89,6 +131,18 @@ class s21_MainWindow : public QMainWindow {
    */
   void on_Dot_Button_clicked();
 
+  /**
+   * @brief Shows the value of the expression being typed under it, or
+   * nothing if it cannot be previewed.
+   */
+  void ShowPreview();
+
+  /**
+   * @brief Shows the latest calculations in a menu at @p position of the
+   * calculation label, recalling the one chosen.
+   */
+  void ShowHistory(const QPoint &position);
+
   /**
    * @brief Slot for handling changes in the Xmin value.
    * @param value The new value of Xmin.
@@ -124,17 +178,177 @@ class s21_MainWindow : public QMainWindow {
    */
   void on_Credit_Button_clicked();
 
+  /**
+   * @brief Slot for handling the click event of the Deposit Button.
+   * Shows the deposit calculator dialog.
+   */
+  void on_Deposit_Button_clicked();
+
   /**
    * @brief Slot for handling the click event of the Graph Button.
-   * Clears existing graphs, generates x and y values, and plots the graph.
+   * Clears existing graphs and plots the expressions of the calculation
+   * label, separated by ';', in the mode chosen: functions of x on a grid
+   * from Xmin to Xmax, or curves with their parameter from Xmin to Xmax.
    */
   void on_Graph_Button_clicked();
 
+  /**
+   * @brief Slot for handling the click event of the Plot Add Button.
+   * Plots the expressions of the calculation label over the graphs already
+   * shown, on their grid, without resampling them.
+   */
+  void on_Plot_Add_Button_clicked();
+
+  /**
+   * @brief Slot for handling a change of the plot mode.
+   * Names the range of the parameter after the mode.
+   * @param index The new mode, a PlotMode.
+   */
+  void on_Plot_Mode_currentIndexChanged(int index);
+
+  /**
+   * @brief Slot called before the plot is redrawn.
+   * Thins the curves again when the scale of the plot has changed, and
+   * samples the implicit curves again when the view has moved, as well as
+   * the graphs once it shows values they were not sampled for.
+   */
+  void Plot_beforeReplot();
+
+  /**
+   * @brief Slot for handling the click event of the Roots Button.
+   * Plots the graph and marks its roots, minima and maxima on [Xmin, Xmax].
+   * Does nothing unless the plot mode is functions of x.
+   */
+  void on_Roots_Button_clicked();
+
+  /**
+   * @brief Slot for handling the click event of the Integral Button.
+   * Shows the definite integral of the expression with its error estimate.
+   */
+  void on_Integral_Button_clicked();
+
  private:
+  /// The entries of the plot mode box.
+  enum PlotMode { kFunction, kParametric, kPolar, kImplicit };
+
+  /**
+   * @struct PlottedCurve
+   * @brief A sampled curve and the pieces it is drawn with.
+   */
+  struct PlottedCurve {
+    s21::CurveSampler::Curve curve;
+    QColor color;
+    std::vector<QCPCurve *> pieces;  ///< Between breaks; owned by the plot.
+    QString implicit;  ///< f of a curve f(x,y)=0, sampled for every view.
+  };
+
+  /**
+   * @brief Moves @p step calculations back in the history, forward if
+   * negative, and recalls the one reached, or the text typed before
+   * browsing once past the latest.
+   */
+  void BrowseHistory(int step);
+
+  /**
+   * @brief Shows a calculation of the history with its x and result.
+   */
+  void Recall(const s21::HistoryFile::Record &record);
+
+  /**
+   * @brief Adds a graph of unconnected markers to the plot.
+   *
+   * @param[in] x The x coordinates of the markers.
+   * @param[in] y The y coordinates of the markers.
+   * @param[in] shape The scatter shape of the markers.
+   * @param[in] color The color of the markers.
+   */
+  void AddMarkers(const std::vector<double> &x, const std::vector<double> &y,
+                  QCPScatterStyle::ScatterShape shape, const QColor &color);
+
+  /**
+   * @brief Clears the plot and adds the expressions of the calculation
+   * label in the plot mode chosen, without replotting.
+   *
+   * @return False, with "plot error" shown, if an expression is invalid.
+   */
+  bool DrawGraph();
+
+  /**
+   * @brief Returns the plot, creating it in its area on the first call.
+   */
+  QCustomPlot *Plot();
+
+  /**
+   * @brief Samples the expressions of the calculation label on the grid and
+   * adds a graph of its own color for each one.
+   *
+   * @return False, with "plot error" shown, if an expression is invalid.
+   */
+  bool AddFunctions();
+
+  /**
+   * @brief Samples the graphs again for the visible range of y.
+   */
+  void ResampleFunctions();
+
+  /**
+   * @brief Sets the data of @p graph to @p sampled on grid_, with a gap at
+   * each of its breaks.
+   */
+  void SetGraphData(QCPGraph *graph, const s21::GraphSampler::Graph &sampled);
+
+  /**
+   * @brief Returns half the height of a pixel of the plot, the error allowed
+   * in the values of the graphs.
+   */
+  double PlotTolerance();
+
+  /**
+   * @brief Samples the curves of the calculation label, parametric, polar
+   * or implicit as the plot mode says, and adds each one in its own color.
+   *
+   * @return False, with "plot error" shown, if an expression is invalid or
+   * one of a parametric pair is missing.
+   */
+  bool AddCurves();
+
+  /**
+   * @brief Draws the points of @p plotted worth drawing at the scale of
+   * thinned_.
+   */
+  void ShowCurve(PlottedCurve &plotted);
+
+  /**
+   * @brief Returns the visible rectangle of the plot and its size in pixels.
+   */
+  s21::CurveSampler::Viewport PlotViewport();
+
   Ui::s21_MainWindow *ui;  ///< A pointer to an interface object.
-  s21::Controller
-      controller_;  ///< The associated Controller handling credit calculations.
-  s21::CreditCalc credit_calc_;  ///< The View of Credit Calculator.
+  /// The Controller of the application, shared with the calculator windows,
+  /// which owns the definitions, the precompiled library and the history.
+  s21::Controller controller_;
+  std::unique_ptr<s21::CreditCalc>
+      credit_calc_;  ///< The View of Credit Calculator, once opened.
+  std::unique_ptr<s21::DepositCalc>
+      deposit_calc_;  ///< The View of Deposit Calculator, once opened.
+  QCustomPlot *plot_ = nullptr;  ///< The plot, once created; owned by Qt.
+  QStringList functions_;        ///< The expressions plotted, in order.
+  std::vector<double> grid_;     ///< The x values shared by the graphs.
+  /// The graphs of functions_, in order; owned by the plot.
+  std::vector<QCPGraph *> graphs_;
+  /// The range of y the graphs are sampled for, beyond the visible one.
+  QCPRange sampled_;
+  /// The parametric, polar and implicit curves, in order.
+  std::vector<PlottedCurve> curves_;
+  /// The scale the curves were last thinned for.
+  s21::CurveSampler::Viewport thinned_{};
+  /// The calculations browsed, the latest first, loaded on the first step.
+  std::vector<s21::HistoryFile::Record> history_;
+  /// The calculation of history_ shown, or -1 while not browsing.
+  int history_position_ = -1;
+  QString typed_;  ///< The text of the label before browsing.
+  std::optional<QElapsedTimer>
+      startup_;  ///< Started with the process, while measuring.
   bool is_trigonometry_ = false;
 };
 
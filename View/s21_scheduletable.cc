@@ -0,0 +1,58 @@
+/**
+ * @file s21_scheduletable.cc
+ * @brief Implementation file for the s21_scheduletable.h.
+ */
+
+#include "s21_scheduletable.h"
+
+#include <QString>
+
+namespace s21 {
+
+namespace {
+
+/// Column titles: payment, interest, principal and remaining debt.
+const char *const kHeaders[] = {"Платёж", "Проценты", "Основной долг",
+                                "Остаток"};
+
+}  // namespace
+
+ScheduleTable::ScheduleTable(QObject *parent) : QAbstractTableModel(parent) {}
+
+bool ScheduleTable::Update(
+    const std::function<bool(CreditModel::Schedule &)> &fill) {
+  beginResetModel();
+  bool is_filled = fill(schedule_);
+  if (!is_filled) schedule_ = CreditModel::Schedule();
+  endResetModel();
+  return is_filled;
+}
+
+int ScheduleTable::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(schedule_.Size());
+}
+
+int ScheduleTable::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : 4;
+}
+
+QVariant ScheduleTable::data(const QModelIndex &index, int role) const {
+  if (!index.isValid()) return QVariant();
+  if (role == Qt::TextAlignmentRole)
+    return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+  if (role != Qt::DisplayRole) return QVariant();
+
+  const std::vector<double> *columns[] = {
+      &schedule_.payment, &schedule_.interest, &schedule_.principal,
+      &schedule_.balance};
+  return Controller::FormatFixed((*columns[index.column()])[index.row()]);
+}
+
+QVariant ScheduleTable::headerData(int section, Qt::Orientation orientation,
+                                   int role) const {
+  if (role != Qt::DisplayRole) return QVariant();
+  if (orientation == Qt::Vertical) return section + 1;
+  return QString(kHeaders[section]);
+}
+
+}  // namespace s21
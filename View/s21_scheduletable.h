@@ -0,0 +1,58 @@
+/**
+ * @file s21_scheduletable.h
+ * @brief Header file containing the declaration of the ScheduleTable, the
+ * table model presenting an amortization schedule.
+ */
+
+#ifndef SMARTCALC_VIEW_S21_SCHEDULETABLE_H
+#define SMARTCALC_VIEW_S21_SCHEDULETABLE_H
+
+#include <QAbstractTableModel>
+#include <QModelIndex>
+#include <QVariant>
+#include <functional>
+
+#include "../Controller/s21_controller.h"
+
+namespace s21 {
+
+/**
+ * @class ScheduleTable
+ * @brief Read-only table model over the buffers of a credit schedule.
+ *
+ * The model formats cells on request, so a QTableView only converts the rows
+ * it is currently showing, however long the schedule is.
+ */
+class ScheduleTable : public QAbstractTableModel {
+  Q_OBJECT
+
+ public:
+  /**
+   * @brief Constructor for the ScheduleTable class.
+   * @param parent The parent object (default is nullptr).
+   */
+  explicit ScheduleTable(QObject *parent = nullptr);
+
+  /**
+   * @brief Refills the schedule and notifies the attached views.
+   *
+   * @param[in] fill Writes the new schedule into the buffers, reusing their
+   * capacity, and returns false on invalid input.
+   * @return The value returned by @p fill; the table is empty on false.
+   */
+  bool Update(const std::function<bool(CreditModel::Schedule &)> &fill);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+ private:
+  CreditModel::Schedule schedule_;  ///< The periods shown by the table.
+};
+
+}  // namespace s21
+
+#endif  // SMARTCALC_VIEW_S21_SCHEDULETABLE_H